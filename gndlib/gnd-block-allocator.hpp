@@ -0,0 +1,307 @@
+/*
+ * gnd-block-allocator.hpp
+ *
+ *  fixed size memory block pool for grid-map memory units
+ */
+
+#ifndef GND_BLOCK_ALLOCATOR_HPP_
+#define GND_BLOCK_ALLOCATOR_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "gnd-lib-error.h"
+
+/**
+ * @ifnot GNDStorage
+ * @defgroup GNDStorage storage
+ * @endif
+ */
+
+/**
+ * @defgroup GNDBlockAllocator block-allocator
+ * @ingroup GNDStorage
+ * supply fixed size memory block pool for grid-map memory units.
+ * blocks are cut out of large anonymous mapped chunks (arena) and
+ * released blocks are kept in a free list to be reused.
+ */
+
+// ---> constant value definition
+namespace gnd {
+	/// @brief alignment of blocks (cache line)
+	static const size_t BlockAllocatorAlignment = 64;
+	/// @brief minimum byte size of chunk
+	static const size_t BlockAllocatorChunkMin = 1 << 20;
+	/// @brief huge page size
+	static const size_t BlockAllocatorHugePage = 2 << 20;
+}
+// <--- constant value definition
+
+
+// ---> type declaration
+namespace gnd {
+	/**
+	 * @ingroup GNDBlockAllocator
+	 * @brief fixed size memory block pool
+	 * @details allocate() takes a block from the free list, or cuts a new one out of the current chunk.
+	 * deallocate() only pushes the block to the free list, and chunks are returned to the system by release().
+	 * chunks are anonymous mapped memory, so pages which are never touched cost no physical memory.
+	 * with huge page backing, chunks are 2MB aligned and taken from reserved huge pages (MAP_HUGETLB) if possible,
+	 * otherwise transparent huge pages are requested (MADV_HUGEPAGE).
+	 * @note not thread safe
+	 */
+	class block_allocator {
+		// ---> constructor, destructor
+	public:
+		block_allocator();
+		~block_allocator();
+		// <--- constructor, destructor
+
+		// ---> variables
+	private:
+		/// @brief chunk header (placed at the head of each chunk)
+		struct chunk {
+			chunk *next;		///< next chunk
+			size_t length;		///< mapped length
+		};
+		/// @brief list of chunks
+		struct chunk *_chunk;
+		/// @brief free list of released blocks
+		void *_free;
+		/// @brief unused area of current chunk
+		char *_cur, *_end;
+		/// @brief block size (aligned)
+		size_t _bsize;
+		/// @brief chunk size
+		size_t _csize;
+		/// @brief huge page backing
+		bool _huge;
+		/// @brief number of blocks in use
+		size_t _nuse;
+		// <--- variables
+
+	public:
+		int initialize(size_t bs, size_t nb = 0, bool huge = false);
+		int release();
+		bool is_initialized() const;
+		size_t block_size() const;
+		size_t nblocks() const;
+		size_t reserved() const;
+		void* allocate();
+		int deallocate(void *p);
+	private:
+		int _grow_();
+		block_allocator(const block_allocator&);
+		block_allocator& operator=(const block_allocator&);
+	};
+}
+// <--- type declaration
+
+
+
+// ---> function definition
+namespace gnd {
+
+	/**
+	 * @brief constructor
+	 */
+	inline
+	block_allocator::block_allocator()
+	: _chunk(0), _free(0), _cur(0), _end(0), _bsize(0), _csize(0), _huge(false), _nuse(0)
+	{
+	}
+
+	/**
+	 * @brief destructor
+	 */
+	inline
+	block_allocator::~block_allocator()
+	{
+		release();
+	}
+
+	/**
+	 * @brief set block size
+	 * @param[in]   bs : byte size of a block
+	 * @param[in]   nb : number of blocks in a chunk (0: chunks are at least BlockAllocatorChunkMin bytes)
+	 * @param[in] huge : back chunks with 2MB huge pages (chunk size is rounded up to 2MB)
+	 * @note if the setting is changed, all chunks are released (it fails while some blocks are in use).
+	 * otherwise chunks are kept for reuse.
+	 */
+	inline
+	int block_allocator::initialize(size_t bs, size_t nb, bool huge)
+	{
+		gnd_assert(bs == 0, -1, "invalid argument");
+
+		{ // ---> operation
+			const size_t page = huge ? BlockAllocatorHugePage : (size_t) ::sysconf(_SC_PAGESIZE);
+			const size_t head = (sizeof(struct chunk) + BlockAllocatorAlignment - 1) & ~(BlockAllocatorAlignment - 1);
+			size_t b, c;
+
+			b = (bs + BlockAllocatorAlignment - 1) & ~(BlockAllocatorAlignment - 1);
+			if( nb == 0 ) {
+				nb = (BlockAllocatorChunkMin - head) / b;
+				nb = nb > 0 ? nb : 1;
+			}
+			c = (head + b * nb + page - 1) / page * page;
+			if( b == _bsize && c == _csize && huge == _huge )	return 0;
+
+			gnd_error(_nuse > 0, -1, "blocks are in use");
+			release();
+			_bsize = b;
+			_csize = c;
+			_huge = huge;
+		} // <--- operation
+		return 0;
+	}
+
+	/**
+	 * @brief return all chunks to the system
+	 * @note blocks in use become invalid
+	 */
+	inline
+	int block_allocator::release()
+	{
+		while( _chunk ) {
+			struct chunk *c = _chunk;
+			_chunk = c->next;
+			::munmap(c, c->length);
+		}
+		_free = 0;
+		_cur = _end = 0;
+		_nuse = 0;
+		return 0;
+	}
+
+	/**
+	 * @brief block size is set or not
+	 */
+	inline
+	bool block_allocator::is_initialized() const
+	{
+		return _bsize > 0;
+	}
+
+	/**
+	 * @brief byte size of a block (aligned)
+	 */
+	inline
+	size_t block_allocator::block_size() const
+	{
+		return _bsize;
+	}
+
+	/**
+	 * @brief number of blocks in use
+	 */
+	inline
+	size_t block_allocator::nblocks() const
+	{
+		return _nuse;
+	}
+
+	/**
+	 * @brief byte size of mapped chunks
+	 */
+	inline
+	size_t block_allocator::reserved() const
+	{
+		size_t s = 0;
+		for( struct chunk *c = _chunk; c; c = c->next )	s += c->length;
+		return s;
+	}
+
+	/**
+	 * @brief get a block
+	 * @return null : fail
+	 * @note contents of a block are undefined
+	 */
+	inline
+	void* block_allocator::allocate()
+	{
+		void *p;
+
+		gnd_assert(_bsize == 0, 0, "block size is not set");
+
+		if( _free ) {
+			// reuse released block
+			p = _free;
+			_free = *static_cast<void**>(_free);
+		}
+		else {
+			if( _cur + _bsize > _end && _grow_() < 0 )	return 0;
+			p = _cur;
+			_cur += _bsize;
+		}
+		_nuse++;
+		return p;
+	}
+
+	/**
+	 * @brief release a block
+	 * @param[in] p : block (null is ignored)
+	 * @note the block is kept for reuse, not returned to the system
+	 */
+	inline
+	int block_allocator::deallocate(void *p)
+	{
+		if( !p )	return 0;
+		gnd_assert(_nuse == 0, -1, "no block is in use");
+
+		*static_cast<void**>(p) = _free;
+		_free = p;
+		_nuse--;
+		return 0;
+	}
+
+	/**
+	 * @privatesection
+	 * @brief map a new chunk
+	 */
+	inline
+	int block_allocator::_grow_()
+	{
+		const size_t head = (sizeof(struct chunk) + BlockAllocatorAlignment - 1) & ~(BlockAllocatorAlignment - 1);
+		const size_t length = _csize;
+		char *addr = static_cast<char*>(MAP_FAILED);
+
+#ifdef MAP_HUGETLB
+		// reserved huge pages (fails if they are not reserved)
+		if( _huge )	addr = static_cast<char*>( ::mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0) );
+#endif
+		if( addr == MAP_FAILED && _huge ) { // ---> transparent huge pages
+			char *top;
+
+			// map with margin to align to huge page, and unmap the margin
+			addr = static_cast<char*>( ::mmap(0, length + BlockAllocatorHugePage, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) );
+			if( addr == MAP_FAILED )	return -1;
+			top = reinterpret_cast<char*>( (reinterpret_cast<uintptr_t>(addr) + BlockAllocatorHugePage - 1) & ~(uintptr_t)(BlockAllocatorHugePage - 1) );
+			if( top > addr )	::munmap(addr, top - addr);
+			::munmap(top + length, (addr + BlockAllocatorHugePage) - top);
+			addr = top;
+#ifdef MADV_HUGEPAGE
+			::madvise(addr, length, MADV_HUGEPAGE);
+#endif
+		} // <--- transparent huge pages
+		else if( addr == MAP_FAILED ) {
+			addr = static_cast<char*>( ::mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) );
+			if( addr == MAP_FAILED )	return -1;
+		}
+
+		{ // ---> link chunk
+			struct chunk *c = reinterpret_cast<struct chunk*>(addr);
+			c->next = _chunk;
+			c->length = length;
+			_chunk = c;
+		} // <--- link chunk
+
+		_cur = addr + head;
+		_end = addr + length;
+		return 0;
+	}
+}
+// <--- function definition
+
+#endif /* GND_BLOCK_ALLOCATOR_HPP_ */
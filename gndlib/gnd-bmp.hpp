@@ -296,7 +296,7 @@ namespace gnd {
 				// write image data
 				for( size_t h = 0; h < (unsigned)iheader.biHeight; h++ ){
 					for( size_t w = 0; w < (unsigned)iheader.biWidth; w += gm->_unit_column_() ){
-						if( ::write(fd, gm->pointer(h, w), gm->_unit_column_() * sizeof(unsigned char)) <
+						if( ::write(fd, gm->cpointer(h, w), gm->_unit_column_() * sizeof(unsigned char)) <
 								((signed)gm->_unit_column_() * (signed)sizeof(unsigned char)) )	return -1;
 					}
 					for( size_t i = 0; i < pad; i++ ){
@@ -493,7 +493,7 @@ namespace gnd {
 				// write image data
 				for( size_t h = 0; h < (unsigned)iheader.biHeight; h++ ){
 					for( size_t w = 0; w < (unsigned)iheader.biWidth; w += gm->_unit_column_() ){
-						if( ::write(fd, gm->pointer(h, w), gm->_unit_column_() * sizeof(uint32_t)) <
+						if( ::write(fd, gm->cpointer(h, w), gm->_unit_column_() * sizeof(uint32_t)) <
 								((signed)gm->_unit_column_() * (signed)sizeof(uint32_t)) )	return -1;
 					}
 					for( size_t i = 0; i < pad; i++ ){
@@ -9,6 +9,7 @@
 #define GND_COORD_TREE_HPP_
 
 #include "gnd-matrix-base.hpp"
+#include "gnd-matrix-coordinate.hpp"
 #include "gnd-queue.hpp"
 
 
@@ -36,6 +37,10 @@ namespace gnd { // ---> namespace gnd
 			int parent;								///< parent node index
 			char name[NameLength];					///< name of coordinate
 
+			coord_matrix root;						///< cache: coordinate convert matrix from this node to root
+			coord_matrix root_inv;					///< cache: coordinate convert matrix from root to this node
+			bool dirty;								///< cache is invalid (if parent is dirty, child is also dirty)
+
 			// ---> constructor
 			coord_node();
 			coord_node( const flex* obj );
@@ -81,6 +86,11 @@ namespace gnd {
 			tree_t _tree;						///< coorinate tree
 			int _id;							///< issued id No
 
+			// ---> cache
+		private:
+			int _update_cache_(const int i);
+			int _invalidate_cache_(const int i);
+
 			// ---> create coordinate
 		private:
 			int create_root(node_t *rt);
@@ -111,6 +121,10 @@ namespace gnd {
 		public:
 			template< typename T1, typename T2, typename MTRX >
 			int get_convert_matrix( const T1& f, const T2& t, MTRX *m );
+			template< typename T1, typename T2 >
+			int get_convert_matrix( const T1& f, const T2& t, coord2d *m );
+			template< typename T1, typename T2, typename T3, typename MTRX1, typename MTRX2 >
+			int get_convert_matrices( const T1& f, const T2& t, const T3& p, const MTRX1 *c, const size_t n, MTRX2 *m );
 
 			int get_node_id(const char* n);
 		};
@@ -127,7 +141,7 @@ namespace gnd {
 		 */
 		inline
 		coord_node::coord_node()
-		: id(coord_tree::InvalidID), depth(coord_tree::InvalidDepth), parent(coord_tree::InvalidParent)
+		: id(coord_tree::InvalidID), depth(coord_tree::InvalidDepth), parent(coord_tree::InvalidParent), dirty(true)
 		{
 			::memset(name, 0, sizeof(name));
 		}
@@ -138,7 +152,7 @@ namespace gnd {
 		 */
 		inline
 		coord_node::coord_node( const flex *c)
-		: id(coord_tree::InvalidID), depth(coord_tree::InvalidDepth), parent(coord_tree::InvalidParent)
+		: id(coord_tree::InvalidID), depth(coord_tree::InvalidDepth), parent(coord_tree::InvalidParent), dirty(true)
 		{
 			::memset(name, 0, sizeof(name));
 			matrix::copy(this, c);
@@ -148,7 +162,7 @@ namespace gnd {
 		 * @brief copy constructor
 		 */
 		inline coord_node::coord_node( const coord_matrix* c )
-		: id(coord_tree::InvalidID), depth(coord_tree::InvalidDepth), parent(coord_tree::InvalidParent)
+		: id(coord_tree::InvalidID), depth(coord_tree::InvalidDepth), parent(coord_tree::InvalidParent), dirty(true)
 		{
 			::memset(name, 0, sizeof(name));
 			matrix::copy(this, c);
@@ -201,6 +215,9 @@ namespace gnd {
 			root.depth = RootDepth;
 			// set root coordinate matrix(unit matirx)
 			set_unit(&root);
+			set_unit(&root.root);
+			set_unit(&root.root_inv);
+			root.dirty = false;
 			// put in cooridnate tree
 			_tree.push_back( &root );
 		}
@@ -301,11 +318,13 @@ namespace gnd {
 		int coord_tree::set_coordinate( const int id, const MTRX *o )
 		{
 			int pi;
-			if( !(pi = find(id)) ){
+			// root coordinate is fixed
+			if( (pi = find(id)) <= 0 ){
 				return -1;
 			}
 			// set coordinate matrix
 			matrix::copy(&_tree[pi], o);
+			_invalidate_cache_(pi);
 
 			return 0;
 		}
@@ -321,11 +340,13 @@ namespace gnd {
 		int coord_tree::set_coordinate( const char *n, const MTRX *o )
 		{
 			int pi;
-			if( !(pi = find(n)) ){
+			// root coordinate is fixed
+			if( (pi = find(n)) <= 0 ){
 				return -1;
 			}
 			// set coordinate matrix
 			matrix::copy(&_tree[pi], o);
+			_invalidate_cache_(pi);
 
 			return 0;
 		}
@@ -358,6 +379,8 @@ namespace gnd {
 		int coord_tree::find(const int id)
 		{
 			uint64_t i;
+			// id is issued in order of addition
+			if( id >= 0 && (unsigned) id < _tree.size() && _tree[id].id == id )	return id;
 			for( i = 0; i < _tree.size(); i++){
 				if( _tree[i].id == id )	return i;
 			}
@@ -366,21 +389,79 @@ namespace gnd {
 
 
 
+		/**
+		 * @privatesection
+		 * @brief update cache of root-relative coordinate convert matrix
+		 * @param [in] i : node index
+		 * @return    0 :
+		 * @details the ancestors are updated first, then this node is
+		 * root = parent's root * coordinate matrix.
+		 */
+		inline
+		int coord_tree::_update_cache_(const int i)
+		{
+			node_t *node = &_tree[i];
+
+			if( !node->dirty ) {
+				return 0;
+			}
+
+			if( node->parent < 0 ) {
+				set_unit(&node->root);
+				set_unit(&node->root_inv);
+			}
+			else {
+				const coord_matrix *c = node;
+
+				_update_cache_(node->parent);
+				matrix::prod(&_tree[node->parent].root, c, &node->root);
+				matrix::inverse(&node->root, &node->root_inv);
+			}
+			node->dirty = false;
+			return 0;
+		}
+
+		/**
+		 * @privatesection
+		 * @brief invalidate cache of a node and its subtree
+		 * @param [in] i : node index
+		 * @return    0 :
+		 * @details a child is always added after its parent,
+		 * so that the subtree is marked in one pass from the node.
+		 */
+		inline
+		int coord_tree::_invalidate_cache_(const int i)
+		{
+			uint64_t j;
+
+			// subtree is already dirty
+			if( _tree[i].dirty ) {
+				return 0;
+			}
+
+			_tree[i].dirty = true;
+			for( j = i + 1; j < _tree.size(); j++ ){
+				if( _tree[j].parent >= 0 && _tree[ _tree[j].parent ].dirty )	_tree[j].dirty = true;
+			}
+			return 0;
+		}
+
+
+
 		/**
 		 * @brief get cooridnate convert matrix
 		 * @param  [in] f : from (name or id)
 		 * @param  [in] t : to   (name or id)
 		 * @param [out] m : coordinate convert matrix from f to t
 		 * @return    < 0 : fail to find node(f or t)
+		 * @details root-relative matrices are cached on each node,
+		 * so that it is a matrix product unless the coordinates have been changed.
 		 */
 		template< typename T1, typename T2, typename MTRX >
 		inline
 		int coord_tree::get_convert_matrix( const T1& f, const T2& t, MTRX *m )
 		{
-			matrix::fixed< 4, 4 > fconv;
-			matrix::fixed< 4, 4 > tconv;
-			matrix::fixed< 4, 4 > ws;		// work space
-			int fi, ti;						// traversal node index (starting form "f" and "t")
+			int fi, ti;						// node index of "f" and "t"
 
 			// find from-cooridnate
 			fi = find( f );
@@ -393,47 +474,105 @@ namespace gnd {
 				return -1;
 			}
 
-			{ // ---> initialize
-				set_unit(&fconv);
-				set_unit(&tconv);
-			} // <--- initialize
-
-			// ---> tree traversal loop
-			// traverse the parent node of both "t" and "f"
-			// until traversal nodes starting from both "t" and "f" is identical
-			while(_tree[fi].id != _tree[ti].id){
-				// check depth
-				int depth = _tree[fi].depth > _tree[ti].depth ? _tree[fi].depth : _tree[ti].depth;
-
-				if( _tree[fi].depth >= depth ){
-					// add to coordinate convert matrix
-					copy(&ws, &fconv);
-					matrix::prod(&_tree[fi], &ws, &fconv);
-					// get parent node index
-					fi = _tree[fi].parent;
-				}
+			if( fi == ti ) {
+				set_unit(m);
+				return 0;
+			}
+
+			_update_cache_(fi);
+			_update_cache_(ti);
 
-				if( _tree[ti].depth >= depth ){
-					// add to coordinate convert matrix
-					matrix::copy(&ws, &tconv);
-					matrix::prod(&_tree[ti], &ws, &tconv);
-					// get parent node index
-					ti = _tree[ti].parent;
+			// (root to "t") * ("f" to root)
+			return matrix::prod(&_tree[ti].root_inv, &_tree[fi].root, m);
+		}
+
+		/**
+		 * @brief get coordinate convert matrices for many coordinates of a node
+		 * @param  [in] f : from (name or id)
+		 * @param  [in] t : to   (name or id)
+		 * @param  [in] p : node which coordinate is replaced (name or id), "f" itself or its ancestor
+		 * @param  [in] c : coordinate matrices of "p" (n)
+		 * @param  [in] n : number of coordinate matrices
+		 * @param [out] m : coordinate convert matrices from "f" to "t" for each coordinate of "p" (n)
+		 * @return    < 0 : fail to find node, "p" is not "f" or its ancestor, or "t" is in the subtree of "p"
+		 * @details the tree is not changed.
+		 * the part of "t" side and the part between "f" and "p" are computed once,
+		 * so that each coordinate costs two matrix products.
+		 * e.g. sensor to global convert matrices of the particles of robot position.
+		 */
+		template< typename T1, typename T2, typename T3, typename MTRX1, typename MTRX2 >
+		inline
+		int coord_tree::get_convert_matrices( const T1& f, const T2& t, const T3& p, const MTRX1 *c, const size_t n, MTRX2 *m )
+		{
+			matrix::fixed< 4, 4 > a;		// from parent of "p" to "t"
+			matrix::fixed< 4, 4 > b;		// from "f" to "p"
+			matrix::fixed< 4, 4 > ws;		// work space
+			int fi, ti, pi;					// node index of "f", "t" and "p"
+			int i;
+
+			gnd_assert(n > 0 && (!c || !m), -1, "null pointer");
+
+			if( (fi = find( f )) < 0 ) {
+				return -1;
+			}
+			if( (ti = find( t )) < 0 ) {
+				return -1;
+			}
+			// root coordinate is fixed
+			if( (pi = find( p )) <= 0 ) {
+				return -1;
+			}
+
+			// "t" must not depend on coordinate of "p"
+			for( i = ti; i >= 0; i = _tree[i].parent ){
+				if( i == pi )	return -1;
+			}
+
+			{ // ---> from "f" to "p"
+				set_unit(&b);
+				for( i = fi; i != pi; i = _tree[i].parent ){
+					const coord_matrix *ci;
+					// "p" is not ancestor of "f"
+					if( i < 0 )	return -1;
+					ci = &_tree[i];
+					matrix::prod(ci, &b, &b);
 				}
-			} // ---> tree traversal loop
+			} // <--- from "f" to "p"
 
-			{ // ---> invert matrix
-				matrix::copy(&ws, &tconv);
-				matrix::inverse(&ws, &tconv);
-			} // <--- invert matrix
+			{ // ---> from parent of "p" to "t"
+				_update_cache_(ti);
+				_update_cache_(_tree[pi].parent);
+				matrix::prod(&_tree[ti].root_inv, &_tree[ _tree[pi].parent ].root, &a);
+			} // <--- from parent of "p" to "t"
 
-			{ // ---> fuse
-				matrix::prod(&tconv, &fconv, m);
-			} // <--- fuse
+			for( size_t k = 0; k < n; k++ ){
+				matrix::prod(c + k, &b, &ws);
+				matrix::prod(&a, &ws, m + k);
+			}
 
 			return 0;
 		}
 
+		/**
+		 * @brief get planar rigid transform
+		 * @param  [in] f : from (name or id)
+		 * @param  [in] t : to   (name or id)
+		 * @param [out] m : planar rigid transform from f to t
+		 * @return    < 0 : fail to find node(f or t)
+		 * @details the out of plane component of the coordinate convert matrix is ignored.
+		 */
+		template< typename T1, typename T2 >
+		inline
+		int coord_tree::get_convert_matrix( const T1& f, const T2& t, coord2d *m )
+		{
+			matrix::fixed< 4, 4 > cm;
+
+			if( get_convert_matrix(f, t, &cm) < 0 ) {
+				return -1;
+			}
+			return coord2d_from_matrix(m, &cm);
+		}
+
 		/**
 		 * @brief get node id
 		 * @param [in] n : name
@@ -17,6 +17,7 @@
 #include <errno.h>
 
 #include "gnd-wrap-sys.hpp"
+#include "gnd-block-allocator.hpp"
 
 // include debug logging function
 #define GND_DEBUG_LOG_NAMESPACE1 gnd
@@ -93,12 +94,23 @@ namespace gnd { // ---> namespace gnd
 		 * @ingroup GNDGridMap
 		 * @brief grid-map basic class
 		 * @tparam T : stored data type in a pixel
+		 * @details pixels are stored in memory units (blocks of unit-row x unit-column pixels).
+		 * memory units are allocated on the first write access, so empty area costs only a directory entry.
+		 * the directory keeps margin in each direction, and growing the map only moves the directory origin
+		 * until the margin runs out (then the directory is doubled), so reallocate() is O(1) amortized
+		 * and never copies pixel data.
+		 * memory units are taken from the block allocator of the map, so they are cut out of
+		 * large chunks instead of the heap. chunks are kept by deallocate() and reused by the next allocation,
+		 * and they are returned to the system when the map is destroyed.
+		 * T is copied by memcpy, so it must be trivially copyable.
 		 */
 		template < typename T>
 		class basic_gridmap {
 		public:
 			/// @brief pointer type
 			typedef T*		pt;
+			/// @brief const pointer type
+			typedef const T*	const_pt;
 			/// @brief double pointer type
 			typedef T**		wpt;
 			/// @brief triple pointer type
@@ -114,14 +126,27 @@ namespace gnd { // ---> namespace gnd
 
 			// ---> variables
 		protected:
-			/// @brief data storage header pointer
-			tpt _header;
+			/// @brief memory unit directory (row major, null: not allocated yet)
+			wpt _header;
+			/// @brief size of memory unit directory
+			gridmap::pixelindex _dir;
+			/// @brief directory index of memory unit (0, 0)
+			gridmap::pixelindex _dorg;
+			/// @brief initial pixel value
+			T _init;
+			/// @brief pixel values of memory units that are not allocated yet
+			/// (null while the plane has only one memory unit, which is always allocated)
+			pt _empty;
 			/// @brief number of memory unit
 			gridmap::pixelindex _unit;
 			/// @brief number of plane
 			gridmap::pixelindex _plane;
 			/// @brief flag of auto allocation
 			bool autoreallocate;
+			/// @brief block allocator of memory units
+			block_allocator _pool;
+			/// @brief flag of huge page backing of memory units
+			bool _huge;
 			// <--- variables
 
 			// ---> allocate, deallocate
@@ -132,8 +157,15 @@ namespace gnd { // ---> namespace gnd
 			virtual bool is_allocate();
 			virtual int reallocate(const unsigned long sr, const unsigned long sc,
 					const unsigned long hr, const unsigned long hc);
+			int shrink();
 		public:
 			int set_autoreallocate(bool flg);
+			int set_huge_page(bool flg);
+		private:
+			pt* _slot_(const uint32_t r, const uint32_t c);
+			pt _fill_(pt *s);
+			void _initialize_unit_(pt u);
+			int _resize_directory_(const uint32_t pr, const uint32_t pc, const uint32_t hr, const uint32_t hc);
 			// <--- allocate, deallocate
 
 			// ---> setter, getter
@@ -142,14 +174,36 @@ namespace gnd { // ---> namespace gnd
 			 * @brief get pixel pointer
 			 * @param[in] r: pixel row index
 			 * @param[in] c: pixel column index
+			 * @note the memory unit is allocated if it is not yet
 			 */
 			pt pointer(const unsigned long r, const unsigned long c);
+			/**
+			 * @brief get pixel pointer for read only access
+			 * @param[in] r: pixel row index
+			 * @param[in] c: pixel column index
+			 * @note never allocate memory unit
+			 */
+			const_pt cpointer(const unsigned long r, const unsigned long c);
 			/**
 			 * @brief get plane pointer
 			 * @param[in] r: plane row index
 			 * @param[in] c: plane column index
+			 * @note the memory unit is allocated if it is not yet
 			 */
 			pt blockheader(const uint32_t r, const uint32_t c);
+			/**
+			 * @brief get plane pointer for read only access
+			 * @param[in] r: plane row index
+			 * @param[in] c: plane column index
+			 * @note never allocate memory unit
+			 */
+			const_pt cblockheader(const uint32_t r, const uint32_t c);
+			/**
+			 * @brief memory unit is allocated or not
+			 * @param[in] r: plane row index
+			 * @param[in] c: plane column index
+			 */
+			bool is_unit_allocate(const uint32_t r, const uint32_t c);
 			/**
 			 * @brief get pixel value
 			 * @param[in] r: pixel row index
@@ -198,8 +252,13 @@ namespace gnd { // ---> namespace gnd
 		 */
 		template< typename T >
 		inline
-		basic_gridmap<T>::basic_gridmap() : _header(0)
+		basic_gridmap<T>::basic_gridmap() : _header(0), _empty(0), _huge(false)
 		{
+			_dir.row = 0;
+			_dir.column = 0;
+			_dorg.row = 0;
+			_dorg.column = 0;
+
 			_unit.row = 0;
 			_unit.column = 0;
 
@@ -230,18 +289,7 @@ namespace gnd { // ---> namespace gnd
 		inline
 		int basic_gridmap<T>::allocate(const uint32_t r, const uint32_t c)
 		{
-			if(is_allocate())	return -1;
-
-			if( !(_header = new wpt[1]) )	return -1;
-			_plane.row = 1;
-			if( !(_header[0] = new pt[1]) )	return -1;
-			_plane.column = 1;
-
-			if( !(_header[0][0] = new T[(unsigned long)r*c]) )	return -1;
-			_unit.row = r;
-			_unit.column = c;
-
-			return 0;
+			return allocate(r, c, 1, 1);
 		}
 
 		/**
@@ -250,25 +298,24 @@ namespace gnd { // ---> namespace gnd
 		 * @param[in] uc : memory unit size (column)
 		 * @param[in] pr : number of unit (row)
 		 * @param[in] pc : number of unit (column)
+		 * @note memory units themselves are allocated on the first write access
+		 * (if the plane has only one memory unit, it is allocated at once)
 		 */
 		template< typename T >
 		inline int basic_gridmap<T>::allocate(const uint32_t ur, const uint32_t uc, const uint32_t pr, const uint32_t pc)
 		{
 			if(is_allocate())	return -1;
 
-			if( !(_header = new wpt[pr]) )	return -1;
-			for( uint32_t r = 0; r < pr; r++  ){
-				if( !(_header[r] = new pt[pc]) )	return -1;
-				for( uint32_t c = 0; c < pc; c++){
-					if( !(_header[r][c] = new T[(unsigned long)ur*uc]) )	return -1;
-				}
-			}
+			if( _pool.initialize(sizeof(T) * ur * uc, 0, _huge) < 0 )	return -1;
 
-			_plane.row = pr;
-			_plane.column = pc;
+			_init = T();
 			_unit.row = ur;
 			_unit.column = uc;
 
+			if( _resize_directory_(pr, pc, 0, 0) < 0 )	return -1;
+			// a single memory unit is allocated at once (no initial value unit is needed)
+			if( !_empty && !_fill_(_slot_(0, 0)) )	return -1;
+
 			return 0;
 		}
 
@@ -280,14 +327,18 @@ namespace gnd { // ---> namespace gnd
 		{
 			if(!is_allocate())	return -1;
 
-			for( uint32_t pr = 0; pr < _plane.row; pr++){
-				for( uint32_t pc = 0; pc < _plane.column; pc++){
-					delete [] _header[pr][pc];
-				}
-				delete [] _header[pr];
+			for( unsigned long i = 0; i < (unsigned long)_dir.row * _dir.column; i++){
+				_pool.deallocate(_header[i]);
 			}
 			delete[] _header;
-
+			delete[] _empty;
+			_header = 0;
+			_empty = 0;
+
+			_dir.row = 0;
+			_dir.column = 0;
+			_dorg.row = 0;
+			_dorg.column = 0;
 			_unit.row = 0;
 			_unit.column = 0;
 			_plane.row = 0;
@@ -303,6 +354,7 @@ namespace gnd { // ---> namespace gnd
 		 * @param[in] sc : required size of grid (column)
 		 * @param[in] hr : index of current header (row)
 		 * @param[in] hc : index of current header (column)
+		 * @note new memory units are not allocated until they are written
 		 */
 		template< typename T >
 		inline int basic_gridmap<T>::reallocate(const unsigned long sr, const unsigned long sc, const unsigned long hr, const unsigned long hc)
@@ -313,40 +365,38 @@ namespace gnd { // ---> namespace gnd
 				uint32_t	npr = sr > row() ? ceil( (double)sr / _unit.row ) : _plane.row,
 						npc = sc > column() ? ceil( (double)sc / _unit.column ) : _plane.column;
 				uint32_t ncr =  ceil( (double)hr / _unit.row ),
-						//					ncc =  ceil( (double)cc / _unit.row );
 						ncc =  ceil( (double)hc / _unit.column );
-				tpt header;
 
+				return _resize_directory_(npr, npc, ncr, ncc);
+			}
+		}
 
-				header = new wpt[npr];
-				for(uint32_t i = 0; i < npr; i++){
-					header[i] = new pt[npc];
-					for(uint32_t j = 0; j < npc; j++){
-						// copy
-						if( i >= ncr && i < ncr + _plane.row &&
-								j >= ncc && j < ncc + _plane.column ){
-							header[i][j] = _header[i - ncr][j - ncc];
-						}
-						// new
-						else{
-							header[i][j] = new T[_unit.row*_unit.column];
-						}
-					}
-				}
+		/**
+		 * @brief release memory units which hold only initial value
+		 */
+		template< typename T >
+		inline int basic_gridmap<T>::shrink()
+		{
+			if(!is_allocate())	return -1;
 
-				// deallocate
-				for( uint32_t pr = 0; pr < _plane.row; pr++){
-					delete [] _header[pr];
+			{
+				const unsigned long us = sizeof(T) * _unit.row * _unit.column;
+				int n = 0;
+
+				// single memory unit is never released
+				if( !_empty )	return 0;
+				for( uint32_t r = 0; r < _plane.row; r++){
+					for( uint32_t c = 0; c < _plane.column; c++){
+						pt *s = _slot_(r, c);
+
+						if( !*s || ::memcmp(*s, _empty, us) )	continue;
+						_pool.deallocate(*s);
+						*s = 0;
+						n++;
+					}
 				}
-				delete[] _header;
-
-				// swap
-				_header = header;
-				_plane.row = npr;
-				_plane.column = npc;
+				return n;
 			}
-
-			return 0;
 		}
 
 		/**
@@ -360,6 +410,18 @@ namespace gnd { // ---> namespace gnd
 			return 0;
 		}
 
+		/**
+		 * @brief change huge page backing of memory units
+		 * @param[in] flg
+		 * @note it is applied on the next allocation (see block_allocator::initialize())
+		 */
+		template< typename T >
+		inline int basic_gridmap<T>::set_huge_page(bool flg)
+		{
+			_huge = flg;
+			return 0;
+		}
+
 
 		/**
 		 * @brief return memory allocated or not
@@ -369,6 +431,109 @@ namespace gnd { // ---> namespace gnd
 		{
 			return _header && _unit.row && _unit.column;
 		}
+
+		/**
+		 * @privatesection
+		 * @brief directory entry of a memory unit
+		 * @param[in] r : memory unit index (row)
+		 * @param[in] c : memory unit index (column)
+		 */
+		template< typename T >
+		inline T** basic_gridmap<T>::_slot_(const uint32_t r, const uint32_t c)
+		{
+			return _header + (unsigned long)(r + _dorg.row) * _dir.column + (c + _dorg.column);
+		}
+
+		/**
+		 * @privatesection
+		 * @brief allocate a memory unit with initial value
+		 * @param[in,out] s : directory entry
+		 */
+		template< typename T >
+		inline T* basic_gridmap<T>::_fill_(pt *s)
+		{
+			const unsigned long n = (unsigned long)_unit.row * _unit.column;
+
+			if( !(*s = static_cast<pt>(_pool.allocate())) )	return 0;
+			if( _empty )	::memcpy(*s, _empty, sizeof(T) * n);
+			else			_initialize_unit_(*s);
+			return *s;
+		}
+
+		/**
+		 * @privatesection
+		 * @brief set initial value to all pixels of a memory unit
+		 * @param[out] u : memory unit
+		 */
+		template< typename T >
+		inline void basic_gridmap<T>::_initialize_unit_(pt u)
+		{
+			const unsigned long s = (unsigned long)_unit.column * _unit.row;
+			unsigned long i, j;
+
+			::memcpy( u + 0, &_init, sizeof(T)) ;
+			j = s >> 1;
+			for(i = 1; i <= j; i <<= 1){
+				::memcpy( u + i, u + 0, sizeof(T) * i);
+			}
+			if(i < s)	::memcpy( u + i, u + 0, sizeof(T) * (s-i));
+		}
+
+		/**
+		 * @privatesection
+		 * @brief resize memory unit directory
+		 * @param[in] pr : number of unit (row)
+		 * @param[in] pc : number of unit (column)
+		 * @param[in] hr : new index of current unit (0, 0) (row)
+		 * @param[in] hc : new index of current unit (0, 0) (column)
+		 * @details if the directory has enough margin, only its origin moves.
+		 * otherwise the directory is doubled and only the entries are copied.
+		 */
+		template< typename T >
+		inline int basic_gridmap<T>::_resize_directory_(const uint32_t pr, const uint32_t pc, const uint32_t hr, const uint32_t hc)
+		{
+			if( pr < hr + _plane.row || pc < hc + _plane.column )	return -1;
+
+			if( _header && hr <= _dorg.row && hc <= _dorg.column &&
+					_dorg.row - hr + pr <= _dir.row && _dorg.column - hc + pc <= _dir.column ) {
+				// ---> move origin in the margin
+				_dorg.row -= hr;
+				_dorg.column -= hc;
+			} // <--- move origin in the margin
+			else { // ---> grow directory
+				gridmap::pixelindex d, o;
+				wpt h;
+
+				// first allocation fits, growth is doubled
+				d.row = !_header ? pr : (pr <= _dir.row ? _dir.row : 2 * pr);
+				d.column = !_header ? pc : (pc <= _dir.column ? _dir.column : 2 * pc);
+				o.row = (d.row - pr) / 2;
+				o.column = (d.column - pc) / 2;
+
+				if( !(h = new pt[(unsigned long)d.row * d.column]) )	return -1;
+				::memset(h, 0, sizeof(pt) * d.row * d.column);
+				for( uint32_t r = 0; r < _plane.row; r++){
+					for( uint32_t c = 0; c < _plane.column; c++){
+						h[(unsigned long)(o.row + hr + r) * d.column + (o.column + hc + c)] = *_slot_(r, c);
+					}
+				}
+
+				delete[] _header;
+				_header = h;
+				_dir = d;
+				_dorg = o;
+			} // <--- grow directory
+
+			_plane.row = pr;
+			_plane.column = pc;
+
+			// initial value unit for memory units which are not allocated yet
+			if( !_empty && (unsigned long)pr * pc > 1 ) {
+				if( !(_empty = new T[(unsigned long)_unit.row * _unit.column]) )	return -1;
+				_initialize_unit_(_empty);
+			}
+			return 0;
+		}
 		// <---------------------------------------- allocate, deallocate
 
 
@@ -382,16 +547,31 @@ namespace gnd { // ---> namespace gnd
 		inline T* basic_gridmap<T>::pointer(const unsigned long r, const unsigned long c)
 		{
 			if(!is_allocate())				return 0;
-			if(r > row() || c > column())	return 0;
+			if(r >= row() || c >= column())	return 0;
 
 			{
-				uint32_t pr, pc, ur, uc;
-				pr = memory_unit_row(r);
-				pc = memory_unit_column(c);
-				ur = r % _unit.row;
-				uc = c % _unit.column;
+				pt *s = _slot_(memory_unit_row(r), memory_unit_column(c));
 
-				return _header[pr][pc] + (_unit.column * ur) + uc;
+				if( !*s && !_fill_(s) )	return 0;
+				return *s + (_unit.column * (r % _unit.row)) + (c % _unit.column);
+			}
+		}
+
+		/**
+		 * @brief pointer of a pixel (read only)
+		 * @param[in] r : pixel index (row)
+		 * @param[in] c : pixel index (column)
+		 */
+		template< typename T >
+		inline const T* basic_gridmap<T>::cpointer(const unsigned long r, const unsigned long c)
+		{
+			if(!is_allocate())				return 0;
+			if(r >= row() || c >= column())	return 0;
+
+			{
+				const_pt h = *_slot_(memory_unit_row(r), memory_unit_column(c));
+
+				return (h ? h : _empty) + (_unit.column * (r % _unit.row)) + (c % _unit.column);
 			}
 		}
 
@@ -404,9 +584,45 @@ namespace gnd { // ---> namespace gnd
 		inline T* basic_gridmap<T>::blockheader(const uint32_t r, const uint32_t c)
 		{
 			if(!is_allocate())	return 0;
-			if(r > _plane_row_() || c > _plane_column_())	return 0;
+			if(r >= _plane_row_() || c >= _plane_column_())	return 0;
+
+			{
+				pt *s = _slot_(r, c);
+
+				return *s ? *s : _fill_(s);
+			}
+		}
+
+		/**
+		 * @brief pointer of a memory unit (read only)
+		 * @param[in] r : memory unit index (row)
+		 * @param[in] c : memory unit index (column)
+		 */
+		template< typename T >
+		inline const T* basic_gridmap<T>::cblockheader(const uint32_t r, const uint32_t c)
+		{
+			if(!is_allocate())	return 0;
+			if(r >= _plane_row_() || c >= _plane_column_())	return 0;
+
+			{
+				const_pt h = *_slot_(r, c);
 
-			return _header[r][c];
+				return h ? h : _empty;
+			}
+		}
+
+		/**
+		 * @brief memory unit is allocated or not
+		 * @param[in] r : memory unit index (row)
+		 * @param[in] c : memory unit index (column)
+		 */
+		template< typename T >
+		inline bool basic_gridmap<T>::is_unit_allocate(const uint32_t r, const uint32_t c)
+		{
+			if(!is_allocate())	return false;
+			if(r >= _plane_row_() || c >= _plane_column_())	return false;
+
+			return *_slot_(r, c) != 0;
 		}
 
 
@@ -418,7 +634,7 @@ namespace gnd { // ---> namespace gnd
 		template< typename T >
 		inline T basic_gridmap<T>::value(const unsigned long r, const unsigned long c)
 		{
-			return * pointer(r, c);
+			return * cpointer(r, c);
 		}
 
 		/**
@@ -449,7 +665,7 @@ namespace gnd { // ---> namespace gnd
 		inline int basic_gridmap<T>::get(const unsigned long r, const unsigned long c, pt v)
 		{
 			if(!v)	return -1;
-			::memcpy(v, pointer(r, c), sizeof(T));
+			::memcpy(v, cpointer(r, c), sizeof(T));
 			return 0;
 		}
 
@@ -480,6 +696,8 @@ namespace gnd { // ---> namespace gnd
 		/**
 		 * @brief set all pixel value uniformly
 		 * @param[in] v : value
+		 * @note all memory units are released and the value becomes their initial value
+		 * (single memory unit of the plane is overwritten)
 		 */
 		template< typename T >
 		inline int basic_gridmap<T>::set_uniform(const T *v)
@@ -487,27 +705,22 @@ namespace gnd { // ---> namespace gnd
 			if(!v)	return -1;
 			if(!is_allocate())	return -1;
 
-			{ // ---> unit
-				const uint32_t s = _unit.column * _unit.row;
-				uint32_t i, j;
-
-				::memcpy( _header[0][0] + 0, v, sizeof(T)) ;
-				j = s >> 1;
-				for(i = 1; i <= j; i <<= 1){
-					::memcpy( _header[0][0] + i, _header[0][0] + 0, sizeof(T) * i);
-				}
-				if(i < s)	::memcpy( _header[0][0] + i, _header[0][0] + 0, sizeof(T) * (s-i));
-			} // <--- unit
+			::memcpy( &_init, v, sizeof(T) );
+			if( !_empty ) {
+				// single memory unit is overwritten
+				_initialize_unit_( *_slot_(0, 0) );
+				return 0;
+			}
 
-			{ // ---> plane
-				const uint32_t cps = sizeof(T) * _unit.row * _unit.column;
-				for(uint32_t r = 0; r < _plane.row; r++){
-					for(uint32_t c = 0; c < _plane.column; c++){
-						if(r != 0 || c != 0) ::memcpy(_header[r][c], _header[0][0], cps);
-					}
+			{ // ---> release memory units
+				for( unsigned long i = 0; i < (unsigned long)_dir.row * _dir.column; i++){
+					_pool.deallocate(_header[i]);
+					_header[i] = 0;
 				}
-			} // <--- plane
+			} // <--- release memory units
 
+			// initial value
+			_initialize_unit_(_empty);
 			return 0;
 		}
 
@@ -577,6 +790,7 @@ namespace gnd { // ---> namespace gnd
 		/**
 		 * @brief file write (binary)
 		 * @param[in] fname : file path
+		 * @note memory units which are not allocated are written with initial value
 		 */
 		template< typename T >
 		inline int basic_gridmap<T>::fwrite(const char *fname)
@@ -614,7 +828,7 @@ namespace gnd { // ---> namespace gnd
 				unit_size = sizeof(T) * _unit.row * _unit.column;
 				for(uint32_t r = 0; r < _plane.row; r++){
 					for(uint32_t c = 0; c < _plane.column; c++){
-						if( (ret = ::write(fd, _header[r][c], unit_size) ) != unit_size )
+						if( (ret = ::write(fd, cblockheader(r, c), unit_size) ) != unit_size )
 							return -1;
 						fsize += ret;
 					}
@@ -633,6 +847,7 @@ namespace gnd { // ---> namespace gnd
 		/**
 		 * @brief file read (binary)
 		 * @param[in] fname : file path
+		 * @note memory units which hold only initial value are released after reading
 		 */
 		template< typename T >
 		inline int basic_gridmap<T>::fread(const char *fname)
@@ -676,11 +891,12 @@ namespace gnd { // ---> namespace gnd
 				unit_size = sizeof(T) * _unit.row * _unit.column;
 				for(uint32_t r = 0; r < _plane.row; r++){
 					for(uint32_t c = 0; c < _plane.column; c++){
-						if( (ret = ::read(fd, _header[r][c], unit_size) ) != unit_size )
+						if( (ret = ::read(fd, blockheader(r, c), unit_size) ) != unit_size )
 							return -1;
 						fsize += ret;
 					}
 				} // <--- data
+				shrink();
 			} // <--- operation
 
 
@@ -775,6 +991,8 @@ namespace gnd { // namespace gnd
 			int pindex(const double x, const double y, long *r, long *c);
 			// get pixel pointer
 			pt ppointer(const double x, const double y);
+			// get pixel pointer (read only)
+			const_pt pcpointer(const double x, const double y);
 			// get pixel value
 			T pvalue(const double x, const double y);
 			// x lower bounds on current plane
@@ -1029,6 +1247,23 @@ namespace gnd { // namespace gnd
 			return basic_gridmap<T>::pointer(r, c);
 		}
 
+		/**
+		 * @brief get pointer (read only)
+		 * @param[in]  x : x component value
+		 * @param[in]  y : y component value
+		 * @return 0 : not exit
+		 * @note memory unit is not allocated, so that it can be called from several threads while the map is not changed
+		 */
+		template< typename T >
+		inline const T* gridplane<T>::pcpointer(const double x, const double y)
+		{
+			long r, c;
+
+			if( pindex(x, y, &r, &c) < 0 ) return 0;
+
+			return basic_gridmap<T>::cpointer(r, c);
+		}
+
 		/**
 		 * @brief get value
 		 * @param[in]  x : x component value
@@ -1090,7 +1325,7 @@ namespace gnd { // namespace gnd
 
 			if(!v)	return -1;
 			if( pindex(x, y, &r, &c) < 0 ) return -1;
-			::memcpy(v, basic_gridmap<T>::pointer(r, c), sizeof(T));
+			::memcpy(v, basic_gridmap<T>::cpointer(r, c), sizeof(T));
 			return 0;
 		}
 
@@ -1312,7 +1547,7 @@ namespace gnd { // namespace gnd
 				for(uint32_t r = 0; r < basic_gridmap<T>::_plane.row; r++){
 					for(uint32_t c = 0; c < basic_gridmap<T>::_plane.column; c++){
 						uint32_t nwrite = 0;
-						char *p = (char*)basic_gridmap<T>::_header[r][c];
+						const char *p = (const char*)basic_gridmap<T>::cblockheader(r, c);
 
 						while( nwrite < unit_size ) {
 							ret = ::write(fd, p + nwrite, unit_size - nwrite);
@@ -1437,7 +1672,7 @@ namespace gnd { // namespace gnd
 				for(uint32_t r = 0; r < basic_gridmap<T>::_plane.row; r++){
 					for(uint32_t c = 0; c < basic_gridmap<T>::_plane.column; c++){
 						int32_t nread = 0;
-						char* p = (char*) basic_gridmap<T>::_header[r][c];
+						char* p = (char*) basic_gridmap<T>::blockheader(r, c);
 
 						while( nread < unit_size ) {
 							ret = ::read(fd, p + nread, unit_size - nread);
@@ -1453,6 +1688,7 @@ namespace gnd { // namespace gnd
 						fsize += nread;
 					}
 				} // <--- data
+				basic_gridmap<T>::shrink();
 
 			} // <--- operation
 
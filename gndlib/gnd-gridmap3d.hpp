@@ -16,6 +16,8 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include "gnd-block-allocator.hpp"
+
 /**
  * @ifnot GNDStorage
  * @defgroup GNDStorage storage
@@ -82,6 +84,8 @@ namespace gnd { // ---> namespace gnd
 	 * @ingroup GNDGridMap3D
 	 * @brief grid-map basic class
 	 * @tparam T : stored data type in a pixel
+	 * @details memory blocks are taken from the block allocator of the map.
+	 * chunks are kept by deallocate() and reused by the next allocation.
 	 */
 	template < typename T>
 	class basic_gridmap3d {
@@ -117,6 +121,10 @@ namespace gnd { // ---> namespace gnd
 		GridMap3D::voxelindex _mapsize;
 		/// @brief flag of auto allocation
 		bool autoreallocate;
+		/// @brief block allocator of memory blocks
+		block_allocator _pool;
+		/// @brief flag of huge page backing of memory blocks
+		bool _huge;
 		// <--- variables
 
 		// ---> allocate, deallocate
@@ -129,6 +137,7 @@ namespace gnd { // ---> namespace gnd
 				const size_t hx, const size_t hy, const size_t hz);
 	public:
 		int set_autoreallocate(bool flg);
+		int set_huge_page(bool flg);
 		// <--- allocate, deallocate
 
 		// ---> setter, getter
@@ -196,7 +205,7 @@ namespace gnd { // ---> namespace gnd
 	 */
 	template< typename T >
 	inline
-	basic_gridmap3d<T>::basic_gridmap3d() : _header(0)
+	basic_gridmap3d<T>::basic_gridmap3d() : _header(0), _huge(false)
 	{
 		_blocksize.x = 0;
 		_blocksize.y = 0;
@@ -232,13 +241,14 @@ namespace gnd { // ---> namespace gnd
 	int basic_gridmap3d<T>::allocate(const size_t x, const size_t y, const size_t z)
 	{
 		if(is_allocate())	return -1;
+		if( _pool.initialize(sizeof(T) * x * y * z, 0, _huge) < 0 )	return -1;
 
 		if( !(_header = new tpt[1]) )	return -1;
 		if( !(_header[0] = new wpt[1]) )	return -1;
 		if( !(_header[0][0] = new pt[1]) )	return -1;
 		_mapsize.x = _mapsize.y = _mapsize.z = 1;
 
-		if( !(_header[0][0][0] = new T[(unsigned long)x*y*z]) )	return -1;
+		if( !(_header[0][0][0] = static_cast<pt>(_pool.allocate())) )	return -1;
 		_blocksize.x = x;
 		_blocksize.y = y;
 		_blocksize.z = z;
@@ -262,6 +272,7 @@ namespace gnd { // ---> namespace gnd
 		if(is_allocate())	return -1;
 		if( !mx || !my || !mz )	return -1;
 		if( !bx || !by || !bz )	return -1;
+		if( _pool.initialize(sizeof(T) * bx * by * bz, 0, _huge) < 0 )	return -1;
 
 		if( !(_header       = new tpt[mz]) )	return -1;
 		for( size_t z = 0; z < mz; z++  ){
@@ -269,7 +280,7 @@ namespace gnd { // ---> namespace gnd
 			for( size_t y = 0; y < my; y++){
 				if( !(_header[z][y] = new  pt[mx]) )	return -1;
 				for( size_t x = 0; x < mx; x++){
-					if( !(_header[z][y][x] = new T[(unsigned long)bx*by*bz]) )	return -1;
+					if( !(_header[z][y][x] = static_cast<pt>(_pool.allocate())) )	return -1;
 				}
 			}
 		}
@@ -296,13 +307,14 @@ namespace gnd { // ---> namespace gnd
 		for( size_t z = 0; z < _mapsize.z; z++){
 			for( size_t y = 0; y < _mapsize.y; y++){
 				for( size_t x = 0; x < _mapsize.x; x++){
-					delete [] blockheader(x,y,z);
+					_pool.deallocate(blockheader(x,y,z));
 				}
 				delete [] _header[z][y];
 			}
 			delete [] _header[z];
 		}
 		delete[] _header;
+		_header = 0;
 
 		_blocksize.x = 0;
 		_blocksize.y = 0;
@@ -352,7 +364,7 @@ namespace gnd { // ---> namespace gnd
 						}
 						// new
 						else{
-							if( !(h[zi][yi][xi] = new T[ _blocksize.x * _blocksize.y * _blocksize.z ]) ) return -1;
+							if( !(h[zi][yi][xi] = static_cast<pt>(_pool.allocate())) ) return -1;
 						}
 					} // for(x)
 				} // for(y)
@@ -389,6 +401,18 @@ namespace gnd { // ---> namespace gnd
 		return 0;
 	}
 
+	/**
+	 * @brief change huge page backing of memory blocks
+	 * @param[in] flg
+	 * @note it is applied on the next allocation (see block_allocator::initialize())
+	 */
+	template< typename T >
+	inline int basic_gridmap3d<T>::set_huge_page(bool flg)
+	{
+		_huge = flg;
+		return 0;
+	}
+
 
 	/**
 	 * @brief return memory allocated or not
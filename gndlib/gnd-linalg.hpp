@@ -5,6 +5,8 @@
  *      Author: tyamada
  */
 
+#ifndef GND_LINALG_HPP_
+#define GND_LINALG_HPP_
 
 #include "gnd-vector-base.hpp"
 #include "gnd-matrix-base.hpp"
@@ -112,3 +114,4 @@ namespace gnd {
 	} // <--- namespace linalg
 } // <--- namespace gnd
 
+#endif /* GND_LINALG_HPP_ */
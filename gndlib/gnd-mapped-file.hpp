@@ -0,0 +1,670 @@
+/*
+ * gnd-mapped-file.hpp
+ *
+ *  read-only memory mapped data file (zero-copy map cache)
+ */
+
+#ifndef GND_MAPPED_FILE_HPP_
+#define GND_MAPPED_FILE_HPP_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "gnd-lib-error.h"
+#include "gnd-gridmap.hpp"
+
+/**
+ * @ifnot GNDMappedFile
+ * @defgroup GNDMappedFile mapped file
+ * supply read-only memory mapped data file.
+ * a file has a header and contiguous data aligned to page size,
+ * so that data can be used directly (zero-copy) and shared between processes.
+ * @endif
+ */
+
+// ---> constant value definition
+namespace gnd {
+	/// @brief mapped file magic
+	static const char MappedFileMagic[8] = {'G', 'N', 'D', 'M', 'A', 'P', 'F', '\0'};
+	/// @brief mapped file format version
+	static const uint32_t MappedFileVersion = 1;
+	/// @brief alignment of data in mapped file
+	static const uint64_t MappedFileAlignment = 4096;
+	/// @brief size of content type tag (include terminator)
+	static const size_t MappedFileTypeSize = 16;
+}
+// <--- constant value definition
+
+
+// ---> type definition
+namespace gnd {
+	/**
+	 * @ingroup GNDMappedFile
+	 * @brief mapped file header
+	 */
+	struct mapped_file_header {
+		char magic[8];						///< magic (MappedFileMagic)
+		uint32_t version;					///< format version (MappedFileVersion)
+		uint32_t header_size;				///< size of this header
+		char type[MappedFileTypeSize];		///< content type tag
+		uint32_t element_size;				///< size of an element
+		uint32_t stride;					///< number of elements for each cell
+		uint64_t row;						///< number of rows
+		uint64_t column;					///< number of columns
+		double xorg;						///< origin x
+		double yorg;						///< origin y
+		double xrsl;						///< cell size x
+		double yrsl;						///< cell size y
+		uint64_t key;						///< user key (e.g. hash of source data and parameters)
+		uint64_t offset;					///< data offset from file head
+		uint64_t size;						///< data size
+		uint64_t checksum;					///< checksum of data
+	};
+	/**
+	 * @typedef mapped_file_header_t
+	 * @see mapped_file_header
+	 */
+	typedef struct mapped_file_header mapped_file_header_t;
+
+
+	/**
+	 * @ingroup GNDMappedFile
+	 * @brief read-only memory mapped file
+	 */
+	class mapped_file {
+		// ---> constructor, destructor
+	public:
+		mapped_file();
+		~mapped_file();
+		// <--- constructor, destructor
+
+		// ---> variables
+	private:
+		/// @brief mapped memory
+		void *_addr;
+		/// @brief mapped size
+		size_t _length;
+		// <--- variables
+
+	public:
+		int open(const char *path, const char *type, uint64_t key = 0, bool verify = false);
+		int close();
+		bool is_open() const;
+		const mapped_file_header_t* header() const;
+		const void* data() const;
+	private:
+		mapped_file(const mapped_file&);
+		mapped_file& operator=(const mapped_file&);
+	};
+
+
+	/**
+	 * @ingroup GNDMappedFile
+	 * @brief read-only grid plane on mapped file
+	 * @details accessors are compatible with gridmap::gridplane.
+	 */
+	template < typename T >
+	class mapped_plane {
+		// ---> variables
+	private:
+		/// @brief mapped file
+		mapped_file _file;
+		/// @brief data
+		const T *_data;
+		/// @brief number of rows
+		unsigned long _row;
+		/// @brief number of columns
+		unsigned long _column;
+		/// @brief origin
+		double _xorg, _yorg;
+		/// @brief cell size
+		double _xrsl, _yrsl;
+		// <--- variables
+
+	public:
+		mapped_plane();
+		int open(const char *path, const char *type, uint64_t key = 0, bool verify = false);
+		int close();
+		bool is_allocate() const;
+		unsigned long row() const;
+		unsigned long column() const;
+		double xlower() const;
+		double xupper() const;
+		double ylower() const;
+		double yupper() const;
+		double xrsl() const;
+		double yrsl() const;
+		const T* pointer(unsigned long r, unsigned long c) const;
+		int get(unsigned long r, unsigned long c, T *v) const;
+		int pindex(double x, double y, long *r, long *c) const;
+		const T* ppointer(double x, double y) const;
+		const T* pcpointer(double x, double y) const;
+		T pvalue(double x, double y) const;
+		int pget_pos_core(unsigned long r, unsigned long c, double *x, double *y) const;
+		int copy(gridmap::gridplane<T> *p) const;
+	};
+}
+// <--- type definition
+
+
+// ---> function declaration
+namespace gnd {
+	uint64_t mapped_file_checksum(const void *p, size_t n, uint64_t seed = 0);
+	int write_mapped_file(const char *path, mapped_file_header_t *h, const void *data);
+	template < typename T >
+	int write_mapped_plane(const char *path, gridmap::gridplane<T> *p, const char *type, uint64_t key = 0);
+}
+// <--- function declaration
+
+
+// ---> function definition
+namespace gnd {
+
+	/**
+	 * @ingroup GNDMappedFile
+	 * @brief checksum (FNV-1a 64bit)
+	 * @param[in]    p : data
+	 * @param[in]    n : data size
+	 * @param[in] seed : previous checksum to continue (0: start)
+	 */
+	inline
+	uint64_t mapped_file_checksum(const void *p, size_t n, uint64_t seed) {
+		const unsigned char *b = static_cast<const unsigned char*>(p);
+		uint64_t h = seed ? seed : 14695981039346656037ULL;
+
+		for( size_t i = 0; i < n; i++ ) {
+			h ^= b[i];
+			h *= 1099511628211ULL;
+		}
+		return h;
+	}
+
+	/**
+	 * @ingroup GNDMappedFile
+	 * @brief write mapped file
+	 * @param[in]     path : file path
+	 * @param[in,out]    h : header (magic, version, header_size, offset and checksum are set in this function)
+	 * @param[in]     data : data (h->size bytes)
+	 * @note the file is written to temporary file and renamed,
+	 * so that processes mapping the old file are not affected.
+	 */
+	inline
+	int write_mapped_file(const char *path, mapped_file_header_t *h, const void *data) {
+		gnd_assert(!path || !h, -1, "invalid null pointer");
+		gnd_assert(h->size > 0 && !data, -1, "invalid null pointer");
+
+		{ // ---> operation
+			char tmp[1024];
+			char pad[256];
+			int fd;
+			uint64_t n;
+			const unsigned char *p = static_cast<const unsigned char*>(data);
+
+			::memcpy(h->magic, MappedFileMagic, sizeof(h->magic));
+			h->version = MappedFileVersion;
+			h->header_size = sizeof(mapped_file_header_t);
+			h->offset = (sizeof(mapped_file_header_t) + MappedFileAlignment - 1) / MappedFileAlignment * MappedFileAlignment;
+			h->checksum = mapped_file_checksum(data, h->size);
+
+			if( ::snprintf(tmp, sizeof(tmp), "%s.tmp%d", path, (int)::getpid()) >= (signed)sizeof(tmp) ) return -1;
+			if( (fd = ::open(tmp, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)) < 0 ) return -1;
+
+			// header
+			if( ::write(fd, h, sizeof(*h)) != (signed)sizeof(*h) ) {
+				::close(fd);
+				::unlink(tmp);
+				return -1;
+			}
+			// padding
+			::memset(pad, 0, sizeof(pad));
+			for( n = sizeof(*h); n < h->offset; ) {
+				uint64_t s = h->offset - n < sizeof(pad) ? h->offset - n : sizeof(pad);
+				if( ::write(fd, pad, s) != (signed)s ) {
+					::close(fd);
+					::unlink(tmp);
+					return -1;
+				}
+				n += s;
+			}
+			// data
+			for( n = 0; n < h->size; ) {
+				ssize_t ret = ::write(fd, p + n, h->size - n);
+				if( ret <= 0 ) {
+					::close(fd);
+					::unlink(tmp);
+					return -1;
+				}
+				n += ret;
+			}
+
+			if( ::close(fd) < 0 || ::rename(tmp, path) < 0 ) {
+				::unlink(tmp);
+				return -1;
+			}
+		} // <--- operation
+		return 0;
+	}
+
+
+
+	/**
+	 * @brief constructor
+	 */
+	inline
+	mapped_file::mapped_file() : _addr(0), _length(0)
+	{
+	}
+
+	/**
+	 * @brief destructor
+	 */
+	inline
+	mapped_file::~mapped_file()
+	{
+		close();
+	}
+
+	/**
+	 * @brief map a file (read-only)
+	 * @param[in]   path : file path
+	 * @param[in]   type : content type tag
+	 * @param[in]    key : user key (0: not checked)
+	 * @param[in] verify : verify checksum of whole data
+	 * @return ==0 : success
+	 * @return  <0 : fail (not exist, invalid format, version, type, key or checksum)
+	 * @note only the header is checked by default, so that opening a file does not read all of its pages.
+	 * files are written to temporary file and renamed (see write_mapped_file()), so a truncated file is not expected.
+	 */
+	inline
+	int mapped_file::open(const char *path, const char *type, uint64_t key, bool verify)
+	{
+		gnd_assert(!path || !type, -1, "invalid null pointer");
+
+		close();
+		{ // ---> operation
+			int fd;
+			struct stat st;
+			void *addr;
+			const mapped_file_header_t *h;
+
+			if( (fd = ::open(path, O_RDONLY)) < 0 ) return -1;
+			if( ::fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(mapped_file_header_t) ) {
+				::close(fd);
+				return -1;
+			}
+			addr = ::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+			if( addr == MAP_FAILED ) return -1;
+
+			_addr = addr;
+			_length = st.st_size;
+			h = header();
+
+			// ---> check header
+			if( ::memcmp(h->magic, MappedFileMagic, sizeof(h->magic)) != 0 ||
+					h->version != MappedFileVersion ||
+					h->header_size != sizeof(mapped_file_header_t) ||
+					::strncmp(h->type, type, MappedFileTypeSize) != 0 ||
+					(key != 0 && h->key != key) ||
+					h->offset % MappedFileAlignment != 0 ||
+					h->offset > _length || h->size > _length - h->offset ) {
+				close();
+				return -1;
+			} // <--- check header
+
+			if( verify && mapped_file_checksum(data(), h->size) != h->checksum ) {
+				close();
+				return -1;
+			}
+		} // <--- operation
+		return 0;
+	}
+
+	/**
+	 * @brief unmap
+	 */
+	inline
+	int mapped_file::close()
+	{
+		if( !_addr ) return 0;
+		::munmap(_addr, _length);
+		_addr = 0;
+		_length = 0;
+		return 0;
+	}
+
+	/**
+	 * @brief mapped or not
+	 */
+	inline
+	bool mapped_file::is_open() const
+	{
+		return _addr != 0;
+	}
+
+	/**
+	 * @brief header
+	 */
+	inline
+	const mapped_file_header_t* mapped_file::header() const
+	{
+		return static_cast<const mapped_file_header_t*>(_addr);
+	}
+
+	/**
+	 * @brief data
+	 */
+	inline
+	const void* mapped_file::data() const
+	{
+		if( !_addr ) return 0;
+		return static_cast<const char*>(_addr) + header()->offset;
+	}
+
+
+
+	/**
+	 * @brief constructor
+	 */
+	template < typename T >
+	inline
+	mapped_plane<T>::mapped_plane()
+	: _data(0), _row(0), _column(0), _xorg(0), _yorg(0), _xrsl(0), _yrsl(0)
+	{
+	}
+
+	/**
+	 * @brief map a plane file
+	 * @param[in]   path : file path
+	 * @param[in]   type : content type tag
+	 * @param[in]    key : user key (0: not checked)
+	 * @param[in] verify : verify checksum of whole data (see mapped_file::open())
+	 */
+	template < typename T >
+	inline
+	int mapped_plane<T>::open(const char *path, const char *type, uint64_t key, bool verify)
+	{
+		const mapped_file_header_t *h;
+
+		close();
+		if( _file.open(path, type, key, verify) < 0 ) return -1;
+		h = _file.header();
+		if( h->element_size != sizeof(T) || h->stride != 1 || h->size != h->row * h->column * sizeof(T) ) {
+			_file.close();
+			return -1;
+		}
+		_data = static_cast<const T*>(_file.data());
+		_row = h->row;
+		_column = h->column;
+		_xorg = h->xorg;
+		_yorg = h->yorg;
+		_xrsl = h->xrsl;
+		_yrsl = h->yrsl;
+		return 0;
+	}
+
+	/**
+	 * @brief unmap
+	 */
+	template < typename T >
+	inline
+	int mapped_plane<T>::close()
+	{
+		_data = 0;
+		_row = 0;
+		_column = 0;
+		return _file.close();
+	}
+
+	/**
+	 * @brief mapped or not
+	 */
+	template < typename T >
+	inline bool mapped_plane<T>::is_allocate() const
+	{
+		return _data != 0;
+	}
+
+	/**
+	 * @brief number of rows
+	 */
+	template < typename T >
+	inline unsigned long mapped_plane<T>::row() const
+	{
+		return _row;
+	}
+
+	/**
+	 * @brief number of columns
+	 */
+	template < typename T >
+	inline unsigned long mapped_plane<T>::column() const
+	{
+		return _column;
+	}
+
+	/**
+	 * @brief x lower bound
+	 */
+	template < typename T >
+	inline double mapped_plane<T>::xlower() const
+	{
+		return _xorg;
+	}
+
+	/**
+	 * @brief x upper bound
+	 */
+	template < typename T >
+	inline double mapped_plane<T>::xupper() const
+	{
+		return _xorg + _column * _xrsl;
+	}
+
+	/**
+	 * @brief y lower bound
+	 */
+	template < typename T >
+	inline double mapped_plane<T>::ylower() const
+	{
+		return _yorg;
+	}
+
+	/**
+	 * @brief y upper bound
+	 */
+	template < typename T >
+	inline double mapped_plane<T>::yupper() const
+	{
+		return _yorg + _row * _yrsl;
+	}
+
+	/**
+	 * @brief x resolution
+	 */
+	template < typename T >
+	inline double mapped_plane<T>::xrsl() const
+	{
+		return _xrsl;
+	}
+
+	/**
+	 * @brief y resolution
+	 */
+	template < typename T >
+	inline double mapped_plane<T>::yrsl() const
+	{
+		return _yrsl;
+	}
+
+	/**
+	 * @brief pointer of a pixel
+	 * @param[in] r : pixel index (row)
+	 * @param[in] c : pixel index (column)
+	 */
+	template < typename T >
+	inline const T* mapped_plane<T>::pointer(unsigned long r, unsigned long c) const
+	{
+		if( !_data || r >= _row || c >= _column ) return 0;
+		return _data + r * _column + c;
+	}
+
+	/**
+	 * @brief get value in a pixel
+	 * @param[in]  r : pixel index (row)
+	 * @param[in]  c : pixel index (column)
+	 * @param[out] v : value
+	 */
+	template < typename T >
+	inline int mapped_plane<T>::get(unsigned long r, unsigned long c, T *v) const
+	{
+		const T *p = pointer(r, c);
+		if( !p || !v ) return -1;
+		*v = *p;
+		return 0;
+	}
+
+	/**
+	 * @brief get index
+	 * @param[in]  x : x component value
+	 * @param[in]  y : y component value
+	 * @param[out] r : row index
+	 * @param[out] c : column index
+	 */
+	template < typename T >
+	inline int mapped_plane<T>::pindex(double x, double y, long *r, long *c) const
+	{
+		if( !_data ) return -1;
+		*r = ::floor( (y - _yorg) / _yrsl );
+		*c = ::floor( (x - _xorg) / _xrsl );
+		return (*r >= 0 && *r < (signed)_row && *c >= 0 && *c < (signed)_column) ? 0 : -1;
+	}
+
+	/**
+	 * @brief get pointer
+	 * @param[in]  x : x component value
+	 * @param[in]  y : y component value
+	 * @return 0 : not exit
+	 */
+	template < typename T >
+	inline const T* mapped_plane<T>::ppointer(double x, double y) const
+	{
+		long r, c;
+		if( pindex(x, y, &r, &c) < 0 ) return 0;
+		return _data + r * _column + c;
+	}
+
+	/**
+	 * @brief get pointer (read only)
+	 * @param[in]  x : x component value
+	 * @param[in]  y : y component value
+	 * @return 0 : not exit
+	 */
+	template < typename T >
+	inline const T* mapped_plane<T>::pcpointer(double x, double y) const
+	{
+		return ppointer(x, y);
+	}
+
+	/**
+	 * @brief get value
+	 * @param[in]  x : x component value
+	 * @param[in]  y : y component value
+	 */
+	template < typename T >
+	inline T mapped_plane<T>::pvalue(double x, double y) const
+	{
+		return *ppointer(x, y);
+	}
+
+	/**
+	 * @brief get core position of a pixel
+	 * @param[in]  r : row index
+	 * @param[in]  c : column index
+	 * @param[out] x : x component value
+	 * @param[out] y : y component value
+	 */
+	template < typename T >
+	inline int mapped_plane<T>::pget_pos_core(unsigned long r, unsigned long c, double *x, double *y) const
+	{
+		*x = _xorg + _xrsl * c + _xrsl / 2.0;
+		*y = _yorg + _yrsl * r + _yrsl / 2.0;
+		return 0;
+	}
+
+	/**
+	 * @brief copy to grid plane
+	 * @param[out] p : grid plane
+	 */
+	template < typename T >
+	inline int mapped_plane<T>::copy(gridmap::gridplane<T> *p) const
+	{
+		gnd_assert(!p, -1, "invalid null pointer");
+		gnd_assert(!_data, -1, "not mapped");
+
+		if( p->is_allocate() ) p->deallocate();
+		if( p->allocate(_row, _column) < 0 ) return -1;
+		p->pset_origin(_xorg, _yorg);
+		p->pset_rsl(_xrsl, _yrsl);
+		for( unsigned long r = 0; r < _row; r++ ) {
+			::memcpy(p->pointer(r, 0), _data + r * _column, _column * sizeof(T));
+		}
+		return 0;
+	}
+
+
+	/**
+	 * @ingroup GNDMappedFile
+	 * @brief write grid plane as mapped file
+	 * @param[in] path : file path
+	 * @param[in]    p : grid plane
+	 * @param[in] type : content type tag
+	 * @param[in]  key : user key
+	 */
+	template < typename T >
+	inline
+	int write_mapped_plane(const char *path, gridmap::gridplane<T> *p, const char *type, uint64_t key) {
+		gnd_assert(!path || !p || !type, -1, "invalid null pointer");
+		gnd_assert(!p->is_allocate(), -1, "invalid argument");
+
+		{ // ---> operation
+			mapped_file_header_t h;
+			T *buf;
+			int ret;
+
+			::memset(&h, 0, sizeof(h));
+			::strncpy(h.type, type, sizeof(h.type) - 1);
+			h.element_size = sizeof(T);
+			h.stride = 1;
+			h.row = p->row();
+			h.column = p->column();
+			h.xorg = p->xlower();
+			h.yorg = p->ylower();
+			h.xrsl = p->xrsl();
+			h.yrsl = p->yrsl();
+			h.key = key;
+			h.size = h.row * h.column * sizeof(T);
+
+			// gather memory units into contiguous rows
+			if( !(buf = static_cast<T*>(::malloc(h.size ? h.size : 1))) ) return -1;
+			for( unsigned long r = 0; r < h.row; r++ ) {
+				for( unsigned long c = 0; c < h.column; c++ ) {
+					buf[r * h.column + c] = *p->cpointer(r, c);
+				}
+			}
+			ret = write_mapped_file(path, &h, buf);
+			::free(buf);
+			return ret;
+		} // <--- operation
+	}
+}
+// <--- function definition
+
+#endif /* GND_MAPPED_FILE_HPP_ */
@@ -75,6 +75,7 @@ namespace gnd { // ---> namespace gnd
 			/// @brief column size
 			static const uint32_t column = C;
 			double* operator[](int i);
+			const double* operator[](int i) const;
 			fixed();
 			fixed(const component_t *src, uint32_t l);
 			// todo copy constructor
@@ -110,6 +111,11 @@ namespace gnd { // ---> namespace gnd
 
 #define gnd_matrix_exist(mt, r, c)	\
 		(gnd_matrix_is_avail(mt) && _gnd_matrix_row_(mt) > r && _gnd_matrix_column_(mt) > c )
+
+#ifndef GND_MATRIX_UNROLL_MAX
+/// @brief largest number of multiply-add (or element) that fixed size kernel expands at compile time
+#define GND_MATRIX_UNROLL_MAX	64
+#endif
 // <--- private interface
 
 
@@ -643,6 +649,129 @@ namespace gnd { // ---> namespace gnd
 
 
 
+		// ---> fixed size kernel
+		/**
+		 * @privatesection
+		 * @brief compile-time unrolled element-wise and dot kernel
+		 * @tparam N : number of elements
+		 * @details recursion on N is expanded by the compiler,
+		 * so the small sizes (2x1, 2x2, 3x1, 3x3, 4x1, 4x4) run without loop and index arithmetic.
+		 */
+		template < uint32_t N >
+		struct _fixed_unroll_ {
+			/// @brief o[i] = a[i] + b[i]
+			static inline void add(component_t *o, const component_t *a, const component_t *b) {
+				_fixed_unroll_<N-1>::add(o, a, b);
+				o[N-1] = a[N-1] + b[N-1];
+			}
+			/// @brief o[i] = a[i] - b[i]
+			static inline void sub(component_t *o, const component_t *a, const component_t *b) {
+				_fixed_unroll_<N-1>::sub(o, a, b);
+				o[N-1] = a[N-1] - b[N-1];
+			}
+			/// @brief sum of a[k * SA] * b[k * SB]
+			template < uint32_t SA, uint32_t SB >
+			static inline component_t dot(const component_t *a, const component_t *b) {
+				return _fixed_unroll_<N-1>::template dot<SA, SB>(a, b) + a[(N-1) * SA] * b[(N-1) * SB];
+			}
+		};
+		template < >
+		struct _fixed_unroll_<0> {
+			static inline void add(component_t *, const component_t *, const component_t *) {
+			}
+			static inline void sub(component_t *, const component_t *, const component_t *) {
+			}
+			template < uint32_t SA, uint32_t SB >
+			static inline component_t dot(const component_t *, const component_t *) {
+				return 0;
+			}
+		};
+
+
+		/**
+		 * @privatesection
+		 * @brief compile-time unrolled product kernel
+		 * @tparam M  : rows of output
+		 * @tparam N  : inner size
+		 * @tparam L  : columns of output
+		 * @tparam AI : stride of matrix1 along output row
+		 * @tparam AK : stride of matrix1 along inner index
+		 * @tparam BK : stride of matrix2 along inner index
+		 * @tparam BJ : stride of matrix2 along output column
+		 * @tparam K  : number of remaining output elements
+		 * @details the strides select prod (N,1,L,1), prod_transpose1 (1,M,L,1) and prod_transpose2 (N,1,1,N).
+		 */
+		template < uint32_t M, uint32_t N, uint32_t L, uint32_t AI, uint32_t AK, uint32_t BK, uint32_t BJ, uint32_t K >
+		struct _fixed_unroll_prod_ {
+			static inline void apply(component_t *o, const component_t *a, const component_t *b) {
+				_fixed_unroll_prod_<M, N, L, AI, AK, BK, BJ, K-1>::apply(o, a, b);
+				o[K-1] = _fixed_unroll_<N>::template dot<AK, BK>(a + ((K-1) / L) * AI, b + ((K-1) % L) * BJ);
+			}
+		};
+		template < uint32_t M, uint32_t N, uint32_t L, uint32_t AI, uint32_t AK, uint32_t BK, uint32_t BJ >
+		struct _fixed_unroll_prod_<M, N, L, AI, AK, BK, BJ, 0> {
+			static inline void apply(component_t *, const component_t *, const component_t *) {
+			}
+		};
+
+
+		/**
+		 * @privatesection
+		 * @brief fixed size kernel
+		 * @tparam Unroll : expand at compile time (true) or keep the loop (false)
+		 * @details the product is computed into a local buffer,
+		 * so that output may alias an input and the compiler can keep the terms in register.
+		 */
+		template < bool Unroll >
+		struct _fixed_kernel_ {
+			template < uint32_t S >
+			static inline void add(component_t *o, const component_t *a, const component_t *b) {
+				_fixed_unroll_<S>::add(o, a, b);
+			}
+			template < uint32_t S >
+			static inline void sub(component_t *o, const component_t *a, const component_t *b) {
+				_fixed_unroll_<S>::sub(o, a, b);
+			}
+			template < uint32_t M, uint32_t N, uint32_t L, uint32_t AI, uint32_t AK, uint32_t BK, uint32_t BJ >
+			static inline void prod(component_t *o, const component_t *a, const component_t *b) {
+				component_t t[M * L];
+				_fixed_unroll_prod_<M, N, L, AI, AK, BK, BJ, M * L>::apply(t, a, b);
+				::memcpy(o, t, sizeof(t));
+			}
+		};
+		template < >
+		struct _fixed_kernel_<false> {
+			template < uint32_t S >
+			static inline void add(component_t *o, const component_t *a, const component_t *b) {
+				uint32_t i;
+				for(i = 0; i < S; i++)	o[i] = a[i] + b[i];
+			}
+			template < uint32_t S >
+			static inline void sub(component_t *o, const component_t *a, const component_t *b) {
+				uint32_t i;
+				for(i = 0; i < S; i++)	o[i] = a[i] - b[i];
+			}
+			template < uint32_t M, uint32_t N, uint32_t L, uint32_t AI, uint32_t AK, uint32_t BK, uint32_t BJ >
+			static inline void prod(component_t *o, const component_t *a, const component_t *b) {
+				component_t t[M * L];
+				uint32_t i, j, k;
+
+				for(i = 0; i < M; i++){
+					for(j = 0; j < L; j++){
+						component_t v = 0;
+						for(k = 0; k < N; k++){
+							v += a[i * AI + k * AK] * b[k * BK + j * BJ];
+						}
+						t[i * L + j] = v;
+					}
+				}
+				::memcpy(o, t, sizeof(t));
+			}
+		};
+		// <--- fixed size kernel
+
+
+
 
 
 		/**
@@ -942,15 +1071,8 @@ namespace gnd { // ---> namespace gnd
 			gnd_assert(!gnd_matrix_is_avail(m2), -1, "invalid matrix property");
 			gnd_assert(!gnd_matrix_is_avail(o), -1, "invalid matrix property");
 
-			{
-				uint32_t i;
-				const component_t *p1 = _gnd_matrix_pointer_(m1, 0, 0),
-						*p2 = _gnd_matrix_pointer_(m2, 0, 0);
-				component_t *po = _gnd_matrix_pointer_(o, 0, 0);
-				for(i = 0; i < R * C; i++){
-					*po++ = *p1++ + *p2++;
-				}
-			}
+			_fixed_kernel_< (R * C <= GND_MATRIX_UNROLL_MAX) >::template add< R * C >(
+					_gnd_matrix_pointer_(o, 0, 0), _gnd_matrix_pointer_(m1, 0, 0), _gnd_matrix_pointer_(m2, 0, 0));
 			return 0;
 		}
 
@@ -1195,7 +1317,7 @@ namespace gnd { // ---> namespace gnd
 				r = (_gnd_matrix_row_(m1) < _gnd_matrix_row_(m2)) ? _gnd_matrix_row_(m1) : _gnd_matrix_row_(m2);
 				r = (r < _gnd_matrix_row_(o)) ? r : _gnd_matrix_row_(o);
 				c = (_gnd_matrix_column_(m1) < _gnd_matrix_column_(m2)) ? _gnd_matrix_column_(m1) : _gnd_matrix_column_(m2);
-				c = (c < _gnd_matrix_column_(o)) ? r : _gnd_matrix_column_(o);
+				c = (c < _gnd_matrix_column_(o)) ? c : _gnd_matrix_column_(o);
 
 				return submatrix_sub(m1, 0, 0,
 						m2, 0, 0,
@@ -1206,6 +1328,27 @@ namespace gnd { // ---> namespace gnd
 
 
 
+		/**
+		 * @ingroup GNDMatrix
+		 * @brief subtraction m1 - m2
+		 * @param  [in]   m1 : matrix1
+		 * @param  [in]   m2 : matrix2
+		 * @param [out]    o :  o
+		 * @return ==0 : success
+		 * @return  <0 : fail
+		 */
+		template < uint32_t R, uint32_t C >
+		inline int sub(const fixed<R,C> *m1, const fixed<R,C> *m2, fixed<R,C> *o)
+		{
+			gnd_assert((!m1 || !m2 || !o), -1, "null pointer");
+
+			_fixed_kernel_< (R * C <= GND_MATRIX_UNROLL_MAX) >::template sub< R * C >(
+					_gnd_matrix_pointer_(o, 0, 0), _gnd_matrix_pointer_(m1, 0, 0), _gnd_matrix_pointer_(m2, 0, 0));
+			return 0;
+		}
+
+
+
 		/**
 		 * @ingroup GNDMatrix
 		 * @brief submatrix subtraction
@@ -1395,19 +1538,8 @@ namespace gnd { // ---> namespace gnd
 		{
 			gnd_assert((!m1 || !m2 || !o), -1, "null pointer");
 
-			{
-				unsigned int i, j, k;
-
-				for(i = 0; i < M; i++){
-					for(j = 0; j < L; j++){
-						_gnd_matrix_ref_(o, i, j) = 0;
-						for(k = 0; k < N; k++){
-							_gnd_matrix_ref_(o, i, j) +=
-									_gnd_matrix_ref_(m1, i, k) * _gnd_matrix_ref_(m2, k, j);
-						}
-					}
-				}
-			}
+			_fixed_kernel_< (M * N * L <= GND_MATRIX_UNROLL_MAX) >::template prod< M, N, L, N, 1, L, 1 >(
+					_gnd_matrix_pointer_(o, 0, 0), _gnd_matrix_pointer_(m1, 0, 0), _gnd_matrix_pointer_(m2, 0, 0));
 			return 0;
 		}
 
@@ -1488,6 +1620,15 @@ namespace gnd { // ---> namespace gnd
 			const uint32_t l = (_gnd_matrix_column_(m2) < _gnd_matrix_column_(o)) ? _gnd_matrix_column_(m2) : _gnd_matrix_column_(o);
 			return submatrix_prod_transpose1(m1, 0, 0, m2, 0, 0, m, n, l, o, 0, 0);
 		}
+		template < uint32_t M, uint32_t N, uint32_t L >
+		inline int prod_transpose1 ( const fixed<N,M> *m1, const fixed<N,L> *m2, fixed<M,L> *o)
+		{
+			gnd_assert((!m1 || !m2 || !o), -1, "null pointer");
+
+			_fixed_kernel_< (M * N * L <= GND_MATRIX_UNROLL_MAX) >::template prod< M, N, L, 1, M, L, 1 >(
+					_gnd_matrix_pointer_(o, 0, 0), _gnd_matrix_pointer_(m1, 0, 0), _gnd_matrix_pointer_(m2, 0, 0));
+			return 0;
+		}
 
 
 		/**
@@ -1563,6 +1704,15 @@ namespace gnd { // ---> namespace gnd
 			const uint32_t l = (_gnd_matrix_row_(m2) < _gnd_matrix_column_(o)) ? _gnd_matrix_row_(m2) : _gnd_matrix_column_(o);
 			return submatrix_prod_transpose2(m1, 0, 0, m2, 0, 0, m, n, l, o, 0, 0);
 		}
+		template < uint32_t M, uint32_t N, uint32_t L >
+		inline int prod_transpose2(const fixed<M,N> *m1, const fixed<L,N> *m2, fixed<M,L> *o)
+		{
+			gnd_assert((!m1 || !m2 || !o), -1, "null pointer");
+
+			_fixed_kernel_< (M * N * L <= GND_MATRIX_UNROLL_MAX) >::template prod< M, N, L, N, 1, 1, N >(
+					_gnd_matrix_pointer_(o, 0, 0), _gnd_matrix_pointer_(m1, 0, 0), _gnd_matrix_pointer_(m2, 0, 0));
+			return 0;
+		}
 
 
 
@@ -2051,26 +2201,6 @@ namespace gnd { // ---> namespace gnd
 			return 0;
 		}
 
-		/**
-		 * @brief Compute Determinant (fixed)
-		 * @param [in]  mt  : Matrix
-		 * @param [in]  ws  : Work Space
-		 * @param [out] v 	: Determinant
-		 * @return ==0 : success
-		 * @return  <0 : fail
-		 */
-		template < uint32_t R, uint32_t C, typename MTRX >
-		inline int det(const fixed<R, C> *mt, component_t *v)
-		{
-			gnd_assert((!mt || !v), -1, "null pointer");
-
-			{ // ---> operation
-				fixed<R, C> ws;
-
-				return gnd_matrix_det(mt, &ws, v);
-			} // <--- operation
-		}
-
 		/**
 		 * @brief Compute Determinant (explicit 2x2)
 		 * @param [in]  mt  : Matrix (2x2)
@@ -2079,7 +2209,6 @@ namespace gnd { // ---> namespace gnd
 		 * @return ==0 : success
 		 * @return  <0 : fail
 		 */
-		template < typename MTRX >
 		inline int det(const fixed<2, 2> *mt, component_t *v)
 		{
 			gnd_assert((!mt || !v), -1, "null pointer");
@@ -2097,7 +2226,6 @@ namespace gnd { // ---> namespace gnd
 		 * @return ==0 : success
 		 * @return  <0 : fail
 		 */
-		template < typename MTRX >
 		inline int det(const fixed<3, 3> *mt, component_t *v)
 		{
 			gnd_assert((!mt || !v), -1, "null pointer");
@@ -2115,7 +2243,6 @@ namespace gnd { // ---> namespace gnd
 		 * @return ==0 : success
 		 * @return  <0 : fail
 		 */
-		template < typename MTRX >
 		inline int det(const fixed<4, 4> *mt, component_t *v)
 		{
 			gnd_assert((!mt || !v), -1, "null pointer");
@@ -2159,15 +2286,18 @@ namespace gnd { // ---> namespace gnd
 		template < typename MTRX1, typename MTRX2  >
 		inline int _inverse_2x2_( MTRX1 *mt, MTRX2 *inv)
 		{
-			double det;
+			const double a = _gnd_matrix_ref_(mt, 0, 0), b = _gnd_matrix_ref_(mt, 0, 1),
+					c = _gnd_matrix_ref_(mt, 1, 0), d = _gnd_matrix_ref_(mt, 1, 1);
+			const double det = a * d - b * c;
+			double r;
 
-			_det_2x2_(mt, &det);
 			if( det == 0 )	return -1;
+			r = 1.0 / det;
 
-			_gnd_matrix_ref_(inv, 0, 0) =   _gnd_matrix_ref_(mt, 1, 1) / det;
-			_gnd_matrix_ref_(inv, 0, 1) = - _gnd_matrix_ref_(mt, 0, 1) / det;
-			_gnd_matrix_ref_(inv, 1, 0) = - _gnd_matrix_ref_(mt, 1, 0) / det;
-			_gnd_matrix_ref_(inv, 1, 1) =   _gnd_matrix_ref_(mt, 0, 0) / det;
+			_gnd_matrix_ref_(inv, 0, 0) =   d * r;
+			_gnd_matrix_ref_(inv, 0, 1) = - b * r;
+			_gnd_matrix_ref_(inv, 1, 0) = - c * r;
+			_gnd_matrix_ref_(inv, 1, 1) =   a * r;
 
 			return 0;
 		}
@@ -2185,22 +2315,30 @@ namespace gnd { // ---> namespace gnd
 		template < typename MTRX1, typename MTRX2  >
 		inline int _inverse_3x3_( MTRX1 *mt, MTRX2 *inv)
 		{
-			double det;
+			const double m00 = _gnd_matrix_ref_(mt, 0, 0), m01 = _gnd_matrix_ref_(mt, 0, 1), m02 = _gnd_matrix_ref_(mt, 0, 2),
+					m10 = _gnd_matrix_ref_(mt, 1, 0), m11 = _gnd_matrix_ref_(mt, 1, 1), m12 = _gnd_matrix_ref_(mt, 1, 2),
+					m20 = _gnd_matrix_ref_(mt, 2, 0), m21 = _gnd_matrix_ref_(mt, 2, 1), m22 = _gnd_matrix_ref_(mt, 2, 2);
+			// cofactor
+			const double c00 = m11 * m22 - m12 * m21,
+					c10 = m12 * m20 - m10 * m22,
+					c20 = m10 * m21 - m11 * m20;
+			const double det = m00 * c00 + m01 * c10 + m02 * c20;
+			double r;
 
-			gnd::matrix::_det_3x3_(mt, &det);
 			if( det == 0 )	return -1;
+			r = 1.0 / det;
 
-			_gnd_matrix_ref_(inv, 0, 0) = ( _gnd_matrix_ref_(mt, 1, 1) * _gnd_matrix_ref_(mt, 2, 2) - _gnd_matrix_ref_(mt, 1, 2) * _gnd_matrix_ref_(mt, 2, 1) ) / det;
-			_gnd_matrix_ref_(inv, 0, 1) = ( _gnd_matrix_ref_(mt, 0, 2) * _gnd_matrix_ref_(mt, 2, 1) - _gnd_matrix_ref_(mt, 0, 1) * _gnd_matrix_ref_(mt, 2, 2) ) / det;
-			_gnd_matrix_ref_(inv, 0, 2) = ( _gnd_matrix_ref_(mt, 0, 1) * _gnd_matrix_ref_(mt, 1, 2) - _gnd_matrix_ref_(mt, 0, 2) * _gnd_matrix_ref_(mt, 1, 1) ) / det;
+			_gnd_matrix_ref_(inv, 0, 0) = c00 * r;
+			_gnd_matrix_ref_(inv, 0, 1) = ( m02 * m21 - m01 * m22 ) * r;
+			_gnd_matrix_ref_(inv, 0, 2) = ( m01 * m12 - m02 * m11 ) * r;
 
-			_gnd_matrix_ref_(inv, 1, 0) = ( _gnd_matrix_ref_(mt, 1, 2) * _gnd_matrix_ref_(mt, 2, 0) - _gnd_matrix_ref_(mt, 1, 0) * _gnd_matrix_ref_(mt, 2, 2) ) / det;
-			_gnd_matrix_ref_(inv, 1, 1) = ( _gnd_matrix_ref_(mt, 0, 0) * _gnd_matrix_ref_(mt, 2, 2) - _gnd_matrix_ref_(mt, 0, 2) * _gnd_matrix_ref_(mt, 2, 0) ) / det;
-			_gnd_matrix_ref_(inv, 1, 2) = ( _gnd_matrix_ref_(mt, 0, 2) * _gnd_matrix_ref_(mt, 1, 0) - _gnd_matrix_ref_(mt, 0, 0) * _gnd_matrix_ref_(mt, 1, 2) ) / det;
+			_gnd_matrix_ref_(inv, 1, 0) = c10 * r;
+			_gnd_matrix_ref_(inv, 1, 1) = ( m00 * m22 - m02 * m20 ) * r;
+			_gnd_matrix_ref_(inv, 1, 2) = ( m02 * m10 - m00 * m12 ) * r;
 
-			_gnd_matrix_ref_(inv, 2, 0) = ( _gnd_matrix_ref_(mt, 1, 0) * _gnd_matrix_ref_(mt, 2, 1) - _gnd_matrix_ref_(mt, 1, 1) * _gnd_matrix_ref_(mt, 2, 0) ) / det;
-			_gnd_matrix_ref_(inv, 2, 1) = ( _gnd_matrix_ref_(mt, 0, 1) * _gnd_matrix_ref_(mt, 2, 0) - _gnd_matrix_ref_(mt, 0, 0) * _gnd_matrix_ref_(mt, 2, 1) ) / det;
-			_gnd_matrix_ref_(inv, 2, 2) = ( _gnd_matrix_ref_(mt, 0, 0) * _gnd_matrix_ref_(mt, 1, 1) - _gnd_matrix_ref_(mt, 0, 1) * _gnd_matrix_ref_(mt, 1, 0) ) / det;
+			_gnd_matrix_ref_(inv, 2, 0) = c20 * r;
+			_gnd_matrix_ref_(inv, 2, 1) = ( m01 * m20 - m00 * m21 ) * r;
+			_gnd_matrix_ref_(inv, 2, 2) = ( m00 * m11 - m01 * m10 ) * r;
 
 			return 0;
 		}
@@ -2723,6 +2861,20 @@ namespace gnd { // ---> namespace gnd
 			return _gnd_matrix_pointer_(this, i, 0);
 		}
 
+		/**
+		 * @ingroup GNDMatrix
+		 * @brief indexer like double pointer (read only)
+		 * @param[in] i : row index
+		 * @return row head pointer
+		 */
+		template<uint32_t R, uint32_t C>
+		inline
+		const double* fixed<R, C>::operator[](int i) const
+		{
+			gnd_assert(i < 0 || i > (signed)_gnd_matrix_row_(this), 0, "out of buffer");
+			return _gnd_matrix_pointer_(this, i, 0);
+		}
+
 	} // <--- namespace matrix
 } // <--- namespace gnd
 // <--- function definition
@@ -13,11 +13,21 @@
 #include <math.h>
 #include <float.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "gnd-optimize.hpp"
 #include "gnd-gridmap.hpp"
 #include "gnd-random.hpp"
 #include "gnd-bmp.hpp"
+#include "gnd-mapped-file.hpp"
+#include "gnd-thread-pool.hpp"
 #include "gnd-util.h"
 #include "gnd-queue.hpp"
 #include "gnd-linalg.hpp"
@@ -57,6 +67,8 @@ class optimize_quasi_monte_calro;
 typedef optimize_quasi_monte_calro qmc;
 class optimize_hybrid_qmc2newton;
 typedef optimize_hybrid_qmc2newton hybrid_q2n;
+class optimize_branch_and_bound;
+typedef optimize_branch_and_bound bnb;
 }
 
 }
@@ -100,11 +112,41 @@ static const char CMapFileNameDefault[] = "opsm";
  */
 static const char CMapFileExtension[] = "cmap";
 
+/**
+ * @brief compiled map file name format
+ */
+static const char CmplFileNameFormat[] = "%s/%s.%s";
+
+/**
+ * @brief default compiled map file extension
+ */
+static const char CmplFileExtension[] = "cmpl";
+
+/**
+ * @brief compiled map file type tag
+ */
+static const char CmplFileType[] = "opsm-cmpl";
+
+/**
+ * @brief default built map file extension
+ */
+static const char MapFileExtension[] = "map";
+
+/**
+ * @brief built map file type tag
+ */
+static const char MapFileType[] = "opsm-map";
+
 /**
  * @brief default map data cell size
  */
 static const double DefaultMapCellSize = 5;
 
+/**
+ * @brief number of points processed at once in batch likelihood computation
+ */
+static const size_t LikelihoodBatchSize = 64;
+
 /**
  * @brief reflection point position index
  */
@@ -134,13 +176,79 @@ struct counting_map_pixel {
  */
 typedef struct counting_map_pixel cmap_pixel_t;
 
+/**
+ * @ingroup GNDPSM
+ * @brief summed-area table of the number of points for each plane
+ * @details data[i][r * (column[i] + 1) + c] is the sum of pixels in [0, r) x [0, c) of plane i,
+ * so that the sum in a rectangular window is obtained in O(1).
+ */
+struct summed_area_table {
+	/// @brief cumulative sums ( (row + 1) x (column + 1) ) for each plane
+	uint64_t *data[PlaneNum];
+	/// @brief number of rows of each plane
+	unsigned long row[PlaneNum];
+	/// @brief number of columns of each plane
+	unsigned long column[PlaneNum];
+	/// @brief revision of source map that this table is built (0: not built)
+	uint64_t revision;
+	/// @brief generation of source counting map that this table is built (0: unknown)
+	uint64_t generation;
+	/// @brief constructor
+	summed_area_table() : revision(0), generation(0) {
+		for( size_t i = 0; i < PlaneNum; i++ ) {
+			data[i] = 0;
+			row[i] = 0;
+			column[i] = 0;
+		}
+	}
+	/// @brief destructor
+	~summed_area_table() {
+		for( size_t i = 0; i < PlaneNum; i++ ) ::free(data[i]);
+	}
+};
+/**
+ * @typedef sat_t
+ * @see summed_area_table
+ */
+typedef struct summed_area_table sat_t;
+
+/**
+ * @brief modification state of counting map memory unit (block)
+ */
+struct counting_map_block {
+	/// @brief generation of last modification
+	uint64_t stamp;
+	/// @brief block may have reflection points
+	bool used;
+	/// @brief constructor
+	counting_map_block() : stamp(0), used(false) {}
+};
+/**
+ * @typedef cmap_block_t
+ * @see counting_map_block
+ */
+typedef struct counting_map_block cmap_block_t;
+
 /**
  * @ingroup GNDPSM
  * @brief counting map
+ * @details modified memory units are tracked for rebuild_map().
  */
 struct counting_map {
 	/// @brief four planes
 	gridmap::gridplane<cmap_pixel_t> plane[PlaneNum];
+	/// @brief modification state of each memory unit of each plane
+	gridmap::basic_gridmap<cmap_block_t> block[PlaneNum];
+	/// @brief current generation (incremented by each map building)
+	uint64_t generation;
+	/// @brief generation of last memory unit layout change (reallocation, file read)
+	uint64_t layout;
+	/// @brief revision (incremented by each modification)
+	uint64_t revision;
+	/// @brief summed-area table of counts (see build_sat())
+	sat_t sat;
+	/// @brief constructor
+	counting_map() : generation(1), layout(1), revision(1) {}
 };
 /**
  * @ingroup GNDPSM
@@ -179,6 +287,14 @@ typedef struct map_pixel pixel_t;
 struct scanmatching_map {
 	/// @brief four planes
 	gridmap::gridplane<pixel_t> plane[PlaneNum];
+	/// @brief generation of counting map that this map is built
+	uint64_t generation;
+	/// @brief revision (incremented by each modification)
+	uint64_t revision;
+	/// @brief summed-area table of the number of points (see build_sat())
+	sat_t sat;
+	/// @brief constructor
+	scanmatching_map() : generation(0), revision(1) {}
 };
 /**
  * @typedef map_t
@@ -186,6 +302,128 @@ struct scanmatching_map {
  */
 typedef struct scanmatching_map map_t;
 
+/**
+ * @brief maximum number of coarse levels of map pyramid
+ */
+static const size_t PyramidLevelMax = 4;
+
+/**
+ * @ingroup GNDPSM
+ * @brief map pyramid (coarse levels of a map)
+ * @details level k (1 <= k <= n) has 2^k times pixel size of the original map (level 0).
+ * statistics of each level are aggregated from the finer level, see build_map_pyramid().
+ */
+struct map_pyramid {
+	/// @brief counting map of each coarse level (index k - 1 for level k)
+	cmap_t cnt[PyramidLevelMax];
+	/// @brief map of each coarse level (index k - 1 for level k)
+	map_t map[PyramidLevelMax];
+	/// @brief number of coarse levels
+	size_t n;
+	/// @brief generation of source counting map that each level is built (see rebuild_map_pyramid())
+	uint64_t generation[PyramidLevelMax];
+	/// @brief constructor
+	map_pyramid() : n(0) {
+		for( size_t k = 0; k < PyramidLevelMax; k++ ) generation[k] = 0;
+	}
+};
+/**
+ * @typedef map_pyramid_t
+ * @see map_pyramid
+ */
+typedef struct map_pyramid map_pyramid_t;
+
+/**
+ * @brief number of levels of max-pooled likelihood field (branch and bound)
+ */
+static const size_t BnBLevelNum = 7;
+
+/**
+ * @ingroup GNDPSM
+ * @brief max-pooled likelihood field for branch and bound search
+ * @details level 0 is the quantized likelihood field of half map pixel size,
+ * level k pixel is the max of 2^k x 2^k pixels of level 0. see build_bnb_field().
+ */
+struct bnb_field {
+	/// @brief field of each level
+	gridmap::gridplane<uint16_t> level[BnBLevelNum];
+	/// @brief source map
+	const void *map;
+	/// @brief revision of source map
+	uint64_t revision;
+	/// @brief constructor
+	bnb_field() : map(0), revision(0) {}
+};
+/**
+ * @typedef bnb_field_t
+ * @see bnb_field
+ */
+typedef struct bnb_field bnb_field_t;
+
+/**
+ * @brief compiled map cell element index
+ * @note each element has PlaneNum values (one for each plane)
+ */
+enum {
+	CmplMeanX = 0,							///< mean x (cell core offset included)
+	CmplMeanY = CmplMeanX + PlaneNum,		///< mean y (cell core offset included)
+	CmplInvCov00 = CmplMeanY + PlaneNum,	///< inverse matrix of covariance (0,0)
+	CmplInvCov01 = CmplInvCov00 + PlaneNum,	///< inverse matrix of covariance (0,1)
+	CmplInvCov11 = CmplInvCov01 + PlaneNum,	///< inverse matrix of covariance (1,1)
+	CmplWeight = CmplInvCov11 + PlaneNum,	///< weight K
+	CmplElementNum = CmplWeight + PlaneNum,	///< number of values in a cell
+};
+
+/**
+ * @brief alignment of compiled map cell (cache line size)
+ */
+static const size_t CmplAlignment = 64;
+
+/**
+ * @ingroup GNDPSM
+ * @brief read-only compiled scan matching map
+ * @details four planes are interleaved in each cell.
+ * the cell size is half of map pixel size, so that a cell is included in just one pixel of each plane
+ * and likelihood computation need only one index computation.
+ * mean is stored relative to the origin of compiled map (pixel core position is folded).
+ * T is float or double.
+ */
+template < typename T >
+struct compiled_map {
+	/// @brief cell data (cache line aligned, stride elements for each cell)
+	T *data;
+	/// @brief number of elements for each cell
+	size_t stride;
+	/// @brief number of row
+	long row;
+	/// @brief number of column
+	long column;
+	/// @brief origin x
+	double xorg;
+	/// @brief origin y
+	double yorg;
+	/// @brief cell size
+	double rsl;
+	/// @brief inverse of cell size
+	double irsl;
+	/// @brief mapped file (data is on read-only mapped file, see read_compiled_map())
+	gnd::mapped_file *file;
+	/// @brief generation of counting map that the map is built (0: unknown, see rebuild_compiled_map())
+	uint64_t generation;
+	/// @brief constructor
+	compiled_map() : data(0), stride(0), row(0), column(0), xorg(0), yorg(0), rsl(0), irsl(0), file(0), generation(0) {}
+};
+/**
+ * @typedef compiled_map_t
+ * @see compiled_map
+ */
+typedef struct compiled_map<double> compiled_map_t;
+/**
+ * @typedef compiled_mapf_t
+ * @see compiled_map
+ */
+typedef struct compiled_map<float> compiled_mapf_t;
+
 /**
  * @ingroup GNDPSM
  * @brief position_gain
@@ -215,25 +453,73 @@ int clear_counting_map(cmap_t *m);
 int destroy_counting_map(cmap_t *m);
 
 int counting_map(cmap_t *m, double x, double y);
+int _sync_counting_map_block_(cmap_t *m, size_t i, bool force);
+bool _is_empty_unit_(map_t *map, cmap_t *cnt, size_t i, unsigned long r, unsigned long c, double x, double y);
 
 int update_map(cmap_t *cnt, map_t *map, double x, double y, double err = ErrorMargin );
 int update_ndt_map(cmap_t *c, map_t *m, double x, double y);
+int refresh_map(cmap_t *cnt, map_t *map, double x, double y, double err = ErrorMargin );
+int refresh_ndt_map(cmap_t *cnt, map_t *map, double x, double y, double err = ErrorMargin );
 int build_map(map_t *map, cmap_t *cnt, double err = ErrorMargin, double sr = 0, double *max = 0);
 int build_ndt_map(map_t *map, cmap_t *cnt, double err = ErrorMargin);
+int rebuild_map(map_t *map, cmap_t *cnt, double err = ErrorMargin);
+int rebuild_ndt_map(map_t *map, cmap_t *cnt, double err = ErrorMargin);
 int destroy_map(map_t *m);
+int build_map_pyramid(map_pyramid_t *p, cmap_t *cnt, size_t n, double err = ErrorMargin, double sr = 0);
+int rebuild_map_pyramid(map_pyramid_t *p, cmap_t *cnt, size_t n, double err = ErrorMargin);
+int destroy_map_pyramid(map_pyramid_t *p);
+int build_bnb_field(bnb_field_t *f, map_t *m);
+int destroy_bnb_field(bnb_field_t *f);
+int _coarse_counting_map_(cmap_t *dst, cmap_t *src);
+int _update_coarse_counting_map_(cmap_t *dst, cmap_t *src, uint64_t since);
+void _coarse_counting_merge_(cmap_pixel_t *dp, const cmap_pixel_t *sp, double dx, double dy);
+
+int build_sat(sat_t *s, cmap_t *cnt);
+int build_sat(sat_t *s, map_t *map);
+int destroy_sat(sat_t *s);
+uint64_t window_sum(const sat_t *s, size_t i, long lr, long lc, long ur, long uc);
 
 int position_gain(map_t *map, double x, double y, double r, pgain_t *pg);
 int likelihood(map_t *m, double x, double y, double *l);
 int likelihood(map_t *m, double x, double y, pgain_t *pg, double *l);
+int likelihood(map_t *m, const double *x, const double *y, size_t n, pgain_t *pg, double *sum, double *l = 0);
 int gradient(map_t *m, double x, double y, matrix::fixed<4,4> *c, matrix::fixed<3,1> *g, double *l = 0);
+int newton_variables(map_t *m, const double *x, const double *y, size_t n, matrix::fixed<4,4> *c, double *l, matrix::fixed<3,1> *g, matrix::fixed<3,3> *h);
+
+template < typename T >
+int build_compiled_map(compiled_map<T> *cm, map_t *map);
+template < typename T >
+int rebuild_compiled_map(compiled_map<T> *cm, map_t *map, cmap_t *cnt);
+template < typename T >
+int destroy_compiled_map(compiled_map<T> *cm);
+int _compiled_map_bound_(map_t *map, double *xl, double *yl, long *row, long *column, double *rsl);
+template < typename T >
+void _cmpl_cell_set_(T *cell, size_t i, map_t *map, long pr, long pc, double xl, double yl);
+template < typename T >
+int read_compiled_map(compiled_map<T> *cm, const char* d = CMapDirectoryDefault, const char* f = CMapFileNameDefault, const char* e = CmplFileExtension, uint64_t key = 0);
+template < typename T >
+int write_compiled_map(compiled_map<T> *cm, const char* d = CMapDirectoryDefault, const char* f = CMapFileNameDefault, const char* e = CmplFileExtension, uint64_t key = 0);
+int read_map(map_t *map, cmap_t *cnt, const char* d = CMapDirectoryDefault, const char* f = CMapFileNameDefault, const char* e = MapFileExtension, uint64_t key = 0);
+int write_map(map_t *map, const char* d = CMapDirectoryDefault, const char* f = CMapFileNameDefault, const char* e = MapFileExtension, uint64_t key = 0);
+template < typename T >
+int likelihood(compiled_map<T> *cm, double x, double y, double *l);
+template < typename T >
+int likelihood(compiled_map<T> *cm, double x, double y, pgain_t *pg, double *l);
+template < typename T >
+int likelihood(compiled_map<T> *cm, const double *x, const double *y, size_t n, pgain_t *pg, double *sum, double *l = 0);
+template < typename T >
+int gradient(compiled_map<T> *cm, double x, double y, matrix::fixed<4,4> *c, matrix::fixed<3,1> *g, double *l = 0);
+template < typename T >
+int newton_variables(compiled_map<T> *cm, const double *x, const double *y, size_t n, matrix::fixed<4,4> *c, double *l, matrix::fixed<3,1> *g, matrix::fixed<3,3> *h);
 
 int read_counting_map(cmap_t *c,  const char* d = CMapDirectoryDefault, const char* f = CMapFileNameDefault, const char* e = CMapFileExtension);
 int write_counting_map(cmap_t *c,  const char* d = CMapDirectoryDefault, const char* f = CMapFileNameDefault, const char* e = CMapFileExtension);
+uint64_t counting_map_key(cmap_t *c, uint64_t seed = 0);
 
-int build_bmp(bmp8_t *b, map_t *m, double p = 0.1, double sr = 0.0, double cp = 4.0);
-int build_bmp(bmp32_t *b, map_t *m, double p = 0.1, double sr = 0.0, double cp = 4.0);
-int build_bmp8(bmp8_t *b, map_t *m, double p = 0.1, double sr = 0.0, double cp = 4.0);
-int build_bmp32(bmp32_t *b, map_t *m, double p = 0.1, double sr = 0.0, double cp = 4.0);
+int build_bmp(bmp8_t *b, map_t *m, double p = 0.1, double sr = 0.0, double cp = 4.0, gridmap::gridplane<double> *ws = 0);
+int build_bmp(bmp32_t *b, map_t *m, double p = 0.1, double sr = 0.0, double cp = 4.0, gridmap::gridplane<double> *ws = 0);
+int build_bmp8(bmp8_t *b, map_t *m, double p = 0.1, double sr = 0.0, double cp = 4.0, gridmap::gridplane<double> *ws = 0);
+int build_bmp32(bmp32_t *b, map_t *m, double p = 0.1, double sr = 0.0, double cp = 4.0, gridmap::gridplane<double> *ws = 0);
 }
 };
 // <--- function declaration
@@ -283,7 +569,15 @@ int init_counting_map(cmap_t *m, double p, double u)
 		}
 		// set origin
 		m->plane[i].pset_core( (i % 2) * (p / 2.0), ((i / 2) % 2) * (p / 2.0) );
+		// memory unit state (allocated memory is empty)
+		{
+			cmap_block_t ini;
+			ini.stamp = m->generation;
+			_sync_counting_map_block_(m, i, true);
+			m->block[i].set_uniform(&ini);
+		}
 	} // <--- plane scan loop
+	m->revision++;
 
 	LogUnindent();
 	LogDebugf("End   - init_counting_map(%p, %lf, %lf)\n", m, p, u);
@@ -303,13 +597,94 @@ int clear_counting_map(cmap_t *m) {
 	{ // ---> operation
 		opsm::counting_map_pixel ini;
 
+		m->revision++;
 		for( size_t i = 0; i < opsm::PlaneNum; i++){
-			m->plane[i].set_uniform(&ini);
+			const uint32_t us = m->plane[i]._unit_row_() * m->plane[i]._unit_column_();
+
+			if( _sync_counting_map_block_(m, i, false) > 0 ) {
+				// memory unit layout is changed
+				cmap_block_t bini;
+
+				bini.stamp = m->generation;
+				m->plane[i].set_uniform(&ini);
+				m->block[i].set_uniform(&bini);
+				continue;
+			}
+
+			// clear only memory units which have reflection points
+			for( uint32_t br = 0; br < m->plane[i]._plane_row_(); br++){
+				for( uint32_t bc = 0; bc < m->plane[i]._plane_column_(); bc++){
+					cmap_block_t *b = m->block[i].pointer(br, bc);
+					cmap_pixel_t *h;
+
+					if( !b->used ) continue;
+					h = m->plane[i].blockheader(br, bc);
+					for( uint32_t k = 0; k < us; k++ ) h[k] = ini;
+					b->stamp = m->generation;
+					b->used = false;
+				}
+			}
 		}
 	} // <--- operation
 	return 0;
 }
 
+
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief fit memory unit state table to memory unit layout of a plane
+ * @param[in,out] m : counting map
+ * @param[in]     i : plane index
+ * @param[in] force : reset even if the layout is not changed
+ * @return  >0 : reset (all memory units are marked as modified)
+ * @return ==0 : not changed
+ * @note if the layout is changed, data may be moved, so all memory units are marked as modified.
+ */
+inline
+int _sync_counting_map_block_(cmap_t *m, size_t i, bool force) {
+	if( !force && m->block[i].is_allocate() &&
+			m->block[i].row() == m->plane[i]._plane_row_() &&
+			m->block[i].column() == m->plane[i]._plane_column_() ){
+		return 0;
+	}
+
+	{ // ---> reset
+		cmap_block_t ini;
+
+		ini.stamp = m->generation;
+		ini.used = true;
+		if( m->block[i].is_allocate() ) m->block[i].deallocate();
+		if( m->block[i].allocate( m->plane[i]._plane_row_(), m->plane[i]._plane_column_() ) < 0 ) return -1;
+		m->block[i].set_uniform(&ini);
+		m->layout = m->generation;
+	} // <--- reset
+	return 1;
+}
+
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief check whether a pixel needs no update on map building
+ * @param[in] map : map
+ * @param[in] cnt : counting map
+ * @param[in]   i : plane index
+ * @param[in]   r : pixel row index on counting map
+ * @param[in]   c : pixel column index on counting map
+ * @param[in]   x : pixel core position x
+ * @param[in]   y : pixel core position y
+ * @return true : neither the counting map nor the map has memory unit on the pixel
+ * @note memory units that were never observed are left not allocated.
+ */
+inline
+bool _is_empty_unit_(map_t *map, cmap_t *cnt, size_t i, unsigned long r, unsigned long c, double x, double y) {
+	long mr, mc;
+
+	if( cnt->plane[i].is_unit_allocate( r / cnt->plane[i]._unit_row_(), c / cnt->plane[i]._unit_column_() ) ) return false;
+	if( map->plane[i].pindex(x, y, &mr, &mc) < 0 ) return true;
+	return !map->plane[i].is_unit_allocate( mr / map->plane[i]._unit_row_(), mc / map->plane[i]._unit_column_() );
+}
+
 /**
  * @ingroup GNDPSM
  * @brief release counting map
@@ -325,7 +700,11 @@ int destroy_counting_map(cmap_t *m)
 
 	for( size_t i = 0; i < PlaneNum; i++){
 		m->plane[i].deallocate();
+		if( m->block[i].is_allocate() ) m->block[i].deallocate();
 	}
+	m->layout = m->generation;
+	m->revision++;
+	destroy_sat(&m->sat);
 
 	LogUnindent();
 	LogDebugf("  End - destroy_counting_map(%p)\n", m);
@@ -347,6 +726,7 @@ int counting_map(cmap_t *m, double x, double y)
 	{ // ---> operate
 		matrix::fixed<PosDim, 1> xx;
 
+		m->revision++;
 		set(&xx, PosX, 0, x);
 		set(&xx, PosY, 0, y);
 
@@ -367,6 +747,15 @@ int counting_map(cmap_t *m, double x, double y)
 
 			// get row and column number of reflection point pixel
 			m->plane[i].pindex(x, y, &r, &c);
+
+			{ // ---> mark memory unit as modified
+				cmap_block_t *b;
+
+				_sync_counting_map_block_(m, i, false);
+				b = m->block[i].pointer( r / m->plane[i]._unit_row_(), c / m->plane[i]._unit_column_() );
+				b->stamp = m->generation;
+				b->used = true;
+			} // <--- mark memory unit as modified
 			// get core position of reflection point pixel
 			m->plane[i].pget_pos_core(r, c, pointer(&core, PosX, 0), pointer(&core, PosY, 0));
 
@@ -402,13 +791,39 @@ int update_map(cmap_t *cnt, map_t *map, double x, double y, double err )
 
 	{ // ---> operation
 		int ret;
-		matrix::fixed<PosDim,PosDim> ws2x2;	// workspace 2x2 matrix
-		matrix::fixed<PosDim,PosDim> cov;		// covariance matrix
-		long r = 0, c = 0;
 
 		if( (ret = counting_map(cnt, x, y)) < 0){
 			return ret;
 		}
+		return refresh_map(cnt, map, x, y, err);
+	} // <--- operation
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief refresh map pixels on a point from counting map
+ * @param[in]     cnt : counting map
+ * @param[out]    map : map
+ * @param[in]       x : laser scanner reflection point x
+ * @param[in]       y : laser scanner reflection point y
+ * @param[in]     err : margin of some kinds of error ( such as rounding error sensor resolution  )
+ * @note update_map() is counting_map() and this.
+ * this is used to apply the same update to another map that shares the counting map.
+ */
+inline
+int refresh_map(cmap_t *cnt, map_t *map, double x, double y, double err )
+{
+	gnd_assert(!cnt, -1, "invalid null argument");
+	gnd_assert(!map, -1, "invalid null argument");
+
+	{ // ---> operation
+		int ret;
+		matrix::fixed<PosDim,PosDim> ws2x2;	// workspace 2x2 matrix
+		matrix::fixed<PosDim,PosDim> cov;		// covariance matrix
+		long r = 0, c = 0;
+
+		map->revision++;
 		// ---> for each plane
 		for(size_t i = 0; i < PlaneNum; i++){
 			cmap_pixel_t *cpp;
@@ -497,13 +912,39 @@ int update_ndt_map(cmap_t *cnt, map_t *map, double x, double y, double err)
 {
 	gnd_assert(!map, -1, "invalid null argument");
 
+	{ // ---> operation
+		int ret;
+
+		if( (ret = counting_map(cnt, x, y)) < 0) return ret;
+		return refresh_ndt_map(cnt, map, x, y, err);
+	} // <--- operation
+}
+
+
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief refresh map pixels on a point from counting map (ndt)
+ * @param[in]     cnt : counting map
+ * @param[out]    map : map
+ * @param[in]       x : laser scanner reflection point x
+ * @param[in]       y : laser scanner reflection point y
+ * @param[in]     err : minimum error
+ * @note update_ndt_map() is counting_map() and this.
+ */
+inline
+int refresh_ndt_map(cmap_t *cnt, map_t *map, double x, double y, double err)
+{
+	gnd_assert(!cnt, -1, "invalid null argument");
+	gnd_assert(!map, -1, "invalid null argument");
+
 	{ // ---> operation
 		int ret;
 		matrix::fixed<PosDim,PosDim> ws2x2;	// workspace 2x2 matrix
 		matrix::fixed<PosDim,PosDim> cov;		// covariance matrix
 		long r, c;
 
-		if( (ret = counting_map(cnt, x, y)) < 0) return ret;
+		map->revision++;
 		// ---> for each plane
 		for(size_t i = 0; i < PlaneNum; i++){
 			cmap_pixel_t *cpp;
@@ -588,6 +1029,12 @@ int build_map(map_t *map, cmap_t *cnt, double err, double sr, double *maxk) {
 		matrix::fixed<PosDim,PosDim> cov;	// covariance matrix
 
 		if( maxk ) *maxk = 0;
+		// summed-area table for sum of points in the sensor range
+		if( sr > 0 && build_sat(&cnt->sat, cnt) < 0 ) {
+			LogUnindent();
+			LogDebugf("Fail  - int build_map(%p, %p, %lf, %lf)\n", map, cnt, err, maxk);
+			return -1;
+		}
 
 		// ---> for each plane
 		for(size_t i = 0; i < PlaneNum; i++){
@@ -613,13 +1060,14 @@ int build_map(map_t *map, cmap_t *cnt, double err, double sr, double *maxk) {
 			for( unsigned long r = 0; r < cnt->plane[i].row(); r++){
 				// ---> for each column
 				for( unsigned long c = 0; c < cnt->plane[i].column(); c++){
-					cmap_pixel_t *cpp;
+					const cmap_pixel_t *cpp;
 					pixel_t *pp;
 					double x, y;
 
 					// get ndt data
-					cpp = cnt->plane[i].pointer( r, c );
+					cpp = cnt->plane[i].cpointer( r, c );
 					cnt->plane[i].pget_pos_core(r, c, &x, &y);
+					if( _is_empty_unit_(map, cnt, i, r, c, x, y) ) continue;
 					for( pp = map->plane[i].ppointer( x, y );
 							pp == 0;
 							pp = map->plane[i].ppointer( x, y ) ){
@@ -662,7 +1110,6 @@ int build_map(map_t *map, cmap_t *cnt, double err, double sr, double *maxk) {
 						// ---> obtain the sum of laser points in the sensor range for each plane
 						if( sr > 0 ) {
 							size_t f = ::floor( sr / map->plane[0].xrsl());
-							cmap_pixel_t *tmp_cpp;
 							unsigned long lowerr;	// search range lower row
 							unsigned long upperr;	// search range upper row
 							unsigned long lowerc;	// search range lower column
@@ -672,15 +1119,9 @@ int build_map(map_t *map, cmap_t *cnt, double err, double sr, double *maxk) {
 							upperr = r + f >= map->plane[i].row() ? map->plane[i].row() : r + f;
 							lowerc = c < f ? 0 : c - f;
 							upperc = c + f >= map->plane[i].column() ? map->plane[i].column() : c + f;
-							sum = 0;
 
-							// compute average of local area number of observed point
-							for( unsigned long rr = lowerr; rr < upperr; rr++){
-								for( unsigned long cc = lowerc; cc < upperc; cc++){
-									tmp_cpp = cnt->plane[i].pointer( rr, cc );
-									sum += tmp_cpp->cnt;
-								}
-							}
+							// sum of local area number of observed point
+							sum = window_sum(&cnt->sat, i, lowerr, lowerc, upperr, upperc);
 						} // <--- obtain the sum of laser points in the sensor range for each plane
 						else {
 							sum = 1;
@@ -706,6 +1147,10 @@ int build_map(map_t *map, cmap_t *cnt, double err, double sr, double *maxk) {
 		} // <--- for each plane
 	}  // <--- operation
 
+	// following modification will be applied in rebuild_map()
+	map->generation = ++cnt->generation;
+	map->revision++;
+
 	LogUnindent();
 	LogDebugf("End   - int build_map(%p, %p, %lf, %lf)\n", map, cnt, err, maxk);
 	return 0;
@@ -756,14 +1201,15 @@ int build_ndt_map( map_t *map, cmap_t *cnt, double err )
 			for( unsigned long r = 0; r < cnt->plane[i].row(); r++){
 				// ---> for each column
 				for( unsigned long c = 0; c < cnt->plane[i].column(); c++){
-					cmap_pixel_t *cpp;
+					const cmap_pixel_t *cpp;
 					pixel_t *pp;
 					double x, y;
 
 
 					// get ndt data
-					cpp = cnt->plane[i].pointer( r, c );
+					cpp = cnt->plane[i].cpointer( r, c );
 					cnt->plane[i].pget_pos_core(r, c, &x, &y);
+					if( _is_empty_unit_(map, cnt, i, r, c, x, y) ) continue;
 					for( pp = map->plane[i].ppointer( x, y );
 							pp == 0;
 							pp = map->plane[i].ppointer( x, y ) ){
@@ -805,6 +1251,10 @@ int build_ndt_map( map_t *map, cmap_t *cnt, double err )
 		} // <--- for each plane
 	}  // <--- operation
 
+	// following modification will be applied in rebuild_ndt_map()
+	map->generation = ++cnt->generation;
+	map->revision++;
+
 	LogUnindent();
 	LogDebugf("End - build_ndt_map(%p, %p, %lf)\n", map, cnt, err);
 	return 0;
@@ -812,258 +1262,2242 @@ int build_ndt_map( map_t *map, cmap_t *cnt, double err )
 
 
 /**
+ * @privatesection
  * @ingroup GNDPSM
- * @brief destory map
- * @param[out] m :  map
+ * @brief rebuild modified memory units of map
+ * @param[out] map : map
+ * @param[in]  cnt : counting map
+ * @param[in]  err : minimum error
+ * @param[in]  ndt : ndt mode
  */
 inline
-int destroy_map(map_t *m)
+int _rebuild_map_( map_t *map, cmap_t *cnt, double err, bool ndt )
 {
-	gnd_assert(!m, -1, "invalid null pointer");
+	gnd_assert(!cnt, -1, "invalid null pointer");
+	gnd_assert(!map, -1, "map is null");
 
-	LogDebugf("Begin - destroy_map(%p)\n", m);
+	LogDebugf("Begin - _rebuild_map_(%p, %p, %lf, %d)\n", map, cnt, err, ndt);
 	LogIndent();
 
-	for( size_t i = 0; i < PlaneNum; i++)
-		m->plane[i].deallocate();
+	{ // ---> operation
+		matrix::fixed<PosDim,PosDim> ws2x2;	// workspace 2x2 matrix
+		matrix::fixed<PosDim,PosDim> cov;		// covariance matrix
+		const uint64_t since = map->generation;
+
+		// ---> for each plane
+		for(size_t i = 0; i < PlaneNum; i++){
+			const uint32_t ur = cnt->plane[i]._unit_row_();
+			const uint32_t uc = cnt->plane[i]._unit_column_();
+
+			if( map->plane[i].xrsl() != cnt->plane[i].xrsl() || map->plane[i].yrsl() != cnt->plane[i].yrsl() ){
+				LogDebug("fail to allocate\n");
+				LogUnindent();
+				LogDebugf("Fail  - _rebuild_map_(%p, %p, %lf, %d)\n", map, cnt, err, ndt);
+				return -1;
+			}
+			_sync_counting_map_block_(cnt, i, false);
+
+			// ---> for each memory unit
+			for( uint32_t br = 0; br < cnt->plane[i]._plane_row_(); br++){
+				for( uint32_t bc = 0; bc < cnt->plane[i]._plane_column_(); bc++){
+					if( cnt->block[i].pointer(br, bc)->stamp < since ) continue;
+
+					// ---> for each pixel in memory unit
+					for( unsigned long r = br * ur; r < (br + 1) * ur && r < cnt->plane[i].row(); r++){
+						for( unsigned long c = bc * uc; c < (bc + 1) * uc && c < cnt->plane[i].column(); c++){
+							const cmap_pixel_t *cpp;
+							pixel_t *pp;
+							double x, y;
+
+							cpp = cnt->plane[i].cpointer( r, c );
+							cnt->plane[i].pget_pos_core(r, c, &x, &y);
+							if( _is_empty_unit_(map, cnt, i, r, c, x, y) ) continue;
+							for( pp = map->plane[i].ppointer( x, y );
+									pp == 0;
+									pp = map->plane[i].ppointer( x, y ) ){
+								map->plane[i].reallocate(x, y);
+							}
+
+							pp->N = ndt ? 1 : cpp->cnt;
+
+							// ---> obtain mean and inverse matrix of co-variance
+							if(cpp->cnt <= 3){
+								pp->K = 0;
+								continue;
+							}
+							else {
+								// compute mean
+								scalar_div(&cpp->pos_sum, (double)cpp->cnt, &pp->mean );
+
+								// compute covariance
+								prod_transpose2(&pp->mean, &cpp->pos_sum, &ws2x2);
+								sub(&cpp->cov_sum, &ws2x2, &ws2x2);
+								scalar_div(&ws2x2, (double)cpp->cnt, &cov);
+
+								// add minimal diagonal matrix
+								set_unit(&ws2x2);
+								scalar_prod(&ws2x2, gnd_square(err) , &ws2x2);
+								add(&cov, &ws2x2, &cov);
+
+								// compute inverse covariance
+								inverse(&cov, &pp->inv_cov);
+							}
+							// <--- obtain mean and inverse matrix of co-variance
+
+							if( ndt ) {
+								pp->K = 1.0;
+							}
+							else { // ---> compute evaluation gain
+								double det = 0;
+
+								if( matrix::det(&cov, &det) < 0) {
+									pp->K = 0;
+									continue;
+								}
+								pp->K = (double) (cpp->cnt) / ( ::sqrt(det) );
+							} // <--- compute evaluation gain
+						}
+					} // <--- for each pixel in memory unit
+				}
+			} // <--- for each memory unit
+		} // <--- for each plane
+	}  // <--- operation
+
+	map->generation = ++cnt->generation;
+	map->revision++;
 
 	LogUnindent();
-	LogDebugf("END   - destroy_map(%p)\n", m);
+	LogDebugf("End   - _rebuild_map_(%p, %p, %lf, %d)\n", map, cnt, err, ndt);
 	return 0;
 }
 
 
 /**
  * @ingroup GNDPSM
- * @brief count laser points in the range of robot sensor
- * @param[in] map : map data
- * @param[in]   x : robot position x
- * @param[in]   y : robot position x
- * @param[in]  sr : sensor range
- * @param[out] pg : position gain
- * @return <0 : error
+ * @brief map building function (only modified memory units)
+ * @param[in,out] map : map built by build_map() from cnt
+ * @param[in]     cnt : laser scanner reflection point counting data
+ * @param[in]     err : minimum error
+ * @details pixels in memory units which are modified after the last building of map are rebuilt.
+ * if map is not built yet or memory units layout of cnt is changed, whole map is built by build_map().
+ * the result is same as build_map() with sensor range 0.
+ * each map keeps its own generation, so that some maps can be rebuilt from one counting map.
  */
 inline
-int position_gain(map_t *map, double x, double y, double sr, pgain_t *pg) {
+int rebuild_map( map_t *map, cmap_t *cnt, double err )
+{
+	gnd_assert(!cnt, -1, "invalid null pointer");
 	gnd_assert(!map, -1, "map is null");
-	gnd_assert(!pg, -1, "output storage is null");
-
-	{ // ---> operate
-		long r = 0, c = 0;
-		size_t f = ::floor( sr / map->plane[0].xrsl());
-
-		pixel_t *tmp_cpp;
-		unsigned long lowerr;	// search range lower row
-		unsigned long upperr;	// search range upper row
-		unsigned long lowerc;	// search range lower column
-		unsigned long upperc;	// search range upper column
-
-		// ---> obtain the sum of laser points in the sensor range for each plane
-		for(unsigned int i = 0; i < PlaneNum; i++){
-			// clear
-			pg->N[i] = 0;
-
-			// get row and column index at robot position
-			map->plane[i].pindex(x, y, &r, &c);
 
-			//
-			lowerr = r < (signed)f ? 0 : r - f;
-			upperr = r + f >= map->plane[i].row() ? map->plane[i].row() : r + f;
-			lowerc = c < (signed)f ? 0 : c - f;
-			upperc = c + f >= map->plane[i].column() ? map->plane[i].column() : c + f;
-
-			// compute average of local area number of observed point
-			for( unsigned long rr = lowerr; rr < upperr; rr++){
-				for( unsigned long cc = lowerc; cc < upperc; cc++){
-					tmp_cpp = map->plane[i].pointer( rr, cc );
-					pg->N[i] += tmp_cpp->N;
-				}
-			}
-		}
-		// <--- obtain the sum of laser points in the sensor range for each plane
-
-	} // <--- operate
-	return 0;
+	if( !map->plane[0].is_allocate() || map->generation <= cnt->layout || map->generation > cnt->generation )
+		return build_map(map, cnt, err);
+	return _rebuild_map_(map, cnt, err, false);
 }
 
 
 /**
  * @ingroup GNDPSM
- * @brief compute likelihood
- * @param[in] map : map data
- * @param[in]   x : laser scanner reflection point x
- * @param[in]   y : laser scanner reflection point y
- * @param[out]  l : likelihood
+ * @brief ndt map building function (only modified memory units)
+ * @param[in,out] map : map built by build_ndt_map() from cnt
+ * @param[in]     cnt : laser scanner reflection point counting data
+ * @param[in]     err : minimum error
+ * @see rebuild_map()
  */
 inline
-int likelihood(map_t *map, double x, double y, double *l){
-	return likelihood(map, x, y, 0, l);
+int rebuild_ndt_map( map_t *map, cmap_t *cnt, double err )
+{
+	gnd_assert(!cnt, -1, "invalid null pointer");
+	gnd_assert(!map, -1, "map is null");
+
+	if( !map->plane[0].is_allocate() || map->generation <= cnt->layout || map->generation > cnt->generation )
+		return build_ndt_map(map, cnt, err);
+	return _rebuild_map_(map, cnt, err, true);
 }
 
+
 /**
  * @ingroup GNDPSM
- * @brief compute likelihood
- * @param[in] map : map data
- * @param[in]   x : laser scanner reflection point x
- * @param[in]   y : laser scanner reflection point y
- * @param[in]  pg : position gain
- * @param[out]  l : likelihood
+ * @brief destory map
+ * @param[out] m :  map
  */
 inline
-int likelihood(map_t *map, double x, double y, pgain_t *pg, double *l){
-	gnd_assert(!l, -1, "invalid null pointer");
-	gnd_assert(!map, -1, "map is null");
+int destroy_map(map_t *m)
+{
+	gnd_assert(!m, -1, "invalid null pointer");
 
-	{ // ---> operate
-		matrix::fixed<PosDim,1> pos;
-		matrix::fixed<PosDim,1> q;
-		matrix::fixed<1,PosDim> ws1x2;	// workspace 2x2 matrix
-		matrix::fixed<1,1> ws1x1;		// workspace 1x1 matrix
+	LogDebugf("Begin - destroy_map(%p)\n", m);
+	LogIndent();
 
-		{ // ---> initialize
-			set(&pos, PosX, 0, x);
-			set(&pos, PosY, 0, y);
-			*l = 0;
-		} // <--- initialize
+	for( size_t i = 0; i < PlaneNum; i++)
+		m->plane[i].deallocate();
+	m->generation = 0;
+	m->revision++;
+	destroy_sat(&m->sat);
 
+	LogUnindent();
+	LogDebugf("END   - destroy_map(%p)\n", m);
+	return 0;
+}
 
-		// ---> for
-		for( size_t i = 0; i < PlaneNum; i++){
-			pixel_t *pp;
-			int ret;
-			long pr, pc;
 
-			// get index of pixel
-			ret = map->plane[i].pindex( value(&pos, PosX, 0), value(&pos, PosY, 0), &pr, &pc );
-			// no data
-			if( ret < 0 )			continue;
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief build coarse counting map (twice pixel size)
+ * @param[out] dst : coarse counting map
+ * @param[in]  src : counting map
+ * @details pixels of plane 0 of src are merged into each plane of dst.
+ * the planes of dst are shifted by half of their pixel size (= src pixel size) as init_counting_map(),
+ * so that each src pixel is included in just one dst pixel and the statistics are exact.
+ */
+inline
+int _coarse_counting_map_(cmap_t *dst, cmap_t *src) {
+	gnd_assert(!dst || !src, -1, "invalid null pointer");
+	gnd_assert(!src->plane[0].is_allocate(), -1, "invalid argument");
 
-			// get pixel data
-			pp = map->plane[i].pointer( pr, pc );
-			// zero weight
-			if(pp->K <= 0.0)	continue;
+	destroy_counting_map(dst);
+	{ // ---> operation
+		const double srsl = src->plane[0].xrsl();
+		const double rsl = srsl * 2;
+		const double u = src->plane[0]._unit_column_() * srsl;
+
+		for( size_t i = 0; i < PlaneNum; i++ ){
+			if( dst->plane[i].pallocate(u, u, rsl, rsl) < 0 )	return -1;
+			dst->plane[i].pset_origin( src->plane[0].xlower() + (i % 2) * srsl, src->plane[0].ylower() + ((i / 2) % 2) * srsl );
+			_sync_counting_map_block_(dst, i, true);
+
+			// ---> merge pixels
+			for( unsigned long r = 0; r < src->plane[0].row(); r++ ){
+				for( unsigned long c = 0; c < src->plane[0].column(); c++ ){
+					const cmap_pixel_t *sp = src->plane[0].cpointer(r, c);
+					cmap_pixel_t *dp;
+					long dr = 0, dc = 0;
+					double x, y, cx, cy, dx, dy;
+
+					if( sp->cnt == 0 )	continue;
+					src->plane[0].pget_pos_core(r, c, &x, &y);
+					for( dp = dst->plane[i].ppointer(x, y); dp == 0; dp = dst->plane[i].ppointer(x, y) ) {
+						dst->plane[i].reallocate(x, y);
+					}
+					dst->plane[i].pindex(x, y, &dr, &dc);
+					{ // ---> mark memory unit as modified
+						cmap_block_t *b;
+
+						_sync_counting_map_block_(dst, i, false);
+						b = dst->block[i].pointer( dr / dst->plane[i]._unit_row_(), dc / dst->plane[i]._unit_column_() );
+						b->stamp = dst->generation;
+						b->used = true;
+					} // <--- mark memory unit as modified
+					dst->plane[i].pget_pos_core(dr, dc, &cx, &cy);
+
+					// re-center statistics at coarse pixel core
+					dx = x - cx;
+					dy = y - cy;
+					_coarse_counting_merge_(dp, sp, dx, dy);
+				}
+			} // <--- merge pixels
+		}
+	} // <--- operation
+	dst->revision++;
+	return 0;
+}
 
-			// get pixel core pos on ndt data pixel
-			map->plane[i].pget_pos_core(pr, pc, pointer(&q, PosX, 0), pointer(&q, PosY, 0));
-			sub(&pos, &q, &q);
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief merge a pixel of counting map into a coarse pixel
+ * @param[in,out] dp : coarse pixel
+ * @param[in]     sp : pixel
+ * @param[in]     dx : pixel core position from coarse pixel core (x)
+ * @param[in]     dy : pixel core position from coarse pixel core (y)
+ */
+inline
+void _coarse_counting_merge_(cmap_pixel_t *dp, const cmap_pixel_t *sp, double dx, double dy) {
+	dp->cov_sum[0][0] += sp->cov_sum[0][0] + 2 * dx * sp->pos_sum[PosX][0] + sp->cnt * dx * dx;
+	dp->cov_sum[0][1] += sp->cov_sum[0][1] + dx * sp->pos_sum[PosY][0] + dy * sp->pos_sum[PosX][0] + sp->cnt * dx * dy;
+	dp->cov_sum[1][0] += sp->cov_sum[1][0] + dx * sp->pos_sum[PosY][0] + dy * sp->pos_sum[PosX][0] + sp->cnt * dx * dy;
+	dp->cov_sum[1][1] += sp->cov_sum[1][1] + 2 * dy * sp->pos_sum[PosY][0] + sp->cnt * dy * dy;
+	dp->pos_sum[PosX][0] += sp->pos_sum[PosX][0] + sp->cnt * dx;
+	dp->pos_sum[PosY][0] += sp->pos_sum[PosY][0] + sp->cnt * dy;
+	dp->cnt += sp->cnt;
+}
 
-			// difference from mean
-			sub(&q, &pp->mean, &q);
-			// compute likelihood
-			prod_transpose1(&q, &pp->inv_cov, &ws1x2);
-			prod(&ws1x2, &q, &ws1x1);
-			if( pg ){
-				*l += ::exp( - value(&ws1x1, 0, 0) / 2.0) * (pp->K) / (pg->N[i] + 1);
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief update coarse counting map (only modified memory units)
+ * @param[in,out] dst : coarse counting map built by _coarse_counting_map_() from src
+ * @param[in]     src : counting map
+ * @param[in]   since : generation of src that dst is built
+ * @details each coarse pixel which includes a pixel of the modified memory units of src is recomputed
+ * from its 2 x 2 pixels of src, so that the result is same as _coarse_counting_map_().
+ * @note the memory unit layout of src must not be changed since dst is built.
+ */
+inline
+int _update_coarse_counting_map_(cmap_t *dst, cmap_t *src, uint64_t since) {
+	gnd_assert(!dst || !src, -1, "invalid null pointer");
+	gnd_assert(!src->plane[0].is_allocate() || !dst->plane[0].is_allocate(), -1, "invalid argument");
+
+	{ // ---> operation
+		const double srsl = src->plane[0].xrsl();
+		const uint32_t ur = src->plane[0]._unit_row_();
+		const uint32_t uc = src->plane[0]._unit_column_();
+		const opsm::counting_map_pixel ini;
+
+		_sync_counting_map_block_(src, 0, false);
+		// ---> for each modified memory unit
+		for( uint32_t br = 0; br < src->plane[0]._plane_row_(); br++ ){
+			for( uint32_t bc = 0; bc < src->plane[0]._plane_column_(); bc++ ){
+				if( src->block[0].pointer(br, bc)->stamp < since ) continue;
+
+				for( unsigned long r = br * ur; r < (br + 1) * ur && r < src->plane[0].row(); r++ ){
+					for( unsigned long c = bc * uc; c < (bc + 1) * uc && c < src->plane[0].column(); c++ ){
+						const bool empty = src->plane[0].cpointer(r, c)->cnt == 0;
+						double x, y;
+
+						src->plane[0].pget_pos_core(r, c, &x, &y);
+						for( size_t i = 0; i < PlaneNum; i++ ){
+							cmap_pixel_t *dp;
+							long dr = 0, dc = 0;
+							double cx, cy;
+
+							// empty pixel changes nothing on the coarse pixel which has no memory unit
+							if( dst->plane[i].pindex(x, y, &dr, &dc) < 0 ) {
+								if( empty ) continue;
+								while( dst->plane[i].pindex(x, y, &dr, &dc) < 0 ) dst->plane[i].reallocate(x, y);
+							}
+							else if( empty && !dst->plane[i].is_unit_allocate( dr / dst->plane[i]._unit_row_(), dc / dst->plane[i]._unit_column_() ) ) {
+								continue;
+							}
+							dp = dst->plane[i].pointer(dr, dc);
+							{ // ---> mark memory unit as modified
+								cmap_block_t *b;
+
+								_sync_counting_map_block_(dst, i, false);
+								b = dst->block[i].pointer( dr / dst->plane[i]._unit_row_(), dc / dst->plane[i]._unit_column_() );
+								b->stamp = dst->generation;
+								b->used = true;
+							} // <--- mark memory unit as modified
+							dst->plane[i].pget_pos_core(dr, dc, &cx, &cy);
+
+							// ---> recompute coarse pixel from its 2 x 2 pixels
+							*dp = ini;
+							for( int a = 0; a < 2; a++ ){
+								for( int b = 0; b < 2; b++ ){
+									const cmap_pixel_t *sp;
+									long sr, sc;
+									double sx, sy;
+
+									if( src->plane[0].pindex(cx + (a - 0.5) * srsl, cy + (b - 0.5) * srsl, &sr, &sc) < 0 ) continue;
+									sp = src->plane[0].cpointer(sr, sc);
+									if( sp->cnt == 0 )	continue;
+									src->plane[0].pget_pos_core(sr, sc, &sx, &sy);
+									_coarse_counting_merge_(dp, sp, sx - cx, sy - cy);
+								}
+							} // <--- recompute coarse pixel from its 2 x 2 pixels
+						}
+					}
+				}
+			}
+		} // <--- for each modified memory unit
+	} // <--- operation
+	dst->revision++;
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief build map pyramid
+ * @param[out] p : map pyramid
+ * @param[in] cnt : counting map (level 0)
+ * @param[in]   n : number of coarse levels (<= PyramidLevelMax)
+ * @param[in] err : margin of some kinds of error (see build_map())
+ * @param[in]  sr : sensor range (see build_map())
+ * @note coarse levels are built from scratch (see rebuild_map_pyramid())
+ */
+inline
+int build_map_pyramid(map_pyramid_t *p, cmap_t *cnt, size_t n, double err, double sr) {
+	gnd_assert(!p || !cnt, -1, "invalid null pointer");
+	gnd_assert(n > PyramidLevelMax, -1, "invalid argument");
+
+	LogDebugf("Begin - build_map_pyramid(%p, %p, %d)\n", p, cnt, (int)n);
+	LogIndent();
+
+	p->n = 0;
+	for( size_t k = 0; k < n; k++ ){
+		cmap_t *src = k == 0 ? cnt : p->cnt + k - 1;
+
+		if( _coarse_counting_map_(p->cnt + k, src) < 0 ) {
+			LogUnindent();
+			LogDebugf("Fail  - build_map_pyramid(%p, %p, %d)\n", p, cnt, (int)n);
+			return -1;
+		}
+		// following modification of src will be applied in rebuild_map_pyramid()
+		p->generation[k] = ++src->generation;
+		destroy_map(p->map + k);
+		if( build_map(p->map + k, p->cnt + k, err, sr) < 0 ) {
+			LogUnindent();
+			LogDebugf("Fail  - build_map_pyramid(%p, %p, %d)\n", p, cnt, (int)n);
+			return -1;
+		}
+		p->n = k + 1;
+	}
+
+	LogUnindent();
+	LogDebugf("End   - build_map_pyramid(%p, %p, %d)\n", p, cnt, (int)n);
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief map pyramid building function (only modified memory units)
+ * @param[in,out] p : map pyramid built by build_map_pyramid() from cnt
+ * @param[in]   cnt : counting map (level 0)
+ * @param[in]     n : number of coarse levels (<= PyramidLevelMax)
+ * @param[in]   err : margin of some kinds of error (see build_map())
+ * @details coarse pixels which include modified memory units of the finer level are recomputed,
+ * and the map of each level is rebuilt by rebuild_map().
+ * if the number of levels or memory units layout of the finer level is changed, the level and coarser are built from scratch.
+ * the pixel values are same as build_map_pyramid() with sensor range 0 (planes are not shrunk).
+ */
+inline
+int rebuild_map_pyramid(map_pyramid_t *p, cmap_t *cnt, size_t n, double err) {
+	gnd_assert(!p || !cnt, -1, "invalid null pointer");
+	gnd_assert(n > PyramidLevelMax, -1, "invalid argument");
+
+	LogDebugf("Begin - rebuild_map_pyramid(%p, %p, %d)\n", p, cnt, (int)n);
+	LogIndent();
+
+	{ // ---> operation
+		bool full = p->n != n;
+
+		for( size_t k = 0; k < n; k++ ){
+			cmap_t *src = k == 0 ? cnt : p->cnt + k - 1;
+			int ret;
+
+			full = full || p->generation[k] <= src->layout || p->generation[k] > src->generation;
+			if( full ) {
+				p->n = k;
+				ret = _coarse_counting_map_(p->cnt + k, src);
+				if( ret == 0 ) {
+					destroy_map(p->map + k);
+					ret = build_map(p->map + k, p->cnt + k, err);
+				}
 			}
 			else {
-				*l += ::exp( - value(&ws1x1, 0, 0) / 2.0) * (pp->K);
+				ret = _update_coarse_counting_map_(p->cnt + k, src, p->generation[k]);
+				if( ret == 0 ) ret = rebuild_map(p->map + k, p->cnt + k, err);
 			}
-		} // ---> for
+			if( ret < 0 ) {
+				LogUnindent();
+				LogDebugf("Fail  - rebuild_map_pyramid(%p, %p, %d)\n", p, cnt, (int)n);
+				return -1;
+			}
+			// following modification of src will be applied in next call
+			p->generation[k] = ++src->generation;
+			p->n = k + 1;
+		}
+	} // <--- operation
 
-		// normalization
-		*l /= PlaneNum;
-		return 0;
-	} // <--- operate
+	LogUnindent();
+	LogDebugf("End   - rebuild_map_pyramid(%p, %p, %d)\n", p, cnt, (int)n);
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief release map pyramid
+ * @param[out] p : map pyramid
+ */
+inline
+int destroy_map_pyramid(map_pyramid_t *p) {
+	gnd_assert(!p, -1, "invalid null pointer");
+
+	for( size_t k = 0; k < PyramidLevelMax; k++ ){
+		destroy_map(p->map + k);
+		destroy_counting_map(p->cnt + k);
+		p->generation[k] = 0;
+	}
+	p->n = 0;
+	return 0;
 }
 
 
 /**
- * @brief optimization iterate
- * @param[in]  x : laser scanner reflection point x
- * @param[in]  y : laser scanner reflection point y
- * @param[in]  c : coordinate convert matrix
- * @param[in]  m : likelihood map
- * @param[out] g : gradient   ( derivation of f(x,y) because of minimization problem)
- * @param[out] l : likelihood ( f(x,y) )
- * @return    0 :
- * @details this function compute following value for newton's method:
- * likelihood, gradient, hessian
+ * @ingroup GNDPSM
+ * @brief build max-pooled likelihood field for branch and bound search
+ * @param[out] f : field
+ * @param[in]  m : scan matching map
+ * @note it have to be rebuilt when the map is changed
  */
 inline
-int gradient( map_t *m, double x, double y, matrix::fixed<4,4> *c, matrix::fixed<3,1> *g, double *l ) {
-	matrix::fixed<4,1> X;				// reflection point on global coordinate
-	matrix::fixed<PosDim,3> J;			// jacobi
-	matrix::fixed<PosDim,1> q_quad_33;
+int build_bnb_field(bnb_field_t *f, map_t *m) {
+	gnd_assert(!f || !m, -1, "invalid null pointer");
+	gnd_assert(!m->plane[0].is_allocate(), -1, "map is null");
 
-	{ // ---> initialize
-		matrix::set_zero(g);
-		if(l) *l = 0;
-	} // <--- initialize
+	LogDebugf("Begin - build_bnb_field(%p, %p)\n", f, m);
+	LogIndent();
 
+	{ // ---> operation
+		const double rsl = m->plane[0].xrsl() / 2;
+		double xl = m->plane[0].xlower(), xu = m->plane[0].xupper();
+		double yl = m->plane[0].ylower(), yu = m->plane[0].yupper();
+		unsigned long row, col;
+
+		// bounds of all planes
+		for( size_t i = 1; i < PlaneNum; i++ ){
+			if( !m->plane[i].is_allocate() ) continue;
+			if( xl > m->plane[i].xlower() ) xl = m->plane[i].xlower();
+			if( xu < m->plane[i].xupper() ) xu = m->plane[i].xupper();
+			if( yl > m->plane[i].ylower() ) yl = m->plane[i].ylower();
+			if( yu < m->plane[i].yupper() ) yu = m->plane[i].yupper();
+		}
+		row = (unsigned long) ::ceil( (yu - yl) / rsl );
+		col = (unsigned long) ::ceil( (xu - xl) / rsl );
 
-	{ // ---> compute reflection points on global coordinate
-		matrix::fixed<4,1> xx;				// reflection point on global coordinate
-		xx[0][0] = x;
-		xx[1][0] = y;
-		xx[2][0] = 0;
-		xx[3][0] = 1;
-		matrix::prod(c, &xx, &X);
-	} // <--- compute reflection points on global coordinate
+		for( size_t k = 0; k < BnBLevelNum; k++ ){
+			if( f->level[k].is_allocate() ) f->level[k].deallocate();
+			if( f->level[k].allocate(row, col) < 0 ) {
+				LogUnindent();
+				LogDebugf("Fail  - build_bnb_field(%p, %p)\n", f, m);
+				return -1;
+			}
+			f->level[k].pset_rsl(rsl, rsl);
+			f->level[k].pset_origin(xl, yl);
+		}
 
-	{ // ---> jacobi matrix
-		set_zero(&J);
-		J[PosX][0] = 1;
-		J[PosX][2] = - x * (*c)[1][0] - y * (*c)[0][0];
-		J[PosY][1] = 1;
-		J[PosY][2] =   x * (*c)[0][0] - y * (*c)[1][0];
-	} // <--- jacobi matrix
+		// ---> likelihood field
+		// each pixel distribution is blurred by the field pixel size (sigma^2 I is added to covariance)
+		// and not weighted by number of points, so that the field is smooth in search step and in [0, 1]
+		for( unsigned long r = 0; r < row; r++ ){
+			uint16_t *fp = f->level[0].pointer(r, 0);
+
+			for( unsigned long c = 0; c < col; c++ ){
+				double x, y;
+				double v = 0;
+
+				f->level[0].pget_pos_core(r, c, &x, &y);
+				for( size_t i = 0; i < PlaneNum; i++ ){
+					const pixel_t *pp;
+					long pr, pc;
+					double qx, qy, s00, s01, s11, det;
+
+					if( m->plane[i].pindex(x, y, &pr, &pc) < 0 ) continue;
+					pp = m->plane[i].cpointer(pr, pc);
+					if( pp->K <= 0.0 ) continue;
+
+					// covariance
+					det = pp->inv_cov[0][0] * pp->inv_cov[1][1] - pp->inv_cov[0][1] * pp->inv_cov[1][0];
+					if( det <= 0 ) continue;
+					s00 = pp->inv_cov[1][1] / det + gnd_square(rsl);
+					s01 = - pp->inv_cov[0][1] / det;
+					s11 = pp->inv_cov[0][0] / det + gnd_square(rsl);
+					det = s00 * s11 - s01 * s01;
+
+					// difference from mean
+					m->plane[i].pget_pos_core(pr, pc, &qx, &qy);
+					qx = x - qx - pp->mean[0][0];
+					qy = y - qy - pp->mean[1][0];
+					v += ::exp( - ( s11 * qx * qx - 2 * s01 * qx * qy + s00 * qy * qy ) / det / 2.0 );
+				}
+				fp[c] = (uint16_t) ( 0xffff * v / PlaneNum + 0.5 );
+			}
+		} // <--- likelihood field
+
+		// ---> max pooling (level k covers [r, r + 2^k) x [c, c + 2^k) of level 0)
+		for( size_t k = 1; k < BnBLevelNum; k++ ){
+			const unsigned long s = 1UL << (k - 1);
+			for( unsigned long r = 0; r < row; r++ ){
+				const uint16_t *f0 = f->level[k - 1].pointer(r, 0);
+				const uint16_t *f1 = r + s < row ? f->level[k - 1].pointer(r + s, 0) : 0;
+				uint16_t *fp = f->level[k].pointer(r, 0);
+
+				for( unsigned long c = 0; c < col; c++ ){
+					uint16_t v = f0[c];
+					if( c + s < col && v < f0[c + s] )				v = f0[c + s];
+					if( f1 && v < f1[c] )							v = f1[c];
+					if( f1 && c + s < col && v < f1[c + s] )		v = f1[c + s];
+					fp[c] = v;
+				}
+			}
+		} // <--- max pooling
 
-	{ // ---> q quad_33
-		q_quad_33[PosX][0] = - x * (*c)[0][0] + y * (*c)[1][0];
-		q_quad_33[PosY][0] = - x * (*c)[1][0] - y * (*c)[0][0];
-	} // <--- q quad_33;
+		f->map = m;
+		f->revision = m->revision;
+	} // <--- operation
+
+	LogUnindent();
+	LogDebugf("End   - build_bnb_field(%p, %p)\n", f, m);
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief release max-pooled likelihood field
+ * @param[out] f : field
+ */
+inline
+int destroy_bnb_field(bnb_field_t *f) {
+	gnd_assert(!f, -1, "invalid null pointer");
+
+	for( size_t k = 0; k < BnBLevelNum; k++ ){
+		if( f->level[k].is_allocate() ) f->level[k].deallocate();
+	}
+	f->map = 0;
+	f->revision = 0;
+	return 0;
+}
+
+
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief allocate summed-area table of a plane
+ * @param[out] s : summed-area table
+ * @param[in]  i : plane index
+ * @param[in]  r : number of rows
+ * @param[in]  c : number of columns
+ */
+inline
+int _alloc_sat_(sat_t *s, size_t i, unsigned long r, unsigned long c) {
+	if( s->data[i] && s->row[i] == r && s->column[i] == c ) return 0;
+
+	::free(s->data[i]);
+	s->row[i] = 0;
+	s->column[i] = 0;
+	if( !(s->data[i] = static_cast<uint64_t*>( ::malloc( (r + 1) * (c + 1) * sizeof(uint64_t) ) )) ) return -1;
+	s->row[i] = r;
+	s->column[i] = c;
+	// first row is zero
+	::memset(s->data[i], 0, (c + 1) * sizeof(uint64_t));
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief build summed-area table of the number of points in counting map
+ * @param[out]  s : summed-area table
+ * @param[in] cnt : counting map
+ * @details only the part from the first modified row and column (memory units modified since the last call) is recomputed,
+ * because a modified pixel changes only the sums of lower-right area.
+ * if memory units layout of cnt is changed, whole table is built.
+ * @note if the table is up to date, nothing is done
+ */
+inline
+int build_sat(sat_t *s, cmap_t *cnt) {
+	gnd_assert(!s || !cnt, -1, "invalid null pointer");
+
+	if( s->revision == cnt->revision ) return 0;
+
+	{ // ---> operation
+		const bool full = s->generation <= cnt->layout || s->generation > cnt->generation;
+
+		for( size_t i = 0; i < PlaneNum; i++ ){
+			const unsigned long row = cnt->plane[i].row();
+			const unsigned long column = cnt->plane[i].column();
+			unsigned long rmin = 0, cmin = 0;
+			uint64_t *d;
+
+			if( !full && s->data[i] && s->row[i] == row && s->column[i] == column ) { // ---> first modified row and column
+				const uint32_t ur = cnt->plane[i]._unit_row_();
+				const uint32_t uc = cnt->plane[i]._unit_column_();
+
+				rmin = row;
+				cmin = column;
+				_sync_counting_map_block_(cnt, i, false);
+				for( uint32_t br = 0; br < cnt->plane[i]._plane_row_(); br++ ){
+					for( uint32_t bc = 0; bc < cnt->plane[i]._plane_column_(); bc++ ){
+						if( cnt->block[i].pointer(br, bc)->stamp < s->generation ) continue;
+						if( br * ur < rmin ) rmin = br * ur;
+						if( bc * uc < cmin ) cmin = bc * uc;
+					}
+				}
+			} // <--- first modified row and column
+			else if( _alloc_sat_(s, i, row, column) < 0 ) {
+				return -1;
+			}
+			d = s->data[i];
+
+			for( unsigned long r = rmin; r < row; r++ ){
+				uint64_t *prev = d + r * (column + 1);
+				uint64_t *cur = prev + (column + 1);
+				// sum of row (left of cmin is not modified)
+				uint64_t rs = cmin == 0 ? 0 : cur[cmin] - prev[cmin];
+
+				if( cmin == 0 ) cur[0] = 0;
+				for( unsigned long c = cmin; c < column; c++ ){
+					rs += cnt->plane[i].cpointer(r, c)->cnt;
+					cur[c + 1] = prev[c + 1] + rs;
+				}
+			}
+		}
+		s->revision = cnt->revision;
+		// following modification of cnt will be applied in next call
+		s->generation = ++cnt->generation;
+	} // <--- operation
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief build summed-area table of the number of points in map
+ * @param[out]  s : summed-area table
+ * @param[in] map : map
+ * @note if the table is up to date, nothing is done, otherwise whole table is built
+ * (map has no record of modified memory units, see build_sat(sat_t*, cmap_t*)).
+ * map->sat is used in position_gain()
+ */
+inline
+int build_sat(sat_t *s, map_t *map) {
+	gnd_assert(!s || !map, -1, "invalid null pointer");
+
+	if( s->revision == map->revision ) return 0;
+
+	{ // ---> operation
+		for( size_t i = 0; i < PlaneNum; i++ ){
+			const unsigned long row = map->plane[i].row();
+			const unsigned long column = map->plane[i].column();
+			uint64_t *d;
+
+			if( _alloc_sat_(s, i, row, column) < 0 ) return -1;
+			d = s->data[i];
+
+			for( unsigned long r = 0; r < row; r++ ){
+				uint64_t *prev = d + r * (column + 1);
+				uint64_t *cur = prev + (column + 1);
+				uint64_t rs = 0;	// sum of row
+
+				cur[0] = 0;
+				for( unsigned long c = 0; c < column; c++ ){
+					rs += map->plane[i].cpointer(r, c)->N;
+					cur[c + 1] = prev[c + 1] + rs;
+				}
+			}
+		}
+		s->revision = map->revision;
+	} // <--- operation
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief release summed-area table
+ * @param[out] s : summed-area table
+ */
+inline
+int destroy_sat(sat_t *s) {
+	gnd_assert(!s, -1, "invalid null pointer");
+
+	for( size_t i = 0; i < PlaneNum; i++ ){
+		::free(s->data[i]);
+		s->data[i] = 0;
+		s->row[i] = 0;
+		s->column[i] = 0;
+	}
+	s->revision = 0;
+	s->generation = 0;
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief sum of the number of points in a window
+ * @param[in]  s : summed-area table
+ * @param[in]  i : plane index
+ * @param[in] lr : lower row (include)
+ * @param[in] lc : lower column (include)
+ * @param[in] ur : upper row (not include)
+ * @param[in] uc : upper column (not include)
+ * @note the window is clipped by the table size
+ */
+inline
+uint64_t window_sum(const sat_t *s, size_t i, long lr, long lc, long ur, long uc) {
+	const unsigned long w = s->column[i] + 1;
+	const uint64_t *d = s->data[i];
+
+	if( lr < 0 ) lr = 0;
+	if( lc < 0 ) lc = 0;
+	if( ur > (signed)s->row[i] ) ur = s->row[i];
+	if( uc > (signed)s->column[i] ) uc = s->column[i];
+	if( !d || lr >= ur || lc >= uc ) return 0;
+
+	return d[ur * w + uc] - d[lr * w + uc] - d[ur * w + lc] + d[lr * w + lc];
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief count laser points in the range of robot sensor
+ * @param[in] map : map data
+ * @param[in]   x : robot position x
+ * @param[in]   y : robot position x
+ * @param[in]  sr : sensor range
+ * @param[out] pg : position gain
+ * @return <0 : error
+ * @note if the summed-area table of map is up to date (see build_sat()), window sum is computed in O(1)
+ */
+inline
+int position_gain(map_t *map, double x, double y, double sr, pgain_t *pg) {
+	gnd_assert(!map, -1, "map is null");
+	gnd_assert(!pg, -1, "output storage is null");
+
+	{ // ---> operate
+		long r = 0, c = 0;
+		size_t f = ::floor( sr / map->plane[0].xrsl());
+
+		const pixel_t *tmp_cpp;
+		unsigned long lowerr;	// search range lower row
+		unsigned long upperr;	// search range upper row
+		unsigned long lowerc;	// search range lower column
+		unsigned long upperc;	// search range upper column
+
+		// ---> obtain the sum of laser points in the sensor range for each plane
+		for(unsigned int i = 0; i < PlaneNum; i++){
+			// clear
+			pg->N[i] = 0;
+
+			// get row and column index at robot position
+			map->plane[i].pindex(x, y, &r, &c);
+
+			// summed-area table is up to date
+			if( map->sat.revision == map->revision ) {
+				pg->N[i] = window_sum(&map->sat, i, r - (signed)f, c - (signed)f, r + (signed)f, c + (signed)f);
+				continue;
+			}
+
+			//
+			lowerr = r < (signed)f ? 0 : r - f;
+			upperr = r + f >= map->plane[i].row() ? map->plane[i].row() : r + f;
+			lowerc = c < (signed)f ? 0 : c - f;
+			upperc = c + f >= map->plane[i].column() ? map->plane[i].column() : c + f;
+
+			// compute average of local area number of observed point
+			for( unsigned long rr = lowerr; rr < upperr; rr++){
+				for( unsigned long cc = lowerc; cc < upperc; cc++){
+					tmp_cpp = map->plane[i].cpointer( rr, cc );
+					pg->N[i] += tmp_cpp->N;
+				}
+			}
+		}
+		// <--- obtain the sum of laser points in the sensor range for each plane
+
+	} // <--- operate
+	return 0;
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief compute likelihood
+ * @param[in] map : map data
+ * @param[in]   x : laser scanner reflection point x
+ * @param[in]   y : laser scanner reflection point y
+ * @param[out]  l : likelihood
+ */
+inline
+int likelihood(map_t *map, double x, double y, double *l){
+	return likelihood(map, x, y, 0, l);
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief compute likelihood
+ * @param[in] map : map data
+ * @param[in]   x : laser scanner reflection point x
+ * @param[in]   y : laser scanner reflection point y
+ * @param[in]  pg : position gain
+ * @param[out]  l : likelihood
+ */
+inline
+int likelihood(map_t *map, double x, double y, pgain_t *pg, double *l){
+	gnd_assert(!l, -1, "invalid null pointer");
+	gnd_assert(!map, -1, "map is null");
+
+	{ // ---> operate
+		matrix::fixed<PosDim,1> pos;
+		matrix::fixed<PosDim,1> q;
+		matrix::fixed<1,PosDim> ws1x2;	// workspace 2x2 matrix
+		matrix::fixed<1,1> ws1x1;		// workspace 1x1 matrix
+
+		{ // ---> initialize
+			set(&pos, PosX, 0, x);
+			set(&pos, PosY, 0, y);
+			*l = 0;
+		} // <--- initialize
+
+
+		// ---> for
+		for( size_t i = 0; i < PlaneNum; i++){
+			const pixel_t *pp;
+			int ret;
+			long pr, pc;
+
+			// get index of pixel
+			ret = map->plane[i].pindex( value(&pos, PosX, 0), value(&pos, PosY, 0), &pr, &pc );
+			// no data
+			if( ret < 0 )			continue;
+
+			// get pixel data
+			pp = map->plane[i].cpointer( pr, pc );
+			// zero weight
+			if(pp->K <= 0.0)	continue;
+
+			// get pixel core pos on ndt data pixel
+			map->plane[i].pget_pos_core(pr, pc, pointer(&q, PosX, 0), pointer(&q, PosY, 0));
+			sub(&pos, &q, &q);
+
+			// difference from mean
+			sub(&q, &pp->mean, &q);
+			// compute likelihood
+			prod_transpose1(&q, &pp->inv_cov, &ws1x2);
+			prod(&ws1x2, &q, &ws1x1);
+			if( pg ){
+				*l += ::exp( - value(&ws1x1, 0, 0) / 2.0) * (pp->K) / (pg->N[i] + 1);
+			}
+			else {
+				*l += ::exp( - value(&ws1x1, 0, 0) / 2.0) * (pp->K);
+			}
+		} // ---> for
+
+		// normalization
+		*l /= PlaneNum;
+		return 0;
+	} // <--- operate
+}
+
+
+/**
+ * @privatesection
+ * @brief exponential function approximation for likelihood computation
+ * @param[in] v : exponent
+ * @return exp(v)
+ * @note argument is clamped into [-708, 709].
+ * range reduction v = k ln2 + r (|r| <= ln2/2) and taylor polynomial of degree 11,
+ * relative error is less than 1e-14.
+ * the simd version (_fast_exp_sse2_, _fast_exp_avx2_) use the same procedure.
+ */
+inline
+double _fast_exp_(double v) {
+	double k, r, p;
+	union { double d; uint64_t i; } e;
+
+	// clamp
+	v = v < -708.0 ? -708.0 : v;
+	v = v > 709.0 ? 709.0 : v;
+	// range reduction
+	k = ::floor(v * M_LOG2E + 0.5);
+	r = v - k * 6.93145751953125e-1;
+	r = r - k * 1.42860682030941723212e-6;
+	// taylor polynomial
+	p = 2.50521083854417187751e-8;
+	p = p * r + 2.75573192239858906526e-7;
+	p = p * r + 2.75573192239858906526e-6;
+	p = p * r + 2.48015873015873015873e-5;
+	p = p * r + 1.98412698412698412698e-4;
+	p = p * r + 1.38888888888888888889e-3;
+	p = p * r + 8.33333333333333333333e-3;
+	p = p * r + 4.16666666666666666667e-2;
+	p = p * r + 1.66666666666666666667e-1;
+	p = p * r + 0.5;
+	p = p * r + 1.0;
+	p = p * r + 1.0;
+	// 2^k
+	e.i = ((uint64_t)((int64_t)k + 1023)) << 52;
+	return p * e.d;
+}
+
+#if defined(__AVX2__)
+/**
+ * @privatesection
+ * @brief exponential function approximation (avx2)
+ * @param[in] v : exponent
+ * @see _fast_exp_
+ */
+inline
+__m256d _fast_exp_avx2_(__m256d v) {
+	__m256d k, r, p;
+	__m256i e;
+
+	v = _mm256_max_pd(v, _mm256_set1_pd(-708.0));
+	v = _mm256_min_pd(v, _mm256_set1_pd(709.0));
+	k = _mm256_round_pd( _mm256_mul_pd(v, _mm256_set1_pd(M_LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	r = _mm256_sub_pd(v, _mm256_mul_pd(k, _mm256_set1_pd(6.93145751953125e-1)));
+	r = _mm256_sub_pd(r, _mm256_mul_pd(k, _mm256_set1_pd(1.42860682030941723212e-6)));
+
+	p = _mm256_set1_pd(2.50521083854417187751e-8);
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(2.75573192239858906526e-7));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(2.75573192239858906526e-6));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(2.48015873015873015873e-5));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.98412698412698412698e-4));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.38888888888888888889e-3));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(8.33333333333333333333e-3));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(4.16666666666666666667e-2));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.66666666666666666667e-1));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(0.5));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.0));
+	p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(1.0));
+
+	e = _mm256_cvtepi32_epi64( _mm256_cvtpd_epi32(k) );
+	e = _mm256_slli_epi64( _mm256_add_epi64(e, _mm256_set1_epi64x(1023)), 52);
+	return _mm256_mul_pd(p, _mm256_castsi256_pd(e));
+}
+#elif defined(__SSE2__)
+/**
+ * @privatesection
+ * @brief exponential function approximation (sse2)
+ * @param[in] v : exponent
+ * @see _fast_exp_
+ */
+inline
+__m128d _fast_exp_sse2_(__m128d v) {
+	__m128d k, r, p;
+	__m128i e;
+
+	v = _mm_max_pd(v, _mm_set1_pd(-708.0));
+	v = _mm_min_pd(v, _mm_set1_pd(709.0));
+	// round to nearest (default rounding mode)
+	e = _mm_cvtpd_epi32( _mm_mul_pd(v, _mm_set1_pd(M_LOG2E)) );
+	k = _mm_cvtepi32_pd(e);
+	r = _mm_sub_pd(v, _mm_mul_pd(k, _mm_set1_pd(6.93145751953125e-1)));
+	r = _mm_sub_pd(r, _mm_mul_pd(k, _mm_set1_pd(1.42860682030941723212e-6)));
+
+	p = _mm_set1_pd(2.50521083854417187751e-8);
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(2.75573192239858906526e-7));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(2.75573192239858906526e-6));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(2.48015873015873015873e-5));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.98412698412698412698e-4));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.38888888888888888889e-3));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(8.33333333333333333333e-3));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(4.16666666666666666667e-2));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.66666666666666666667e-1));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(0.5));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0));
+	p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0));
+
+	// 2^k : move int32 k into upper 32bit of each 64bit lane
+	e = _mm_add_epi32(e, _mm_set1_epi32(1023));
+	e = _mm_slli_epi32(e, 20);
+	e = _mm_shuffle_epi32(e, _MM_SHUFFLE(1, 3, 0, 3));
+	e = _mm_and_si128(e, _mm_set_epi32(-1, 0, -1, 0));
+	return _mm_mul_pd(p, _mm_castsi128_pd(e));
+}
+#endif
+
+
+/**
+ * @privatesection
+ * @brief weighted gaussian kernel
+ * @param[in]  qx : difference from mean x
+ * @param[in]  qy : difference from mean y
+ * @param[in] s00 : inverse covariance (0,0)
+ * @param[in] s01 : inverse covariance (0,1) + (1,0)
+ * @param[in] s11 : inverse covariance (1,1)
+ * @param[in]   w : weight
+ * @param[in]   n : number of data
+ * @param[out]  o : w * exp( - q^T * Sigma^-1 * q / 2 )
+ */
+inline
+void _gauss_kernel_(const double *qx, const double *qy,
+		const double *s00, const double *s01, const double *s11, const double *w,
+		size_t n, double *o) {
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	for( ; i + 4 <= n; i += 4 ){
+		__m256d x = _mm256_loadu_pd(qx + i);
+		__m256d y = _mm256_loadu_pd(qy + i);
+		__m256d chi;
+
+		chi = _mm256_mul_pd( _mm256_loadu_pd(s00 + i), _mm256_mul_pd(x, x) );
+		chi = _mm256_add_pd( chi, _mm256_mul_pd( _mm256_loadu_pd(s01 + i), _mm256_mul_pd(x, y) ) );
+		chi = _mm256_add_pd( chi, _mm256_mul_pd( _mm256_loadu_pd(s11 + i), _mm256_mul_pd(y, y) ) );
+		chi = _mm256_mul_pd( chi, _mm256_set1_pd(-0.5) );
+		_mm256_storeu_pd(o + i, _mm256_mul_pd( _fast_exp_avx2_(chi), _mm256_loadu_pd(w + i) ) );
+	}
+#elif defined(__SSE2__)
+	for( ; i + 2 <= n; i += 2 ){
+		__m128d x = _mm_loadu_pd(qx + i);
+		__m128d y = _mm_loadu_pd(qy + i);
+		__m128d chi;
+
+		chi = _mm_mul_pd( _mm_loadu_pd(s00 + i), _mm_mul_pd(x, x) );
+		chi = _mm_add_pd( chi, _mm_mul_pd( _mm_loadu_pd(s01 + i), _mm_mul_pd(x, y) ) );
+		chi = _mm_add_pd( chi, _mm_mul_pd( _mm_loadu_pd(s11 + i), _mm_mul_pd(y, y) ) );
+		chi = _mm_mul_pd( chi, _mm_set1_pd(-0.5) );
+		_mm_storeu_pd(o + i, _mm_mul_pd( _fast_exp_sse2_(chi), _mm_loadu_pd(w + i) ) );
+	}
+#endif
+	// scalar (remainder)
+	for( ; i < n; i++ ){
+		double chi = s00[i] * (qx[i] * qx[i]) + s01[i] * (qx[i] * qy[i]) + s11[i] * (qy[i] * qy[i]);
+		o[i] = _fast_exp_( chi * -0.5 ) * w[i];
+	}
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief compute likelihood of a set of points (batch)
+ * @param[in] map : map data
+ * @param[in]   x : laser scanner reflection points x
+ * @param[in]   y : laser scanner reflection points y
+ * @param[in]   n : number of points
+ * @param[in]  pg : position gain (null: not use)
+ * @param[out] sum : sum of likelihood
+ * @param[out]  l : likelihood of each point (null: not output)
+ * @details points are processed in blocks of LikelihoodBatchSize.
+ * map look up is scalar, quadratic form and exponential are vectorized when sse2 or avx2 is available.
+ */
+inline
+int likelihood(map_t *map, const double *x, const double *y, size_t n, pgain_t *pg, double *sum, double *l){
+	gnd_assert(!map, -1, "map is null");
+	gnd_assert(!sum, -1, "invalid null pointer");
+	gnd_assert(n > 0 && (!x || !y), -1, "invalid null pointer");
+
+	{ // ---> operate
+		double qx[LikelihoodBatchSize], qy[LikelihoodBatchSize];
+		double s00[LikelihoodBatchSize], s01[LikelihoodBatchSize], s11[LikelihoodBatchSize];
+		double w[LikelihoodBatchSize], o[LikelihoodBatchSize];
+		double lkh[LikelihoodBatchSize];
+		size_t idx[LikelihoodBatchSize];
+
+		*sum = 0;
+
+		// ---> block loop
+		for( size_t b = 0; b < n; b += LikelihoodBatchSize ){
+			const size_t nb = (n - b < LikelihoodBatchSize) ? n - b : LikelihoodBatchSize;
+
+			::memset(lkh, 0, sizeof(lkh[0]) * nb);
+
+			// ---> plane loop
+			for( size_t i = 0; i < PlaneNum; i++){
+				size_t nv = 0;
+
+				{ // ---> gather
+					for( size_t j = 0; j < nb; j++ ){
+						const pixel_t *pp;
+						long pr, pc;
+						double cx, cy;
+
+						// no data
+						if( map->plane[i].pindex( x[b + j], y[b + j], &pr, &pc ) < 0 )	continue;
+						pp = map->plane[i].cpointer( pr, pc );
+						// zero weight
+						if( pp->K <= 0.0 )	continue;
+
+						// difference from mean on a focus pixel
+						map->plane[i].pget_pos_core(pr, pc, &cx, &cy);
+						qx[nv] = x[b + j] - cx - pp->mean[PosX][0];
+						qy[nv] = y[b + j] - cy - pp->mean[PosY][0];
+						s00[nv] = pp->inv_cov[0][0];
+						s01[nv] = pp->inv_cov[0][1] + pp->inv_cov[1][0];
+						s11[nv] = pp->inv_cov[1][1];
+						w[nv] = pg ? pp->K / (pg->N[i] + 1) : pp->K;
+						idx[nv] = j;
+						nv++;
+					}
+				} // <--- gather
+
+				_gauss_kernel_(qx, qy, s00, s01, s11, w, nv, o);
+
+				// scatter
+				for( size_t j = 0; j < nv; j++ ){
+					lkh[idx[j]] += o[j];
+				}
+			} // <--- plane loop
+
+			// normalization
+			for( size_t j = 0; j < nb; j++ ){
+				lkh[j] /= PlaneNum;
+				*sum += lkh[j];
+				if( l ) l[b + j] = lkh[j];
+			}
+		} // <--- block loop
+	} // <--- operate
+	return 0;
+}
+
+
+/**
+ * @brief number of terms of newton's method for each point and plane
+ * @see _newton_terms_
+ */
+static const size_t NewtonTermNum = 9;
+
+/**
+ * @privatesection
+ * @brief gradient and hessian terms of newton's method (batch)
+ * @param[in]  qx : difference from mean x
+ * @param[in]  qy : difference from mean y
+ * @param[in] s00 : inverse covariance (0,0)
+ * @param[in] s01 : inverse covariance (0,1) + (1,0)
+ * @param[in] s11 : inverse covariance (1,1)
+ * @param[in]  j0 : jacobi of x with respect to orient ( -x sin - y cos )
+ * @param[in]  j1 : jacobi of y with respect to orient (  x cos - y sin )
+ * @param[in] lkh : likelihood
+ * @param[in]   n : number of data
+ * @param[out]  o : terms (NewtonTermNum x LikelihoodBatchSize),
+ * gradient (0, 1, 2) and upper triangle of hessian (00, 01, 02, 11, 12, 22)
+ * @details closed form of _newton_method_variables_().
+ * with a = Sigma^-1 q, v = J^T a and the second derivative of q (-j1, j0),
+ * gradient is lkh v and hessian is lkh (J^T Sigma^-1 J + a^T q'' - v v^T).
+ */
+inline
+void _newton_terms_(const double *qx, const double *qy,
+		const double *s00, const double *s01, const double *s11,
+		const double *j0, const double *j1, const double *lkh, size_t n, double *o) {
+	double *g0 = o, *g1 = o + LikelihoodBatchSize, *g2 = o + 2 * LikelihoodBatchSize;
+	double *h00 = o + 3 * LikelihoodBatchSize, *h01 = o + 4 * LikelihoodBatchSize, *h02 = o + 5 * LikelihoodBatchSize;
+	double *h11 = o + 6 * LikelihoodBatchSize, *h12 = o + 7 * LikelihoodBatchSize, *h22 = o + 8 * LikelihoodBatchSize;
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	for( ; i + 4 <= n; i += 4 ){
+		const __m256d x = _mm256_loadu_pd(qx + i), y = _mm256_loadu_pd(qy + i);
+		const __m256d a00 = _mm256_loadu_pd(s00 + i), a11 = _mm256_loadu_pd(s11 + i);
+		const __m256d a01 = _mm256_mul_pd( _mm256_loadu_pd(s01 + i), _mm256_set1_pd(0.5) );
+		const __m256d d0 = _mm256_loadu_pd(j0 + i), d1 = _mm256_loadu_pd(j1 + i);
+		const __m256d w = _mm256_loadu_pd(lkh + i);
+		__m256d a0, a1, v2, t0, t1, hh;
+
+		// a = Sigma^-1 q
+		a0 = _mm256_add_pd( _mm256_mul_pd(a00, x), _mm256_mul_pd(a01, y) );
+		a1 = _mm256_add_pd( _mm256_mul_pd(a01, x), _mm256_mul_pd(a11, y) );
+		v2 = _mm256_add_pd( _mm256_mul_pd(a0, d0), _mm256_mul_pd(a1, d1) );
+		// Sigma^-1 J (orient)
+		t0 = _mm256_add_pd( _mm256_mul_pd(a00, d0), _mm256_mul_pd(a01, d1) );
+		t1 = _mm256_add_pd( _mm256_mul_pd(a01, d0), _mm256_mul_pd(a11, d1) );
+
+		_mm256_storeu_pd( g0 + i, _mm256_mul_pd(w, a0) );
+		_mm256_storeu_pd( g1 + i, _mm256_mul_pd(w, a1) );
+		_mm256_storeu_pd( g2 + i, _mm256_mul_pd(w, v2) );
+		_mm256_storeu_pd( h00 + i, _mm256_mul_pd(w, _mm256_sub_pd(a00, _mm256_mul_pd(a0, a0))) );
+		_mm256_storeu_pd( h01 + i, _mm256_mul_pd(w, _mm256_sub_pd(a01, _mm256_mul_pd(a0, a1))) );
+		_mm256_storeu_pd( h02 + i, _mm256_mul_pd(w, _mm256_sub_pd(t0, _mm256_mul_pd(a0, v2))) );
+		_mm256_storeu_pd( h11 + i, _mm256_mul_pd(w, _mm256_sub_pd(a11, _mm256_mul_pd(a1, a1))) );
+		_mm256_storeu_pd( h12 + i, _mm256_mul_pd(w, _mm256_sub_pd(t1, _mm256_mul_pd(a1, v2))) );
+		hh = _mm256_add_pd( _mm256_mul_pd(t0, d0), _mm256_mul_pd(t1, d1) );
+		hh = _mm256_add_pd( hh, _mm256_sub_pd( _mm256_mul_pd(a1, d0), _mm256_mul_pd(a0, d1) ) );
+		_mm256_storeu_pd( h22 + i, _mm256_mul_pd(w, _mm256_sub_pd(hh, _mm256_mul_pd(v2, v2))) );
+	}
+#elif defined(__SSE2__)
+	for( ; i + 2 <= n; i += 2 ){
+		const __m128d x = _mm_loadu_pd(qx + i), y = _mm_loadu_pd(qy + i);
+		const __m128d a00 = _mm_loadu_pd(s00 + i), a11 = _mm_loadu_pd(s11 + i);
+		const __m128d a01 = _mm_mul_pd( _mm_loadu_pd(s01 + i), _mm_set1_pd(0.5) );
+		const __m128d d0 = _mm_loadu_pd(j0 + i), d1 = _mm_loadu_pd(j1 + i);
+		const __m128d w = _mm_loadu_pd(lkh + i);
+		__m128d a0, a1, v2, t0, t1, hh;
+
+		// a = Sigma^-1 q
+		a0 = _mm_add_pd( _mm_mul_pd(a00, x), _mm_mul_pd(a01, y) );
+		a1 = _mm_add_pd( _mm_mul_pd(a01, x), _mm_mul_pd(a11, y) );
+		v2 = _mm_add_pd( _mm_mul_pd(a0, d0), _mm_mul_pd(a1, d1) );
+		// Sigma^-1 J (orient)
+		t0 = _mm_add_pd( _mm_mul_pd(a00, d0), _mm_mul_pd(a01, d1) );
+		t1 = _mm_add_pd( _mm_mul_pd(a01, d0), _mm_mul_pd(a11, d1) );
+
+		_mm_storeu_pd( g0 + i, _mm_mul_pd(w, a0) );
+		_mm_storeu_pd( g1 + i, _mm_mul_pd(w, a1) );
+		_mm_storeu_pd( g2 + i, _mm_mul_pd(w, v2) );
+		_mm_storeu_pd( h00 + i, _mm_mul_pd(w, _mm_sub_pd(a00, _mm_mul_pd(a0, a0))) );
+		_mm_storeu_pd( h01 + i, _mm_mul_pd(w, _mm_sub_pd(a01, _mm_mul_pd(a0, a1))) );
+		_mm_storeu_pd( h02 + i, _mm_mul_pd(w, _mm_sub_pd(t0, _mm_mul_pd(a0, v2))) );
+		_mm_storeu_pd( h11 + i, _mm_mul_pd(w, _mm_sub_pd(a11, _mm_mul_pd(a1, a1))) );
+		_mm_storeu_pd( h12 + i, _mm_mul_pd(w, _mm_sub_pd(t1, _mm_mul_pd(a1, v2))) );
+		hh = _mm_add_pd( _mm_mul_pd(t0, d0), _mm_mul_pd(t1, d1) );
+		hh = _mm_add_pd( hh, _mm_sub_pd( _mm_mul_pd(a1, d0), _mm_mul_pd(a0, d1) ) );
+		_mm_storeu_pd( h22 + i, _mm_mul_pd(w, _mm_sub_pd(hh, _mm_mul_pd(v2, v2))) );
+	}
+#endif
+	// scalar (remainder)
+	for( ; i < n; i++ ){
+		const double a01 = s01[i] * 0.5;
+		const double a0 = s00[i] * qx[i] + a01 * qy[i];
+		const double a1 = a01 * qx[i] + s11[i] * qy[i];
+		const double v2 = a0 * j0[i] + a1 * j1[i];
+		const double t0 = s00[i] * j0[i] + a01 * j1[i];
+		const double t1 = a01 * j0[i] + s11[i] * j1[i];
+
+		g0[i] = lkh[i] * a0;
+		g1[i] = lkh[i] * a1;
+		g2[i] = lkh[i] * v2;
+		h00[i] = lkh[i] * (s00[i] - a0 * a0);
+		h01[i] = lkh[i] * (a01 - a0 * a1);
+		h02[i] = lkh[i] * (t0 - a0 * v2);
+		h11[i] = lkh[i] * (s11[i] - a1 * a1);
+		h12[i] = lkh[i] * (t1 - a1 * v2);
+		h22[i] = lkh[i] * ((t0 * j0[i] + t1 * j1[i]) + (a1 * j0[i] - a0 * j1[i]) - v2 * v2);
+	}
+}
+
+/**
+ * @privatesection
+ * @brief accumulate terms of newton's method
+ * @param[in]    o : terms (see _newton_terms_)
+ * @param[in]  lkh : likelihood
+ * @param[in]    n : number of data
+ * @param[in,out] l : sum of likelihood
+ * @param[in,out] g : sum of gradient
+ * @param[in,out] h : sum of hessian
+ * @note each hessian term is modified to be positive definite before summation, as _newton_method_variables_()
+ */
+inline
+void _newton_accumulate_(const double *o, const double *lkh, size_t n, double *l, matrix::fixed<3,1> *g, matrix::fixed<3,3> *h) {
+	for( size_t i = 0; i < n; i++ ){
+		matrix::fixed<3,3> hh;
+
+		*l += lkh[i];
+		(*g)[0][0] += o[i];
+		(*g)[1][0] += o[LikelihoodBatchSize + i];
+		(*g)[2][0] += o[2 * LikelihoodBatchSize + i];
+
+		hh[0][0] = o[3 * LikelihoodBatchSize + i];
+		hh[0][1] = hh[1][0] = o[4 * LikelihoodBatchSize + i];
+		hh[0][2] = hh[2][0] = o[5 * LikelihoodBatchSize + i];
+		hh[1][1] = o[6 * LikelihoodBatchSize + i];
+		hh[1][2] = hh[2][1] = o[7 * LikelihoodBatchSize + i];
+		hh[2][2] = o[8 * LikelihoodBatchSize + i];
+		optimize::_model_hessian_(&hh);
+
+		for( size_t r = 0; r < 3; r++ )
+			for( size_t c = 0; c < 3; c++ )	(*h)[r][c] += hh[r][c];
+	}
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief compute likelihood, gradient and hessian of a set of points for newton's method (batch)
+ * @param[in]  m : likelihood map
+ * @param[in]  x : laser scanner reflection points x (sensor coordinate)
+ * @param[in]  y : laser scanner reflection points y (sensor coordinate)
+ * @param[in]  n : number of points
+ * @param[in]  c : coordinate convert matrix
+ * @param[out] l : sum of likelihood
+ * @param[out] g : sum of gradient
+ * @param[out] h : sum of hessian
+ * @return    0 :
+ * @details same as summation of optimize_newton::_newton_method_variables_() over the points.
+ * points are processed in blocks of LikelihoodBatchSize,
+ * map look up is scalar, and the others are vectorized with closed form of rigid body jacobi.
+ */
+inline
+int newton_variables(map_t *m, const double *x, const double *y, size_t n, matrix::fixed<4,4> *c, double *l, matrix::fixed<3,1> *g, matrix::fixed<3,3> *h) {
+	gnd_assert(!m || !c || !l || !g || !h, -1, "invalid null pointer");
+	gnd_assert(n > 0 && (!x || !y), -1, "invalid null pointer");
+
+	*l = 0;
+	matrix::set_zero(g);
+	matrix::set_zero(h);
+
+	{ // ---> operate
+		const double r00 = (*c)[0][0], r01 = (*c)[0][1], tx = (*c)[0][3];
+		const double r10 = (*c)[1][0], r11 = (*c)[1][1], ty = (*c)[1][3];
+		double X[LikelihoodBatchSize], Y[LikelihoodBatchSize];
+		double J0[LikelihoodBatchSize], J1[LikelihoodBatchSize];
+		double qx[LikelihoodBatchSize], qy[LikelihoodBatchSize];
+		double s00[LikelihoodBatchSize], s01[LikelihoodBatchSize], s11[LikelihoodBatchSize];
+		double j0[LikelihoodBatchSize], j1[LikelihoodBatchSize];
+		double w[LikelihoodBatchSize], lkh[LikelihoodBatchSize];
+		double o[NewtonTermNum * LikelihoodBatchSize];
+
+		// ---> block loop
+		for( size_t b = 0; b < n; b += LikelihoodBatchSize ){
+			const size_t nb = (n - b < LikelihoodBatchSize) ? n - b : LikelihoodBatchSize;
+
+			// reflection points on global coordinate and jacobi (orient)
+			for( size_t j = 0; j < nb; j++ ){
+				X[j] = r00 * x[b + j] + r01 * y[b + j] + tx;
+				Y[j] = r10 * x[b + j] + r11 * y[b + j] + ty;
+				J0[j] = - x[b + j] * r10 - y[b + j] * r00;
+				J1[j] =   x[b + j] * r00 - y[b + j] * r10;
+			}
+
+			// ---> plane loop
+			for( size_t i = 0; i < PlaneNum; i++){
+				size_t nv = 0;
+
+				{ // ---> gather
+					for( size_t j = 0; j < nb; j++ ){
+						const pixel_t *pp;
+						long pr, pc;
+						double cx, cy;
+
+						// no data
+						if( m->plane[i].pindex( X[j], Y[j], &pr, &pc ) < 0 )	continue;
+						pp = m->plane[i].cpointer( pr, pc );
+						// zero weight
+						if( pp->K <= 0.0 )	continue;
+
+						// difference from mean on a focus pixel
+						m->plane[i].pget_pos_core(pr, pc, &cx, &cy);
+						qx[nv] = X[j] - cx - pp->mean[PosX][0];
+						qy[nv] = Y[j] - cy - pp->mean[PosY][0];
+						s00[nv] = pp->inv_cov[0][0];
+						s01[nv] = pp->inv_cov[0][1] + pp->inv_cov[1][0];
+						s11[nv] = pp->inv_cov[1][1];
+						w[nv] = pp->K;
+						j0[nv] = J0[j];
+						j1[nv] = J1[j];
+						nv++;
+					}
+				} // <--- gather
+
+				_gauss_kernel_(qx, qy, s00, s01, s11, w, nv, lkh);
+				_newton_terms_(qx, qy, s00, s01, s11, j0, j1, lkh, nv, o);
+				_newton_accumulate_(o, lkh, nv, l, g, h);
+			} // <--- plane loop
+		} // <--- block loop
+	} // <--- operate
+	return 0;
+}
+
+
+/**
+ * @brief optimization iterate
+ * @param[in]  x : laser scanner reflection point x
+ * @param[in]  y : laser scanner reflection point y
+ * @param[in]  c : coordinate convert matrix
+ * @param[in]  m : likelihood map
+ * @param[out] g : gradient   ( derivation of f(x,y) because of minimization problem)
+ * @param[out] l : likelihood ( f(x,y) )
+ * @return    0 :
+ * @details this function compute following value for newton's method:
+ * likelihood, gradient, hessian
+ */
+inline
+int gradient( map_t *m, double x, double y, matrix::fixed<4,4> *c, matrix::fixed<3,1> *g, double *l ) {
+	matrix::fixed<4,1> X;				// reflection point on global coordinate
+	matrix::fixed<PosDim,3> J;			// jacobi
+	matrix::fixed<PosDim,1> q_quad_33;
+
+	{ // ---> initialize
+		matrix::set_zero(g);
+		if(l) *l = 0;
+	} // <--- initialize
+
+
+	{ // ---> compute reflection points on global coordinate
+		matrix::fixed<4,1> xx;				// reflection point on global coordinate
+		xx[0][0] = x;
+		xx[1][0] = y;
+		xx[2][0] = 0;
+		xx[3][0] = 1;
+		matrix::prod(c, &xx, &X);
+	} // <--- compute reflection points on global coordinate
+
+	{ // ---> jacobi matrix
+		set_zero(&J);
+		J[PosX][0] = 1;
+		J[PosX][2] = - x * (*c)[1][0] - y * (*c)[0][0];
+		J[PosY][1] = 1;
+		J[PosY][2] =   x * (*c)[0][0] - y * (*c)[1][0];
+	} // <--- jacobi matrix
+
+	{ // ---> q quad_33
+		q_quad_33[PosX][0] = - x * (*c)[0][0] + y * (*c)[1][0];
+		q_quad_33[PosY][0] = - x * (*c)[1][0] - y * (*c)[0][0];
+	} // <--- q quad_33;
+
+	// ---> scanning loop of map plane
+	for( size_t mi = 0; mi < PlaneNum; mi++){
+		const pixel_t *px;
+		matrix::fixed<PosDim,1> q;
+		matrix::fixed<1,PosDim> qT_invS;		// q^t * Sigma^-1
+		matrix::fixed<1,3> qT_invS_J;			// q^t * Sigma^-1 * J
+		double chi_sq_2;						// q^T * Sigma^-1 * q / 2 / 2value
+		double lkh = 0;
+		matrix::fixed<1,3> gg;					// gradient
+		matrix::fixed<1,1> ws1x1;				// work space
+
+		{ // ---> get pixel data and compute q(difference from mean)
+			matrix::fixed<2,1> ws2x1;
+			long pr, pc;
+			// get index of pixel
+			if( m->plane[mi].pindex( X[PosX][0], X[PosY][0], &pr, &pc ) < 0)
+				continue; // no data
+			px = m->plane[mi].cpointer( pr, pc );
+			// zero weight
+			if(px->K <= 0.0)	continue;
+			// get pixel core position
+			m->plane[mi].pget_pos_core(pr, pc, pointer(&ws2x1, PosX, 0), pointer(&ws2x1, PosY, 0));
+			// compute sensor reading position on a focus pixel
+			sub(&X, &ws2x1, &ws2x1);
+			// compute difference from mean
+			sub(&ws2x1, &px->mean, &q);
+		} // <--- get pixel data and compute q(difference from mean)
+
+
+		{ // ---> likelihood
+			// q^T * Sigma^-1
+			prod_transpose1(&q, &px->inv_cov, &qT_invS);
+			// chi-square / 2.0
+			prod(&qT_invS, &q, &ws1x1);
+			chi_sq_2 = ws1x1[0][0] / 2.0;
+			// likelihood exp( -q^T * Sigma^-1 * q / 2 )
+			lkh = ::exp( -chi_sq_2 ) * px->K;
+			if( l ) (*l) += lkh;
+		} // <--- likelihood
+
+		{ // ---> gradient
+			// q^T * Sigma^-1 * q' * exp( - q^T * Sigma^-1 * q / 2)
+			prod(&qT_invS, &J, &qT_invS_J);
+			// gradient
+			matrix::scalar_prod(&qT_invS_J, lkh, &gg);
+			matrix::sub_transpose2(g, &gg, g);
+		} // <--- gradient
+	}
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief build compiled map
+ * @param[out] cm : compiled map
+ * @param[in] map : map data
+ * @return    0 :
+ * @return   <0 : fail
+ */
+template < typename T >
+inline
+int build_compiled_map(compiled_map<T> *cm, map_t *map) {
+	gnd_assert(!cm || !map, -1, "invalid null pointer");
+
+	LogDebugf("Begin - build_compiled_map(%p, %p)\n", cm, map);
+	LogIndent();
+
+	{ // ---> operate
+		double xl = 0, yl = 0;
+		double rsl = 0;
+		long row, column;
+		size_t stride;
+
+		if( _compiled_map_bound_(map, &xl, &yl, &row, &column, &rsl) < 0 ) {
+			LogUnindent();
+			LogDebugf("Fail  - build_compiled_map(%p, %p)\n", cm, map);
+			return -1;
+		}
+
+		{ // ---> allocate
+			stride = ( (CmplElementNum * sizeof(T) + CmplAlignment - 1) / CmplAlignment * CmplAlignment ) / sizeof(T);
+
+			if( !cm->data || cm->file || cm->row * cm->column * cm->stride != row * column * stride ){
+				void *p;
+				destroy_compiled_map(cm);
+				if( ::posix_memalign(&p, CmplAlignment, row * column * stride * sizeof(T)) != 0 ) {
+					LogUnindent();
+					LogDebugf("Fail  - build_compiled_map(%p, %p)\n", cm, map);
+					return -1;
+				}
+				cm->data = (T*) p;
+			}
+			cm->row = row;
+			cm->column = column;
+			cm->stride = stride;
+			cm->xorg = xl;
+			cm->yorg = yl;
+			cm->rsl = rsl;
+			cm->irsl = 1.0 / rsl;
+			cm->generation = 0;
+			::memset(cm->data, 0, row * column * stride * sizeof(T));
+		} // <--- allocate
+
+		// ---> cell scanning loop
+		for( long r = 0; r < row; r++ ){
+			for( long c = 0; c < column; c++ ){
+				T *cell = cm->data + (r * column + c) * stride;
+				const double x = xl + (c + 0.5) * rsl;
+				const double y = yl + (r + 0.5) * rsl;
+
+				for( size_t i = 0; i < PlaneNum; i++ ){
+					long pr, pc;
+
+					// no data
+					if( map->plane[i].pindex(x, y, &pr, &pc) < 0 )	continue;
+					_cmpl_cell_set_(cell, i, map, pr, pc, xl, yl);
+				}
+			}
+		} // <--- cell scanning loop
+	} // <--- operate
+
+	LogUnindent();
+	LogDebugf("End   - build_compiled_map(%p, %p)\n", cm, map);
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief compiled map building function (only modified memory units)
+ * @param[in,out] cm : compiled map
+ * @param[in]    map : map data (rebuilt from cnt)
+ * @param[in]    cnt : counting map
+ * @details the cells on memory units of cnt which are modified since the last call are rewritten from map.
+ * if the compiled map is not built by this function, or the bounds of map or memory units layout of cnt are changed,
+ * whole compiled map is built by build_compiled_map().
+ * @note call this after the map is rebuilt (see rebuild_map())
+ */
+template < typename T >
+inline
+int rebuild_compiled_map(compiled_map<T> *cm, map_t *map, cmap_t *cnt) {
+	gnd_assert(!cm || !map || !cnt, -1, "invalid null pointer");
+
+	LogDebugf("Begin - rebuild_compiled_map(%p, %p, %p)\n", cm, map, cnt);
+	LogIndent();
+
+	{ // ---> operation
+		double xl = 0, yl = 0;
+		double rsl = 0;
+		long row = 0, column = 0;
+
+		if( !cm->data || cm->file || cm->generation <= cnt->layout || cm->generation > cnt->generation ||
+				_compiled_map_bound_(map, &xl, &yl, &row, &column, &rsl) < 0 ||
+				xl != cm->xorg || yl != cm->yorg || row != cm->row || column != cm->column || rsl != cm->rsl ) {
+			if( build_compiled_map(cm, map) < 0 ) {
+				LogUnindent();
+				LogDebugf("Fail  - rebuild_compiled_map(%p, %p, %p)\n", cm, map, cnt);
+				return -1;
+			}
+		}
+		else {
+			for( size_t i = 0; i < PlaneNum; i++ ){
+				const uint32_t ur = map->plane[i]._unit_row_();
+				const uint32_t uc = map->plane[i]._unit_column_();
+
+				if( !map->plane[i].is_allocate() ) continue;
+				_sync_counting_map_block_(cnt, i, false);
+				// ---> for each modified memory unit
+				for( uint32_t br = 0; br < map->plane[i]._plane_row_(); br++ ){
+					for( uint32_t bc = 0; bc < map->plane[i]._plane_column_(); bc++ ){
+						if( cnt->block[i].pointer(br, bc)->stamp < cm->generation ) continue;
+
+						for( unsigned long pr = br * ur; pr < (br + 1) * ur && pr < map->plane[i].row(); pr++ ){
+							for( unsigned long pc = bc * uc; pc < (bc + 1) * uc && pc < map->plane[i].column(); pc++ ){
+								double cx, cy;
+
+								map->plane[i].pget_pos_core(pr, pc, &cx, &cy);
+								// a pixel covers 2 x 2 cells
+								for( int a = 0; a < 2; a++ ){
+									for( int b = 0; b < 2; b++ ){
+										const long r = (long) ::floor( (cy + (b - 0.5) * rsl - yl) / rsl );
+										const long c = (long) ::floor( (cx + (a - 0.5) * rsl - xl) / rsl );
+
+										if( r < 0 || r >= row || c < 0 || c >= column ) continue;
+										_cmpl_cell_set_(cm->data + (r * column + c) * cm->stride, i, map, pr, pc, xl, yl);
+									}
+								}
+							}
+						}
+					}
+				} // <--- for each modified memory unit
+			}
+		}
+		// following modification of cnt will be applied in next call
+		cm->generation = ++cnt->generation;
+	} // <--- operation
+
+	LogUnindent();
+	LogDebugf("End   - rebuild_compiled_map(%p, %p, %p)\n", cm, map, cnt);
+	return 0;
+}
+
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief get bounds of compiled map
+ * @param[in]   map : map data
+ * @param[out]   xl : origin x
+ * @param[out]   yl : origin y
+ * @param[out]  row : number of row
+ * @param[out] column : number of column
+ * @param[out]  rsl : cell size (half of pixel size)
+ * @return   <0 : no plane is allocated
+ */
+inline
+int _compiled_map_bound_(map_t *map, double *xl, double *yl, long *row, long *column, double *rsl) {
+	double xu = 0, yu = 0;
+	bool flg = false;
+
+	for( size_t i = 0; i < PlaneNum; i++){
+		if( !map->plane[i].is_allocate() ) continue;
+		if( !flg || map->plane[i].xlower() < *xl ) *xl = map->plane[i].xlower();
+		if( !flg || map->plane[i].ylower() < *yl ) *yl = map->plane[i].ylower();
+		if( !flg || map->plane[i].xupper() > xu ) xu = map->plane[i].xupper();
+		if( !flg || map->plane[i].yupper() > yu ) yu = map->plane[i].yupper();
+		*rsl = map->plane[i].xrsl() / 2.0;
+		flg = true;
+	}
+	if( !flg ) return -1;
+
+	*row = (long) ::ceil( (yu - *yl) / *rsl );
+	*column = (long) ::ceil( (xu - *xl) / *rsl );
+	return 0;
+}
+
+/**
+ * @privatesection
+ * @ingroup GNDPSM
+ * @brief write a pixel of a plane into a compiled map cell
+ * @param[out] cell : compiled map cell
+ * @param[in]     i : plane index
+ * @param[in]   map : map data
+ * @param[in]    pr : pixel row
+ * @param[in]    pc : pixel column
+ * @param[in]    xl : origin x of compiled map
+ * @param[in]    yl : origin y of compiled map
+ * @note zero weight pixel is written as zero (no data)
+ */
+template < typename T >
+inline
+void _cmpl_cell_set_(T *cell, size_t i, map_t *map, long pr, long pc, double xl, double yl) {
+	const pixel_t *pp = map->plane[i].cpointer( pr, pc );
+	double cx, cy;
+
+	if( pp->K <= 0.0 ) {
+		cell[CmplMeanX + i] = 0;
+		cell[CmplMeanY + i] = 0;
+		cell[CmplInvCov00 + i] = 0;
+		cell[CmplInvCov01 + i] = 0;
+		cell[CmplInvCov11 + i] = 0;
+		cell[CmplWeight + i] = 0;
+		return;
+	}
+
+	map->plane[i].pget_pos_core(pr, pc, &cx, &cy);
+	cell[CmplMeanX + i] = (T) (cx + pp->mean[PosX][0] - xl);
+	cell[CmplMeanY + i] = (T) (cy + pp->mean[PosY][0] - yl);
+	cell[CmplInvCov00 + i] = (T) pp->inv_cov[0][0];
+	cell[CmplInvCov01 + i] = (T) ((pp->inv_cov[0][1] + pp->inv_cov[1][0]) / 2.0);
+	cell[CmplInvCov11 + i] = (T) pp->inv_cov[1][1];
+	cell[CmplWeight + i] = (T) pp->K;
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief release compiled map
+ * @param[out] cm : compiled map
+ */
+template < typename T >
+inline
+int destroy_compiled_map(compiled_map<T> *cm) {
+	gnd_assert(!cm, -1, "invalid null pointer");
+
+	if( cm->file ) {
+		// mapped file
+		delete cm->file;
+		cm->file = 0;
+	}
+	else {
+		::free(cm->data);
+	}
+	cm->data = 0;
+	cm->row = 0;
+	cm->column = 0;
+	cm->generation = 0;
+	return 0;
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief compiled map file read (memory mapped, zero-copy)
+ * @param[out] cm : compiled map
+ * @param[in]   d : directory path
+ * @param[in]   f : file name
+ * @param[in]   e : extention
+ * @param[in] key : key of source data (0: not checked, see counting_map_key())
+ * @return    0 :
+ * @return   <0 : fail (not exist, or invalid format, element type, key)
+ * @note cm->data points read-only mapped memory until destroy_compiled_map() or build_compiled_map()
+ */
+template < typename T >
+inline
+int read_compiled_map(compiled_map<T> *cm, const char* d, const char* f, const char* e, uint64_t key) {
+	gnd_assert(!cm, -1, "invalid null pointer");
+	gnd_assert(!d || !f || !e, -1, "invalid null argument");
+
+	{ // ---> operation
+		char path[1024];
+		gnd::mapped_file *file = new gnd::mapped_file;
+		const mapped_file_header_t *h;
+
+		::sprintf(path, CmplFileNameFormat, d, f, e);
+		LogVerbosef("compiled map path \"%s\"\n", path);
+		if( file->open(path, CmplFileType, key) < 0 ) {
+			delete file;
+			return -1;
+		}
+		h = file->header();
+		if( h->element_size != sizeof(T) || h->stride == 0 ||
+				h->size != h->row * h->column * h->stride * sizeof(T) ) {
+			delete file;
+			return -1;
+		}
+
+		destroy_compiled_map(cm);
+		cm->file = file;
+		cm->data = (T*) file->data();
+		cm->row = h->row;
+		cm->column = h->column;
+		cm->stride = h->stride;
+		cm->xorg = h->xorg;
+		cm->yorg = h->yorg;
+		cm->rsl = h->xrsl;
+		cm->irsl = 1.0 / h->xrsl;
+	} // <--- operation
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief compiled map file out
+ * @param[in] cm : compiled map
+ * @param[in]  d : directory path
+ * @param[in]  f : file name
+ * @param[in]  e : extention
+ * @param[in] key : key of source data (see counting_map_key())
+ */
+template < typename T >
+inline
+int write_compiled_map(compiled_map<T> *cm, const char* d, const char* f, const char* e, uint64_t key) {
+	gnd_assert(!cm || !cm->data, -1, "invalid null pointer");
+	gnd_assert(!d || !f || !e, -1, "invalid null argument");
+
+	{ // ---> operation
+		char path[1024];
+		mapped_file_header_t h;
+
+		::memset(&h, 0, sizeof(h));
+		::strncpy(h.type, CmplFileType, sizeof(h.type) - 1);
+		h.element_size = sizeof(T);
+		h.stride = cm->stride;
+		h.row = cm->row;
+		h.column = cm->column;
+		h.xorg = cm->xorg;
+		h.yorg = cm->yorg;
+		h.xrsl = cm->rsl;
+		h.yrsl = cm->rsl;
+		h.key = key;
+		h.size = cm->row * cm->column * cm->stride * sizeof(T);
+
+		::sprintf(path, CmplFileNameFormat, d, f, e);
+		LogVerbosef("compiled map path \"%s\"\n", path);
+		return write_mapped_file(path, &h, cm->data);
+	} // <--- operation
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief built map file read
+ * @param[out] map : map
+ * @param[in]  cnt : counting map that the map was built from
+ * @param[in]    d : directory path
+ * @param[in]    f : file name
+ * @param[in]    e : extention
+ * @param[in]  key : key of source data and building parameter (0: not checked, see counting_map_key())
+ * @return    0 :
+ * @return   <0 : fail (not exist, or invalid format, key, or shape different from counting map)
+ * @details it is used instead of build_map() (or build_ndt_map()) of the same counting map.
+ * the memory unit layout follows the counting map, and only memory units allocated in the counting map are copied.
+ * the map is regarded as built from the counting map, so that rebuild_map() can follow.
+ */
+inline
+int read_map(map_t *map, cmap_t *cnt, const char* d, const char* f, const char* e, uint64_t key) {
+	gnd_assert(!map || !cnt, -1, "invalid null pointer");
+	gnd_assert(!d || !f || !e, -1, "invalid null argument");
+
+	LogDebugf("Begin - read_map(%p, %p)\n", map, cnt);
+	LogIndent();
+
+	{ // ---> operation
+		mapped_plane<pixel_t> mp[PlaneNum];
+
+		// ---> map all plane files
+		for( size_t i = 0; i < PlaneNum; i++ ){
+			char path[1024];
+
+			::sprintf(path, CMapFileNameFormat, d, f, (int)i, e);
+			LogVerbosef("map path \"%s\"\n", path);
+			if( mp[i].open(path, MapFileType, key) < 0 ||
+					mp[i].row() != cnt->plane[i].row() || mp[i].column() != cnt->plane[i].column() ||
+					mp[i].xlower() != cnt->plane[i].xlower() || mp[i].ylower() != cnt->plane[i].ylower() ||
+					mp[i].xrsl() != cnt->plane[i].xrsl() || mp[i].yrsl() != cnt->plane[i].yrsl() ) {
+				LogUnindent();
+				LogDebugf("Fail  - read_map(%p, %p)\n", map, cnt);
+				return -1;
+			}
+		} // <--- map all plane files
+
+		// ---> copy memory units
+		for( size_t i = 0; i < PlaneNum; i++ ){
+			const unsigned long ur = cnt->plane[i]._unit_row_(), uc = cnt->plane[i]._unit_column_();
+			const unsigned long row = cnt->plane[i].row(), col = cnt->plane[i].column();
+
+			if( map->plane[i].is_allocate() ) map->plane[i].deallocate();
+			if( map->plane[i].allocate( ur, uc, cnt->plane[i]._plane_row_(), cnt->plane[i]._plane_column_()) < 0 ) {
+				LogUnindent();
+				LogDebugf("Fail  - read_map(%p, %p)\n", map, cnt);
+				return -1;
+			}
+			map->plane[i].pset_origin( cnt->plane[i].xlower(), cnt->plane[i].ylower());
+			map->plane[i].pset_rsl( cnt->plane[i].xrsl(), cnt->plane[i].yrsl());
+
+			for( unsigned long r = 0; r < row; r += ur ){
+				for( unsigned long c = 0; c < col; c += uc ){
+					const unsigned long n = c + uc < col ? uc : col - c;
+
+					if( !cnt->plane[i].is_unit_allocate( r / ur, c / uc ) ) continue;
+					for( unsigned long k = r; k < r + ur && k < row; k++ ){
+						::memcpy( map->plane[i].pointer(k, c), mp[i].pointer(k, c), sizeof(pixel_t) * n );
+					}
+				}
+			}
+		} // <--- copy memory units
+	} // <--- operation
+
+	// following modification will be applied in rebuild_map()
+	map->generation = ++cnt->generation;
+	map->revision++;
+
+	LogUnindent();
+	LogDebugf("End   - read_map(%p, %p)\n", map, cnt);
+	return 0;
+}
+
+/**
+ * @ingroup GNDPSM
+ * @brief built map file out
+ * @param[in] map : map
+ * @param[in]   d : directory path
+ * @param[in]   f : file name
+ * @param[in]   e : extention
+ * @param[in] key : key of source data and building parameter (see counting_map_key())
+ */
+inline
+int write_map(map_t *map, const char* d, const char* f, const char* e, uint64_t key) {
+	gnd_assert(!map, -1, "invalid null pointer");
+	gnd_assert(!d || !f || !e, -1, "invalid null argument");
+
+	for( size_t i = 0; i < PlaneNum; i++ ){
+		char path[1024];
+
+		::sprintf(path, CMapFileNameFormat, d, f, (int)i, e);
+		LogVerbosef("map path \"%s\"\n", path);
+		if( write_mapped_plane(path, map->plane + i, MapFileType, key) < 0 ) return -1;
+	}
+	return 0;
+}
+
+
+#if defined(__AVX2__)
+/**
+ * @privatesection
+ * @brief load values of four planes
+ */
+inline
+__m256d _cmpl_load_avx2_(const double *p) {
+	return _mm256_load_pd(p);
+}
+inline
+__m256d _cmpl_load_avx2_(const float *p) {
+	return _mm256_cvtps_pd(_mm_load_ps(p));
+}
+#elif defined(__SSE2__)
+/**
+ * @privatesection
+ * @brief load values of two planes
+ */
+inline
+__m128d _cmpl_load_sse2_(const double *p) {
+	return _mm_load_pd(p);
+}
+inline
+__m128d _cmpl_load_sse2_(const float *p) {
+	return _mm_set_pd(p[1], p[0]);
+}
+#endif
+
+
+/**
+ * @privatesection
+ * @brief likelihood of a compiled map cell
+ * @param[in] cell : cell data
+ * @param[in]    x : reflection point x (compiled map coordinate)
+ * @param[in]    y : reflection point y (compiled map coordinate)
+ * @param[in]   pw : weight of each plane
+ * @param[out]   o : likelihood of each plane (not normalized)
+ */
+template < typename T >
+inline
+void _cmpl_cell_likelihood_(const T *cell, double x, double y, const double *pw, double *o) {
+#if defined(__AVX2__)
+	__m256d qx = _mm256_sub_pd( _mm256_set1_pd(x), _cmpl_load_avx2_(cell + CmplMeanX) );
+	__m256d qy = _mm256_sub_pd( _mm256_set1_pd(y), _cmpl_load_avx2_(cell + CmplMeanY) );
+	__m256d chi;
+
+	chi = _mm256_mul_pd( _cmpl_load_avx2_(cell + CmplInvCov00), _mm256_mul_pd(qx, qx) );
+	chi = _mm256_add_pd( chi, _mm256_mul_pd( _cmpl_load_avx2_(cell + CmplInvCov01), _mm256_mul_pd(_mm256_add_pd(qx, qx), qy) ) );
+	chi = _mm256_add_pd( chi, _mm256_mul_pd( _cmpl_load_avx2_(cell + CmplInvCov11), _mm256_mul_pd(qy, qy) ) );
+	chi = _fast_exp_avx2_( _mm256_mul_pd(chi, _mm256_set1_pd(-0.5)) );
+	chi = _mm256_mul_pd( chi, _cmpl_load_avx2_(cell + CmplWeight) );
+	_mm256_storeu_pd( o, _mm256_mul_pd( chi, _mm256_loadu_pd(pw) ) );
+#elif defined(__SSE2__)
+	for( size_t i = 0; i < PlaneNum; i += 2 ){
+		__m128d qx = _mm_sub_pd( _mm_set1_pd(x), _cmpl_load_sse2_(cell + CmplMeanX + i) );
+		__m128d qy = _mm_sub_pd( _mm_set1_pd(y), _cmpl_load_sse2_(cell + CmplMeanY + i) );
+		__m128d chi;
+
+		chi = _mm_mul_pd( _cmpl_load_sse2_(cell + CmplInvCov00 + i), _mm_mul_pd(qx, qx) );
+		chi = _mm_add_pd( chi, _mm_mul_pd( _cmpl_load_sse2_(cell + CmplInvCov01 + i), _mm_mul_pd(_mm_add_pd(qx, qx), qy) ) );
+		chi = _mm_add_pd( chi, _mm_mul_pd( _cmpl_load_sse2_(cell + CmplInvCov11 + i), _mm_mul_pd(qy, qy) ) );
+		chi = _fast_exp_sse2_( _mm_mul_pd(chi, _mm_set1_pd(-0.5)) );
+		chi = _mm_mul_pd( chi, _cmpl_load_sse2_(cell + CmplWeight + i) );
+		_mm_storeu_pd( o + i, _mm_mul_pd( chi, _mm_loadu_pd(pw + i) ) );
+	}
+#else
+	for( size_t i = 0; i < PlaneNum; i++ ){
+		double qx = x - cell[CmplMeanX + i];
+		double qy = y - cell[CmplMeanY + i];
+		double chi = cell[CmplInvCov00 + i] * (qx * qx) + cell[CmplInvCov01 + i] * ((qx + qx) * qy) + cell[CmplInvCov11 + i] * (qy * qy);
+		o[i] = _fast_exp_( chi * -0.5 ) * cell[CmplWeight + i] * pw[i];
+	}
+#endif
+}
+
+
+/**
+ * @privatesection
+ * @brief get compiled map cell
+ * @param[in] cm : compiled map
+ * @param[in,out] x : reflection point x (global -> compiled map coordinate)
+ * @param[in,out] y : reflection point y (global -> compiled map coordinate)
+ * @return cell pointer (0: out of map)
+ */
+template < typename T >
+inline
+const T* _cmpl_cell_(compiled_map<T> *cm, double *x, double *y) {
+	long r, c;
+
+	*x -= cm->xorg;
+	*y -= cm->yorg;
+	r = (long) ::floor( *y * cm->irsl );
+	c = (long) ::floor( *x * cm->irsl );
+	if( r < 0 || r >= cm->row || c < 0 || c >= cm->column )	return 0;
+	return cm->data + (r * cm->column + c) * cm->stride;
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief compute likelihood with compiled map
+ * @param[in]  cm : compiled map
+ * @param[in]   x : laser scanner reflection point x
+ * @param[in]   y : laser scanner reflection point y
+ * @param[out]  l : likelihood
+ */
+template < typename T >
+inline
+int likelihood(compiled_map<T> *cm, double x, double y, double *l) {
+	return likelihood(cm, x, y, 0, l);
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief compute likelihood with compiled map
+ * @param[in]  cm : compiled map
+ * @param[in]   x : laser scanner reflection point x
+ * @param[in]   y : laser scanner reflection point y
+ * @param[in]  pg : position gain
+ * @param[out]  l : likelihood
+ */
+template < typename T >
+inline
+int likelihood(compiled_map<T> *cm, double x, double y, pgain_t *pg, double *l) {
+	return likelihood(cm, &x, &y, 1, pg, l);
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief compute likelihood of a set of points with compiled map (batch)
+ * @param[in]  cm : compiled map
+ * @param[in]   x : laser scanner reflection points x
+ * @param[in]   y : laser scanner reflection points y
+ * @param[in]   n : number of points
+ * @param[in]  pg : position gain (null: not use)
+ * @param[out] sum : sum of likelihood
+ * @param[out]  l : likelihood of each point (null: not output)
+ */
+template < typename T >
+inline
+int likelihood(compiled_map<T> *cm, const double *x, const double *y, size_t n, pgain_t *pg, double *sum, double *l) {
+	gnd_assert(!cm || !sum, -1, "invalid null pointer");
+	gnd_assert(!cm->data, -1, "map is null");
+
+	{ // ---> operate
+		double pw[PlaneNum];
+		double o[PlaneNum];
+
+		for( size_t i = 0; i < PlaneNum; i++ ){
+			pw[i] = pg ? 1.0 / (pg->N[i] + 1) : 1.0;
+		}
+
+		*sum = 0;
+		for( size_t j = 0; j < n; j++ ){
+			double xx = x[j], yy = y[j];
+			double lkh = 0;
+			const T *cell = _cmpl_cell_(cm, &xx, &yy);
+
+			if( cell ) {
+				_cmpl_cell_likelihood_(cell, xx, yy, pw, o);
+				for( size_t i = 0; i < PlaneNum; i++ )	lkh += o[i];
+				lkh /= PlaneNum;
+			}
+			*sum += lkh;
+			if( l ) l[j] = lkh;
+		}
+	} // <--- operate
+	return 0;
+}
 
-	// ---> scanning loop of map plane
-	for( size_t mi = 0; mi < PlaneNum; mi++){
-		pixel_t *px;
-		matrix::fixed<PosDim,1> q;
-		matrix::fixed<1,PosDim> qT_invS;		// q^t * Sigma^-1
-		matrix::fixed<1,3> qT_invS_J;			// q^t * Sigma^-1 * J
-		double chi_sq_2;						// q^T * Sigma^-1 * q / 2 / 2value
-		double lkh = 0;
-		matrix::fixed<1,3> gg;					// gradient
-		matrix::fixed<1,1> ws1x1;				// work space
 
-		{ // ---> get pixel data and compute q(difference from mean)
-			matrix::fixed<2,1> ws2x1;
-			long pr, pc;
-			// get index of pixel
-			if( m->plane[mi].pindex( X[PosX][0], X[PosY][0], &pr, &pc ) < 0)
-				continue; // no data
-			px = m->plane[mi].pointer( pr, pc );
-			// zero weight
-			if(px->K <= 0.0)	continue;
-			// get pixel core position
-			m->plane[mi].pget_pos_core(pr, pc, pointer(&ws2x1, PosX, 0), pointer(&ws2x1, PosY, 0));
-			// compute sensor reading position on a focus pixel
-			sub(&X, &ws2x1, &ws2x1);
-			// compute difference from mean
-			sub(&ws2x1, &px->mean, &q);
-		} // <--- get pixel data and compute q(difference from mean)
+/**
+ * @brief compute likelihood and gradient with compiled map
+ * @param[in]  cm : compiled map
+ * @param[in]   x : laser scanner reflection point x
+ * @param[in]   y : laser scanner reflection point y
+ * @param[in]   c : coordinate convert matrix
+ * @param[out]  g : gradient   ( derivation of f(x,y) because of minimization problem)
+ * @param[out]  l : likelihood ( f(x,y) )
+ * @return    0 :
+ * @see gradient(map_t*, double, double, matrix::fixed<4,4>*, matrix::fixed<3,1>*, double*)
+ */
+template < typename T >
+inline
+int gradient(compiled_map<T> *cm, double x, double y, matrix::fixed<4,4> *c, matrix::fixed<3,1> *g, double *l) {
+	gnd_assert(!cm || !c || !g, -1, "invalid null pointer");
 
+	{ // ---> initialize
+		matrix::set_zero(g);
+		if(l) *l = 0;
+	} // <--- initialize
 
-		{ // ---> likelihood
+	{ // ---> operate
+		// reflection point on global coordinate
+		double X = (*c)[0][0] * x + (*c)[0][1] * y + (*c)[0][3];
+		double Y = (*c)[1][0] * x + (*c)[1][1] * y + (*c)[1][3];
+		// jacobi (orient)
+		const double j0 = - x * (*c)[1][0] - y * (*c)[0][0];
+		const double j1 =   x * (*c)[0][0] - y * (*c)[1][0];
+		const double pw[PlaneNum] = {1.0, 1.0, 1.0, 1.0};
+		double o[PlaneNum];
+		const T *cell;
+
+		if( !(cell = _cmpl_cell_(cm, &X, &Y)) )	return 0;
+		_cmpl_cell_likelihood_(cell, X, Y, pw, o);
+
+		// ---> scanning loop of map plane
+		for( size_t i = 0; i < PlaneNum; i++ ){
+			double qx, qy, a0, a1;
+
+			if( o[i] <= 0.0 )	continue;
+			qx = X - cell[CmplMeanX + i];
+			qy = Y - cell[CmplMeanY + i];
 			// q^T * Sigma^-1
-			prod_transpose1(&q, &px->inv_cov, &qT_invS);
-			// chi-square / 2.0
-			prod(&qT_invS, &q, &ws1x1);
-			chi_sq_2 = ws1x1[0][0] / 2.0;
-			// likelihood exp( -q^T * Sigma^-1 * q / 2 )
-			lkh = ::exp( -chi_sq_2 ) * px->K;
-			if( l ) (*l) += lkh;
-		} // <--- likelihood
+			a0 = cell[CmplInvCov00 + i] * qx + cell[CmplInvCov01 + i] * qy;
+			a1 = cell[CmplInvCov01 + i] * qx + cell[CmplInvCov11 + i] * qy;
 
-		{ // ---> gradient
-			// q^T * Sigma^-1 * q' * exp( - q^T * Sigma^-1 * q / 2)
-			prod(&qT_invS, &J, &qT_invS_J);
 			// gradient
-			matrix::scalar_prod(&qT_invS_J, lkh, &gg);
-			matrix::sub_transpose2(g, &gg, g);
-		} // <--- gradient
-	}
+			(*g)[0][0] -= a0 * o[i];
+			(*g)[1][0] -= a1 * o[i];
+			(*g)[2][0] -= (a0 * j0 + a1 * j1) * o[i];
+			if( l ) (*l) += o[i];
+		} // <--- scanning loop of map plane
+	} // <--- operate
+	return 0;
+}
+
+
+/**
+ * @ingroup GNDPSM
+ * @brief compute likelihood, gradient and hessian of a set of points for newton's method with compiled map (batch)
+ * @param[in] cm : compiled map
+ * @param[in]  x : laser scanner reflection points x (sensor coordinate)
+ * @param[in]  y : laser scanner reflection points y (sensor coordinate)
+ * @param[in]  n : number of points
+ * @param[in]  c : coordinate convert matrix
+ * @param[out] l : sum of likelihood
+ * @param[out] g : sum of gradient
+ * @param[out] h : sum of hessian
+ * @return    0 :
+ * @see newton_variables(map_t*, const double*, const double*, size_t, matrix::fixed<4,4>*, double*, matrix::fixed<3,1>*, matrix::fixed<3,3>*)
+ */
+template < typename T >
+inline
+int newton_variables(compiled_map<T> *cm, const double *x, const double *y, size_t n, matrix::fixed<4,4> *c, double *l, matrix::fixed<3,1> *g, matrix::fixed<3,3> *h) {
+	gnd_assert(!cm || !c || !l || !g || !h, -1, "invalid null pointer");
+	gnd_assert(!cm->data, -1, "map is null");
+	gnd_assert(n > 0 && (!x || !y), -1, "invalid null pointer");
+
+	*l = 0;
+	matrix::set_zero(g);
+	matrix::set_zero(h);
+
+	{ // ---> operate
+		const double r00 = (*c)[0][0], r01 = (*c)[0][1], tx = (*c)[0][3];
+		const double r10 = (*c)[1][0], r11 = (*c)[1][1], ty = (*c)[1][3];
+		const double pw[PlaneNum] = {1.0, 1.0, 1.0, 1.0};
+		double qx[LikelihoodBatchSize], qy[LikelihoodBatchSize];
+		double s00[LikelihoodBatchSize], s01[LikelihoodBatchSize], s11[LikelihoodBatchSize];
+		double j0[LikelihoodBatchSize], j1[LikelihoodBatchSize];
+		double lkh[LikelihoodBatchSize];
+		double o[NewtonTermNum * LikelihoodBatchSize];
+		size_t nv = 0;
+
+		// ---> scanning loop of reflection points
+		for( size_t j = 0; j < n; j++ ){
+			double X = r00 * x[j] + r01 * y[j] + tx;
+			double Y = r10 * x[j] + r11 * y[j] + ty;
+			double ol[PlaneNum];
+			const T *cell;
+
+			if( !(cell = _cmpl_cell_(cm, &X, &Y)) )	continue;
+			_cmpl_cell_likelihood_(cell, X, Y, pw, ol);
+
+			// ---> gather
+			for( size_t i = 0; i < PlaneNum; i++ ){
+				// zero weight
+				if( cell[CmplWeight + i] <= 0.0 )	continue;
+				qx[nv] = X - cell[CmplMeanX + i];
+				qy[nv] = Y - cell[CmplMeanY + i];
+				s00[nv] = cell[CmplInvCov00 + i];
+				s01[nv] = 2.0 * cell[CmplInvCov01 + i];
+				s11[nv] = cell[CmplInvCov11 + i];
+				j0[nv] = - x[j] * r10 - y[j] * r00;
+				j1[nv] =   x[j] * r00 - y[j] * r10;
+				lkh[nv] = ol[i];
+				nv++;
+			} // <--- gather
+
+			// flush (a point adds PlaneNum terms at most)
+			if( nv + PlaneNum > LikelihoodBatchSize || j + 1 == n ) {
+				_newton_terms_(qx, qy, s00, s01, s11, j0, j1, lkh, nv, o);
+				_newton_accumulate_(o, lkh, nv, l, g, h);
+				nv = 0;
+			}
+		} // <--- scanning loop of reflection points
+
+		if( nv > 0 ) {
+			_newton_terms_(qx, qy, s00, s01, s11, j0, j1, lkh, nv, o);
+			_newton_accumulate_(o, lkh, nv, l, g, h);
+		}
+	} // <--- operate
 	return 0;
 }
 
+
+
 /**
  * @ingroup GNDPSM
  * @brief counting map file read
@@ -1094,6 +3528,8 @@ int read_counting_map(cmap_t *c,  const char* d, const char* f, const char* e)
 				LogDebugf("Fail  - read_counting_map(%p, %p, %lf, %lf, %lf)\n", c, d, f, e);
 				gnd_exit(-1, "fail to file-open");
 			}
+			_sync_counting_map_block_(c, i, true);
+			c->revision++;
 		} // <--- map plane data scanning loop
 	} // <--- operation
 	LogUnindent();
@@ -1138,6 +3574,48 @@ int write_counting_map(cmap_t *c,  const char* d, const char* f, const char* e)
 	return 0;
 }
 
+/**
+ * @ingroup GNDPSM
+ * @brief key of counting map contents
+ * @param[in]    c : counting map
+ * @param[in] seed : seed (e.g. key of other parameters)
+ * @return key to identify data built from the counting map (see write_compiled_map(), read_compiled_map())
+ */
+inline
+uint64_t counting_map_key(cmap_t *c, uint64_t seed)
+{
+	gnd_assert(!c, 0, "invalid null argument");
+
+	{ // ---> operation
+		uint64_t h = seed;
+		// ---> map plane data scanning loop
+		for( size_t i = 0; i < PlaneNum; i++){
+			unsigned long shape[2];
+			double org[3];
+
+			if( !c->plane[i].is_allocate() ) continue;
+			shape[0] = c->plane[i].row();
+			shape[1] = c->plane[i].column();
+			org[0] = c->plane[i].xlower();
+			org[1] = c->plane[i].ylower();
+			org[2] = c->plane[i].xrsl();
+			h = mapped_file_checksum(shape, sizeof(shape), h);
+			h = mapped_file_checksum(org, sizeof(org), h);
+			for( unsigned long r = 0; r < shape[0]; r++ ) {
+				for( unsigned long k = 0; k < shape[1]; k++ ) {
+					const cmap_pixel_t *pp = c->plane[i].cpointer(r, k);
+					// skip empty pixel
+					if( pp->cnt == 0 ) continue;
+					h = mapped_file_checksum(&r, sizeof(r), h);
+					h = mapped_file_checksum(&k, sizeof(k), h);
+					h = mapped_file_checksum(pp, sizeof(*pp), h);
+				}
+			}
+		} // <--- map plane data scanning loop
+		return h ? h : 1;
+	} // <--- operation
+}
+
 
 /**
  * @brief build bitmap data (gray)
@@ -1146,10 +3624,11 @@ int write_counting_map(cmap_t *c,  const char* d, const char* f, const char* e)
  * @param[in] ps : pixel size
  * @param[in] sr : smoothing parameter ( sensor range[m])
  * @param[in] cp : contranst parameter
+ * @param[in,out] ws : workspace (null: allocated in each call, see build_bmp8())
  */
 inline
-int build_bmp(bmp8_t *bmp, map_t *map, double ps, double sr, double cp) {
-	return build_bmp8(bmp, map, ps, sr, cp);
+int build_bmp(bmp8_t *bmp, map_t *map, double ps, double sr, double cp, gridmap::gridplane<double> *ws) {
+	return build_bmp8(bmp, map, ps, sr, cp, ws);
 }
 
 /**
@@ -1159,10 +3638,11 @@ int build_bmp(bmp8_t *bmp, map_t *map, double ps, double sr, double cp) {
  * @param[in] ps : pixel size
  * @param[in] sr : smoothing parameter ( sensor range[m])
  * @param[in] cp : contranst parameter
+ * @param[in,out] ws : workspace (null: allocated in each call, see build_bmp32())
  */
 inline
-int build_bmp(bmp32_t *bmp, map_t *map, double ps, double sr, double cp) {
-	return build_bmp32(bmp, map, ps, sr, cp);
+int build_bmp(bmp32_t *bmp, map_t *map, double ps, double sr, double cp, gridmap::gridplane<double> *ws) {
+	return build_bmp32(bmp, map, ps, sr, cp, ws);
 }
 
 
@@ -1173,11 +3653,14 @@ int build_bmp(bmp32_t *bmp, map_t *map, double ps, double sr, double cp) {
  * @param[in] ps   : pixel size
  * @param[in] sr   : sensor range (for smoothing)
  * @param[in] cp   : contrast parameter
+ * @param[in,out] wsp : workspace (null: allocated in this call)
+ * @note a workspace given by caller is kept allocated, and it is reused if the next bitmap has the same shape.
  */
 inline
-int build_bmp8(bmp8_t *bmp, map_t *map, double ps, double sr, double cp)
+int build_bmp8(bmp8_t *bmp, map_t *map, double ps, double sr, double cp, gridmap::gridplane<double> *wsp)
 {
-	gridmap::gridplane<double> ws;	// workspace
+	gridmap::gridplane<double> own;	// workspace (used if not given)
+	gridmap::gridplane<double> &ws = wsp ? *wsp : own;
 
 	gnd_assert(!bmp, -1, "invalid null argument");
 	gnd_assert(!map, -1, "invalid null argument");
@@ -1189,7 +3672,12 @@ int build_bmp8(bmp8_t *bmp, map_t *map, double ps, double sr, double cp)
 		bmp->pallocate(map->plane[0].xupper() - map->plane[3].xlower(), map->plane[0].yupper() - map->plane[3].ylower(), ps, ps);
 		bmp->pset_origin(map->plane[3].xlower(), map->plane[3].ylower());
 
-		ws.pallocate(map->plane[0].xupper() - map->plane[3].xlower(), map->plane[0].yupper() - map->plane[3].ylower(), ps, ps);
+		// summed-area table for position gain
+		if( sr > 0 ) build_sat(&map->sat, map);
+
+		// workspace of the same shape is reused
+		if( ws.is_allocate() && (ws.row() != bmp->row() || ws.column() != bmp->column() || ws.xrsl() != ps) )	ws.deallocate();
+		if( !ws.is_allocate() )	ws.pallocate(map->plane[0].xupper() - map->plane[3].xlower(), map->plane[0].yupper() - map->plane[3].ylower(), ps, ps);
 		ws.pset_origin(map->plane[3].xlower(), map->plane[3].ylower());
 	} // <--- initialize
 
@@ -1277,7 +3765,7 @@ int build_bmp8(bmp8_t *bmp, map_t *map, double ps, double sr, double cp)
 	} // <--- operation
 
 	{ // ---> finalize
-		ws.deallocate();
+		if( !wsp )	ws.deallocate();
 	} // <--- finalize
 
 	return 0;
@@ -1290,11 +3778,14 @@ int build_bmp8(bmp8_t *bmp, map_t *map, double ps, double sr, double cp)
  * @param[in] ps   : pixel size
  * @param[in] sr   : sensor range (for smoothing)
  * @param[in] cp   : contrast parameter
+ * @param[in,out] wsp : workspace (null: allocated in this call)
+ * @note a workspace given by caller is kept allocated, and it is reused if the next bitmap has the same shape.
  */
 inline
-int build_bmp32(bmp32_t *bmp, map_t *map, double ps, double sr, double cp)
+int build_bmp32(bmp32_t *bmp, map_t *map, double ps, double sr, double cp, gridmap::gridplane<double> *wsp)
 {
-	gridmap::gridplane<double> ws;	// workspace
+	gridmap::gridplane<double> own;	// workspace (used if not given)
+	gridmap::gridplane<double> &ws = wsp ? *wsp : own;
 
 	gnd_assert(!bmp, -1, "invalid null argument");
 	gnd_assert(!map, -1, "invalid null argument");
@@ -1307,7 +3798,12 @@ int build_bmp32(bmp32_t *bmp, map_t *map, double ps, double sr, double cp)
 		bmp->pallocate(map->plane[3].xupper() - map->plane[0].xlower(), map->plane[3].yupper() - map->plane[0].ylower(), ps, ps);
 		bmp->pset_origin(map->plane[0].xlower(), map->plane[0].ylower());
 
-		ws.pallocate(map->plane[3].xupper() - map->plane[0].xlower(), map->plane[3].yupper() - map->plane[0].ylower(), ps, ps);
+		// summed-area table for position gain
+		if( sr > 0 ) build_sat(&map->sat, map);
+
+		// workspace of the same shape is reused
+		if( ws.is_allocate() && (ws.row() != bmp->row() || ws.column() != bmp->column() || ws.xrsl() != ps) )	ws.deallocate();
+		if( !ws.is_allocate() )	ws.pallocate(map->plane[3].xupper() - map->plane[0].xlower(), map->plane[3].yupper() - map->plane[0].ylower(), ps, ps);
 		ws.pset_origin(map->plane[0].xlower(), map->plane[0].ylower());
 	} // <--- initialize
 
@@ -1399,7 +3895,7 @@ int build_bmp32(bmp32_t *bmp, map_t *map, double ps, double sr, double cp)
 	} // <--- operation
 
 	{ // ---> finalize
-		ws.deallocate();
+		if( !wsp )	ws.deallocate();
 	} // <--- finalize
 
 	return 0;
@@ -1444,18 +3940,30 @@ public:
 public:
 	optimize_basic();
 	optimize_basic(map_pt m);
-	~optimize_basic();
+	virtual ~optimize_basic();
 	// <--- constructor, destructor
 
 
 	// ---> map
 protected:
 	map_pt _map;	///< @brief map reference
+	compiled_mapf_t *_cmpl_map;	///< @brief compiled map reference
 public:
 	virtual int set_map(map_pt m);
+	virtual int set_compiled_map(compiled_mapf_t *m);
 	virtual int release_map();
 	// <--- map
 
+	// ---> map pyramid
+protected:
+	map_pyramid_t *_pyramid;	///< @brief map pyramid reference
+	size_t _level;				///< @brief current pyramid level (0: original map)
+	int begin_pyramid_level();
+public:
+	virtual int set_map_pyramid(map_pyramid_t *p);
+	size_t pyramid_level() const;
+	// <--- map pyramid
+
 	// ---> reflection point
 protected:
 	/// @brief laser scanner reflection point
@@ -1463,8 +3971,62 @@ protected:
 public:
 	virtual int set_scan_point(double x, double y);
 	virtual int nscan_point() const;
+	virtual int get_scan_point(int i, double *x, double *y);
 	// <--- reflection point
 
+	// ---> batch likelihood
+protected:
+	/// @brief workspace of reflection points on global coordinate (structure of arrays)
+	struct scan_workspace {
+		double *x;		///< x
+		double *y;		///< y
+		size_t n;		///< allocated size
+		scan_workspace();
+		~scan_workspace();
+	};
+	/// @brief workspace of reflection points on global coordinate
+	struct scan_workspace _ws_scan;
+	int scan_likelihood(matrix::fixed<4,4> *c, double *l);
+	int scan_likelihood(const matrix::coord2d *c, double *l);
+	int scan_newton_variables(matrix::fixed<4,4> *c, double *l, matrix::fixed<3,1> *g, matrix::fixed<3,3> *h);
+private:
+	int _reserve_scan_workspace_(struct scan_workspace *ws);
+	int _scan_likelihood_(struct scan_workspace *ws, const matrix::coord2d *c, double *l);
+	// <--- batch likelihood
+
+	// ---> parallel hypothesis scoring
+protected:
+	/// @brief workspace of hypotheses
+	struct hypothesis_workspace {
+		matrix::coord2d **c;	///< planar transform of each hypothesis
+		double *l;				///< likelihood of each hypothesis
+		size_t n;				///< allocated size
+		hypothesis_workspace();
+		~hypothesis_workspace();
+	};
+	/// @brief workspace of hypotheses
+	struct hypothesis_workspace _ws_hyp;
+	/// @brief thread pool reference (null: serial)
+	gnd::thread_pool *_pool;
+	int reserve_hypothesis(size_t n);
+	int scan_likelihood(matrix::coord2d **c, size_t n, double *l);
+public:
+	int set_thread_pool(gnd::thread_pool *p);
+private:
+	/// @brief workspace of worker threads (thread 1, 2, ...)
+	struct scan_workspace *_ws_thread;
+	/// @brief number of workspace of worker threads
+	int _nws_thread;
+	/// @brief argument of parallel hypothesis scoring
+	struct scan_task {
+		optimize_basic *opt;		///< optimizer
+		matrix::coord2d **c;		///< planar transform of each hypothesis
+		size_t n;					///< number of hypotheses
+		double *l;					///< likelihood of each hypothesis
+	};
+	static void _scan_likelihood_task_(void *a, int i, int n);
+	// <--- parallel hypothesis scoring
+
 
 	// ---> starting vlaue of optimization
 public:
@@ -1533,6 +4095,12 @@ inline
 optimize_basic::optimize_basic()
 {
 	_map = 0;
+	_cmpl_map = 0;
+	_pyramid = 0;
+	_level = 0;
+	_pool = 0;
+	_ws_thread = 0;
+	_nws_thread = 0;
 }
 
 /**
@@ -1541,6 +4109,13 @@ optimize_basic::optimize_basic()
  */
 inline
 optimize_basic::optimize_basic(map_pt m) {
+	_map = 0;
+	_cmpl_map = 0;
+	_pyramid = 0;
+	_level = 0;
+	_pool = 0;
+	_ws_thread = 0;
+	_nws_thread = 0;
 	set_map(m);
 }
 
@@ -1551,6 +4126,7 @@ inline
 optimize_basic::~optimize_basic()
 {
 	release_map();
+	delete[] _ws_thread;
 }
 
 
@@ -1567,6 +4143,20 @@ int optimize_basic::set_map(map_pt m)
 	return (_map != 0);
 }
 
+/**
+ * @brief set compiled map
+ * @param[in] m : compiled map pointer (single precision, null: not use)
+ * @return  0 :
+ * @note compiled map is used for likelihood computation instead of map, if it is set.
+ * it have to be rebuilt when the map is changed.
+ */
+inline
+int optimize_basic::set_compiled_map(compiled_mapf_t *m)
+{
+	_cmpl_map = m;
+	return 0;
+}
+
 /**
  * @brief release map
  */
@@ -1574,9 +4164,50 @@ inline
 int optimize_basic::release_map()
 {
 	_map = 0;
+	_cmpl_map = 0;
+	_pyramid = 0;
+	_level = 0;
+	return 0;
+}
+
+
+/**
+ * @brief set map pyramid
+ * @param[in] p : map pyramid pointer (null: not use)
+ * @return  0 :
+ * @details if it is set, optimization begins with the coarsest level of map pyramid
+ * and proceeds to finer level each time it converges. it is applied from next begin().
+ * it have to be rebuilt when the map is changed.
+ */
+inline
+int optimize_basic::set_map_pyramid(map_pyramid_t *p)
+{
+	_pyramid = p;
 	return 0;
 }
 
+/**
+ * @brief get current pyramid level
+ * @return 0 : original map
+ * 		  >0 : coarse level
+ */
+inline
+size_t optimize_basic::pyramid_level() const
+{
+	return _level;
+}
+
+/**
+ * @brief start from the coarsest level of map pyramid
+ * @return current pyramid level
+ */
+inline
+int optimize_basic::begin_pyramid_level()
+{
+	_level = _pyramid ? _pyramid->n : 0;
+	return _level;
+}
+
 
 /**
  * @brief set scan point
@@ -1593,15 +4224,268 @@ int optimize_basic::set_scan_point(double x, double y) {
 }
 
 /**
- * @brief get number of scan point
- * @return    number of points
+ * @brief get number of scan point
+ * @return    number of points
+ */
+inline
+int optimize_basic::nscan_point() const{
+	return _points.size();
+}
+
+/**
+ * @brief get scan point
+ * @param[in]  i : index
+ * @param[out] x : reflect point x
+ * @param[out] y : reflect point y
+ * @return    0 :
+ */
+inline
+int optimize_basic::get_scan_point(int i, double *x, double *y) {
+	gnd_assert(!x || !y, -1, "invalid null pointer");
+	gnd_assert(i < 0 || i >= nscan_point(), -1, "invalid argument");
+
+	*x = _points[i][0][0];
+	*y = _points[i][1][0];
+	return 0;
+}
+
+
+/**
+ * @brief constructor of optimizer_basic::scan_workspace
+ */
+inline
+optimize_basic::scan_workspace::scan_workspace() : x(0), y(0), n(0)
+{
+}
+
+/**
+ * @brief destructor of optimizer_basic::scan_workspace
+ */
+inline
+optimize_basic::scan_workspace::~scan_workspace()
+{
+	delete[] x;
+	delete[] y;
+}
+
+/**
+ * @brief compute likelihood of all reflection points
+ * @param[in]  c : coordinate convert matrix
+ * @param[out] l : sum of likelihood
+ * @return    0 :
+ */
+inline
+int optimize_basic::scan_likelihood(matrix::fixed<4,4> *c, double *l) {
+	gnd_assert(!c || !l, -1, "invalid null pointer");
+
+	{ // ---> operation
+		matrix::coord2d t;
+
+		matrix::coord2d_from_matrix(&t, c);
+		return _scan_likelihood_(&_ws_scan, &t, l);
+	} // <--- operation
+}
+
+/**
+ * @brief compute likelihood of all reflection points
+ * @param[in]  c : planar transform
+ * @param[out] l : sum of likelihood
+ * @return    0 :
+ */
+inline
+int optimize_basic::scan_likelihood(const matrix::coord2d *c, double *l) {
+	gnd_assert(!c || !l, -1, "invalid null pointer");
+
+	return _scan_likelihood_(&_ws_scan, c, l);
+}
+
+/**
+ * @privatesection
+ * @brief compute likelihood of all reflection points with a workspace
+ * @param[in,out] ws : workspace
+ * @param[in]      c : planar transform
+ * @param[out]     l : sum of likelihood
+ * @note this function only read the maps and reflection points, so that it can run on each thread with its own workspace
+ */
+inline
+int optimize_basic::_scan_likelihood_(struct scan_workspace *ws, const matrix::coord2d *c, double *l) {
+	_reserve_scan_workspace_(ws);
+
+	{ // ---> coordinate convert
+		const double r00 = c->c, r01 = -c->s, tx = c->tx;
+		const double r10 = c->s, r11 = c->c, ty = c->ty;
+
+		for( size_t j = 0; j < (unsigned)_points.size(); j++ ){
+			ws->x[j] = r00 * _points[j][0][0] + r01 * _points[j][1][0] + tx;
+			ws->y[j] = r10 * _points[j][0][0] + r11 * _points[j][1][0] + ty;
+		}
+	} // <--- coordinate convert
+
+	if( _level > 0 ) {
+		return opsm::likelihood(_pyramid->map + _level - 1, ws->x, ws->y, _points.size(), 0, l);
+	}
+	if( _cmpl_map && _cmpl_map->data ) {
+		return opsm::likelihood(_cmpl_map, ws->x, ws->y, _points.size(), 0, l);
+	}
+	return opsm::likelihood(_map, ws->x, ws->y, _points.size(), 0, l);
+}
+
+/**
+ * @brief compute likelihood, gradient and hessian of all reflection points for newton's method
+ * @param[in]  c : coordinate convert matrix
+ * @param[out] l : sum of likelihood
+ * @param[out] g : sum of gradient
+ * @param[out] h : sum of hessian
+ * @return    0 :
+ */
+inline
+int optimize_basic::scan_newton_variables(matrix::fixed<4,4> *c, double *l, matrix::fixed<3,1> *g, matrix::fixed<3,3> *h) {
+	gnd_assert(!c || !l || !g || !h, -1, "invalid null pointer");
+
+	_reserve_scan_workspace_(&_ws_scan);
+
+	// structure of arrays (sensor coordinate)
+	for( size_t j = 0; j < (unsigned)_points.size(); j++ ){
+		_ws_scan.x[j] = _points[j][0][0];
+		_ws_scan.y[j] = _points[j][1][0];
+	}
+
+	if( _level > 0 ) {
+		return opsm::newton_variables(_pyramid->map + _level - 1, _ws_scan.x, _ws_scan.y, _points.size(), c, l, g, h);
+	}
+	if( _cmpl_map && _cmpl_map->data ) {
+		return opsm::newton_variables(_cmpl_map, _ws_scan.x, _ws_scan.y, _points.size(), c, l, g, h);
+	}
+	return opsm::newton_variables(_map, _ws_scan.x, _ws_scan.y, _points.size(), c, l, g, h);
+}
+
+/**
+ * @privatesection
+ * @brief allocate workspace for all reflection points
+ * @param[in,out] ws : workspace
+ */
+inline
+int optimize_basic::_reserve_scan_workspace_(struct scan_workspace *ws) {
+	if( ws->n < (unsigned)_points.size() ) {
+		delete[] ws->x;
+		delete[] ws->y;
+		ws->n = _points.size();
+		ws->x = new double[ws->n];
+		ws->y = new double[ws->n];
+	}
+	return 0;
+}
+
+
+/**
+ * @brief constructor of optimizer_basic::hypothesis_workspace
+ */
+inline
+optimize_basic::hypothesis_workspace::hypothesis_workspace() : c(0), l(0), n(0)
+{
+}
+
+/**
+ * @brief destructor of optimizer_basic::hypothesis_workspace
+ */
+inline
+optimize_basic::hypothesis_workspace::~hypothesis_workspace()
+{
+	delete[] c;
+	delete[] l;
+}
+
+/**
+ * @brief set thread pool for hypothesis scoring
+ * @param[in] p : thread pool (null: serial)
+ * @return  0 :
+ * @note the thread pool is shared, and it is not deleted by optimizer
+ */
+inline
+int optimize_basic::set_thread_pool(gnd::thread_pool *p)
+{
+	_pool = p;
+	return 0;
+}
+
+/**
+ * @brief allocate workspace of hypotheses
+ * @param[in] n : number of hypotheses
+ */
+inline
+int optimize_basic::reserve_hypothesis(size_t n)
+{
+	if( _ws_hyp.n < n ) {
+		delete[] _ws_hyp.c;
+		delete[] _ws_hyp.l;
+		_ws_hyp.n = n;
+		_ws_hyp.c = new matrix::coord2d*[n];
+		_ws_hyp.l = new double[n];
+	}
+	return 0;
+}
+
+/**
+ * @brief compute likelihood of all reflection points for each hypothesis
+ * @param[in]  c : planar transform of each hypothesis
+ * @param[in]  n : number of hypotheses
+ * @param[out] l : sum of likelihood of each hypothesis
+ * @return    0 :
+ * @details if thread pool is set, hypotheses are split across the threads.
+ * each likelihood is computed by one thread in the same order as serial,
+ * so that the result does not depend on the number of threads.
+ */
+inline
+int optimize_basic::scan_likelihood(matrix::coord2d **c, size_t n, double *l)
+{
+	gnd_assert(n > 0 && (!c || !l), -1, "invalid null pointer");
+
+	if( !_pool || _pool->size() == 1 || n < 2 ) {
+		for( size_t j = 0; j < n; j++ ){
+			_scan_likelihood_(&_ws_scan, c[j], l + j);
+		}
+		return 0;
+	}
+
+	{ // ---> parallel
+		struct scan_task task;
+
+		if( _nws_thread < _pool->size() - 1 ) {
+			delete[] _ws_thread;
+			_nws_thread = _pool->size() - 1;
+			_ws_thread = new struct scan_workspace[_nws_thread];
+		}
+
+		task.opt = this;
+		task.c = c;
+		task.n = n;
+		task.l = l;
+		_pool->run(_scan_likelihood_task_, &task);
+	} // <--- parallel
+	return 0;
+}
+
+/**
+ * @privatesection
+ * @brief task of parallel hypothesis scoring
+ * @param[in,out] a : argument (scan_task)
+ * @param[in]     i : thread index
+ * @param[in]     n : number of threads
  */
 inline
-int optimize_basic::nscan_point() const{
-	return _points.size();
+void optimize_basic::_scan_likelihood_task_(void *a, int i, int n)
+{
+	struct scan_task *task = static_cast<struct scan_task*>(a);
+	optimize_basic *opt = task->opt;
+	struct scan_workspace *ws = i == 0 ? &opt->_ws_scan : opt->_ws_thread + i - 1;
+	size_t b = 0, e = 0;
+
+	thread_pool::partition(task->n, i, n, &b, &e);
+	for( size_t j = b; j < e; j++ ){
+		opt->_scan_likelihood_(ws, task->c[j], task->l + j);
+	}
 }
 
-
 /**
  * @brief constructor of optimizer_basic::converge_var
  */
@@ -1622,10 +4506,19 @@ int optimize_basic::set_converge_threshold(double d, double o) {
 
 /**
  * @brief converge test
+ * @details on coarse level of map pyramid, thresholds are scaled by the pixel size ratio
+ * and the level proceeds to finer one when it converges.
  */
 int optimize_basic::converge_test() {
-	return converge_test( gnd_square( _converge.delta[0][0] ) + gnd_square( _converge.delta[1][0] ) , _converge.delta[2][0],
-			_converge.sqdist, _converge.orient);
+	const double s = (double) (1 << _level);
+	int ret = converge_test( gnd_square( _converge.delta[0][0] ) + gnd_square( _converge.delta[1][0] ) , _converge.delta[2][0],
+			_converge.sqdist * s * s, _converge.orient * s);
+
+	if( ret && _level > 0 ) {
+		_level--;
+		return 0;
+	}
+	return ret;
 }
 
 
@@ -1807,6 +4700,7 @@ int optimize_newton::begin(void *v) {
 	// set zero
 	_var.likelihood = 0;
 	_points.clear();
+	begin_pyramid_level();
 	return 0;
 }
 
@@ -1821,23 +4715,11 @@ int optimize_newton::begin(void *v) {
 inline
 int optimize_newton::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1> *p, double *l) {
 	double likelihood = 0;
-	uint64_t pi;
 	matrix::fixed<3,1> grad;
 	matrix::fixed<3,3> hess;
 
-	// ---> scanning loop of reflection points
-	for( pi = 0; pi < _points.size(); pi++ ){
-		double l;
-		matrix::fixed<3,1> g;
-		matrix::fixed<3,3> h;
-
-		// compute likelihood, gradient, hessian
-		_newton_method_variables_( _points[pi][0][0], _points[pi][1][0], &_coordm, _map, &l, &g, &h );
-		// summation
-		likelihood += l;
-		add(&grad, &g, &grad);
-		add(&hess, &h, &hess);
-	} // <--- scanning loop of reflection points
+	// compute summation of likelihood, gradient, hessian
+	scan_newton_variables( &_coordm, &likelihood, &grad, &hess );
 
 
 	{ // ---> optimization
@@ -1930,7 +4812,7 @@ int optimize_newton::_newton_method_variables_( double x, double y, matrix::fixe
 
 	// ---> scanning loop of map plane
 	for( size_t mi = 0; mi < PlaneNum; mi++){
-		pixel_t *px;
+		const pixel_t *px;
 		matrix::fixed<PosDim,1> q;
 		matrix::fixed<1,PosDim> qT_invS;		// q^t * Sigma^-1
 		matrix::fixed<1,3> qT_invS_J;			// q^t * Sigma^-1 * J
@@ -1946,7 +4828,7 @@ int optimize_newton::_newton_method_variables_( double x, double y, matrix::fixe
 			// get index of pixel
 			if( m->plane[mi].pindex( X[PosX][0], X[PosY][0], &pr, &pc ) < 0)
 				continue; // no data
-			px = m->plane[mi].pointer( pr, pc );
+			px = m->plane[mi].cpointer( pr, pc );
 			// zero weight
 			if(px->K <= 0.0)	continue;
 			// get pixel core position
@@ -2049,7 +4931,7 @@ protected:
 	/// @brief particle
 	struct particle {
 		vector::fixed_column<3> pos;	///< position
-		matrix::fixed<4,4> coordm;		///< coordinate convert matrix
+		matrix::coord2d coordm;			///< planar transform
 		double likelihood;				///< likelihood
 	};
 	/// @brief particles
@@ -2058,6 +4940,19 @@ protected:
 	queue< struct particle > _ws_resmpl;
 	// <--- particle
 
+	// ---> random
+public:
+	void random_seed(uint64_t s);
+protected:
+	/// @brief random engine of this optimizer
+	random_engine _rng;
+	/// @brief gaussian random value buffer
+	double *_ws_rnd;
+	/// @brief size of gaussian random value buffer
+	size_t _n_ws_rnd;
+	int reserve_random(size_t n);
+	// <--- random
+
 	// ---> starting value
 public:
 	/// @brief starting value of optimization
@@ -2098,7 +4993,8 @@ protected:
  * @brief constructor
  */
 inline
-optimize_monte_calro_method::optimize_monte_calro_method() {
+optimize_monte_calro_method::optimize_monte_calro_method()
+: _ws_rnd(0), _n_ws_rnd(0) {
 	return;
 }
 
@@ -2108,7 +5004,7 @@ optimize_monte_calro_method::optimize_monte_calro_method() {
  */
 inline
 optimize_monte_calro_method::optimize_monte_calro_method(map_pt m)
-: optimize_basic(m) {
+: optimize_basic(m), _ws_rnd(0), _n_ws_rnd(0) {
 	return;
 }
 
@@ -2117,6 +5013,31 @@ optimize_monte_calro_method::optimize_monte_calro_method(map_pt m)
  */
 inline
 optimize_monte_calro_method::~optimize_monte_calro_method(){
+	delete[] _ws_rnd;
+}
+
+
+/**
+ * @brief set seed of random engine
+ * @param[in] s : seed
+ */
+inline
+void optimize_monte_calro_method::random_seed(uint64_t s) {
+	_rng.seed(s);
+}
+
+/**
+ * @brief reserve gaussian random value buffer
+ * @param[in] n : number of value
+ */
+inline
+int optimize_monte_calro_method::reserve_random(size_t n) {
+	if( _n_ws_rnd < n ) {
+		delete[] _ws_rnd;
+		_n_ws_rnd = n;
+		_ws_rnd = new double[n];
+	}
+	return 0;
 }
 
 
@@ -2183,6 +5104,7 @@ int optimize_monte_calro_method::begin(void *v) {
 
 	// clear laser scanner reflection point
 	_points.clear();
+	begin_pyramid_level();
 
 	LogUnindent();
 	LogDebug("End   - mcl begin\n");
@@ -2212,27 +5134,28 @@ int optimize_monte_calro_method::init_particle( initial_parameter *v ) {
 	// set position
 	matrix::copy(&p.pos, &v->pos);
 
-	// get coordinate convert matrix
-	matrix::coordinate_converter(&p.coordm,
-			p.pos[0], p.pos[1], 0,
-			::cos(p.pos[2]), ::sin(p.pos[2]), 0,
-			 0, 0, 1);
+	// get planar transform
+	matrix::coord2d_set(&p.coordm, p.pos[0], p.pos[1], p.pos[2]);
 	particles.push_back(&p);
 
+	// gaussian random value for all particles
+	if( v->n > 1 ) {
+		reserve_random( 3 * (v->n - 1) );
+		_rng.fill_gaussian(_ws_rnd, 3 * (v->n - 1));
+	}
+
 	while ( particles.size() < v->n ){
 		// create particle according to gaussian
-		rnd[0][0] = random_gaussian(1.0);
-		rnd[1][0] = random_gaussian(1.0);
-		rnd[2][0] = random_gaussian(1.0);
+		double *r = _ws_rnd + 3 * (particles.size() - 1);
+		rnd[0][0] = r[0];
+		rnd[1][0] = r[1];
+		rnd[2][0] = r[2];
 		matrix::prod(&L, &rnd, &p.pos);
 		// add average
 		matrix::add(&p.pos, &v->pos, &p.pos);
 
-		// get coordinate convert matrix
-		matrix::coordinate_converter(&p.coordm,
-				p.pos[0], p.pos[1], 0,
-				::cos(p.pos[2]), ::sin(p.pos[2]), 0,
-				 0, 0, 1);
+		// get planar transform
+		matrix::coord2d_set(&p.coordm, p.pos[0], p.pos[1], p.pos[2]);
 
 		particles.push_back(&p);
 	}
@@ -2259,8 +5182,7 @@ int optimize_monte_calro_method::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,
 	LogIndent();
 
 	{ // ---> operate
-		uint32_t i, j;
-		double lk = 0;
+		uint32_t i;
 		double sum;
 		double max;
 		size_t imax;
@@ -2270,22 +5192,13 @@ int optimize_monte_calro_method::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,
 
 		matrix::set_zero(&delta);
 		sum = 0;
-		for( j = 0; j < _points.size(); j++ ){
-			matrix::fixed<4,1> p;
-
-			p[0][0] = _points[j][0][0];
-			p[1][0] = _points[j][1][0];
-			p[2][0] = 0;
-			p[3][0] = 1;
-
-			for(size_t i = 0; i < (unsigned)particles.size(); i++){
-				matrix::fixed<4,1> x;
-
-				matrix::prod( &particles[i].coordm,  &p, &x );
-
-				opsm::likelihood(_map, x[0][0], x[1][0], &lk);
-				particles[i].likelihood += lk;
-			}
+		reserve_hypothesis(particles.size());
+		for( i = 0; i < (unsigned)particles.size(); i++ ){
+			_ws_hyp.c[i] = &particles[i].coordm;
+		}
+		scan_likelihood( _ws_hyp.c, particles.size(), _ws_hyp.l );
+		for( i = 0; i < (unsigned)particles.size(); i++ ){
+			particles[i].likelihood += _ws_hyp.l[i];
 		} // ---> loop for compute likelihood
 
 
@@ -2354,7 +5267,7 @@ int optimize_monte_calro_method::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,
 
 			// ---> select particle considering its likelihood
 			while( _ws_resmpl.size() < _v.n ) {
-				double lrand = sum * random_uniform();
+				double lrand = sum * _rng.uniform();
 
 				// select sample
 				for( i = 0; i < particles.size() - 1 && lrand > 0; i++ )
@@ -2376,22 +5289,23 @@ int optimize_monte_calro_method::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,
 
 			// set max
 			particles.push_back(&_ws_resmpl[0]);
+			// gaussian random value for all resampled particles
+			reserve_random( 3 * _ws_resmpl.size() );
+			_rng.fill_gaussian(_ws_rnd, 3 * (_ws_resmpl.size() - particles.size()));
 			// resample
 			for( i = particles.size(); i < _ws_resmpl.size(); i++ ) {
 				// random
-				ws3x1[0] = random_gaussian(1.0);
-				ws3x1[1] = random_gaussian(1.0);
-				ws3x1[2] = random_gaussian(1.0);
+				double *r = _ws_rnd + 3 * (i - 1);
+				ws3x1[0] = r[0];
+				ws3x1[1] = r[1];
+				ws3x1[2] = r[2];
 
 				matrix::prod( &_v.var_rsmp, &ws3x1, &p.pos );
 				LogVerbosef("rand : %.4lf, %.4lf, %.4lf\n", p.pos[0], p.pos[1], p.pos[2] );
 				matrix::add( &p.pos, &_ws_resmpl[i].pos, &p.pos );
 
-				// get coordinate convert matrix
-				matrix::coordinate_converter(&p.coordm,
-						p.pos[0], p.pos[1], 0,
-						::cos(p.pos[2]), ::sin(p.pos[2]), 0,
-						 0, 0, 1);
+				// get planar transform
+				matrix::coord2d_set(&p.coordm, p.pos[0], p.pos[1], p.pos[2]);
 
 				// set
 				particles.push_back(&p);
@@ -2468,7 +5382,7 @@ protected:
 	/// @brief particle
 	struct particle {
 		vector::fixed_column<3> pos;		///< position
-		matrix::fixed<4,4> coordm;	///< coordinate convert matrix
+		matrix::coord2d coordm;		///< planar transform
 		double likelihood;			///< likelihood
 	};
 	/// @brief particles
@@ -2621,6 +5535,7 @@ int optimize_quasi_monte_calro::begin(void *v) {
 
 	// clear laser scanner reflection point
 	_points.clear();
+	begin_pyramid_level();
 	::memcpy( &_v, varp, sizeof(_v) );
 
 	return 0;
@@ -2651,19 +5566,13 @@ int optimize_quasi_monte_calro::create_particle(initial_parameter *v) {
 	// set 0
 	p.likelihood = 0;
 	matrix::set_zero(&p.pos);
-	matrix::coordinate_converter(&p.coordm,
-			p.pos[0] + v->pos[0], p.pos[1] + v->pos[1], 0,
-			::cos(p.pos[2] + v->pos[2]), ::sin(p.pos[2] + v->pos[2]), 0,
-			 0, 0, 1);
+	matrix::coord2d_set(&p.coordm, p.pos[0] + v->pos[0], p.pos[1] + v->pos[1], p.pos[2] + v->pos[2]);
 	particles.push_back(&p);
 
 	// ---> scanning loop for Table
 	for( i = 0; i < table.size(); i++ ){
 		prod(&L, table + i, &p.pos);
-		matrix::coordinate_converter(&p.coordm,
-				p.pos[0] + v->pos[0], p.pos[1] + v->pos[1], 0,
-				::cos(p.pos[2] + v->pos[2]), ::sin(p.pos[2] + v->pos[2]), 0,
-				 0, 0, 1);
+		matrix::coord2d_set(&p.coordm, p.pos[0] + v->pos[0], p.pos[1] + v->pos[1], p.pos[2] + v->pos[2]);
 		LogVerbosef("%.04lf %.04lf %.04lf\n", p.pos[0], p.pos[1], p.pos[2]);
 		particles.push_back(&p);
 	} // <--- scanning loop for SphereTable
@@ -2688,7 +5597,6 @@ int optimize_quasi_monte_calro::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1
 	gnd_error(particles.size() == 0, -1, "no data" );
 
 	{ // ---> operate
-		double lk = 0;
 		double sum;
 		matrix::fixed<3,1> delta;
 		matrix::fixed<3,1> ws3x1;
@@ -2696,25 +5604,13 @@ int optimize_quasi_monte_calro::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1
 		set_zero(&delta);
 		sum = 0;
 		// ---> loop for compute likelihood
+		reserve_hypothesis(particles.size());
 		for(size_t i = 0; i < (unsigned)particles.size(); i++){
-			particles[i].likelihood = 0;
+			_ws_hyp.c[i] = &particles[i].coordm;
 		}
-		for(size_t j = 0; j < (unsigned)_points.size(); j++ ){
-			matrix::fixed<4,1> p;
-
-			p[0][0] = _points[j][0][0];
-			p[1][0] = _points[j][1][0];
-			p[2][0] = 0;
-			p[3][0] = 1;
-
-			for(size_t i = 0; i < (unsigned)particles.size(); i++){
-				matrix::fixed<4,1> x;
-
-				matrix::prod( &particles[i].coordm,  &p, &x );
-
-				opsm::likelihood(_map, x[0][0], x[1][0], &lk);
-				particles[i].likelihood += lk;
-			}
+		scan_likelihood( _ws_hyp.c, particles.size(), _ws_hyp.l );
+		for(size_t i = 0; i < (unsigned)particles.size(); i++){
+			particles[i].likelihood = _ws_hyp.l[i];
 		} // ---> loop for compute likelihood
 		for(size_t i = 0; i < (unsigned)particles.size(); i++){
 			sum += particles[i].likelihood;
@@ -2862,7 +5758,7 @@ inline
 int optimize_hybrid_qmc2newton::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1> *p, double *l){
 
 	{ // ---> operate
-		double lk, likelihood = 0;
+		double likelihood = 0;
 		double sum;
 		matrix::fixed<3,1> delta;
 		matrix::fixed<3,1> ws3x1;
@@ -2874,22 +5770,13 @@ int optimize_hybrid_qmc2newton::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1
 
 			LogVerbose("     : qmc2newton - quasi-monte-calro:\n");
 			// ---> loop for compute likelihood
+			reserve_hypothesis(particles.size());
 			for(size_t i = 0; i < (unsigned)particles.size(); i++){
-				particles[i].likelihood = 0;
-				for(size_t j = 0; j < (unsigned)_points.size(); j++ ){
-					matrix::fixed<4,1> x;
-					matrix::fixed<4,1> X;
-
-					x[0][0] = _points[j][0][0];
-					x[1][0] = _points[j][1][0];
-					x[2][0] = 0;
-					x[3][0] = 1;
-
-					prod( &particles[i].coordm,  &x, &X );
-
-					opsm::likelihood(_map, X[0][0], X[1][0], &lk);
-					particles[i].likelihood += lk;
-				}
+				_ws_hyp.c[i] = &particles[i].coordm;
+			}
+			scan_likelihood( _ws_hyp.c, particles.size(), _ws_hyp.l );
+			for(size_t i = 0; i < (unsigned)particles.size(); i++){
+				particles[i].likelihood = _ws_hyp.l[i];
 				sum += particles[i].likelihood;
 				matrix::scalar_prod( &particles[i].pos, particles[i].likelihood, &ws3x1 );
 				add(&delta, &ws3x1, &delta);
@@ -2922,7 +5809,6 @@ int optimize_hybrid_qmc2newton::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1
 		// ---> newton's method
 		else {
 			int ret;
-			uint64_t pi;
 			matrix::fixed<3,1> grad;
 			matrix::fixed<3,3> hess;
 			matrix::fixed<4,4> coordm;
@@ -2934,19 +5820,8 @@ int optimize_hybrid_qmc2newton::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1
 					::cos(_v.pos[2]), ::sin(_v.pos[2]), 0,
 					 0, 0, 1);
 
-			// ---> scanning loop of reflection points
-			for( pi = 0; pi < _points.size(); pi++ ){
-				matrix::fixed<3,1> g;
-				matrix::fixed<3,3> h;
-
-				// compute likelihood, gradient, hessian
-				optimize_newton::_newton_method_variables_( _points[pi][0][0], _points[pi][1][0], &coordm, _map, &lk, &g, &h );
-
-				// summation
-				likelihood += lk;
-				add( &grad, &g, &grad );
-				add( &hess, &h, &hess );
-			} // <--- scanning loop of reflection points
+			// compute summation of likelihood, gradient, hessian
+			scan_newton_variables( &coordm, &likelihood, &grad, &hess );
 
 			// modified newton's method for unconstrained minimizer
 			if( (ret = optimize::newtons_method_unconstrainted( &grad, &hess, &delta )) < 0)
@@ -2966,8 +5841,8 @@ int optimize_hybrid_qmc2newton::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1
 		// output delta
 		if( d )	matrix::copy( d, &delta );
 
-		// select qmc or neton's method
-		if( !converge_test( gnd_square( _converge.delta[0][0] ) + gnd_square( _converge.delta[1][0] ) , _converge.delta[2][0],
+		// select qmc or neton's method (quasi monte calro method on coarse level of map pyramid)
+		if( _level > 0 || !converge_test( gnd_square( _converge.delta[0][0] ) + gnd_square( _converge.delta[1][0] ) , _converge.delta[2][0],
 				gnd_square( gnd_m2dist(0.001) ), gnd_deg2ang(1)) ) {
 			// quasi monte calro method
 			particles.clear();
@@ -2985,6 +5860,433 @@ int optimize_hybrid_qmc2newton::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1
 }
 };
 
+
+// ---> class definition
+namespace gnd {
+namespace opsm {
+
+/**
+ * @ingroup GNDPSM
+ * @brief correlative scan matching optimizer (branch and bound)
+ * @details search exhaustively the (x, y, theta) window around starting value for the global optimum of
+ * likelihood field (grid of half map pixel size, see build_bnb_field()).
+ * the translation is searched by branch and bound on max-pooled likelihood field
+ * (level k pixel is the max of 2^k x 2^k pixels of level 0), whose score is the upper bound of all translations in the block.
+ * the search is finished in one iteration.
+ */
+class optimize_branch_and_bound : public optimize_basic {
+
+	// ---> type declaration
+public:
+	/// map type
+	typedef opsm::map_t		map_t;
+	/// map type pointer
+	typedef map_t*			map_pt;
+	/// pixel type
+	typedef opsm::pixel_t	pixel_t;
+	/// pixel type pointer
+	typedef pixel_t*		pixel_pt;
+
+	/// @brief starting value of optimization
+	typedef struct initial_parameter {
+		vector::fixed_column<3>	pos;	///<! position
+		double					dist;	///<! half width of search window (distance)
+		double					orient;	///<! half width of search window (orient)
+		initial_parameter();
+	} initial_parameter;
+	// <--- type declaration
+
+	// ---> constructor, destructor
+public:
+	optimize_branch_and_bound();
+	optimize_branch_and_bound(map_pt m);
+	~optimize_branch_and_bound();
+	// <--- constructor, destructor
+
+	// ---> variables
+protected:
+	/// @brief starting value
+	initial_parameter _v;
+	/// @brief max-pooled likelihood field built by this optimizer (used if external field is not set)
+	bnb_field_t _own_field;
+	/// @brief max-pooled likelihood field reference (built outside, see set_field())
+	bnb_field_t *_ext_field;
+	/// @brief max-pooled likelihood field in use
+	bnb_field_t *_field;
+	/// @brief pixel index of reflection points of each orientation (row)
+	int32_t *_ws_row;
+	/// @brief pixel index of reflection points of each orientation (column)
+	int32_t *_ws_col;
+	/// @brief allocated size of pixel index workspace
+	size_t _ws_n;
+
+	/// @brief search candidate
+	struct candidate {
+		long dx;		///< translation x (pixel)
+		long dy;		///< translation y (pixel)
+		size_t o;		///< orientation index
+		uint64_t score;	///< score (upper bound on coarse level)
+	};
+	/// @brief search state
+	struct search_state {
+		long wx;				///< half width of window x (pixel)
+		long wy;				///< half width of window y (pixel)
+		size_t n;				///< number of reflection points
+		struct candidate best;	///< best candidate
+	};
+	// <--- variables
+
+	// ---> starting value of optimization
+public:
+	virtual int initial_parameter_create(void** p);
+	virtual int initial_parameter_delete(void** p);
+	virtual int initial_parameter_set_position(void* p, double x, double y, double theta);
+	// <--- starting value of optimization
+
+	// ---> optimization
+public:
+	virtual int begin(void *v);
+	virtual int iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1> *p, double *l);
+	int set_field(bnb_field_t *f);
+	// <--- optimization
+
+private:
+	uint64_t _score_(size_t lv, const int32_t *r, const int32_t *c, size_t n, long dx, long dy);
+	int _branch_(struct search_state *s, struct candidate *cnd, size_t lv);
+	static int _candidate_cmp_(const void *a, const void *b);
+};
+
+
+/**
+ * @brief constructor
+ */
+inline
+optimize_branch_and_bound::optimize_branch_and_bound()
+: _ext_field(0), _field(0), _ws_row(0), _ws_col(0), _ws_n(0)
+{
+}
+
+/**
+ * @brief constructor
+ * @param[in] m : map
+ */
+inline
+optimize_branch_and_bound::optimize_branch_and_bound(map_pt m)
+: optimize_basic(m), _ext_field(0), _field(0), _ws_row(0), _ws_col(0), _ws_n(0)
+{
+}
+
+/**
+ * @brief destructor
+ */
+inline
+optimize_branch_and_bound::~optimize_branch_and_bound()
+{
+	delete[] _ws_row;
+	delete[] _ws_col;
+	destroy_bnb_field(&_own_field);
+}
+
+
+/**
+ * @brief create starting value
+ * @param[in,out] p : starting value buffer pointer
+ */
+inline
+int optimize_branch_and_bound::initial_parameter_create(void** p) {
+	*p = static_cast<void*>( new initial_parameter );
+	return 0;
+}
+
+/**
+ * @brief delete starting value
+ * @param[in,out] p : starting value
+ */
+inline
+int optimize_branch_and_bound::initial_parameter_delete(void** p) {
+	initial_parameter* pp = static_cast<initial_parameter*>( *p );
+	delete pp;
+	*p = 0;
+	return 0;
+}
+
+/**
+ * @brief set starting value
+ * @param[in]     p : starting value
+ * @param[in]     x : robot position x
+ * @param[in]     y : robot position y
+ * @param[in] theta : robot position theta
+ */
+inline
+int optimize_branch_and_bound::initial_parameter_set_position(void* p, double x, double y, double theta) {
+	initial_parameter *pp = static_cast<initial_parameter*>(p);
+	pp->pos[0] = x;
+	pp->pos[1] = y;
+	pp->pos[2] = theta;
+	return 0;
+}
+
+/**
+ * @brief input starting value
+ * @param[in] v : starting value
+ */
+inline
+int optimize_branch_and_bound::begin(void *v) {
+	gnd_assert(!v, -1, "invalid null argument");
+
+	::memcpy( &_v, v, sizeof(_v) );
+	_points.clear();
+	return 0;
+}
+
+/**
+ * @brief set max-pooled likelihood field
+ * @param[in] f : field pointer (null: build by itself from the map)
+ * @return  0 :
+ * @details if it is set, the field is used instead of building it in iterate(),
+ * so that it can be built out of the loop of scan matching (e.g. with the map on background thread).
+ * it have to be rebuilt when the map is changed.
+ */
+inline
+int optimize_branch_and_bound::set_field(bnb_field_t *f) {
+	_ext_field = f;
+	return 0;
+}
+
+
+/**
+ * @brief optimization iterate
+ * @param[out] d : difference
+ * @param[out] p : pos
+ * @param[out] l : score (mean of normalized likelihood field of reflection points, 0 to 1)
+ * @return    0 :
+ */
+inline
+int optimize_branch_and_bound::iterate(matrix::fixed<3,1> *d, matrix::fixed<3,1> *p, double *l) {
+	gnd_error(_points.size() == 0, -1, "no scan data" );
+
+	if( _ext_field && _ext_field->level[0].is_allocate() ) {
+		_field = _ext_field;
+	}
+	else {
+		gnd_assert(!_map, -1, "map is null");
+		// build on demand when the map is changed
+		if( _own_field.map != _map || _own_field.revision != _map->revision || !_own_field.level[0].is_allocate() ) {
+			if( build_bnb_field(&_own_field, _map) < 0 ) return -1;
+		}
+		_field = &_own_field;
+	}
+
+	LogDebug("Begin - bnb iterate\n");
+	LogIndent();
+
+	{ // ---> operation
+		const double rsl = _field->level[0].xrsl();
+		const size_t n = _points.size();
+		struct search_state s;
+		size_t no;
+		double ostep;
+		size_t lv;
+
+		{ // ---> orientation step
+			double dmax = 0;
+			for( size_t j = 0; j < n; j++ ){
+				double dd = gnd_square(_points[j][0][0]) + gnd_square(_points[j][1][0]);
+				if( dmax < dd ) dmax = dd;
+			}
+			dmax = ::sqrt(dmax);
+			// the farthest point moves about a pixel
+			ostep = dmax > rsl ? ::acos( 1.0 - gnd_square(rsl) / (2 * gnd_square(dmax)) ) : ::fabs(_v.orient);
+			if( ostep <= 0 || ::fabs(_v.orient) < ostep ) {
+				no = 1;
+				ostep = 0;
+			}
+			else {
+				size_t h = (size_t) ::ceil( ::fabs(_v.orient) / ostep );
+				ostep = ::fabs(_v.orient) / h;
+				no = 2 * h + 1;
+			}
+		} // <--- orientation step
+
+		// ---> pixel index of reflection points for each orientation
+		if( _ws_n < no * n ) {
+			delete[] _ws_row;
+			delete[] _ws_col;
+			_ws_n = no * n;
+			_ws_row = new int32_t[_ws_n];
+			_ws_col = new int32_t[_ws_n];
+		}
+		for( size_t o = 0; o < no; o++ ){
+			const double t = _v.pos[2] + ((double)o - (no - 1) / 2) * ostep;
+			const double cs = ::cos(t), sn = ::sin(t);
+			for( size_t j = 0; j < n; j++ ){
+				double x = cs * _points[j][0][0] - sn * _points[j][1][0] + _v.pos[0];
+				double y = sn * _points[j][0][0] + cs * _points[j][1][0] + _v.pos[1];
+				_ws_row[o * n + j] = (int32_t) ::floor( (y - _field->level[0].ylower()) / rsl );
+				_ws_col[o * n + j] = (int32_t) ::floor( (x - _field->level[0].xlower()) / rsl );
+			}
+		} // <--- pixel index of reflection points for each orientation
+
+		s.wx = (long) ::ceil( ::fabs(_v.dist) / rsl );
+		s.wy = s.wx;
+		s.n = n;
+		s.best.dx = 0;
+		s.best.dy = 0;
+		s.best.o = (no - 1) / 2;
+		s.best.score = 0;
+
+		// coarsest level to cover the window
+		lv = 0;
+		while( lv < BnBLevelNum - 1 && (1L << lv) < 2 * s.wx + 1 ) lv++;
+
+		{ // ---> branch and bound
+			const long st = 1L << lv;
+			const long m = (2 * s.wx + st) / st;
+			struct candidate *root = new struct candidate[no * m * m];
+			size_t nr = 0;
+
+			for( size_t o = 0; o < no; o++ ){
+				for( long dy = -s.wy; dy <= s.wy; dy += st ){
+					for( long dx = -s.wx; dx <= s.wx; dx += st ){
+						root[nr].o = o;
+						root[nr].dx = dx;
+						root[nr].dy = dy;
+						root[nr].score = _score_(lv, _ws_row + o * n, _ws_col + o * n, n, dx, dy);
+						nr++;
+					}
+				}
+			}
+			::qsort(root, nr, sizeof(root[0]), _candidate_cmp_);
+
+			for( size_t j = 0; j < nr && root[j].score > s.best.score; j++ ){
+				_branch_(&s, root + j, lv);
+			}
+			delete[] root;
+		} // <--- branch and bound
+
+		{ // ---> set output
+			matrix::fixed<3,1> delta;
+
+			delta[0][0] = s.best.dx * rsl;
+			delta[1][0] = s.best.dy * rsl;
+			delta[2][0] = ((double)s.best.o - (no - 1) / 2) * ostep;
+			LogDebugf("     : bnb - delta = (%lf, %lf, %lf):\n", delta[0][0], delta[1][0], delta[2][0]);
+
+			// search is finished in one iteration
+			set_zero(&_converge.delta);
+
+			if( d ) copy(d, &delta);
+			_v.pos[0] += delta[0][0];
+			_v.pos[1] += delta[1][0];
+			_v.pos[2] += delta[2][0];
+			if( p ) {
+				(*p)[0][0] = _v.pos[0];
+				(*p)[1][0] = _v.pos[1];
+				(*p)[2][0] = _v.pos[2];
+			}
+			if( l ) *l = (double) s.best.score / (0xffff * (double) n);
+		} // <--- set output
+	} // <--- operation
+
+	LogUnindent();
+	LogDebug("End   - bnb iterate\n");
+	return 0;
+}
+
+/**
+ * @privatesection
+ * @brief score of a translation on a level
+ * @param[in] lv : level
+ * @param[in]  r : pixel index of reflection points (row)
+ * @param[in]  c : pixel index of reflection points (column)
+ * @param[in]  n : number of reflection points
+ * @param[in] dx : translation x (pixel)
+ * @param[in] dy : translation y (pixel)
+ * @return sum of field value
+ */
+inline
+uint64_t optimize_branch_and_bound::_score_(size_t lv, const int32_t *r, const int32_t *c, size_t n, long dx, long dy) {
+	const long row = _field->level[lv].row();
+	const long col = _field->level[lv].column();
+	const long w = 1L << lv;
+	const uint16_t *f = _field->level[lv].pointer(0, 0);
+	uint64_t sum = 0;
+
+	for( size_t j = 0; j < n; j++ ){
+		long rr = r[j] + dy;
+		long cc = c[j] + dx;
+		// the block [rr, rr + w) x [cc, cc + w) of level 0 may be partly in the field.
+		// clamp to the border pixel, which covers the inside part, so that the score is still upper bound
+		if( rr + w <= 0 || rr >= row || cc + w <= 0 || cc >= col ) continue;
+		if( rr < 0 ) rr = 0;
+		if( cc < 0 ) cc = 0;
+		sum += f[rr * col + cc];
+	}
+	return sum;
+}
+
+/**
+ * @privatesection
+ * @brief depth first search of a candidate
+ * @param[in,out] s : search state
+ * @param[in]   cnd : candidate (score is computed on level lv)
+ * @param[in]    lv : level
+ */
+inline
+int optimize_branch_and_bound::_branch_(struct search_state *s, struct candidate *cnd, size_t lv) {
+	if( lv == 0 ) {
+		if( cnd->score > s->best.score ) s->best = *cnd;
+		return 0;
+	}
+
+	{ // ---> branch
+		const long st = 1L << (lv - 1);
+		struct candidate child[4];
+		size_t nc = 0;
+
+		for( long b = 0; b < 2; b++ ){
+			for( long a = 0; a < 2; a++ ){
+				struct candidate *p = child + nc;
+				p->dx = cnd->dx + a * st;
+				p->dy = cnd->dy + b * st;
+				p->o = cnd->o;
+				if( p->dx > s->wx || p->dy > s->wy ) continue;
+				p->score = _score_(lv - 1, _ws_row + p->o * s->n, _ws_col + p->o * s->n, s->n, p->dx, p->dy);
+				nc++;
+			}
+		}
+		::qsort(child, nc, sizeof(child[0]), _candidate_cmp_);
+
+		// bound
+		for( size_t j = 0; j < nc && child[j].score > s->best.score; j++ ){
+			_branch_(s, child + j, lv - 1);
+		}
+	} // <--- branch
+	return 0;
+}
+
+/**
+ * @privatesection
+ * @brief compare candidates (descending order of score)
+ */
+inline
+int optimize_branch_and_bound::_candidate_cmp_(const void *a, const void *b) {
+	const struct candidate *ca = static_cast<const struct candidate*>(a);
+	const struct candidate *cb = static_cast<const struct candidate*>(b);
+	return ca->score < cb->score ? 1 : ca->score > cb->score ? -1 : 0;
+}
+
+
+inline
+optimize_branch_and_bound::initial_parameter::initial_parameter(){
+	dist = gnd_m2dist(0.5);
+	orient = gnd_deg2ang(20);
+}
+}
+};
+// <--- class definition
+
+
 #include "gnd-debug-log-util-undef.h"
 
 // <--- class function definition
@@ -12,19 +12,104 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <time.h>
+#include <math.h>
+#include <string.h>
 #include "gnd-matrix-base.hpp"
 #include "gnd-vector-base.hpp"
 
-#define __gnd_random_set_seed__()	(srand(time(0)))
-#define __gnd_random_uniform__()	((double)rand() / RAND_MAX)
+#define __gnd_random_set_seed__()	(gnd::random_default_engine()->seed( (uint64_t)::time(0) ))
+#define __gnd_random_uniform__()	(gnd::random_default_engine()->uniform())
+
+
+// ---> class declaration
+namespace gnd {
+	/**
+	 * @brief pseudo random number generator (xoshiro256+)
+	 * @note not thread safe. give each thread (or each object) its own engine,
+	 *       and use split() to derive non-overlapping streams from one seed.
+	 */
+	class random_engine {
+	public:
+		/// @brief default seed
+		static const uint64_t DefaultSeed = 0x2011062300000000ULL;
+
+		// ---> constructor
+	public:
+		random_engine();
+		random_engine(uint64_t s);
+		// <--- constructor
+
+		// ---> variables
+	private:
+		/// @brief state
+		uint64_t _s[4];
+		/// @brief spare gaussian value (polar method generates a pair)
+		double _spare;
+		/// @brief spare gaussian value is valid
+		bool _has_spare;
+		// <--- variables
+
+		// ---> seed
+	public:
+		void seed(uint64_t s);
+		void jump();
+		void split(random_engine *dest);
+		// <--- seed
+
+		// ---> generate
+	public:
+		uint64_t next();
+		double uniform();
+		double gaussian(const double sigma);
+		int fill_uniform(double *v, const size_t n);
+		int fill_gaussian(double *v, const size_t n, const double sigma = 1.0);
+		// <--- generate
+
+	private:
+		static uint64_t _rotl_(const uint64_t x, const int k);
+	};
+
+	/**
+	 * @brief multi-dimension gaussian sampler
+	 * @note the covariance is factorized once by set(), then any number of values are drawn from it.
+	 * @tparam D : dimension
+	 */
+	template < uint32_t D >
+	class gaussian_sampler {
+		// ---> constructor
+	public:
+		gaussian_sampler();
+		// <--- constructor
+
+		// ---> variables
+	private:
+		/// @brief cholesky factor (lower triangle, row major)
+		double _l[D * D];
+		/// @brief factor is set
+		bool _valid;
+		// <--- variables
+
+	public:
+		template < typename MTRX >
+		int set(MTRX *cov);
+		int sample(random_engine *e, double *out, const size_t n = 1) const;
+	};
+} // <--- class declaration
+
 
 // ---> function declaration
 namespace gnd {
+	inline
+	random_engine* random_default_engine( void );
+
 	inline
 	void random_set_seed( void );
 
+	inline
+	void random_set_seed( uint64_t s );
+
 	/**
-	 * @brief generate randam value [0;1] with uniform probability
+	 * @brief generate randam value [0;1) with uniform probability
 	 */
 	inline
 	double random_uniform( void );
@@ -42,6 +127,13 @@ namespace gnd {
 	inline
 	int random_gaussian_mult(MTRX1 *cov, const size_t n, MTRX2 *ws, MTRX3 *out);
 
+	/*
+	 * @brief generate random value following a gaussian distribution (multi-dimension)
+	 */
+	template < typename MTRX1, typename MTRX2, typename MTRX3 >
+	inline
+	int random_gaussian_mult(random_engine *e, MTRX1 *cov, const size_t n, MTRX2 *ws, MTRX3 *out);
+
 	/*
 	 * @brief generate random value following a gaussian distribution (multi-dimension)
 	 */
@@ -58,10 +150,295 @@ namespace gnd {
 } // <--- function declaration
 
 
+// ---> class definition
+namespace gnd {
+
+	/**
+	 * @brief constructor (default seed)
+	 */
+	inline
+	random_engine::random_engine() {
+		seed(DefaultSeed);
+	}
+
+	/**
+	 * @brief constructor
+	 * @param[in] s : seed
+	 */
+	inline
+	random_engine::random_engine(uint64_t s) {
+		seed(s);
+	}
+
+	/**
+	 * @brief set seed
+	 * @param[in] s : seed
+	 * @note state is expanded from the seed by splitmix64, same seed gives same sequence
+	 */
+	inline
+	void random_engine::seed(uint64_t s) {
+		int i;
+
+		for( i = 0; i < 4; i++ ) {
+			uint64_t z;
+			s += 0x9e3779b97f4a7c15ULL;
+			z = s;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			_s[i] = z ^ (z >> 31);
+		}
+		_has_spare = false;
+		_spare = 0;
+	}
+
+	/**
+	 * @brief advance the state by 2^128 steps
+	 */
+	inline
+	void random_engine::jump() {
+		static const uint64_t j[4] = {
+				0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+				0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+		uint64_t t[4] = {0, 0, 0, 0};
+		int i, b;
+
+		for( i = 0; i < 4; i++ ) {
+			for( b = 0; b < 64; b++ ) {
+				if( j[i] & (1ULL << b) ) {
+					t[0] ^= _s[0];
+					t[1] ^= _s[1];
+					t[2] ^= _s[2];
+					t[3] ^= _s[3];
+				}
+				next();
+			}
+		}
+		_s[0] = t[0];
+		_s[1] = t[1];
+		_s[2] = t[2];
+		_s[3] = t[3];
+		_has_spare = false;
+	}
+
+	/**
+	 * @brief derive an independent stream
+	 * @param[out] dest : engine that takes over the current stream
+	 * @note this engine jumps ahead 2^128 steps, so the streams never overlap
+	 */
+	inline
+	void random_engine::split(random_engine *dest) {
+		*dest = *this;
+		dest->_has_spare = false;
+		jump();
+	}
+
+	inline
+	uint64_t random_engine::_rotl_(const uint64_t x, const int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+	/**
+	 * @brief generate 64bit random value
+	 */
+	inline
+	uint64_t random_engine::next() {
+		const uint64_t r = _s[0] + _s[3];
+		const uint64_t t = _s[1] << 17;
+
+		_s[2] ^= _s[0];
+		_s[3] ^= _s[1];
+		_s[1] ^= _s[2];
+		_s[0] ^= _s[3];
+		_s[2] ^= t;
+		_s[3] = _rotl_(_s[3], 45);
+		return r;
+	}
+
+	/**
+	 * @brief generate random value [0;1) with uniform probability
+	 */
+	inline
+	double random_engine::uniform() {
+		// upper 53bit (lower bits of xoshiro256+ are weak)
+		return (next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	/**
+	 * @brief generate random value following a gaussian distribution (polar method)
+	 * @param [in] sigma : standard deviation
+	 */
+	inline
+	double random_engine::gaussian(const double sigma) {
+		double x, y, r, f;
+
+		if( _has_spare ) {
+			_has_spare = false;
+			return sigma * _spare;
+		}
+
+		do {
+			x = - 1 + 2 * uniform();
+			y = - 1 + 2 * uniform();
+
+			r = x * x + y * y;
+		} while( r >= 1.0 || r == 0 );
+
+		f = ::sqrt(-2.0 * ::log(r) / r);
+		_spare = x * f;
+		_has_spare = true;
+		return sigma * y * f;
+	}
+
+	/**
+	 * @brief fill buffer with random value [0;1)
+	 * @param[out] v : buffer
+	 * @param[in]  n : number of value
+	 */
+	inline
+	int random_engine::fill_uniform(double *v, const size_t n) {
+		size_t i;
+
+		gnd_assert(!v, -1, "null pointer");
+		for( i = 0; i < n; i++ )
+			v[i] = (next() >> 11) * (1.0 / 9007199254740992.0);
+		return 0;
+	}
+
+	/**
+	 * @brief fill buffer with random value following a gaussian distribution
+	 * @param[out]    v : buffer
+	 * @param[in]     n : number of value
+	 * @param[in] sigma : standard deviation
+	 * @note polar method, both values of each accepted pair are stored
+	 */
+	inline
+	int random_engine::fill_gaussian(double *v, const size_t n, const double sigma) {
+		size_t i = 0;
+
+		gnd_assert(!v, -1, "null pointer");
+
+		if( n > 0 && _has_spare ) {
+			v[i++] = gaussian(sigma);
+		}
+		while( i + 1 < n ) {
+			double x, y, r, f;
+
+			x = - 1 + 2 * uniform();
+			y = - 1 + 2 * uniform();
+			r = x * x + y * y;
+			if( r >= 1.0 || r == 0 ) continue;
+
+			f = sigma * ::sqrt(-2.0 * ::log(r) / r);
+			v[i] = x * f;
+			v[i + 1] = y * f;
+			i += 2;
+		}
+		if( i < n ) v[i] = gaussian(sigma);
+		return 0;
+	}
+
+
+	/**
+	 * @brief constructor
+	 */
+	template < uint32_t D >
+	inline
+	gaussian_sampler<D>::gaussian_sampler() : _valid(false) {
+		::memset(_l, 0, sizeof(_l));
+	}
+
+	/**
+	 * @brief set covariance
+	 * @param[in] cov : covariance matrix (D x D, not modified)
+	 * @details positive semidefinite covariance is accepted. components of zero pivot
+	 * (e.g. zero variance) are skipped, and they get no random value.
+	 * @return <0 : covariance is not positive semidefinite
+	 */
+	template < uint32_t D >
+	template < typename MTRX >
+	inline
+	int gaussian_sampler<D>::set(MTRX *cov) {
+		double tol = 0;
+		uint32_t r, c, k;
+
+		gnd_assert(!cov, -1, "null pointer");
+
+		_valid = false;
+		::memset(_l, 0, sizeof(_l));
+		// tolerance of zero pivot (relative to the largest variance)
+		for( r = 0; r < D; r++ ) {
+			if( tol < _gnd_matrix_ref_(cov, r, r) ) tol = _gnd_matrix_ref_(cov, r, r);
+		}
+		tol *= 1.0e-12;
+
+		// ---> cholesky decomposition (lower triangle)
+		for( c = 0; c < D; c++ ) {
+			double d = _gnd_matrix_ref_(cov, c, c);
+
+			for( k = 0; k < c; k++ ) d -= _l[c * D + k] * _l[c * D + k];
+			if( d < -tol )	return -1;
+			// zero pivot, this component is a linear combination of the others
+			if( d <= tol )	continue;
+
+			_l[c * D + c] = ::sqrt(d);
+			for( r = c + 1; r < D; r++ ) {
+				double a = _gnd_matrix_ref_(cov, r, c);
+
+				for( k = 0; k < c; k++ ) a -= _l[r * D + k] * _l[c * D + k];
+				_l[r * D + c] = a / _l[c * D + c];
+			}
+		} // <--- cholesky decomposition (lower triangle)
+		_valid = true;
+		return 0;
+	}
+
+	/**
+	 * @brief generate random value following the gaussian distribution
+	 * @param[in]  e : random engine
+	 * @param[out] out : random value (n x D, row major)
+	 * @param[in]  n : number of random vector
+	 */
+	template < uint32_t D >
+	inline
+	int gaussian_sampler<D>::sample(random_engine *e, double *out, const size_t n) const {
+		size_t i;
+		int r, c;
+
+		gnd_assert(!e || !out, -1, "null pointer");
+		gnd_assert(!_valid, -1, "covariance is not set");
+
+		// standard normal values
+		e->fill_gaussian(out, n * D);
+		// multiply the factor in place, from the last component (row r refers only components 0 to r)
+		for( i = 0; i < n; i++ ) {
+			double *v = out + i * D;
+			for( r = D - 1; r >= 0; r-- ) {
+				double sum = 0;
+				for( c = 0; c <= r; c++ ) sum += _l[r * D + c] * v[c];
+				v[r] = sum;
+			}
+		}
+		return 0;
+	}
+
+} // <--- class definition
+
+
 namespace gnd {// ---> namespace gnd
 
 	/**
-	 * @brief set random seed
+	 * @brief engine used by the functions without engine argument
+	 * @note shared by every caller, not thread safe.
+	 *       it starts from random_engine::DefaultSeed, so runs are reproducible unless random_set_seed() is called.
+	 */
+	inline
+	random_engine* random_default_engine( void ) {
+		static random_engine e;
+		return &e;
+	}
+
+	/**
+	 * @brief set random seed (current time)
 	 */
 	inline
 	void random_set_seed( void ) {
@@ -69,7 +446,16 @@ namespace gnd {// ---> namespace gnd
 	}
 
 	/**
-	 * @brief generate randam value [0;1] with uniform probability
+	 * @brief set random seed
+	 * @param[in] s : seed
+	 */
+	inline
+	void random_set_seed( uint64_t s ) {
+		random_default_engine()->seed(s);
+	}
+
+	/**
+	 * @brief generate randam value [0;1) with uniform probability
 	 */
 	inline
 	double random_uniform( void ) {
@@ -79,22 +465,13 @@ namespace gnd {// ---> namespace gnd
 
 
 	/**
-	 * @brief generate random value following a gaussian distribution (box-muller method)
+	 * @brief generate random value following a gaussian distribution (polar method)
 	 * @param [in] sigma : standard deviation
 	 */
 	inline
 	double random_gaussian(const double sigma)
 	{
-		double x, y, r;
-
-		do {
-			x = - 1 + 2 * random_uniform();
-			y = - 1 + 2 * random_uniform();
-
-			r = x * x + y * y;
-		} while( r > 1.0 || r == 0 );
-
-		return sigma * y * sqrt(-2.0 * log(r) / r);
+		return random_default_engine()->gaussian(sigma);
 	}
 
 
@@ -105,7 +482,22 @@ namespace gnd {// ---> namespace gnd
 	inline
 	int random_gaussian_mult(MTRX1 *cov, const size_t n, MTRX2 *ws, MTRX3 *out)
 	{
-		gnd_assert(!cov || !out , -1, "null pointer");
+		return random_gaussian_mult(random_default_engine(), cov, n, ws, out);
+	}
+
+	/**
+	 * @brief generate random value following a gaussian distribution (multi-dimension)
+	 * @param[in]     e : random engine
+	 * @param[in,out] cov : covariance (overwritten by its cholesky factor)
+	 * @param[in]     n : dimension
+	 * @param[out]   ws : workspace
+	 * @param[out]  out : random value
+	 */
+	template < typename MTRX1, typename MTRX2, typename MTRX3 >
+	inline
+	int random_gaussian_mult(random_engine *e, MTRX1 *cov, const size_t n, MTRX2 *ws, MTRX3 *out)
+	{
+		gnd_assert(!e || !cov || !out , -1, "null pointer");
 		gnd_assert(_gnd_matrix_row_(cov) < n, -1, "invalid matrix property");
 		gnd_assert(_gnd_matrix_column_(cov) < n, -1,  "invalid matrix property");
 		gnd_assert(_gnd_vector_size_(out) < n, -1, "invalid matrix property");
@@ -116,7 +508,7 @@ namespace gnd {// ---> namespace gnd
 			size_t i;
 
 			for(i = 0; i < n; i++)
-				_gnd_matrix_ref_(ws, 0, i) = random_gaussian(1.0);
+				_gnd_matrix_ref_(ws, 0, i) = e->gaussian(1.0);
 		} // <--- initial
 
 		{ // ---> operation
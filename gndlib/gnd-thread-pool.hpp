@@ -0,0 +1,276 @@
+/*
+ * gnd-thread-pool.hpp
+ *
+ *  persistent worker thread pool (fork-join)
+ */
+
+#ifndef GND_THREAD_POOL_HPP_
+#define GND_THREAD_POOL_HPP_
+
+#include <stddef.h>
+#include <pthread.h>
+#include "gnd-lib-error.h"
+
+
+/**
+ * @ifnot GNDTHREAD
+ * @defgroup GNDTHREAD thread
+ * supply persistent worker thread pool (fork-join)
+ * this module need to link libpthread, so you link with -lpthread
+ * @endif
+ */
+
+// ---> type declaration
+namespace gnd {
+	/**
+	 * @ingroup GNDTHREAD
+	 * @brief task function of thread pool
+	 * @param[in,out] a : argument
+	 * @param[in]     i : thread index (0 is the caller thread)
+	 * @param[in]     n : number of threads
+	 */
+	typedef void (*thread_task_t)(void *a, int i, int n);
+
+	/**
+	 * @ingroup GNDTHREAD
+	 * @brief persistent worker thread pool
+	 * @details run() execute a task on all threads (caller thread is index 0)
+	 * and return after all of them have finished.
+	 * threads are created in begin() and kept until end().
+	 */
+	class thread_pool {
+		// ---> constructor, destructor
+	public:
+		thread_pool();
+		~thread_pool();
+		// <--- constructor, destructor
+
+		// ---> variables
+	private:
+		struct worker {
+			thread_pool *pool;		///< pool
+			int index;				///< thread index
+			pthread_t thread;		///< thread
+		};
+		/// @brief worker threads (n - 1)
+		struct worker *_workers;
+		/// @brief number of threads (include caller thread)
+		int _n;
+		/// @brief mutex
+		pthread_mutex_t _mutex;
+		/// @brief condition for task start
+		pthread_cond_t _cond_start;
+		/// @brief condition for task finish
+		pthread_cond_t _cond_finish;
+		/// @brief task generation
+		unsigned long _generation;
+		/// @brief number of unfinished workers
+		int _nrunning;
+		/// @brief quit flag
+		bool _quit;
+		/// @brief current task
+		thread_task_t _task;
+		/// @brief current task argument
+		void *_arg;
+		// <--- variables
+
+	public:
+		int begin(int n);
+		int end();
+		int size() const;
+		int run(thread_task_t f, void *a);
+		static int partition(size_t total, int i, int n, size_t *b, size_t *e);
+	private:
+		static void* _worker_main_(void *a);
+	};
+}
+// <--- type declaration
+
+
+
+// ---> function definition
+namespace gnd {
+
+	/**
+	 * @brief constructor
+	 */
+	inline
+	thread_pool::thread_pool()
+	: _workers(0), _n(1), _generation(0), _nrunning(0), _quit(false), _task(0), _arg(0)
+	{
+		::pthread_mutex_init(&_mutex, 0);
+		::pthread_cond_init(&_cond_start, 0);
+		::pthread_cond_init(&_cond_finish, 0);
+	}
+
+	/**
+	 * @brief destructor
+	 */
+	inline
+	thread_pool::~thread_pool()
+	{
+		end();
+		::pthread_cond_destroy(&_cond_finish);
+		::pthread_cond_destroy(&_cond_start);
+		::pthread_mutex_destroy(&_mutex);
+	}
+
+	/**
+	 * @brief create worker threads
+	 * @param[in] n : number of threads (include caller thread)
+	 * @return ==0 : success
+	 * @return  <0 : fail
+	 */
+	inline
+	int thread_pool::begin(int n)
+	{
+		gnd_assert(n < 1, -1, "invalid argument");
+		gnd_assert(_workers, -1, "thread pool is busy");
+
+		{ // ---> operation
+			_quit = false;
+			_n = 1;
+			_generation = 0;
+			if( n == 1 ) return 0;
+
+			_workers = new struct worker[n - 1];
+			for( int i = 0; i < n - 1; i++ ){
+				_workers[i].pool = this;
+				_workers[i].index = i + 1;
+				if( ::pthread_create(&_workers[i].thread, 0, _worker_main_, _workers + i) != 0 ){
+					// fail to create thread
+					end();
+					return -1;
+				}
+				_n++;
+			}
+		} // <--- operation
+		return 0;
+	}
+
+	/**
+	 * @brief join worker threads
+	 */
+	inline
+	int thread_pool::end()
+	{
+		if( !_workers )	return 0;
+
+		{ // ---> operation
+			::pthread_mutex_lock(&_mutex);
+			_quit = true;
+			::pthread_cond_broadcast(&_cond_start);
+			::pthread_mutex_unlock(&_mutex);
+
+			for( int i = 0; i < _n - 1; i++ ){
+				::pthread_join(_workers[i].thread, 0);
+			}
+			delete[] _workers;
+			_workers = 0;
+			_n = 1;
+		} // <--- operation
+		return 0;
+	}
+
+	/**
+	 * @brief number of threads (include caller thread)
+	 */
+	inline
+	int thread_pool::size() const
+	{
+		return _n;
+	}
+
+	/**
+	 * @brief execute a task on all threads and wait for finish
+	 * @param[in] f : task
+	 * @param[in] a : task argument
+	 */
+	inline
+	int thread_pool::run(thread_task_t f, void *a)
+	{
+		gnd_assert(!f, -1, "invalid null pointer");
+
+		if( _n == 1 ) {
+			f(a, 0, 1);
+			return 0;
+		}
+
+		{ // ---> start
+			::pthread_mutex_lock(&_mutex);
+			_task = f;
+			_arg = a;
+			_nrunning = _n - 1;
+			_generation++;
+			::pthread_cond_broadcast(&_cond_start);
+			::pthread_mutex_unlock(&_mutex);
+		} // <--- start
+
+		// caller thread
+		f(a, 0, _n);
+
+		{ // ---> wait for finish
+			::pthread_mutex_lock(&_mutex);
+			while( _nrunning > 0 ) ::pthread_cond_wait(&_cond_finish, &_mutex);
+			::pthread_mutex_unlock(&_mutex);
+		} // <--- wait for finish
+		return 0;
+	}
+
+	/**
+	 * @brief partition of index range for a thread
+	 * @param[in] total : number of elements
+	 * @param[in]     i : thread index
+	 * @param[in]     n : number of threads
+	 * @param[out]    b : begin index
+	 * @param[out]    e : end index (not include)
+	 */
+	inline
+	int thread_pool::partition(size_t total, int i, int n, size_t *b, size_t *e)
+	{
+		gnd_assert(!b || !e, -1, "invalid null pointer");
+		gnd_assert(n < 1 || i < 0 || i >= n, -1, "invalid argument");
+
+		*b = total * i / n;
+		*e = total * (i + 1) / n;
+		return 0;
+	}
+
+	/**
+	 * @brief worker thread main
+	 */
+	inline
+	void* thread_pool::_worker_main_(void *a)
+	{
+		struct worker *w = static_cast<struct worker*>(a);
+		thread_pool *p = w->pool;
+		unsigned long gen = 0;
+
+		::pthread_mutex_lock(&p->_mutex);
+		for( ;; ) {
+			thread_task_t f;
+			void *arg;
+			int n;
+
+			// wait for task
+			while( !p->_quit && p->_generation == gen ) ::pthread_cond_wait(&p->_cond_start, &p->_mutex);
+			if( p->_quit ) break;
+			gen = p->_generation;
+			f = p->_task;
+			arg = p->_arg;
+			n = p->_n;
+			::pthread_mutex_unlock(&p->_mutex);
+
+			f(arg, w->index, n);
+
+			::pthread_mutex_lock(&p->_mutex);
+			if( --p->_nrunning == 0 ) ::pthread_cond_signal(&p->_cond_finish);
+		}
+		::pthread_mutex_unlock(&p->_mutex);
+		return 0;
+	}
+}
+// <--- function definition
+
+
+#endif /* GND_THREAD_POOL_HPP_ */
@@ -10,6 +10,9 @@
 
 #include <time.h>
 #include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <limits.h>
 #include "gnd-lib-error.h"
 #include "gnd-util.h"
@@ -335,7 +338,7 @@ namespace gnd {
 
 
 		/**
-		 * @brief wait (block)
+		 * @brief get time
 		 * @param [out] t : time from timer beginning
 		 * @param [out] l : time from previous record
 		 */
@@ -349,7 +352,7 @@ namespace gnd {
 				if( (ret = ::clock_gettime(property.clock, &ws) ) < 0 )	return ret;
 				if( t ) *t = gnd_timespec2time( &ws ) - gnd_timespec2time( &var.beginning );
 				if( l ) *l = gnd_timespec2time( &ws ) - gnd_timespec2time( &var.prev_rec );
-				::memcpy(&ws, &var.prev_rec, sizeof(ws));
+				::memcpy(&var.prev_rec, &ws, sizeof(ws));
 			}
 
 			return 0;
@@ -375,4 +378,241 @@ namespace gnd {
 
 
 
+// ---> latency histogram
+namespace gnd {
+	namespace timer {
+
+		/**
+		 * @brief latency histogram
+		 * @details log-linear buckets like hdr-histogram.
+		 * values are counted in microseconds, the range of each power of two is divided into SubBucket buckets,
+		 * so that the relative error of percentiles is less than 1 / SubBucket for any value up to hours.
+		 * recording is constant time and the histogram never allocates memory.
+		 */
+		class histogram {
+			// ---> constant
+		public:
+			/// @brief number of sub-bucket bits
+			static const int SubBucketBits = 4;
+			/// @brief number of buckets in each power of two
+			static const int SubBucket = 1 << SubBucketBits;
+			/// @brief maximum exponent (2^36 [usec] = 19 [hour])
+			static const int ShiftMax = 36;
+			/// @brief number of buckets
+			static const int Size = (ShiftMax + 2) * SubBucket;
+			// <--- constant
+
+			// ---> constructor, destructor
+		public:
+			histogram();
+			~histogram();
+			// <--- constructor, destructor
+
+			// ---> variables
+		private:
+			/// @brief bucket counter
+			uint64_t _bucket[Size];
+			/// @brief number of records
+			uint64_t _n;
+			/// @brief sum of records [sec]
+			double _sum;
+			/// @brief minimum record [sec]
+			double _min;
+			/// @brief maximum record [sec]
+			double _max;
+			// <--- variables
+
+		public:
+			int clear();
+			int record(double t);
+			int merge(const histogram *src);
+			uint64_t count() const;
+			double mean() const;
+			double min() const;
+			double max() const;
+			double percentile(double p) const;
+			int print(FILE *fp, const char *name, const char *head = "") const;
+			int txtlog(FILE *fp, double t, const char *name) const;
+		private:
+			static int _index_(uint64_t v);
+			static double _value_(int i);
+		};
+
+
+		/**
+		 * @brief constructor
+		 */
+		inline
+		histogram::histogram() {
+			clear();
+		}
+
+		/**
+		 * @brief destructor
+		 */
+		inline
+		histogram::~histogram() {
+		}
+
+		/**
+		 * @brief clear records
+		 */
+		inline
+		int histogram::clear() {
+			::memset(_bucket, 0, sizeof(_bucket));
+			_n = 0;
+			_sum = 0;
+			_min = 0;
+			_max = 0;
+			return 0;
+		}
+
+		/**
+		 * @brief bucket index of a value
+		 * @param[in] v : value [usec]
+		 */
+		inline
+		int histogram::_index_(uint64_t v) {
+			int shift = 0;
+
+			if( v < (uint64_t) SubBucket ) return (int) v;
+			// v = (SubBucket + sub) << shift
+			while( (v >> shift) >= (uint64_t) (SubBucket << 1) ) shift++;
+			if( shift > ShiftMax ) return Size - 1;
+			return (shift + 1) * SubBucket + (int) ((v >> shift) - SubBucket);
+		}
+
+		/**
+		 * @brief representative value (middle) of a bucket [usec]
+		 * @param[in] i : bucket index
+		 */
+		inline
+		double histogram::_value_(int i) {
+			int shift;
+
+			if( i < SubBucket ) return i + 0.5;
+			shift = i / SubBucket - 1;
+			return ( (double) (SubBucket + i % SubBucket) + 0.5 ) * ( (uint64_t) 1 << shift );
+		}
+
+		/**
+		 * @brief record a value
+		 * @param[in] t : latency [sec]
+		 */
+		inline
+		int histogram::record(double t) {
+			if( t < 0 ) t = 0;
+			_bucket[ _index_( (uint64_t) (t * 1.0e6) ) ]++;
+			if( _n == 0 || t < _min ) _min = t;
+			if( _n == 0 || t > _max ) _max = t;
+			_sum += t;
+			_n++;
+			return 0;
+		}
+
+		/**
+		 * @brief add records of another histogram
+		 * @param[in] src : histogram
+		 */
+		inline
+		int histogram::merge(const histogram *src) {
+			gnd_assert(!src, -1, "invalid null pointer");
+			if( src->_n == 0 ) return 0;
+
+			for( int i = 0; i < Size; i++ ) _bucket[i] += src->_bucket[i];
+			if( _n == 0 || src->_min < _min ) _min = src->_min;
+			if( _n == 0 || src->_max > _max ) _max = src->_max;
+			_sum += src->_sum;
+			_n += src->_n;
+			return 0;
+		}
+
+		/**
+		 * @brief number of records
+		 */
+		inline
+		uint64_t histogram::count() const {
+			return _n;
+		}
+
+		/**
+		 * @brief mean [sec]
+		 */
+		inline
+		double histogram::mean() const {
+			return _n ? _sum / _n : 0.0;
+		}
+
+		/**
+		 * @brief minimum [sec]
+		 */
+		inline
+		double histogram::min() const {
+			return _min;
+		}
+
+		/**
+		 * @brief maximum [sec]
+		 */
+		inline
+		double histogram::max() const {
+			return _max;
+		}
+
+		/**
+		 * @brief percentile
+		 * @param[in] p : percentile (0 to 100)
+		 * @return value [sec]
+		 */
+		inline
+		double histogram::percentile(double p) const {
+			uint64_t rank, sum = 0;
+
+			if( _n == 0 ) return 0.0;
+			if( p >= 100 ) return _max;
+			rank = (uint64_t) ( (p < 0 ? 0 : p) / 100.0 * _n );
+			for( int i = 0; i < Size; i++ ) {
+				sum += _bucket[i];
+				if( sum > rank ) {
+					double v = _value_(i) * 1.0e-6;
+					// bucket middle may be out of recorded range
+					return v < _min ? _min : (v > _max ? _max : v);
+				}
+			}
+			return _max;
+		}
+
+		/**
+		 * @brief print summary (for cui)
+		 * @param[out]  fp : output stream
+		 * @param[in] name : name
+		 * @param[in] head : line head
+		 */
+		inline
+		int histogram::print(FILE *fp, const char *name, const char *head) const {
+			return ::fprintf(fp, "%s%16s : %8lu, mean %.03lf, 50%% %.03lf, 95%% %.03lf, 99%% %.03lf, max %.03lf [msec]\n",
+					head, name, (unsigned long) _n, mean() * 1.0e3,
+					percentile(50) * 1.0e3, percentile(95) * 1.0e3, percentile(99) * 1.0e3, _max * 1.0e3);
+		}
+
+		/**
+		 * @brief write summary into text log
+		 * @param[out]  fp : output stream
+		 * @param[in]    t : time
+		 * @param[in] name : name (no space)
+		 * @details 1.[time] 2.[name] 3.[count] 4.[mean] 5.[50%] 6.[95%] 7.[99%] 8.[max] (msec)
+		 */
+		inline
+		int histogram::txtlog(FILE *fp, double t, const char *name) const {
+			return ::fprintf(fp, "%lf %s %lu %lf %lf %lf %lf %lf\n",
+					t, name, (unsigned long) _n, mean() * 1.0e3,
+					percentile(50) * 1.0e3, percentile(95) * 1.0e3, percentile(99) * 1.0e3, _max * 1.0e3);
+		}
+
+	} // <--- namespace timer
+} // <--- namespace gnd
+// <--- latency histogram
+
+
+
 #endif /* GND_TIME_HPP_ */
@@ -25,6 +25,7 @@
 
 int main(int argc, char* argv[], char* env[]) {
 	SSMScanPoint2D						ssm_sokuiki_raw;	// laser scanner raw data
+	ssm::ScanPoint2DBeamCache			sokuiki_beam;		// laser scanner beam unit vector cache
 	SSMSOKUIKIData3D					ssm_sokuiki_fs;		// laser scanner data on robot coordinate
 	SSMSOKUIKIData3D					ssm_sokuiki_gl;		// laser scanner data on global coordinate
 	SSMApi<Spur_Odometry> 				ssm_position;		// position data for global coordinate convert
@@ -94,6 +95,7 @@ int main(int argc, char* argv[], char* env[]) {
 				gnd::matrix::fixed<4,4> ws;
 				// allocate
 				ssm_sokuiki_raw.data.alloc(ssm_sokuiki_raw.property.numPoints);
+				sokuiki_beam.set(ssm_sokuiki_raw.property);
 
 				ssm_sokuiki_raw.readLast();
 
@@ -278,6 +280,8 @@ int main(int argc, char* argv[], char* env[]) {
 			// ---> get sokuiki raw and coordinate convert
 			if( ssm_sokuiki_raw.readNext() ) {
 				cnt_scan++;
+				// update beam unit vector
+				sokuiki_beam.refresh( &ssm_sokuiki_raw.data );
 
 				// ---> scanning loop (sokuiki raw)
 				for( int i = 0; i < (signed)ssm_sokuiki_raw.data.numPoints(); i++ ) {
@@ -287,8 +291,8 @@ int main(int argc, char* argv[], char* env[]) {
 						{ // ---> coordinate convert
 							gnd::vector::fixed_column<4> point_sns, point_fs;
 
-							point_sns[0] = ssm_sokuiki_raw.data[i].r * ::cos( ssm_sokuiki_raw.data[i].th );
-							point_sns[1] = ssm_sokuiki_raw.data[i].r * ::sin( ssm_sokuiki_raw.data[i].th );
+							point_sns[0] = ssm_sokuiki_raw.data[i].r * sokuiki_beam.unitX(i);
+							point_sns[1] = ssm_sokuiki_raw.data[i].r * sokuiki_beam.unitY(i);
 							point_sns[2] = 0;
 							point_sns[3] = 1;
 
@@ -313,45 +317,31 @@ int main(int argc, char* argv[], char* env[]) {
 
 				// global cooridnate convert
 				if( pconf.gl_name.value[0] && pconf.gl_pos_name.value[0] && ssm_position.readTime( ssm_sokuiki_raw.time) ){
-					gnd::vector::fixed_column<4> ws, org_gl;
-					gnd::coord_matrix cm;
+					double org_gl[3];
+					gnd::matrix::coord2d cm;
 
-					gnd::matrix::coordinate_converter(&cm,
-							ssm_position.data.x, ssm_position.data.y, 0,
-							::cos(ssm_position.data.theta), ::sin(ssm_position.data.theta), 0,
-							 0, 0, 1);
+					// robot position is planar, so that z is not changed
+					gnd::matrix::coord2d_set(&cm, ssm_position.data.x, ssm_position.data.y, ssm_position.data.theta);
 
 					{ // origin
-						ws[0] = ssm_sokuiki_raw.property.coordm[0][3];
-						ws[1]= ssm_sokuiki_raw.property.coordm[1][3];
-						ws[2] = ssm_sokuiki_raw.property.coordm[2][3];
-						ws[3] = 1.0;
-
-						gnd::matrix::prod(&cm, &ws, &org_gl );
+						gnd::matrix::coord2d_convert(&cm,
+								ssm_sokuiki_raw.property.coordm[0][3], ssm_sokuiki_raw.property.coordm[1][3],
+								org_gl + 0, org_gl + 1);
+						org_gl[2] = ssm_sokuiki_raw.property.coordm[2][3];
 					} // origin
 
 
 
 					// ---> scanning loop (sokuiki raw)
 					for( int i = 0; i < (signed)ssm_sokuiki_raw.data.numPoints(); i++ ) {
-						gnd::vector::fixed_column<4> point_sns, point_gl;
-
 						ssm_sokuiki_gl.data[i].status = ssm_sokuiki_raw.data[i].status;
 
 						if( !ssm_sokuiki_gl.data[i].isError() && ssm_sokuiki_gl.data[i].status != ssm::laser::STATUS_NO_REFLECTION) {
 							{ // ---> coordinate convert
-								gnd::vector::fixed_column<4> point_sns, point_gl;
-
-								point_sns[0] = ssm_sokuiki_fs.data[i].reflect.x;
-								point_sns[1] = ssm_sokuiki_fs.data[i].reflect.y;
-								point_sns[2] = ssm_sokuiki_fs.data[i].reflect.z;
-								point_sns[3] = 1;
-
-								gnd::matrix::prod(&cm, &point_sns, &point_gl);
-
-								ssm_sokuiki_gl.data[i].reflect.x = point_gl[0];
-								ssm_sokuiki_gl.data[i].reflect.y = point_gl[1];
-								ssm_sokuiki_gl.data[i].reflect.z = point_gl[2];
+								gnd::matrix::coord2d_convert(&cm,
+										ssm_sokuiki_fs.data[i].reflect.x, ssm_sokuiki_fs.data[i].reflect.y,
+										&ssm_sokuiki_gl.data[i].reflect.x, &ssm_sokuiki_gl.data[i].reflect.y);
+								ssm_sokuiki_gl.data[i].reflect.z = ssm_sokuiki_fs.data[i].reflect.z;
 							} // <--- coordinate convert
 
 							{ // ---> set value of other kind
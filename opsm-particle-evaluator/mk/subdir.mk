@@ -18,7 +18,11 @@ else
 ifeq ($(MAKECMDGOALS),clean-debug)
 RELEASE_DIR			:=Debug/
 else
+ifeq ($(MAKECMDGOALS),replay)
+RELEASE_DIR			:=Replay/
+else
 RELEASE_DIR			:=Release/
 endif
 endif
+endif
 
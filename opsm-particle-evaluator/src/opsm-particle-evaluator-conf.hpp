@@ -71,6 +71,13 @@ namespace opsm {
 				"load map with counting map"
 		};
 
+		// map-cache
+		static const gnd::conf::parameter_array<char, 512> ConfIni_MapCache = {
+				"map-cache-dir",
+				"",		// map cache file directory
+				"memory mapped cache of built map (empty: not use)"
+		};
+
 		// sokuiki-raw-name
 		static const gnd::conf::parameter_array<char, 512> ConfIni_SokuikiRawName = {
 				"sokuiki-raw-ssm-name",
@@ -182,6 +189,20 @@ namespace opsm {
 				0.05,
 		};
 
+		// number of threads
+		static const gnd::conf::parameter<int> ConfIni_Threads = {
+				"threads",
+				1,
+				"number of particle evaluation threads"
+		};
+
+		// latency log
+		static const gnd::conf::parameter_array<char, 512> ConfIni_LatencyLog = {
+				"latency-txtlog",
+				"",		// file name
+				"processing latency log file name (text)"
+		};
+
 	} // <--- namespace opsm
 } // <--- namespace peval
 
@@ -199,6 +220,7 @@ namespace opsm {
 			// initliaze input
 			gnd::conf::parameter_array<char, 512>	bmp_map;			///< Bit Map
 			gnd::conf::parameter_array<char, 512>	raw_map;			///< Raw Map Data
+			gnd::conf::parameter_array<char, 512>	map_cache;			///< Map Cache Directory
 			// online input output
 			gnd::conf::parameter_array<char, 512>	sokuikiraw_name;	///< Sokuiki ssm data name
 			gnd::conf::parameter<int> 				sokuikiraw_id;		///< Sokuiki ssm data id
@@ -218,6 +240,9 @@ namespace opsm {
 			gnd::conf::parameter<double>			blur;				///< scan range
 			gnd::conf::parameter<double>			scan_range;			///< scan range
 			gnd::conf::parameter<double>			mfailure;			///< matching failure rate
+			gnd::conf::parameter<int>				threads;			///< number of evaluation threads
+			// debug
+			gnd::conf::parameter_array<char, 512>	latency_log;		///< latency log
 
 			proc_configuration();
 		};
@@ -250,6 +275,7 @@ namespace opsm {
 
 			::memcpy(&conf->bmp_map,			&ConfIni_BMPMap,				sizeof(ConfIni_BMPMap));
 			::memcpy(&conf->raw_map,			&ConfIni_RawMap,				sizeof(ConfIni_RawMap));
+			::memcpy(&conf->map_cache,			&ConfIni_MapCache,				sizeof(ConfIni_MapCache));
 			::memcpy(&conf->sokuikiraw_name,	&ConfIni_SokuikiRawName,		sizeof(ConfIni_SokuikiRawName) );
 			::memcpy(&conf->sokuikiraw_id,		&ConfIni_SokuikiRawID,			sizeof(ConfIni_SokuikiRawID) );
 			::memcpy(&conf->odometry_name,		&ConfIni_OdometryName,			sizeof(ConfIni_OdometryName) );
@@ -268,6 +294,8 @@ namespace opsm {
 			::memcpy(&conf->blur,				&ConfIni_Blur,					sizeof(ConfIni_Blur));
 			::memcpy(&conf->scan_range,			&ConfIni_ScanRangeDist,			sizeof(ConfIni_ScanRangeDist));
 			::memcpy(&conf->mfailure,			&ConfIni_MatchingFailureRate,	sizeof(ConfIni_MatchingFailureRate));
+			::memcpy(&conf->threads,			&ConfIni_Threads,				sizeof(ConfIni_Threads));
+			::memcpy(&conf->latency_log,		&ConfIni_LatencyLog,			sizeof(ConfIni_LatencyLog));
 			return 0;
 		}
 
@@ -283,6 +311,7 @@ namespace opsm {
 
 			gnd::conf::get_parameter(src, &dest->bmp_map);
 			gnd::conf::get_parameter(src, &dest->raw_map);
+			gnd::conf::get_parameter(src, &dest->map_cache);
 			gnd::conf::get_parameter(src, &dest->sokuikiraw_name);
 			gnd::conf::get_parameter(src, &dest->sokuikiraw_id);
 			gnd::conf::get_parameter(src, &dest->particle_name);
@@ -298,6 +327,8 @@ namespace opsm {
 			gnd::conf::get_parameter(src, &dest->blur);
 			gnd::conf::get_parameter(src, &dest->scan_range);
 			gnd::conf::get_parameter(src, &dest->mfailure);
+			gnd::conf::get_parameter(src, &dest->threads);
+			gnd::conf::get_parameter(src, &dest->latency_log);
 			if( gnd::conf::get_parameter(src, &dest->sleeping_orient) >= 0 ){
 				// convert unit of angle(deg2rad)
 				dest->sleeping_orient.value = gnd_deg2rad(dest->sleeping_orient.value);
@@ -318,6 +349,7 @@ namespace opsm {
 
 			gnd::conf::set_parameter(dest, &src->bmp_map);
 			gnd::conf::set_parameter(dest, &src->raw_map);
+			gnd::conf::set_parameter(dest, &src->map_cache);
 			gnd::conf::set_parameter(dest, &src->sokuikiraw_name);
 			gnd::conf::set_parameter(dest, &src->sokuikiraw_id);
 			gnd::conf::set_parameter(dest, &src->odometry_name);
@@ -341,6 +373,8 @@ namespace opsm {
 			gnd::conf::set_parameter(dest, &src->blur);
 			gnd::conf::set_parameter(dest, &src->scan_range);
 			gnd::conf::set_parameter(dest, &src->mfailure);
+			gnd::conf::set_parameter(dest, &src->threads);
+			gnd::conf::set_parameter(dest, &src->latency_log);
 			return 0;
 		}
 
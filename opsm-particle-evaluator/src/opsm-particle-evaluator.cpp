@@ -25,26 +25,186 @@
 #include "gnd-bmp.hpp"
 #include "gnd-gridmap.hpp"
 #include "gnd-coord-tree.hpp"
+#include "gnd-thread-pool.hpp"
+#include "gnd-mapped-file.hpp"
 #include "gnd-shutoff.hpp"
 
+namespace opsm {
+	namespace peval {
+		/// @brief map cache file name (likelihood map)
+		static const char MapCacheFileName[] = "eval-map.mmap";
+		/// @brief map cache file name (view map)
+		static const char ViewCacheFileName[] = "view-map.mmap";
+		/// @brief map cache file type tag (likelihood map)
+		static const char MapCacheType[] = "peval-bmp32";
+		/// @brief map cache file type tag (view map)
+		static const char ViewCacheType[] = "peval-bmp8";
+
+		/**
+		 * @brief particle evaluation task
+		 */
+		struct eval_task {
+			const particle_view *particles;			///< particles (record on shared memory)
+			ssm::ScanPoint2DPoints *points;			///< laser scanner reflection points (filtered, on sensor coordinate)
+			gnd::bmp32_t *map;						///< map
+			gnd::mapped_plane<uint32_t> *mapped;	///< map on mapped cache file (used instead of map if not null)
+			gnd::matrix::coord2d *coordm_sns2rt;	///< sensor to robot planar transform
+			gnd::thread_pool *pool;					///< evaluation threads
+			particle_evaluation *eval;				///< evaluation (output)
+			uint32_t nalloc;						///< allocated size of evaluation
+			gnd::timer::stopwatch *sw;				///< stage stopwatch
+			gnd::timer::histogram *lat_read;		///< latency of particle reading
+		};
+
+		template < typename T >
+		void eval_particles(eval_task *task, size_t begin, size_t end);
+		template < typename T, typename M >
+		void eval_particles(eval_task *task, M *map, size_t begin, size_t end);
+
+		/**
+		 * @brief evaluate particles assigned to a thread
+		 * @param[in,out] a : task (eval_task)
+		 * @param[in]     t : thread index
+		 * @param[in]    nt : number of threads
+		 * @note each particle evaluation is independent, so the result is identical with any number of threads
+		 */
+		void eval_task_main(void *a, int t, int nt) {
+			eval_task *task = static_cast<eval_task*>(a);
+			size_t begin = 0, end = 0;
+
+			gnd::thread_pool::partition(task->particles->n, t, nt, &begin, &end);
+			if( task->particles->layout == PARTICLE_LAYOUT_SOA_FLOAT )	eval_particles<float>(task, begin, end);
+			else														eval_particles<double>(task, begin, end);
+		}
+
+		/**
+		 * @brief evaluate particles (select map)
+		 * @param[in,out] task : task
+		 * @param[in]    begin : begin index of particles
+		 * @param[in]      end : end index of particles (not include)
+		 */
+		template < typename T >
+		void eval_particles(eval_task *task, size_t begin, size_t end) {
+			if( task->mapped )	eval_particles<T>(task, task->mapped, begin, end);
+			else				eval_particles<T>(task, task->map, begin, end);
+		}
+
+		/**
+		 * @brief evaluate particles record on shared memory
+		 * @param[in]     v : particles
+		 * @param[in,out] a : task (eval_task)
+		 * @note called while reading the record, particles are not copied
+		 */
+		void eval_view(const particle_view *v, void *a) {
+			eval_task *task = static_cast<eval_task*>(a);
+			double lap = 0;
+
+			// ---> reallocate
+			if( task->nalloc < v->n ){
+				if( task->eval->value )	delete[] task->eval->value;
+				task->eval->value = new double[v->n];
+				task->nalloc = v->n;
+			}// ---> reallocate
+			task->eval->n = v->n;
+			if( task->sw->get(0, &lap) == 0 )	task->lat_read->record(lap);
+
+			task->particles = v;
+			task->pool->run(eval_task_main, task);
+			task->particles = 0;
+		}
+
+		/**
+		 * @brief evaluate particles
+		 * @param[in,out] task : task
+		 * @param[in]      map : map (gridplane or mapped_plane)
+		 * @param[in]    begin : begin index of particles
+		 * @param[in]      end : end index of particles (not include)
+		 * @note T is the component type of the particles record, pose is read from its columns
+		 */
+		template < typename T, typename M >
+		void eval_particles(eval_task *task, M *map, size_t begin, size_t end) {
+			size_t step = 0;
+			const T *px = task->particles->column<T>(PARTICLE_X, &step);
+			const T *py = task->particles->column<T>(PARTICLE_Y, &step);
+			const T *ptheta = task->particles->column<T>(PARTICLE_THETA, &step);
+
+			if( !px || !py || !ptheta ) {
+				for( size_t i = begin ; i < end; i++ )	task->eval->value[i] = 0;
+				return;
+			}
+			// ---> scanning loop (particle)
+			for( size_t i = begin ; i < end; i++ ) {
+				gnd::matrix::coord2d cm_sn2gl = {1, 0, 0, 0};
+
+				{ // ---> set particle coordinate
+					gnd::matrix::coord2d cm = {1, 0, 0, 0};
+
+					if( gnd::matrix::coord2d_set(&cm, px[i * step], py[i * step], ptheta[i * step]) < 0 ||
+							gnd::matrix::coord2d_prod(&cm, task->coordm_sns2rt, &cm_sn2gl) < 0 ) {
+						task->eval->value[i] = 0;
+						continue;
+					}
+				} // <--- set particle coordinate
+
+
+				{ // ---> particle evaluation with laser scanner reading
+					double eval = 0;
+					int cnt = 0;
+
+					// ---> scanning loop (sokuiki data)
+					for( uint32_t j = 0; j < task->points->numPoints(); j++ ) {
+						double x, y;
+						const uint32_t *p;
+
+						// coordinate convert from sensor coordinate to global coordinate
+						gnd::matrix::coord2d_convert(&cm_sn2gl, task->points->x[j], task->points->y[j], &x, &y);
+
+						// read only access (called from several threads)
+						if( (p = map->pcpointer(x, y)) ){
+							eval += (double) *p;
+						}
+						cnt++;
+					} // <--- scanning loop (sokuiki data)
+
+					// normalization
+					if(eval < 0 || cnt <= 0)	eval = 0;
+					else 				eval = (eval / (double) (0x8000 * cnt ));
+
+					task->eval->value[i] = eval;
+				} // <--- particle evaluation with laser scanner reading
+			} // <--- scanning loop (particle)
+		}
+	}
+}
+
 int main(int argc, char *argv[], char **env) {
 	gnd::opsm::map_t 		opsm_map;
 	gnd::bmp32_t			map;			// map
+	gnd::mapped_plane<uint32_t>	map_cache;	// map on mapped cache file
+	gnd::bmp8_t				view_map;		// map for displaying
+	gnd::gridmap::gridplane<double>	bmp_ws;	// workspace of bitmap building (shared by likelihood and view map)
 
 	SSMApi<Spur_Odometry>	ssm_odometry;	//
 	SSMScanPoint2D			ssm_sokuikiraw;	// ssm sokuiki raw data
+	ssm::ScanPoint2DBeamCache	sokuiki_beam;	// sokuiki beam unit vector cache
+	ssm::ScanPoint2DFilter		sokuiki_filter;	// sokuiki reflection point filter
+	ssm::ScanPoint2DPoints		sokuiki_pts;	// sokuiki reflection points (filtered, on sensor coordinate)
 	SSMParticles			ssm_particles;	// ssm particles
 	SSMParticleEvaluation	ssm_evaluation;	// ssm evaluation
 
 	gnd::matrix::coord_tree coordtree;
-	int coordid_gl = -1,
-			coordid_rt = -1,
+	int coordid_rt = -1,
 			coordid_sns = -1;
+	gnd::matrix::coord2d		coordm_sns2rt;	// sensor to robot planar transform
+
+	gnd::thread_pool				tpool;			// evaluation threads
+	opsm::peval::eval_task			etask;			// evaluation task
 
 
 	opsm::peval::proc_configuration pconf;	// process configuration
 	opsm::peval::proc_option_reader popt;	// process option
 	gnd::cui_reader					pcui;	// cui
+	FILE							*lat_fp = 0;	// latency log
 
 
 	{ // ---> initialize
@@ -92,13 +252,54 @@ int main(int argc, char *argv[], char **env) {
 				::fprintf(stderr, " ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to read map data\n");
 			}
 			else {
-				if( gnd::opsm::build_map(&opsm_map, &cnt_map, pconf.blur.value, pconf.scan_range.value) < 0 ) {
+				uint64_t key = 0;
+				char map_path[1024] = "";
+				char view_path[1024] = "";
+				gnd::mapped_plane<unsigned char> view_cache;
+
+				// ---> open map cache
+				if( pconf.map_cache.value[0] != '\0' ) {
+					// key of counting map and map building parameters
+					double prm[3] = { pconf.blur.value, pconf.scan_range.value, gnd_m2dist( 1.0 / 20) };
+					key = gnd::opsm::counting_map_key(&cnt_map, gnd::mapped_file_checksum(prm, sizeof(prm)) );
+
+					::sprintf(map_path, "%s/%s", pconf.map_cache.value, opsm::peval::MapCacheFileName);
+					::sprintf(view_path, "%s/%s", pconf.map_cache.value, opsm::peval::ViewCacheFileName);
+					if( map_cache.open(map_path, opsm::peval::MapCacheType, key) < 0 ||
+							view_cache.open(view_path, opsm::peval::ViewCacheType, key) < 0 ) {
+						map_cache.close();
+						::fprintf(stderr, "   map cache is not available, build map\n");
+					}
+					else {
+						::fprintf(stderr, "   map cache is \"\x1b[4m%s\x1b[0m\"\n", map_path);
+					}
+				} // <--- open map cache
+
+				if( map_cache.is_allocate() ) {
+					// map is on cache file (zero-copy)
+					view_cache.copy(&view_map);
+					::fprintf(stderr, " ...\x1b[1mOK\x1b[0m\n");
+				}
+				else if( gnd::opsm::build_map(&opsm_map, &cnt_map, pconf.blur.value, pconf.scan_range.value) < 0 ) {
 					::fprintf(stderr, " ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to build map\n");
 				}
-				else if( gnd::opsm::build_bmp32(&map, &opsm_map, gnd_m2dist( 1.0 / 20)) < 0 ) {
+				else if( gnd::opsm::build_bmp32(&map, &opsm_map, gnd_m2dist( 1.0 / 20), 0.0, 4.0, &bmp_ws) < 0 ) {
 					::fprintf(stderr, " ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to convert bmp\n");
 				}
 				else {
+					// build bmp 8bit map
+					gnd::opsm::build_bmp( &view_map, &opsm_map, gnd_m2dist(1.0/10), 0.0, 4.0, &bmp_ws );
+
+					// ---> write map cache
+					if( pconf.map_cache.value[0] != '\0' ) {
+						if( gnd::write_mapped_plane(map_path, &map, opsm::peval::MapCacheType, key) < 0 ||
+								gnd::write_mapped_plane(view_path, &view_map, opsm::peval::ViewCacheType, key) < 0 ) {
+							::fprintf(stderr, "   \x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: fail to write map cache \"\x1b[4m%s\x1b[0m\"\n", pconf.map_cache.value);
+						}
+						else {
+							::fprintf(stderr, "   write map cache \"\x1b[4m%s\x1b[0m\"\n", map_path);
+						}
+					} // <--- write map cache
 					::fprintf(stderr, " ...\x1b[1mOK\x1b[0m\n");
 				}
 			}
@@ -121,11 +322,11 @@ int main(int argc, char *argv[], char **env) {
 		// ---> write map info for displaying the map
 		if( !::is_proc_shutoff() ){
 			SSMOPSMMap				ssm_map;		// ssm map (dummy)
-			gnd::bmp8_t				bmp8;
+			gnd::bmp8_t				&bmp8 = view_map;
 			char path[256];
 
 			// build bmp 8bit map
-			gnd::opsm::build_bmp( &bmp8, &opsm_map, gnd_m2dist(1.0/10) );
+			if( !bmp8.is_allocate() ) gnd::opsm::build_bmp( &bmp8, &opsm_map, gnd_m2dist(1.0/10), 0.0, 4.0, &bmp_ws );
 
 			// write 8bit map file
 			gnd_get_working_directory(env, path, sizeof(path));
@@ -182,6 +383,10 @@ int main(int argc, char *argv[], char **env) {
 			else {
 				// allocate
 				ssm_sokuikiraw.data.alloc(ssm_sokuikiraw.property.numPoints);
+				sokuiki_beam.set(ssm_sokuikiraw.property);
+				sokuiki_filter.distMin = 0.3;
+				sokuiki_filter.cull = pconf.cull.value;
+				sokuiki_filter.cullMode = ssm::ScanPoint2DFilter::CULL_ORIGIN;
 				::fprintf(stderr, "  [\x1b[1mOK\x1b[0m]: Open ssm-data \"\x1b[4m%s\x1b[0m\"\n", pconf.sokuikiraw_name.value);
 			}
 		} // <--- sokuiki data ssm open
@@ -230,7 +435,7 @@ int main(int argc, char *argv[], char **env) {
 
 			// define global coordinate
 			gnd::matrix::set_unit(&cm);
-			coordid_gl = coordtree.add("global", "root", &cm);
+			coordtree.add("global", "root", &cm);
 
 			// init robot coordinate
 			gnd::matrix::set_unit(&cm);
@@ -238,9 +443,47 @@ int main(int argc, char *argv[], char **env) {
 
 			// define sensor coordinate
 			coordid_sns = coordtree.add("sensor", "robot", &ssm_sokuikiraw.property.coordm);
+
+			// sensor to robot coordinate convert matrix
+			coordtree.get_convert_matrix(coordid_sns, coordid_rt, &coordm_sns2rt);
 		} // <--- coord tree
 
 
+		// ---> start evaluation threads
+		if( !::is_proc_shutoff() ){
+			::fprintf(stderr, "\n");
+			::fprintf(stderr, " => Start evaluation threads\n");
+			if( tpool.begin( pconf.threads.value < 1 ? 1 : pconf.threads.value ) < 0 ){
+				::fprintf(stderr, "  [\x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m]: Fail to create threads\n");
+				::proc_shutoff();
+			}
+			else {
+				etask.map = &map;
+				etask.mapped = map_cache.is_allocate() ? &map_cache : 0;
+				etask.coordm_sns2rt = &coordm_sns2rt;
+				etask.pool = &tpool;
+				etask.eval = &ssm_evaluation.data;
+				etask.nalloc = 0;
+				::fprintf(stderr, "  [\x1b[1mOK\x1b[0m]: %d threads\n", tpool.size());
+			}
+		} // <--- start evaluation threads
+
+
+		// ---> open latency log
+		if( !::is_proc_shutoff() && *pconf.latency_log.value ){
+			::fprintf(stderr, "\n");
+			::fprintf(stderr, " => Open latency log \"\x1b[4m%s\x1b[0m\"\n", pconf.latency_log.value);
+			if( !(lat_fp = ::fopen(pconf.latency_log.value, "w")) ){
+				::fprintf(stderr, "  [\x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m]: Fail to open \"\x1b[4m%s\x1b[0m\"\n", pconf.latency_log.value);
+				::proc_shutoff();
+			}
+			else {
+				::fprintf(lat_fp, "# 1.[time, s] 2.[stage] 3.[count] 4.[mean] 5.[50%%] 6.[95%%] 7.[99%%] 8.[max] (msec)\n");
+				::fprintf(stderr, "  [\x1b[1mOK\x1b[0m]: Open latency log\n");
+			}
+		} // <--- open latency log
+
+
 		// ---> initialize cui
 		if( !::is_proc_shutoff() ){
 			pcui.set_command(opsm::peval::cui_cmd, sizeof(opsm::peval::cui_cmd) / sizeof(opsm::peval::cui_cmd[0]));
@@ -252,7 +495,6 @@ int main(int argc, char *argv[], char **env) {
 
 	if( !::is_proc_shutoff() ){ // ---> operation
 		Spur_Odometry prev;				// previous position
-		uint32_t nalloc = 0;
 		double sleep_time;
 		int cnt_eval = 0;
 		int nline_show = 0;
@@ -262,6 +504,14 @@ int main(int argc, char *argv[], char **env) {
 		gnd::inttimer timer_operate;
 		gnd::inttimer timer_show;
 		gnd::inttimer timer_sleeping;
+		gnd::inttimer timer_latency;
+
+		gnd::stopwatch sw_stage;			// latency: stage stopwatch
+		gnd::timer::histogram lat_read;		// latency: particle read
+		gnd::timer::histogram lat_eval;		// latency: evaluation
+		gnd::timer::histogram lat_write;	// latency: evaluation write
+		gnd::timer::histogram lat_cycle;	// latency: whole evaluation
+		int cnt_overrun = 0;				// evaluation took longer than cycle
 
 		double cuito = 0;
 		double lh_max = 0.0;
@@ -281,6 +531,8 @@ int main(int argc, char *argv[], char **env) {
 			timer_show.begin(CLOCK_REALTIME, opsm::peval::ShowUpdateCycle, -opsm::peval::ShowUpdateCycle);
 			if( pconf.sleeping_time.value > 0)
 				timer_sleeping.begin(CLOCK_REALTIME, pconf.sleeping_time.value, -pconf.sleeping_time.value);
+			if( lat_fp )
+				timer_latency.begin(CLOCK_REALTIME, opsm::peval::LatencyLogCycle);
 		} // <--- initialize timer
 
 		// ---> operation loop
@@ -375,6 +627,11 @@ int main(int argc, char *argv[], char **env) {
 				nline_show++;	::fprintf(stderr, "\x1b[K       sleep : %lf [s]\n", sleep_time );
 				nline_show++;	::fprintf(stderr, "\x1b[K     average : %.03lf\n", lh_ave );
 				nline_show++;	::fprintf(stderr, "\x1b[K   max - min : max %.03lf, min %.03lf\n", lh_max, lh_min );
+				nline_show++;	::fprintf(stderr, "\x1b[K     overrun : %d\n", cnt_overrun );
+				nline_show++;	lat_read.print(stderr, "particle read", "\x1b[K");
+				nline_show++;	lat_eval.print(stderr, "evaluation", "\x1b[K");
+				nline_show++;	lat_write.print(stderr, "write", "\x1b[K");
+				nline_show++;	lat_cycle.print(stderr, "total", "\x1b[K");
 				//				::fprintf(stderr, "perform eval : %.03lf\n", perform);
 				//				::fprintf(stderr, " fail weight : %.03lf\n", fault_weight );
 				//				::fprintf(stderr, "   rest-mode : %s\n", ssm_position.isOpen() ? "on" : "off"  );
@@ -408,121 +665,80 @@ int main(int argc, char *argv[], char **env) {
 				} // <--- check sleeping mode
 
 
-				{ // ---> get particles
-					if( !ssm_particles.readTime( ssm_sokuikiraw.time ) ) continue;
-
-					ssm_evaluation.data.n = ssm_particles.data.size();
+				double lap = 0, total = 0;
 
-					// ---> reallocate
-					if( nalloc < ssm_evaluation.data.n){
-						if(!ssm_evaluation.data.value)	delete[] ssm_evaluation.data.value;
-						ssm_evaluation.data.value = new double[ssm_evaluation.data.n];
-						nalloc = ssm_evaluation.data.n;
-					}// ---> reallocate
-
-				} // <--- get particles
+				etask.sw = &sw_stage;
+				etask.lat_read = &lat_read;
 
+				sw_stage.begin(CLOCK_MONOTONIC);
+				// extract valid reflection points
+				sokuiki_beam.extract(&ssm_sokuikiraw.data, sokuiki_filter, &sokuiki_pts);
+				etask.points = &sokuiki_pts;
 
+				{ // ---> particle evaluation (parallel, on shared memory record)
+					ssm_evaluation.data.n = 0;
+					if( !ssm_particles.readTimeView( ssm_sokuikiraw.time, opsm::peval::eval_view, &etask ) ) continue;
+					if( ssm_evaluation.data.n == 0 ) continue;
+				} // <--- particle evaluation (parallel, on shared memory record)
 
 				// ---> scanning loop (particle)
-				for( i = 0 ; i <  ssm_particles.data.size(); i++ ) {
-					gnd::matrix::fixed< 1, PARTICLE_DIM >* p = ssm_particles.data.begin() + i;
-					gnd::matrix::fixed<4, 1> prev_csns;
-
-					gnd::matrix::set_zero(&prev_csns);
-					{ // ---> set particle coordinate
-						gnd::coord_matrix cm;
-
-						gnd::matrix::coordinate_converter(&cm,
-								(*p)[0][PARTICLE_X], (*p)[0][PARTICLE_Y], 0,
-								::cos((*p)[0][PARTICLE_THETA]), ::sin((*p)[0][PARTICLE_THETA]), 0,
-								 0, 0, 1);
-
-						coordtree.set_coordinate(coordid_rt, &cm);
-
-					} // <--- set particle coordinate
-
-
-
-					{ // ---> particle evaluation with laser scanner reading
-						double eval = 0;
-						int cnt = 0;
-						double sqdist = 0;
-						gnd::matrix::fixed<4, 1> pos_sns;
-						gnd::matrix::fixed<4, 1> pos_gl;
-						gnd::matrix::fixed<4, 1> prev_pos_sns;
-						gnd::coord_matrix cm_sn2gl;
-
-						gnd::matrix::set_zero(&prev_pos_sns);
-						prev_pos_sns[3][0] = 1;
-
-						coordtree.get_convert_matrix(coordid_sns, coordid_gl, &cm_sn2gl);
-
-						// ---> scanning loop (sokuiki data)
-						for( int j = 0; j < (signed)ssm_sokuikiraw.data.numPoints(); j++ ) {
-							double cosv, sinv;
-
-							if(ssm_sokuikiraw.data[j].status == ssm::laser::STATUS_NO_REFLECTION)	continue;
-							else if( ssm_sokuikiraw.data[j].isError() ) continue;
-							else if( ssm_sokuikiraw.data[j].r < 0.3 ) continue;
-
-							cosv = ::cos(ssm_sokuikiraw.data[j].th);
-							sinv = ::sin(ssm_sokuikiraw.data[j].th);
-
-							// set search position on sensor-coordinate
-							pos_sns[0][0] = ssm_sokuikiraw.data[j].r * cosv;
-							pos_sns[1][0] = ssm_sokuikiraw.data[j].r * sinv;
-							pos_sns[2][0] = 0;
-							pos_sns[3][0] = 1;
-
-							sqdist = gnd_square(pos_sns[0][0] - prev_pos_sns[0][0]) + gnd_square(pos_sns[1][0] - prev_pos_sns[1][0]);
-							if( sqdist <= gnd_square( pconf.cull.value ) )	continue;
-
-							// coordinate convert from sensor coordinate to global coordinate
-							gnd::matrix::prod(&cm_sn2gl, &pos_sns, &pos_gl);
-
-
-							if( map.ppointer(pos_gl[0][0], pos_gl[1][0]) ){
-								eval += (double) map.pvalue(pos_gl[0][0], pos_gl[1][0]);
-							}
-							cnt++;
-						} // <--- scanning loop (sokuiki data)
-
-						// normalization
-						if(eval < 0 || cnt <= 0)	eval = 0;
-						else 				eval = (eval / (double) (0x8000 * cnt ));
-
-						if( lh_max < eval )		lh_max = eval;
-						if( i == 0 || lh_min > eval )	lh_min = eval;
-						lh_ave += eval;
-
-						ssm_evaluation.data.value[i] = eval;
-
-					} // <--- particle evaluation with laser scanner reading
+				for( i = 0 ; i <  ssm_evaluation.data.n; i++ ) {
+					double eval = ssm_evaluation.data.value[i];
 
+					if( lh_max < eval )		lh_max = eval;
+					if( i == 0 || lh_min > eval )	lh_min = eval;
+					lh_ave += eval;
 				} // <--- scanning loop (particle)
-				lh_ave /= ssm_particles.data.size();
+				lh_ave /= ssm_evaluation.data.n;
 
 				if( lh_max <= 0 ) continue;
-				for( i = 0;  i < ssm_particles.data.size(); i++ ){
+				for( i = 0;  i < ssm_evaluation.data.n; i++ ){
 					ssm_evaluation.data.value[i] = (ssm_evaluation.data.value[i] / lh_max) * (1.0 - pconf.mfailure.value) + pconf.mfailure.value;
 				}
+				if( sw_stage.get(0, &lap) == 0 )	lat_eval.record(lap);
 
 				ssm_evaluation.write( ssm_sokuikiraw.time );
 				cnt_eval++;
+				if( sw_stage.get(&total, &lap) == 0 ) {
+					lat_write.record(lap);
+					lat_cycle.record(total);
+					if( timer_operate.cycle() > 0 && total > timer_operate.cycle() ) cnt_overrun++;
+				}
 
 
 			} // <--- particle evaluation with laser-scanner reading
 
 
+			// ---> latency log
+			if( lat_fp && timer_latency.clock() > 0 ) {
+				ssmTimeT t = gettimeSSM();
+
+				lat_read.txtlog(lat_fp, t, "particle-read");
+				lat_eval.txtlog(lat_fp, t, "evaluation");
+				lat_write.txtlog(lat_fp, t, "write");
+				lat_cycle.txtlog(lat_fp, t, "total");
+				::fflush(lat_fp);
+			} // <--- latency log
+
 		} // <--- operation loop
 
+		if( lat_fp ) { // ---> latency log (final)
+			ssmTimeT t = gettimeSSM();
+
+			lat_read.txtlog(lat_fp, t, "particle-read");
+			lat_eval.txtlog(lat_fp, t, "evaluation");
+			lat_write.txtlog(lat_fp, t, "write");
+			lat_cycle.txtlog(lat_fp, t, "total");
+		} // <--- latency log (final)
+
 	} // <--- operation
 
 
 
 
 	{ // ---> finalize
+		tpool.end();
+		if( lat_fp ) ::fclose(lat_fp);
 		::endSSM();
 
 		::fprintf(stdout, "\n\n");
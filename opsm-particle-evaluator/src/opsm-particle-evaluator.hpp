@@ -12,6 +12,7 @@
 namespace opsm {
 	namespace peval {
 		const double Frame = 0.025;
+		const double LatencyLogCycle = 10.0;
 		const char ProcName[] = "opsm-particle-evaluator";
 	}
 }
@@ -1,4 +1,4 @@
 
 OBJS	:=$(patsubst %.cpp,%.o,$(SRCS))
 
-LIBS	:=ssm
\ No newline at end of file
+LIBS	:=ssm pthread
\ No newline at end of file
@@ -131,6 +131,27 @@ namespace opsm {
 				"orientation threshold for scan matching failure test [deg]"
 		};
 
+		// recovery search window distance
+		static const gnd::conf::parameter<double> ConfIni_RecoveryDist = {
+				"recovery-dist",
+				gnd_m2dist(0.0),
+				"half width of correlative search window for initial localization and failure recovery [m] (0: not use)"
+		};
+
+		// recovery search window orient
+		static const gnd::conf::parameter<double> ConfIni_RecoveryOrient = {
+				"recovery-orient",
+				gnd_deg2ang(20),
+				"half width of correlative search window for initial localization and failure recovery [deg]"
+		};
+
+		// recovery score threshold
+		static const gnd::conf::parameter<double> ConfIni_RecoveryScore = {
+				"recovery-score",
+				0.5,
+				"minimum score of correlative search (0 to 1) to accept the result"
+		};
+
 
 		// cycle
 		static const gnd::conf::parameter<double> ConfIni_Cycle = {
@@ -139,6 +160,20 @@ namespace opsm {
 				"scan matching cycle [sec]"
 		};
 
+		// scheduler
+		static const gnd::conf::parameter<bool> ConfIni_Scheduler = {
+				"scheduler",
+				false,
+				"sleep until next sensor reading or cui input instead of busy polling"
+		};
+
+		// wake-latency
+		static const gnd::conf::parameter<double> ConfIni_WakeLatency = {
+				"wake-latency",
+				gnd_sec2time(0.005),	// [s]
+				"scheduler mode maximum sleep time [sec]"
+		};
+
 		// rest-cycle
 		static const gnd::conf::parameter<double> ConfIni_RestCycle = {
 				"pause-time",
@@ -185,6 +220,20 @@ namespace opsm {
 				"orient threshold of map update [deg]"
 		};
 
+		// map update thread
+		static const gnd::conf::parameter<bool> ConfIni_MapUpdateThread = {
+				"map-update-thread",
+				false,
+				"integrate scan into map on background thread while next scan is matched"
+		};
+
+		// huge page backing of map
+		static const gnd::conf::parameter<bool> ConfIni_HugePage = {
+				"huge-page",
+				false,
+				"back memory units of scan matching map with 2MB huge pages"
+		};
+
 
 		// optimizer
 		static const char OptNewton[]		= __OPTIMIZER_NEWTON__;
@@ -197,6 +246,13 @@ namespace opsm {
 				"optimize method (newton or mcl or qmc or qmc2newton)"
 		};
 
+		// number of optimizer threads
+		static const gnd::conf::parameter<int> ConfIni_OptimizerThreads = {
+				"optimizer-threads",
+				1,
+				"number of threads for hypothesis scoring in mcl, qmc and qmc2newton (1: serial)"
+		};
+
 		// distance threshold of converge test
 		static const gnd::conf::parameter<double> ConfIni_ConvergeDist = {
 				"converge-distance",
@@ -210,6 +266,13 @@ namespace opsm {
 				"orient threshold of converge test [deg]",
 		};
 
+		// map pyramid
+		static const gnd::conf::parameter<int> ConfIni_MapPyramid = {
+				"map-pyramid",
+				0,
+				"number of coarse map levels for coarse-to-fine scan matching (0: not use, opsm only)",
+		};
+
 		// number of scan data for first map building
 		static const gnd::conf::parameter<int> ConfIni_InitMapCnt = {
 				"init-map-cnt",
@@ -289,6 +352,13 @@ namespace opsm {
 				"laser point log file name (text)"
 		};
 
+		// latency log
+		static const gnd::conf::parameter_array<char, 256> ConfIni_LatencyLog = {
+				"latency-txtlog",
+				"",		// file name
+				"processing latency log file name (text)"
+		};
+
 		// bmp
 		static const gnd::conf::parameter<bool> ConfIni_BMP = {
 				"bmp-map",
@@ -376,8 +446,13 @@ namespace opsm {
 			gnd::conf::parameter<int>				corrected_id;		///< corrected position log id
 			gnd::conf::parameter<double>			culling;			///< laser scanner data decimate parameter [m]
 			gnd::conf::parameter<double>			cycle;				///< operation cycle
+			gnd::conf::parameter<bool>				scheduler;			///< scheduler mode (sleep instead of polling)
+			gnd::conf::parameter<double>			wake_latency;		///< scheduler mode maximum sleep time
 			gnd::conf::parameter<double>			failure_dist;			///< failure test parameter (distance threshold)
 			gnd::conf::parameter<double>			failure_orient;		///< failure test parameter (orient threshold)
+			gnd::conf::parameter<double>			recovery_dist;		///< recovery search window (distance)
+			gnd::conf::parameter<double>			recovery_orient;	///< recovery search window (orient)
+			gnd::conf::parameter<double>			recovery_score;		///< recovery score threshold
 			gnd::conf::parameter<double>			use_range_dist;		///< matching data parameter (distance threshold)
 			gnd::conf::parameter<double>			use_range_orient;	///< matching data parameter (orient threshold)
 
@@ -388,11 +463,15 @@ namespace opsm {
 			gnd::conf::parameter<double>			map_update_time;		///< map update parameter (time threshold)
 			gnd::conf::parameter<double>			map_update_dist;		///< map update parameter (distance threshold)
 			gnd::conf::parameter<double>			map_update_orient;	///< map update parameter (orient threshold)
+			gnd::conf::parameter<bool>				map_update_thread;	///< map update on background thread
+			gnd::conf::parameter<bool>				huge_page;			///< huge page backing of map
 
 
 			gnd::conf::parameter_array<char, 256>	optimizer;			///< kind of optimizer
+			gnd::conf::parameter<int>				optimizer_threads;	///< number of optimizer threads
 			gnd::conf::parameter<double>			converge_dist;		///< convergence test threshold (position distance) [m]
 			gnd::conf::parameter<double>			converge_orient;	///< convergence test threshold (position orientation) [deg]
+			gnd::conf::parameter<int>				map_pyramid;		///< number of coarse map levels
 			gnd::conf::parameter<int>				ini_map_cnt;		///< number of scan data for first map building
 			gnd::conf::parameter<int>				ini_match_cnt;		///< count of initial position estimation. in these matching result is not resister on odometry error map
 			gnd::conf::parameter<bool>				ndt;				///< ndt mode
@@ -408,6 +487,7 @@ namespace opsm {
 			gnd::conf::parameter_array<char, 256>	trajectory_log;		///< trajectory log
 			gnd::conf::parameter_array<char, 256>	trajectory4route;	///< trajectory for route edit
 			gnd::conf::parameter_array<char, 256>	laserpoint_log;		///< laser point log
+			gnd::conf::parameter_array<char, 256>	latency_log;		///< latency log
 
 			gnd::conf::parameter_array<char, 256>	output_dir;			///< file output directory
 			gnd::conf::parameter<bool>				debug_odo_err_map;	///< file output directory
@@ -449,8 +529,13 @@ namespace opsm {
 			::memcpy(&conf->cmap,				&ConfIni_CorrectionMapPath,		sizeof(ConfIni_CorrectionMapPath) );
 			::memcpy(&conf->culling,			&ConfIni_Culling,				sizeof(ConfIni_Culling) );
 			::memcpy(&conf->cycle,				&ConfIni_Cycle,					sizeof(ConfIni_Cycle) );
+			::memcpy(&conf->scheduler,			&ConfIni_Scheduler,				sizeof(ConfIni_Scheduler) );
+			::memcpy(&conf->wake_latency,		&ConfIni_WakeLatency,			sizeof(ConfIni_WakeLatency) );
 			::memcpy(&conf->failure_dist,		&ConfIni_FailDist,				sizeof(ConfIni_FailDist) );
 			::memcpy(&conf->failure_orient,		&ConfIni_FailOrient,			sizeof(ConfIni_FailOrient) );
+			::memcpy(&conf->recovery_dist,		&ConfIni_RecoveryDist,			sizeof(ConfIni_RecoveryDist) );
+			::memcpy(&conf->recovery_orient,	&ConfIni_RecoveryOrient,		sizeof(ConfIni_RecoveryOrient) );
+			::memcpy(&conf->recovery_score,		&ConfIni_RecoveryScore,			sizeof(ConfIni_RecoveryScore) );
 			::memcpy(&conf->use_range_dist,		&ConfIni_LaserUseDist,			sizeof(ConfIni_LaserUseDist) );
 			::memcpy(&conf->use_range_orient,	&ConfIni_LaserUseOrient,		sizeof(ConfIni_LaserUseOrient) );
 			::memcpy(&conf->pause_time,			&ConfIni_RestCycle,				sizeof(ConfIni_RestCycle) );
@@ -460,9 +545,13 @@ namespace opsm {
 			::memcpy(&conf->map_update_time,	&ConfIni_MapUpdateTime,			sizeof(ConfIni_MapUpdateTime) );
 			::memcpy(&conf->map_update_dist,	&ConfIni_MapUpdateDist,			sizeof(ConfIni_MapUpdateDist) );
 			::memcpy(&conf->map_update_orient,	&ConfIni_MapUpdateOrient,		sizeof(ConfIni_MapUpdateOrient) );
+			::memcpy(&conf->map_update_thread,	&ConfIni_MapUpdateThread,		sizeof(ConfIni_MapUpdateThread) );
+			::memcpy(&conf->huge_page,			&ConfIni_HugePage,				sizeof(ConfIni_HugePage) );
 			::memcpy(&conf->optimizer,			&ConfIni_Optimizer,				sizeof(ConfIni_Optimizer) );
+			::memcpy(&conf->optimizer_threads,	&ConfIni_OptimizerThreads,		sizeof(ConfIni_OptimizerThreads) );
 			::memcpy(&conf->converge_dist,		&ConfIni_ConvergeDist,			sizeof(ConfIni_ConvergeDist) );
 			::memcpy(&conf->converge_orient,	&ConfIni_ConvergeOrient,		sizeof(ConfIni_ConvergeOrient) );
+			::memcpy(&conf->map_pyramid,		&ConfIni_MapPyramid,			sizeof(ConfIni_MapPyramid) );
 			::memcpy(&conf->ini_map_cnt,		&ConfIni_InitMapCnt,			sizeof(ConfIni_InitMapCnt) );
 			::memcpy(&conf->ini_match_cnt,		&ConfIni_InitMatchingCnt,		sizeof(ConfIni_InitMatchingCnt) );
 			::memcpy(&conf->ndt,				&ConfIni_NDT,					sizeof(ConfIni_NDT) );
@@ -478,6 +567,7 @@ namespace opsm {
 			::memcpy(&conf->trajectory_log,		&ConfIni_TrajectoryLog,			sizeof(ConfIni_TrajectoryLog) );
 			::memcpy(&conf->trajectory4route,	&ConfIni_Trajectory4Route,		sizeof(ConfIni_Trajectory4Route) );
 			::memcpy(&conf->laserpoint_log,		&ConfIni_LaserPointLog,			sizeof(ConfIni_LaserPointLog) );
+			::memcpy(&conf->latency_log,		&ConfIni_LatencyLog,			sizeof(ConfIni_LatencyLog) );
 			::memcpy(&conf->output_dir,			&ConfIni_OutputDir,				sizeof(ConfIni_OutputDir) );
 			::memcpy(&conf->debug_odo_err_map,	&ConfIni_DebugOdometryErrorMap,	sizeof(ConfIni_DebugOdometryErrorMap) );
 
@@ -499,9 +589,15 @@ namespace opsm {
 			gnd::conf::get_parameter( src, &dest->cmap );
 			gnd::conf::get_parameter( src, &dest->culling );
 			gnd::conf::get_parameter( src, &dest->cycle );
+			gnd::conf::get_parameter( src, &dest->scheduler );
+			gnd::conf::get_parameter( src, &dest->wake_latency );
 			gnd::conf::get_parameter( src, &dest->failure_dist );
 			if( !gnd::conf::get_parameter( src, &dest->failure_orient) )
 				dest->failure_orient.value = gnd_deg2ang(dest->failure_orient.value);
+			gnd::conf::get_parameter( src, &dest->recovery_dist );
+			if( !gnd::conf::get_parameter( src, &dest->recovery_orient) )
+				dest->recovery_orient.value = gnd_deg2ang(dest->recovery_orient.value);
+			gnd::conf::get_parameter( src, &dest->recovery_score );
 			gnd::conf::get_parameter( src, &dest->use_range_dist );
 			if( !gnd::conf::get_parameter( src, &dest->use_range_orient) )
 				dest->use_range_orient.value = gnd_deg2ang(dest->use_range_orient.value);
@@ -514,10 +610,14 @@ namespace opsm {
 			gnd::conf::get_parameter( src, &dest->map_update_dist );
 			if( !gnd::conf::get_parameter( src, &dest->map_update_orient) )
 				dest->converge_orient.value = gnd_deg2ang(dest->map_update_orient.value);
+			gnd::conf::get_parameter( src, &dest->map_update_thread );
+			gnd::conf::get_parameter( src, &dest->huge_page );
 			gnd::conf::get_parameter( src, &dest->optimizer );
+			gnd::conf::get_parameter( src, &dest->optimizer_threads );
 			gnd::conf::get_parameter( src, &dest->converge_dist );
 			if( !gnd::conf::get_parameter( src, &dest->converge_orient) )
 				dest->converge_orient.value = gnd_deg2ang(dest->converge_orient.value);
+			gnd::conf::get_parameter( src, &dest->map_pyramid );
 			gnd::conf::get_parameter( src, &dest->ini_map_cnt );
 			gnd::conf::get_parameter( src, &dest->ini_match_cnt );
 			gnd::conf::get_parameter( src, &dest->ndt );
@@ -540,6 +640,7 @@ namespace opsm {
 			gnd::conf::get_parameter( src, &dest->trajectory_log );
 			gnd::conf::get_parameter( src, &dest->trajectory4route );
 			gnd::conf::get_parameter( src, &dest->laserpoint_log );
+			gnd::conf::get_parameter( src, &dest->latency_log );
 			gnd::conf::get_parameter( src, &dest->output_dir );
 			gnd::conf::get_parameter( src, &dest->debug_odo_err_map );
 
@@ -565,18 +666,28 @@ namespace opsm {
 
 				// scan matching parameter
 				gnd::conf::set_parameter(dest, &src->cycle);
+				gnd::conf::set_parameter(dest, &src->scheduler);
+				gnd::conf::set_parameter(dest, &src->wake_latency);
 				gnd::conf::set_parameter(dest, &src->culling);
 				gnd::conf::set_parameter(dest, &src->optimizer);
+				gnd::conf::set_parameter(dest, &src->optimizer_threads);
 				gnd::conf::set_parameter(dest, &src->converge_dist);
 				src->converge_orient.value = gnd_ang2deg(src->converge_orient.value);
 				gnd::conf::set_parameter(dest, &src->converge_orient);
 				src->converge_orient.value = gnd_deg2ang(src->converge_orient.value);
+				gnd::conf::set_parameter(dest, &src->map_pyramid);
 
 				gnd::conf::set_parameter(dest, &src->failure_dist);
 				src->failure_orient.value = gnd_ang2deg(src->failure_orient.value);
 				gnd::conf::set_parameter(dest, &src->failure_orient);
 				src->failure_orient.value = gnd_deg2ang(src->failure_orient.value);
 
+				gnd::conf::set_parameter(dest, &src->recovery_dist);
+				src->recovery_orient.value = gnd_ang2deg(src->recovery_orient.value);
+				gnd::conf::set_parameter(dest, &src->recovery_orient);
+				src->recovery_orient.value = gnd_deg2ang(src->recovery_orient.value);
+				gnd::conf::set_parameter(dest, &src->recovery_score);
+
 				gnd::conf::set_parameter(dest, &src->pause_time);
 				gnd::conf::set_parameter(dest, &src->pause_dist);
 				src->pause_orient.value = gnd_ang2deg(src->pause_orient.value);
@@ -598,6 +709,8 @@ namespace opsm {
 				src->map_update_orient.value = gnd_ang2deg(src->map_update_orient.value);
 				gnd::conf::set_parameter(dest, &src->map_update_orient);
 				src->map_update_orient.value = gnd_deg2ang(src->map_update_orient.value);
+				gnd::conf::set_parameter(dest, &src->map_update_thread);
+				gnd::conf::set_parameter(dest, &src->huge_page);
 
 				gnd::conf::set_parameter(dest, &src->output_dir );
 
@@ -611,6 +724,7 @@ namespace opsm {
 				gnd::conf::set_parameter(dest, &src->trajectory_log );
 				gnd::conf::set_parameter(dest, &src->trajectory4route );
 				gnd::conf::set_parameter(dest, &src->laserpoint_log );
+				gnd::conf::set_parameter(dest, &src->latency_log );
 
 				gnd::conf::set_parameter(dest, &src->cui_show );
 				gnd::conf::set_parameter(dest, &src->init_opsm_map);
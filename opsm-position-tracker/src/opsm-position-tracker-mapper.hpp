@@ -0,0 +1,531 @@
+/*
+ * opsm-position-tracker-mapper.hpp
+ *
+ *  scan matching map updater (background map integration) of opsm-position-tracker
+ */
+
+#ifndef OPSM_POSITION_TRACKER_MAPPER_HPP_
+#define OPSM_POSITION_TRACKER_MAPPER_HPP_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "gnd-opsm.hpp"
+#include "gnd-timer.hpp"
+
+#ifndef opsm_pt
+#define opsm_pt opsm::position_tracker
+#endif
+
+
+namespace opsm {
+	namespace position_tracker {
+
+		/**
+		 * @brief scan matching map updater
+		 * @details integrate laser scanner reflection points into the map.
+		 * if thread mode, the map is double buffered and integration runs on a background thread
+		 * while the optimizer match the next scan with the front map.
+		 * the finished back map is swapped in publish(), so that the optimizer always sees a consistent map.
+		 * if not thread mode, the map is updated in place in post().
+		 *
+		 * usage
+		 *  1. wait()        : wait for previous integration and publish it
+		 *  2. push() * n    : entry reflection points (global coordinate)
+		 *  3. post()        : start integration
+		 *  and call publish() before each optimization
+		 */
+		class map_updater {
+			// ---> constructor, destructor
+		public:
+			map_updater();
+			~map_updater();
+			// <--- constructor, destructor
+
+			// ---> variables
+		private:
+			/// @brief counting map (owned by worker while busy)
+			gnd::opsm::cmap_t *_cnt;
+			/// @brief map used by optimizer
+			gnd::opsm::map_t *_front;
+			/// @brief compiled map used by optimizer
+			gnd::opsm::compiled_mapf_t *_front_cmpl;
+			/// @brief map to be updated
+			gnd::opsm::map_t *_back;
+			/// @brief compiled map to be updated
+			gnd::opsm::compiled_mapf_t *_back_cmpl;
+			/// @brief map pyramid used by optimizer
+			gnd::opsm::map_pyramid_t *_front_pyr;
+			/// @brief map pyramid to be updated
+			gnd::opsm::map_pyramid_t *_back_pyr;
+			/// @brief number of coarse levels of map pyramid (0: not use)
+			size_t _pyr_level;
+			/// @brief branch and bound field used by correlative scan matching
+			gnd::opsm::bnb_field_t *_front_field;
+			/// @brief branch and bound field to be updated
+			gnd::opsm::bnb_field_t *_back_field;
+			/// @brief correlative scan matching (null: not use)
+			gnd::opsm::bnb *_bnb;
+			/// @brief optimizer
+			gnd::opsm::optimize_basic *_optimizer;
+			/// @brief ndt mode
+			bool _ndt;
+			/// @brief incremental update (slam), otherwise clear and rebuild
+			bool _incremental;
+			/// @brief error margin
+			double _err;
+
+			/// @brief reflection points (0: posted, 1: previous posted)
+			double *_x[2], *_y[2];
+			/// @brief number of reflection points
+			size_t _n[2];
+			/// @brief allocated size of reflection points buffer
+			size_t _alloc[2];
+
+			/// @brief thread mode
+			bool _thread;
+			/// @brief worker thread
+			pthread_t _worker;
+			/// @brief mutex
+			pthread_mutex_t _mutex;
+			/// @brief condition for job post
+			pthread_cond_t _cond_post;
+			/// @brief condition for job finish
+			pthread_cond_t _cond_finish;
+			/// @brief job is running
+			bool _busy;
+			/// @brief finished job is not published
+			bool _ready;
+			/// @brief quit flag
+			bool _quit;
+			/// @brief begin flag
+			bool _begin;
+			/// @brief latency of integration job (guarded by mutex)
+			gnd::timer::histogram _latency;
+			// <--- variables
+
+		public:
+			int begin(gnd::opsm::cmap_t *cnt,
+					gnd::opsm::map_t *front, gnd::opsm::compiled_mapf_t *front_cmpl,
+					gnd::opsm::map_t *back, gnd::opsm::compiled_mapf_t *back_cmpl,
+					gnd::opsm::optimize_basic *optimizer, bool ndt, bool incremental, double err, bool thread);
+			int end();
+			int set_pyramid(gnd::opsm::map_pyramid_t *front, gnd::opsm::map_pyramid_t *back, size_t n);
+			int set_field(gnd::opsm::bnb_field_t *front, gnd::opsm::bnb_field_t *back, gnd::opsm::bnb *bnb);
+			int publish();
+			int wait();
+			int push(double x, double y);
+			int post();
+			gnd::opsm::map_t* map();
+			int latency(gnd::timer::histogram *h);
+		private:
+			int _build_(gnd::opsm::map_t *map);
+			int _job_();
+			static void* _worker_main_(void *a);
+		};
+
+	}
+}
+
+
+
+namespace opsm {
+	namespace position_tracker {
+
+		/**
+		 * @brief constructor
+		 */
+		inline
+		map_updater::map_updater()
+		: _cnt(0), _front(0), _front_cmpl(0), _back(0), _back_cmpl(0),
+		  _front_pyr(0), _back_pyr(0), _pyr_level(0),
+		  _front_field(0), _back_field(0), _bnb(0), _optimizer(0),
+		  _ndt(false), _incremental(false), _err(0),
+		  _thread(false), _busy(false), _ready(false), _quit(false), _begin(false)
+		{
+			for( int i = 0; i < 2; i++ ) {
+				_x[i] = 0;
+				_y[i] = 0;
+				_n[i] = 0;
+				_alloc[i] = 0;
+			}
+			::pthread_mutex_init(&_mutex, 0);
+			::pthread_cond_init(&_cond_post, 0);
+			::pthread_cond_init(&_cond_finish, 0);
+		}
+
+		/**
+		 * @brief destructor
+		 */
+		inline
+		map_updater::~map_updater()
+		{
+			end();
+			for( int i = 0; i < 2; i++ ) {
+				::free(_x[i]);
+				::free(_y[i]);
+			}
+			::pthread_cond_destroy(&_cond_finish);
+			::pthread_cond_destroy(&_cond_post);
+			::pthread_mutex_destroy(&_mutex);
+		}
+
+		/**
+		 * @brief start map updater
+		 * @param[in,out]        cnt : counting map
+		 * @param[in,out]      front : map (already built, used by optimizer)
+		 * @param[in,out] front_cmpl : compiled map of front
+		 * @param[out]          back : map for double buffering (built from counting map in this function)
+		 * @param[out]     back_cmpl : compiled map of back
+		 * @param[in]      optimizer : optimizer
+		 * @param[in]            ndt : ndt mode
+		 * @param[in]    incremental : update map incrementally (slam), otherwise clear counting map and rebuild
+		 * @param[in]            err : error margin
+		 * @param[in]         thread : integrate on background thread
+		 * @return ==0 : success
+		 * @return  <0 : fail
+		 */
+		inline
+		int map_updater::begin(gnd::opsm::cmap_t *cnt,
+				gnd::opsm::map_t *front, gnd::opsm::compiled_mapf_t *front_cmpl,
+				gnd::opsm::map_t *back, gnd::opsm::compiled_mapf_t *back_cmpl,
+				gnd::opsm::optimize_basic *optimizer, bool ndt, bool incremental, double err, bool thread)
+		{
+			gnd_assert(!cnt || !front || !front_cmpl || !optimizer, -1, "invalid null pointer");
+			gnd_assert(thread && (!back || !back_cmpl), -1, "invalid null pointer");
+			gnd_assert(_begin, -1, "map updater is busy");
+
+			{ // ---> operation
+				_cnt = cnt;
+				_front = front;
+				_front_cmpl = front_cmpl;
+				_optimizer = optimizer;
+				_ndt = ndt;
+				_incremental = incremental;
+				_err = err;
+				_thread = thread;
+				_busy = false;
+				_ready = false;
+				_quit = false;
+				_n[0] = 0;
+				_n[1] = 0;
+
+				if( !_thread ) {
+					// update in place
+					_back = _front;
+					_back_cmpl = _front_cmpl;
+					_back_pyr = _front_pyr;
+					_back_field = _front_field;
+				}
+				else {
+					_back = back;
+					_back_cmpl = back_cmpl;
+					// back map starts from the same counting map as front
+					if( _build_(_back) < 0 ) return -1;
+					gnd::opsm::rebuild_compiled_map(_back_cmpl, _back, _cnt);
+					if( _pyr_level > 0 && gnd::opsm::build_map_pyramid(_back_pyr, _cnt, _pyr_level, _err) < 0 ) return -1;
+					if( _bnb && gnd::opsm::build_bnb_field(_back_field, _back) < 0 ) return -1;
+
+					if( ::pthread_create(&_worker, 0, _worker_main_, this) != 0 ) {
+						_thread = false;
+						_back = _front;
+						_back_cmpl = _front_cmpl;
+						_back_pyr = _front_pyr;
+						_back_field = _front_field;
+						return -1;
+					}
+				}
+				_begin = true;
+			} // <--- operation
+			return 0;
+		}
+
+		/**
+		 * @brief wait for integration, publish it and join worker thread
+		 */
+		inline
+		int map_updater::end()
+		{
+			if( !_begin ) return 0;
+
+			{ // ---> operation
+				wait();
+				if( _thread ) {
+					::pthread_mutex_lock(&_mutex);
+					_quit = true;
+					::pthread_cond_signal(&_cond_post);
+					::pthread_mutex_unlock(&_mutex);
+					::pthread_join(_worker, 0);
+				}
+				_begin = false;
+			} // <--- operation
+			return 0;
+		}
+
+		/**
+		 * @brief set map pyramid (coarse-to-fine scan matching)
+		 * @param[in,out] front : map pyramid (already built, used by optimizer)
+		 * @param[out]     back : map pyramid for double buffering
+		 * @param[in]         n : number of coarse levels
+		 * @note call this before begin(). map pyramid is rebuilt with the map, and it is not used in ndt mode.
+		 */
+		inline
+		int map_updater::set_pyramid(gnd::opsm::map_pyramid_t *front, gnd::opsm::map_pyramid_t *back, size_t n)
+		{
+			gnd_assert(n > 0 && (!front || !back), -1, "invalid null pointer");
+			gnd_assert(_begin, -1, "map updater is busy");
+
+			_front_pyr = front;
+			_back_pyr = back;
+			_pyr_level = n;
+			return 0;
+		}
+
+		/**
+		 * @brief set max-pooled likelihood field of correlative scan matching
+		 * @param[in,out] front : field (already built, used by bnb)
+		 * @param[out]     back : field for double buffering
+		 * @param[in]       bnb : correlative scan matching
+		 * @note call this before begin(). the field is rebuilt with the map, so that bnb never builds it in the loop of scan matching.
+		 */
+		inline
+		int map_updater::set_field(gnd::opsm::bnb_field_t *front, gnd::opsm::bnb_field_t *back, gnd::opsm::bnb *bnb)
+		{
+			gnd_assert(bnb && (!front || !back), -1, "invalid null pointer");
+			gnd_assert(_begin, -1, "map updater is busy");
+
+			_front_field = front;
+			_back_field = back;
+			_bnb = bnb;
+			return 0;
+		}
+
+		/**
+		 * @brief swap maps if integration is finished (not blocking)
+		 * @return  >0 : published
+		 * @return ==0 : nothing to publish
+		 */
+		inline
+		int map_updater::publish()
+		{
+			bool ready;
+
+			if( !_thread ) return 0;
+
+			::pthread_mutex_lock(&_mutex);
+			ready = _ready;
+			_ready = false;
+			::pthread_mutex_unlock(&_mutex);
+			if( !ready ) return 0;
+
+			{ // ---> swap
+				gnd::opsm::map_t *m = _front;
+				gnd::opsm::compiled_mapf_t *cm = _front_cmpl;
+				gnd::opsm::map_pyramid_t *pyr = _front_pyr;
+				gnd::opsm::bnb_field_t *fld = _front_field;
+
+				_front = _back;
+				_front_cmpl = _back_cmpl;
+				_front_pyr = _back_pyr;
+				_back = m;
+				_back_cmpl = cm;
+				_back_pyr = pyr;
+				_front_field = _back_field;
+				_back_field = fld;
+			} // <--- swap
+			_optimizer->set_map(_front);
+			_optimizer->set_compiled_map(_front_cmpl);
+			if( _pyr_level > 0 ) _optimizer->set_map_pyramid(_front_pyr);
+			if( _bnb ) _bnb->set_field(_front_field);
+			return 1;
+		}
+
+		/**
+		 * @brief wait for previous integration and publish it
+		 * @note call this before push()
+		 */
+		inline
+		int map_updater::wait()
+		{
+			if( !_thread ) return 0;
+
+			::pthread_mutex_lock(&_mutex);
+			while( _busy ) ::pthread_cond_wait(&_cond_finish, &_mutex);
+			::pthread_mutex_unlock(&_mutex);
+			return publish();
+		}
+
+		/**
+		 * @brief entry a reflection point
+		 * @param[in] x : reflection point x (global coordinate)
+		 * @param[in] y : reflection point y (global coordinate)
+		 */
+		inline
+		int map_updater::push(double x, double y)
+		{
+			if( _n[0] >= _alloc[0] ) { // ---> reallocate
+				size_t a = _alloc[0] ? _alloc[0] * 2 : 1024;
+				double *px = static_cast<double*>( ::realloc(_x[0], a * sizeof(double)) );
+				double *py;
+
+				if( !px ) return -1;
+				_x[0] = px;
+				if( !(py = static_cast<double*>( ::realloc(_y[0], a * sizeof(double)) )) ) return -1;
+				_y[0] = py;
+				_alloc[0] = a;
+			} // <--- reallocate
+
+			_x[0][_n[0]] = x;
+			_y[0][_n[0]] = y;
+			_n[0]++;
+			return 0;
+		}
+
+		/**
+		 * @brief integrate pushed reflection points into map
+		 * @note if thread mode, this function returns immediately and the result is published in publish()
+		 */
+		inline
+		int map_updater::post()
+		{
+			if( !_thread )	return _job_();
+
+			::pthread_mutex_lock(&_mutex);
+			_busy = true;
+			::pthread_cond_signal(&_cond_post);
+			::pthread_mutex_unlock(&_mutex);
+			return 0;
+		}
+
+		/**
+		 * @brief map used by optimizer
+		 */
+		inline
+		gnd::opsm::map_t* map_updater::map()
+		{
+			return _front;
+		}
+
+		/**
+		 * @brief get latency histogram of integration (map update and build)
+		 * @param[out] h : histogram
+		 */
+		inline
+		int map_updater::latency(gnd::timer::histogram *h)
+		{
+			gnd_assert(!h, -1, "invalid null pointer");
+			::pthread_mutex_lock(&_mutex);
+			*h = _latency;
+			::pthread_mutex_unlock(&_mutex);
+			return 0;
+		}
+
+		/**
+		 * @brief build map from counting map
+		 */
+		inline
+		int map_updater::_build_(gnd::opsm::map_t *map)
+		{
+			int ret;
+			if( !_ndt ) ret = gnd::opsm::build_map(map, _cnt, _err);
+			else		ret = gnd::opsm::build_ndt_map(map, _cnt, _err);
+			if( ret < 0 ) {
+				::fprintf(stderr, "\x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: invalid map property\n");
+			}
+			return ret;
+		}
+
+		/**
+		 * @brief integration job
+		 */
+		inline
+		int map_updater::_job_()
+		{
+			int ret = 0;
+			gnd::stopwatch sw;
+			double lap = 0;
+
+			sw.begin(CLOCK_MONOTONIC);
+
+			if( _incremental ) { // ---> incremental update
+				// catch up: previous points have been integrated into the other map only
+				if( _back != _front ) {
+					for( size_t i = 0; i < _n[1]; i++ ) {
+						if( _ndt )	gnd::opsm::refresh_ndt_map(_cnt, _back, _x[1][i], _y[1][i], _err);
+						else		gnd::opsm::refresh_map(_cnt, _back, _x[1][i], _y[1][i], _err);
+					}
+				}
+				for( size_t i = 0; i < _n[0]; i++ ) {
+					if( _ndt )	gnd::opsm::update_ndt_map(_cnt, _back, _x[0][i], _y[0][i], _err);
+					else		gnd::opsm::update_map(_cnt, _back, _x[0][i], _y[0][i], _err);
+				}
+			} // <--- incremental update
+			else { // ---> rebuild
+				gnd::opsm::clear_counting_map(_cnt);
+				for( size_t i = 0; i < _n[0]; i++ ) {
+					gnd::opsm::counting_map(_cnt, _x[0][i], _y[0][i]);
+				}
+				// only modified memory units since the last building of back map
+				if( !_ndt )	ret = gnd::opsm::rebuild_map(_back, _cnt, _err);
+				else		ret = gnd::opsm::rebuild_ndt_map(_back, _cnt, _err);
+				if( ret < 0 ) {
+					::fprintf(stderr, "\x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: invalid map property\n");
+				}
+			} // <--- rebuild
+
+			// rebuild compiled map (only cells on modified memory units)
+			gnd::opsm::rebuild_compiled_map(_back_cmpl, _back, _cnt);
+			// rebuild map pyramid (only coarse pixels on modified memory units)
+			if( _pyr_level > 0 ) gnd::opsm::rebuild_map_pyramid(_back_pyr, _cnt, _pyr_level, _err);
+			// rebuild field of correlative scan matching
+			if( _bnb ) gnd::opsm::build_bnb_field(_back_field, _back);
+
+			{ // ---> keep posted points for catch up
+				double *p;
+				size_t s;
+
+				p = _x[1]; _x[1] = _x[0]; _x[0] = p;
+				p = _y[1]; _y[1] = _y[0]; _y[0] = p;
+				s = _alloc[1]; _alloc[1] = _alloc[0]; _alloc[0] = s;
+				_n[1] = _n[0];
+				_n[0] = 0;
+			} // <--- keep posted points for catch up
+
+			if( sw.get(0, &lap) == 0 ) {
+				::pthread_mutex_lock(&_mutex);
+				_latency.record(lap);
+				::pthread_mutex_unlock(&_mutex);
+			}
+			return ret;
+		}
+
+		/**
+		 * @brief worker thread main
+		 */
+		inline
+		void* map_updater::_worker_main_(void *a)
+		{
+			map_updater *p = static_cast<map_updater*>(a);
+
+			::pthread_mutex_lock(&p->_mutex);
+			for( ;; ) {
+				while( !p->_quit && !p->_busy ) ::pthread_cond_wait(&p->_cond_post, &p->_mutex);
+				if( p->_quit ) break;
+				::pthread_mutex_unlock(&p->_mutex);
+
+				p->_job_();
+
+				::pthread_mutex_lock(&p->_mutex);
+				p->_busy = false;
+				p->_ready = true;
+				::pthread_cond_signal(&p->_cond_finish);
+			}
+			::pthread_mutex_unlock(&p->_mutex);
+			return 0;
+		}
+
+	}
+}
+
+#endif /* OPSM_POSITION_TRACKER_MAPPER_HPP_ */
@@ -16,6 +16,7 @@
 
 #include "opsm-position-tracker-opt.hpp"
 #include "opsm-position-tracker-cui.hpp"
+#include "opsm-position-tracker-mapper.hpp"
 
 #include "gnd-coord-tree.hpp"
 #include "gnd-matrix-coordinate.hpp"
@@ -27,19 +28,96 @@
 #include "gnd-shutoff.hpp"
 #include "gnd-timer.hpp"
 #include "gnd-bmp.hpp"
+#include "gnd-thread-pool.hpp"
 
 
 static const double ShowCycle = gnd_sec2time(1.0);
 static const double ClockCycle = gnd_sec2time(1.0) / 1000.0 ;
+static const double LatencyLogCycle = gnd_sec2time(10.0);
+
+
+/**
+ * @brief restart optimization from the result of correlative scan matching
+ * @param[in,out] opt : optimizer
+ * @param[in,out] ini : optimization starting value
+ * @param[in]       r : correlative scan matching (scan points are copied to the optimizer)
+ * @param[in]       p : starting position (x, y, theta)
+ */
+static int optimize_restart(gnd::opsm::optimize_basic *opt, void *ini, gnd::opsm::bnb *r, gnd::vector::fixed_column<3> *p) {
+	opt->initial_parameter_set_position( ini, (*p)[0], (*p)[1], (*p)[2] );
+	opt->begin(ini);
+	for( int i = 0; i < r->nscan_point(); i++ ) {
+		double x, y;
+		r->get_scan_point(i, &x, &y);
+		opt->set_scan_point(x, y);
+	}
+	return 0;
+}
+
+/**
+ * @brief iterate optimization until convergence
+ * @param[in,out]  opt : optimizer
+ * @param[in,out] move : movement by optimization (accumulated)
+ * @param[out]     pos : optimized position
+ * @param[out]     lkl : likelihood
+ * @param[out]     cnt : number of iterations
+ * @return <0 : optimization error
+ */
+static int optimize_converge(gnd::opsm::optimize_basic *opt, gnd::vector::fixed_column<3> *move, Spur_Odometry *pos, double *lkl, int *cnt) {
+	int ret = 0;
+
+	// zero reset likelihood
+	*lkl = 0;
+	// zero reset optimization iteration counter
+	*cnt = 0;
+	do{
+		gnd::vector::fixed_column<3> delta;
+		gnd::vector::fixed_column<3> ws3x1;
+
+		// ---> step iteration of optimization
+		if( (ret = opt->iterate(&delta, &ws3x1, lkl)) < 0 ){
+			break;
+		}
+
+		// get optimized position
+		pos->x = ws3x1[0];
+		pos->y = ws3x1[1];
+		pos->theta = ws3x1[2];
+		// get movement by optimization
+		gnd::matrix::add(move, &delta, move);
+		// <--- step iteration of optimization
+
+		// loop counting
+		(*cnt)++;
+		// convergence test
+	} while( !opt->converge_test() ); // <--- position optimization loop
+
+	return ret;
+}
+
 
 int main(int argc, char* argv[]) {
 	gnd::opsm::optimize_basic	*optimizer = 0;		// optimizer class
 	void 						*optim_ini = 0;		// optimization starting value
+	gnd::thread_pool				optim_pool;			// hypothesis scoring threads
+	gnd::opsm::bnb				*recovery = 0;		// correlative scan matching (initial localization and failure recovery)
+	void						*recovery_ini = 0;	// correlative scan matching starting value
 
 	gnd::opsm::cmap_t			cnt_smmap;			// probabilistic scan matching counting map
 	gnd::opsm::map_t				smmap;				// probabilistic scan matching map
+	gnd::opsm::compiled_mapf_t	smmap_cmpl;			// compiled scan matching map (runtime query)
+	gnd::opsm::map_t				smmap_back;			// scan matching map for background update
+	gnd::opsm::compiled_mapf_t	smmap_cmpl_back;	// compiled scan matching map for background update
+	gnd::opsm::map_pyramid_t		smmap_pyr;			// scan matching map pyramid (coarse-to-fine)
+	gnd::opsm::map_pyramid_t		smmap_pyr_back;		// scan matching map pyramid for background update
+	gnd::opsm::bnb_field_t			smmap_field;		// max-pooled likelihood field of correlative scan matching
+	gnd::opsm::bnb_field_t			smmap_field_back;	// max-pooled likelihood field for background update
+	opsm_pt::map_updater			mapper;				// scan matching map updater
+	gnd::gridmap::gridplane<double>	bmp_ws;				// workspace of bitmap building (shared by 32bit and 8bit)
 
 	SSMScanPoint2D				ssm_sokuikiraw;		// sokuiki raw streaming data
+	ssm::ScanPoint2DBeamCache	sokuiki_beam;		// sokuiki beam unit vector cache
+	ssm::ScanPoint2DPoints		sokuiki_pts;		// sokuiki reflection points (filtered, converted in place from sensor coordinate)
 	SSMApi<Spur_Odometry>		ssm_odometry;		// odometry
 	SSMApi<Spur_Odometry>		ssm_position_write;	// corrected position
 	SSMApi<Spur_Odometry>		ssm_position_read;	// corrected position
@@ -63,6 +141,7 @@ int main(int argc, char* argv[]) {
 	FILE *tlog_fp = 0;
 	FILE *llog_fp = 0;
 	FILE *t4re_fp = 0;
+	FILE *lat_fp = 0;
 
 	{
 		gnd::opsm::debug_set_log_level(0);
@@ -73,6 +152,7 @@ int main(int argc, char* argv[]) {
 	{ // ---> initialization
 		int ret;								// function return value
 		uint32_t phase = 1;						// initialize phase
+		uint64_t cmpl_key = 0;					// key of compiled map file
 
 		// ---> read process options
 		if( (ret = popt.get_option(argc, argv)) != 0 ) {
@@ -204,9 +284,40 @@ int main(int argc, char* argv[]) {
 				::fprintf(stderr, "  ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: invalid optimizer type\n");
 			}
 
+			// hypothesis scoring threads
+			if( !::is_proc_shutoff() && pconf.optimizer_threads.value > 1 ) {
+				if( optim_pool.begin( pconf.optimizer_threads.value ) < 0 ) {
+					::proc_shutoff();
+					::fprintf(stderr, "  ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to create optimizer threads\n");
+				}
+				else {
+					optimizer->set_thread_pool(&optim_pool);
+					::fprintf(stderr, "  ... %d optimizer threads \x1b[1mOK\x1b[0m\n", optim_pool.size());
+				}
+			}
+
+			// correlative scan matching for initial localization and failure recovery
+			if( !::is_proc_shutoff() && pconf.recovery_dist.value > 0 ) {
+				gnd::opsm::bnb::initial_parameter *p;
+				recovery = new gnd::opsm::bnb;
+				recovery->initial_parameter_create(&recovery_ini);
+				p = static_cast<gnd::opsm::bnb::initial_parameter*>(recovery_ini);
+				p->dist = pconf.recovery_dist.value;
+				p->orient = pconf.recovery_orient.value;
+				::fprintf(stderr, "  ... branch and bound recovery \x1b[1mOK\x1b[0m\n");
+			}
+
 		} // ---> set optimizer
 
 
+		// ---> huge page backing of map memory units
+		if( !::is_proc_shutoff() && pconf.huge_page.value ) {
+			for( size_t i = 0; i < gnd::opsm::PlaneNum; i++ ) {
+				cnt_smmap.plane[i].set_huge_page(true);
+				smmap.plane[i].set_huge_page(true);
+				smmap_back.plane[i].set_huge_page(true);
+			}
+		} // <--- huge page backing of map memory units
 
 
 		// ---> build map
@@ -217,29 +328,51 @@ int main(int argc, char* argv[]) {
 				::proc_shutoff();
 				::fprintf(stderr, "  ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to load scan matching map \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
 			}
-			else if( !pconf.ndt.value){
-				if( gnd::opsm::build_map(&smmap, &cnt_smmap, gnd_mm2dist(1)) < 0) {
-					::proc_shutoff();
-					::fprintf(stderr, "  ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to build scan matching map \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
-				}
-				else {
-					::fprintf(stderr, "  ... \x1b[1mOK\x1b[0m: load scan matching map \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
-				}
-			}
 			else {
-				if(gnd::opsm::build_ndt_map(&smmap, &cnt_smmap, gnd_mm2dist(1)) < 0){
+				double prm[2] = { pconf.ndt.value ? 1.0 : 0.0, gnd_mm2dist(1) };
+				cmpl_key = gnd::opsm::counting_map_key(&cnt_smmap, gnd::mapped_file_checksum(prm, sizeof(prm)));
+
+				// built map is used if it is written by previous run
+				if( gnd::opsm::read_map(&smmap, &cnt_smmap, pconf.init_opsm_map.value,
+						gnd::opsm::CMapFileNameDefault, gnd::opsm::MapFileExtension, cmpl_key) == 0 ) {
+					::fprintf(stderr, "  ... \x1b[1mOK\x1b[0m: map built map file in \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
+				}
+				else if( (!pconf.ndt.value ? gnd::opsm::build_map(&smmap, &cnt_smmap, gnd_mm2dist(1)) :
+						gnd::opsm::build_ndt_map(&smmap, &cnt_smmap, gnd_mm2dist(1))) < 0) {
 					::proc_shutoff();
 					::fprintf(stderr, "  ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to build scan matching map \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
 				}
 				else {
 					::fprintf(stderr, "  ... \x1b[1mOK\x1b[0m: load scan matching map \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
+					// write built map file for next run (read-only map directory is allowed)
+					if( gnd::opsm::write_map(&smmap, pconf.init_opsm_map.value,
+							gnd::opsm::CMapFileNameDefault, gnd::opsm::MapFileExtension, cmpl_key) < 0 ) {
+						::fprintf(stderr, "  ... \x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: fail to write built map file in \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
+					}
 				}
 			}
 		} // <--- build map
 
 
 		// set map
-		if(!::is_proc_shutoff() )	optimizer->set_map(&smmap);
+		if(!::is_proc_shutoff() ) {
+			optimizer->set_map(&smmap);
+			if( recovery ) recovery->set_map(&smmap);
+			// compiled map is used if it is built
+			if( cmpl_key && gnd::opsm::read_compiled_map(&smmap_cmpl, pconf.init_opsm_map.value,
+					gnd::opsm::CMapFileNameDefault, gnd::opsm::CmplFileExtension, cmpl_key) == 0 ) {
+				// map the compiled map file of previous run (zero-copy)
+				::fprintf(stderr, "  ... \x1b[1mOK\x1b[0m: map compiled map file in \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
+			}
+			else if( gnd::opsm::build_compiled_map(&smmap_cmpl, &smmap) == 0 && cmpl_key ) {
+				// write compiled map file for next run (read-only map directory is allowed)
+				if( gnd::opsm::write_compiled_map(&smmap_cmpl, pconf.init_opsm_map.value,
+						gnd::opsm::CMapFileNameDefault, gnd::opsm::CmplFileExtension, cmpl_key) < 0 ) {
+					::fprintf(stderr, "  ... \x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: fail to write compiled map file in \"\x1b[4m%s\x1b[0m\"\n", pconf.init_opsm_map.value);
+				}
+			}
+			optimizer->set_compiled_map(&smmap_cmpl);
+		}
 
 
 		// ---> initialize ssm
@@ -310,7 +443,8 @@ int main(int argc, char* argv[]) {
 
 						coordtree.set_coordinate(coordid_odm, &pos_cc);
 					} // ---> set coordinate
-					ssm_odometry.setBlocking(true);
+					// in scheduler mode, operation loop sleeps by itself
+					ssm_odometry.setBlocking( !pconf.scheduler.value );
 					ssm_odometry.readLast();
 				}
 			}
@@ -345,6 +479,7 @@ int main(int argc, char* argv[]) {
 
 					// allocate
 					ssm_sokuikiraw.data.alloc(ssm_sokuikiraw.property.numPoints);
+					sokuiki_beam.set(ssm_sokuikiraw.property);
 
 					// define coordinate
 					coordtree.set_coordinate(coordid_sns, &ssm_sokuikiraw.property.coordm);
@@ -443,6 +578,26 @@ int main(int argc, char* argv[]) {
 		}
 
 
+		if ( !::is_proc_shutoff() && *pconf.latency_log.value) {
+			char fname[512];
+			::fprintf(stderr, "\n");
+			::fprintf(stderr, " => open latency log file\n");
+
+			if( ::snprintf(fname, sizeof(fname), "%s/%s", *pconf.output_dir.value ? pconf.output_dir.value : "./", pconf.latency_log.value) == sizeof(fname) ){
+				::proc_shutoff();
+				::fprintf(stderr, " ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: file path is too long\n");
+			}
+			else if( !(lat_fp = fopen( fname, "w" )) ) {
+				::proc_shutoff();
+				::fprintf(stderr, " ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to open \"\x1b[4m%s\x1b[0m\"\n", fname);
+			}
+			else {
+				::fprintf(lat_fp, "# 1.[time, s] 2.[stage] 3.[count] 4.[mean] 5.[50%%] 6.[95%%] 7.[99%%] 8.[max] (msec)\n");
+				::fprintf(stderr, "  ... \x1b[1mOK\x1b[0m\n");
+			}
+		}
+
+
 		if ( !::is_proc_shutoff() && !cmap.is_allocate()) {
 			// create map
 			gnd::odometry::correction::create(&cmap, pconf.pos_gridsizex.value, pconf.pos_gridsizey.value, pconf.ang_rsl.value);
@@ -476,12 +631,14 @@ int main(int argc, char* argv[]) {
 		Spur_Odometry prev_odometry = ssm_odometry.data; // previous odometry position
 		Spur_Odometry move_est;							// estimation of movement quantity
 
-		double culling_sqdist							// data decimation threshold
-		= gnd_square( pconf.culling.value );
+		ssm::ScanPoint2DFilter filter_match;			// laser scanner reading filter for scan matching
+		ssm::ScanPoint2DFilter filter_map;				// laser scanner reading filter for map update
 		double lkl = 0;									// likelihood
 		Spur_Odometry pos_opt = ssm_position_read.data; // optimized position
+		Spur_Odometry pos_start = ssm_position_read.data; // starting position of optimization (reference of failure test)
 		int cnt_opt = 0;								// optimization loop counter
 		int cnt_correct = 0;
+		bool matched = false;
 
 		gnd::vector::fixed_column<3> move_opt;			// position estimation movement by optimization
 		double change_dist = 0;							// change value on distance between previous and current frame
@@ -492,11 +649,27 @@ int main(int argc, char* argv[]) {
 		Spur_Odometry pos_premap;						// odometry position streaming data
 		ssmTimeT time_premap = 0;						// previous map update time
 
-		gnd::matrix::fixed<4,4> coordm_sns2rbt;			// coordinate convert matrix from sensor to robot
-		gnd::matrix::fixed<4,4> coordm_sns2gl;			// coordinate convert matrix from sensor to global
+		gnd::matrix::coord2d coordm_sns2rbt;			// planar transform from sensor to robot
+		gnd::matrix::coord2d coordm_sns2gl;				// planar transform from sensor to global
 
 		double cuito = 0;								// blocking time out for cui input
 
+		{ // ---> laser scanner reading filter
+			filter_match.distMin = ssm_sokuikiraw.property.distMin * 1.1;
+			filter_match.distMax = ssm_sokuikiraw.property.distMax * 0.9;
+			filter_map.distMin = ssm_sokuikiraw.property.distMin;
+			filter_map.distMax = ssm_sokuikiraw.property.distMax;
+			if( pconf.use_range_dist.value > 0 && filter_match.distMax > pconf.use_range_dist.value )
+				filter_match.distMax = pconf.use_range_dist.value;
+			if( pconf.use_range_dist.value > 0 && filter_map.distMax > pconf.use_range_dist.value )
+				filter_map.distMax = pconf.use_range_dist.value;
+			filter_match.angMax = pconf.use_range_orient.value;
+			filter_map.angMax = pconf.use_range_orient.value;
+			// data decimation threshold
+			filter_match.cull = pconf.culling.value;
+			filter_map.cull = pconf.culling.value;
+		} // <--- laser scanner reading filter
+
 		gnd::timer::interval_timer timer_clock;			// clock
 		gnd::timer::interval_timer timer_operate;			// operation timer
 		gnd::timer::interval_timer timer_show;			// time operation timer
@@ -505,7 +678,21 @@ int main(int argc, char* argv[]) {
 		bool mapupdate = false;
 		int cnt_mapupdate = 0;
 
+		bool busy = true;								// scheduler: any event is processed in previous loop
+		double odm_cycle = 0;							// scheduler: estimated odometry cycle
+		ssmTimeT odm_prevtime = ssm_odometry.time;		// scheduler: previous odometry time
+
 		int cnt_fail = 0;
+		int cnt_recovery = 0;
+
+		gnd::stopwatch sw_stage;						// latency: stage stopwatch
+		gnd::timer::histogram lat_read;					// latency: scan read and entry
+		gnd::timer::histogram lat_optimize;				// latency: optimization iteration (and recovery)
+		gnd::timer::histogram lat_mapupdate;			// latency: map update entry
+		gnd::timer::histogram lat_build;				// latency: map integration and build (map updater)
+		gnd::timer::histogram lat_cycle;				// latency: whole scan matching
+		int cnt_overrun = 0;							// scan matching took longer than cycle
+		gnd::timer::interval_timer timer_latency;		// latency log timer
 
 		// get coordinate convert matrix
 		coordtree.get_convert_matrix(coordid_sns, coordid_rbt, &coordm_sns2rbt);
@@ -612,54 +799,19 @@ int main(int argc, char* argv[]) {
 
 					gnd::matrix::set_zero(&move_opt);
 					{ // ---> 3. entry laser scanner reading
-						gnd::vector::fixed_column<3> delta;
-						gnd::vector::fixed_column<2> reflect_prevent;
-
-						// clear previous entered sensor reading
-						gnd::matrix::set_zero(&reflect_prevent);
+						// extract valid reflection points
+						sokuiki_beam.extract(&ssm_sokuikiraw.data, filter_match, &sokuiki_pts);
+						// convert from sensor coordinate to global coordinate (in place)
+						gnd::matrix::coord2d_convert(&coordm_sns2gl, sokuiki_pts.x, sokuiki_pts.y, sokuiki_pts.numPoints(),
+								sokuiki_pts.x, sokuiki_pts.y);
 
 						// ---> scanning loop for sokuikiraw-data
-						for(size_t i = 0; i < ssm_sokuikiraw.data.numPoints(); i++){
-							// ---> entry laser scanner reflection
-							gnd::vector::fixed_column<4> reflect_csns, reflect_cgl;
-							gnd::vector::fixed_column<3> ws3x1;
-							gnd::matrix::fixed<3,3> ws3x3;
-
-							// if range data is null because of no reflection
-							if(ssm_sokuikiraw.data[i].status == ssm::laser::STATUS_NO_REFLECTION)	continue;
-							// ignore error data
-							else if(ssm_sokuikiraw.data[i].isError()) 	continue;
-							else if(ssm_sokuikiraw.data[i].r < ssm_sokuikiraw.property.distMin * 1.1)	continue;
-							else if(ssm_sokuikiraw.data[i].r > ssm_sokuikiraw.property.distMax * 0.9)	continue;
-							else if( pconf.use_range_dist.value > 0 && ssm_sokuikiraw.data[i].r > pconf.use_range_dist.value )		continue;
-							else if( pconf.use_range_orient.value > 0 && ssm_sokuikiraw.data[i].th > pconf.use_range_orient.value )	continue;
-
-
-							{ // ---> compute laser scanner reading position on robot coordinate
-								// set search position on sensor-coordinate
-								reflect_csns[0] = ssm_sokuikiraw.data[i].r * ::cos(ssm_sokuikiraw.data[i].th);
-								reflect_csns[1] = ssm_sokuikiraw.data[i].r * ::sin(ssm_sokuikiraw.data[i].th);
-								reflect_csns[2] = 0;
-								reflect_csns[3] = 1;
-
-								// data decimation with distance threshold
-								if( gnd_square(reflect_csns[0] - reflect_prevent[0]) + gnd_square(reflect_csns[1] - reflect_prevent[1]) < culling_sqdist ){
-									continue;
-								}
-								else {
-									// update previous entered data
-									gnd::matrix::copy(&reflect_prevent, &reflect_csns);
-								}
-
-								// convert from sensor coordinate to robot coordinate
-								gnd::matrix::prod(&coordm_sns2gl, &reflect_csns, &reflect_cgl);
-							} // <--- compute laser scanner reading position on robot coordinate
-
+						for(size_t i = 0; i < sokuiki_pts.numPoints(); i++){
 							// data entry
-							gnd::opsm::counting_map(&cnt_smmap, reflect_cgl[0], reflect_cgl[1]);
+							gnd::opsm::counting_map(&cnt_smmap, sokuiki_pts.x[i], sokuiki_pts.y[i]);
 
 							// log
-							if( llog_fp )	::fprintf(llog_fp, "%lf %lf\n", reflect_cgl[0], reflect_cgl[1]);
+							if( llog_fp )	::fprintf(llog_fp, "%lf %lf\n", sokuiki_pts.x[i], sokuiki_pts.y[i]);
 						} // <--- scanning loop for sokuikiraw-data
 
 						// log
@@ -689,9 +841,49 @@ int main(int argc, char* argv[]) {
 			else {
 				::fprintf(stderr, "\n... \x1b[1mOK\x1b[0m success to build ndt map\n");
 			} // <--- map build
+			gnd::opsm::build_compiled_map(&smmap_cmpl, &smmap);
 		} // <--- map initialization
 
 
+		// ---> build map pyramid
+		if( !::is_proc_shutoff() && pconf.map_pyramid.value > 0 ) {
+			size_t n = (size_t) pconf.map_pyramid.value < gnd::opsm::PyramidLevelMax ? (size_t) pconf.map_pyramid.value : gnd::opsm::PyramidLevelMax;
+
+			if( pconf.ndt.value ) {
+				::fprintf(stderr, "\x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: map pyramid is not supported in ndt mode\n");
+			}
+			else if( gnd::opsm::build_map_pyramid(&smmap_pyr, &cnt_smmap, n, gnd_mm2dist(1)) < 0 ) {
+				::fprintf(stderr, "\x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: fail to build map pyramid\n");
+			}
+			else {
+				optimizer->set_map_pyramid(&smmap_pyr);
+				mapper.set_pyramid(&smmap_pyr, &smmap_pyr_back, n);
+				::fprintf(stderr, "... \x1b[1mOK\x1b[0m success to build map pyramid (%d levels)\n", (int)n);
+			}
+		} // <--- build map pyramid
+
+
+		// ---> build field of correlative scan matching
+		if( !::is_proc_shutoff() && recovery ) {
+			if( gnd::opsm::build_bnb_field(&smmap_field, &smmap) < 0 ) {
+				::fprintf(stderr, "\x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: fail to build field of correlative scan matching\n");
+			}
+			else {
+				// rebuilt with the map by map updater, not in the loop of scan matching
+				recovery->set_field(&smmap_field);
+				mapper.set_field(&smmap_field, &smmap_field_back, recovery);
+			}
+		} // <--- build field of correlative scan matching
+
+
+		// ---> start map updater
+		if( mapper.begin(&cnt_smmap, &smmap, &smmap_cmpl, &smmap_back, &smmap_cmpl_back, optimizer,
+				pconf.ndt.value, pconf.map_update.value, gnd_mm2dist(1), pconf.map_update_thread.value) < 0 ){
+			::fprintf(stderr, "\x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to start map update thread\n");
+			::proc_shutoff();
+		} // <--- start map updater
+
+
 		{ // ---> initialize corrected position
 			ssm_position_write.data = ssm_odometry.data;
 			ssm_position_read.data = ssm_odometry.data;;
@@ -723,6 +915,7 @@ int main(int argc, char* argv[]) {
 			timer_clock.begin(CLOCK_REALTIME, pconf.cycle.value );
 			if( pconf.cui_show.value )	timer_show.begin(CLOCK_REALTIME, ShowCycle, -ShowCycle);
 			else 							::fprintf(stderr, "  > ");
+			if( lat_fp )				timer_latency.begin(CLOCK_REALTIME, LatencyLogCycle);
 		} // <--- timer
 
 
@@ -730,6 +923,23 @@ int main(int argc, char* argv[]) {
 		// ---> operation loop
 		while ( !::is_proc_shutoff() ) {
 			//			timer_clock.wait();
+			double cui_timeout = cuito;					// cui polling time out
+
+			// ---> scheduler
+			// sleep in cui polling until next expected sensor reading (at most wake-latency)
+			if( pconf.scheduler.value && cuito >= 0 && !busy ) {
+				ssmTimeT now = gettimeSSM();
+				double t;
+
+				cui_timeout = pconf.wake_latency.value;
+				// next laser scanner reading
+				t = ssm_sokuikiraw.time + ssm_sokuikiraw.property.cycle - now;
+				if( ssm_sokuikiraw.property.cycle > 0 && t > 0 && t < cui_timeout )	cui_timeout = t;
+				// next odometry
+				t = ssm_odometry.time + odm_cycle - now;
+				if( odm_cycle > 0 && t > 0 && t < cui_timeout )	cui_timeout = t;
+			} // <--- scheduler
+			busy = false;
 
 			{ // ---> cui
 				int cuival = 0;
@@ -738,7 +948,8 @@ int main(int argc, char* argv[]) {
 				::memset(cuiarg, 0, sizeof(cuiarg));
 
 				// ---> get command
-				if( gcui.poll(&cuival, cuiarg, sizeof(cuiarg), cuito) > 0 ){
+				if( gcui.poll(&cuival, cuiarg, sizeof(cuiarg), cui_timeout) > 0 ){
+					busy = true;
 					if( timer_show.cycle() > 0 ){
 						// quit show status mode
 						timer_show.end();
@@ -832,6 +1043,16 @@ int main(int argc, char* argv[]) {
 					nline_show++; ::fprintf(stderr, "\x1b[K*      use range : %lf [deg]\n", pconf.use_range_orient.value );
 				}
 				nline_show++; ::fprintf(stderr, "\x1b[K   matching fail : %d\n", cnt_fail );
+				if( recovery ) {
+					nline_show++; ::fprintf(stderr, "\x1b[K        recovery : %d\n", cnt_recovery );
+				}
+				nline_show++; ::fprintf(stderr, "\x1b[K         overrun : %d\n", cnt_overrun );
+				mapper.latency(&lat_build);
+				nline_show++; lat_read.print(stderr, "scan read", "\x1b[K");
+				nline_show++; lat_optimize.print(stderr, "optimize", "\x1b[K");
+				nline_show++; lat_mapupdate.print(stderr, "map update", "\x1b[K");
+				nline_show++; lat_build.print(stderr, "build map", "\x1b[K");
+				nline_show++; lat_cycle.print(stderr, "total", "\x1b[K");
 				nline_show++; ::fprintf(stderr, "\x1b[K\n");
 				nline_show++; ::fprintf(stderr, "\x1b[K Push \x1b[1mEnter\x1b[0m to change CUI Mode\n");
 			} // <--- show status
@@ -839,6 +1060,17 @@ int main(int argc, char* argv[]) {
 
 			// ---> update position
 			if( ssm_odometry.readNext() ){
+				busy = true;
+				{ // ---> estimate odometry cycle (scheduler)
+					double dt = ssm_odometry.time - odm_prevtime;
+
+					if( dt > 0 ) {
+						if( odm_cycle <= 0 )	odm_cycle = dt;
+						else					odm_cycle += 0.1 * (dt - odm_cycle);
+					}
+					odm_prevtime = ssm_odometry.time;
+				} // <--- estimate odometry cycle (scheduler)
+
 				{ // ---> compute the movement estimation
 					gnd::vector::fixed_column<4> odov_cprev;			// current odometry position vector on previous odometry coordinate
 
@@ -917,6 +1149,10 @@ int main(int argc, char* argv[]) {
 
 			// ---> read ssm-sokuikiraw-data
 			if( timer_operate.clock() && ssm_sokuikiraw.readNew()  ) {
+				double lap = 0, total = 0;
+
+				busy = true;
+				sw_stage.begin(CLOCK_MONOTONIC);
 				// ---> position tracking
 				// ... operation flow
 				//      *0. get laser scanner reading
@@ -928,98 +1164,89 @@ int main(int argc, char* argv[]) {
 				// read sokuiki data
 				if( !ssm_position_read.readTime( ssm_sokuikiraw.time) ) continue;
 
+				// swap in map updated on background thread
+				mapper.publish();
+
 				// ---> 2. set position estimation by odometry as optimization starting value
 				optimizer->initial_parameter_set_position( optim_ini, ssm_position_read.data.x, ssm_position_read.data.y, ssm_position_read.data.theta );
 				optimizer->begin(optim_ini);
+				if( recovery ) {
+					recovery->set_map( mapper.map() );
+					recovery->initial_parameter_set_position( recovery_ini, ssm_position_read.data.x, ssm_position_read.data.y, ssm_position_read.data.theta );
+					recovery->begin(recovery_ini);
+				}
 
 
 				gnd::matrix::set_zero(&move_opt);
 				{ // ---> 3. optimization iteration by matching laser scanner reading to map(likelihood field)
-					gnd::vector::fixed_column<3>	delta;
-					gnd::vector::fixed_column<2>	reflect_prevent;
 
-					// clear previous entered sensor reading
-					gnd::matrix::set_zero(&reflect_prevent);
+					// extract valid reflection points
+					sokuiki_beam.extract(&ssm_sokuikiraw.data, filter_match, &sokuiki_pts);
+					// convert from sensor coordinate to robot coordinate (in place)
+					gnd::matrix::coord2d_convert(&coordm_sns2rbt, sokuiki_pts.x, sokuiki_pts.y, sokuiki_pts.numPoints(),
+							sokuiki_pts.x, sokuiki_pts.y);
 
 					// ---> scanning loop for sokuikiraw-data
-					for(size_t i = 0; i < ssm_sokuikiraw.data.numPoints(); i++){
-						// ---> entry laser scanner reflection
-						gnd::vector::fixed_column<4> reflect_csns, reflect_crbt;
-						gnd::vector::fixed_column<3> ws3x1;
-						gnd::matrix::fixed<3,3>		 ws3x3;
-
-						// if range data is null because of no reflection
-						if( ssm_sokuikiraw.data[i].status == ssm::laser::STATUS_NO_REFLECTION)	continue;
-						// ignore error data
-						else if( ssm_sokuikiraw.data[i].isError()) 	continue;
-						else if( ssm_sokuikiraw.data[i].r < ssm_sokuikiraw.property.distMin * 1.1)	continue;
-						else if( ssm_sokuikiraw.data[i].r > ssm_sokuikiraw.property.distMax * 0.9)	continue;
-						else if( pconf.use_range_dist.value > 0 && ssm_sokuikiraw.data[i].r > pconf.use_range_dist.value )		continue;
-						else if( pconf.use_range_orient.value > 0 && ssm_sokuikiraw.data[i].th > pconf.use_range_orient.value )	continue;
-
-						{ // ---> compute laser scanner reading position on robot coordinate
-							// set search position on sensor-coordinate
-							reflect_csns[0] = ssm_sokuikiraw.data[i].r * ::cos( ssm_sokuikiraw.data[i].th );
-							reflect_csns[1] = ssm_sokuikiraw.data[i].r * ::sin( ssm_sokuikiraw.data[i].th );
-							reflect_csns[2] = 0;
-							reflect_csns[3] = 1;
-
-							// data decimation with distance threshold
-							if( gnd_square(reflect_csns[0] - reflect_prevent[0]) + gnd_square(reflect_csns[1] - reflect_prevent[1]) < culling_sqdist ){
-								continue;
-							}
-							else {
-								// update previous entered data
-								gnd::matrix::copy(&reflect_prevent, &reflect_csns);
-							}
-
-							// convert from sensor coordinate to robot coordinate
-							gnd::matrix::prod(&coordm_sns2rbt, &reflect_csns, &reflect_crbt);
-						} // <--- compute laser scanner reading position on robot coordinate
-
+					for(size_t i = 0; i < sokuiki_pts.numPoints(); i++){
 						// data entry
-						optimizer->set_scan_point( reflect_crbt[0], reflect_crbt[1] );
-						// <--- entry laser scanner reflection
+						optimizer->set_scan_point( sokuiki_pts.x[i], sokuiki_pts.y[i] );
+						if( recovery ) recovery->set_scan_point( sokuiki_pts.x[i], sokuiki_pts.y[i] );
 					} // <--- scanning loop for sokuikiraw-data
+					if( sw_stage.get(0, &lap) == 0 )	lat_read.record(lap);
 
 					if( optimizer->nscan_point() <= 0 )	continue;
 
-					// zero reset likelihood
-					lkl = 0;
-					// zero reset optimization iteration counter
-					cnt_opt = 0;
 					gnd::matrix::set_zero(&move_opt);
-					do{
-						// store previous optimization position likelihood
-
-						{ // ---> step iteration of optimization
-							gnd::vector::fixed_column<3> ws3x1;
-							if( (ret = optimizer->iterate(&delta, &ws3x1, &lkl)) < 0 ){
-								break;
-							}
-
-							// get optimized position
-							pos_opt.x = ws3x1[0];
-							pos_opt.y = ws3x1[1];
-							pos_opt.theta = ws3x1[2];
-							// get movement by optimization
-							gnd::matrix::add(&move_opt, &delta, &move_opt);
-						} // <--- step iteration of optimization
-
-						// loop counting
-						cnt_opt++;
-						// convergence test
-					} while( !optimizer->converge_test() ); // <--- position optimization loop
+					pos_start = ssm_position_read.data;
+					// ---> initial localization
+					if( recovery && cnt_correct == 0 ) {
+						gnd::vector::fixed_column<3> delta, ws3x1;
+						double score;
+
+						// start optimization from the global optimum in the search window
+						if( recovery->iterate(&delta, &ws3x1, &score) >= 0 && score >= pconf.recovery_score.value ) {
+							gnd::matrix::copy(&move_opt, &delta);
+							optimize_restart(optimizer, optim_ini, recovery, &ws3x1);
+							pos_start.x = ws3x1[0];
+							pos_start.y = ws3x1[1];
+							pos_start.theta = ws3x1[2];
+						}
+					} // <--- initial localization
 
+					ret = optimize_converge(optimizer, &move_opt, &pos_opt, &lkl, &cnt_opt);
 				} // ---> 3. optimization iteration by matching laser scanner reading to map(likelihood field)
 
 
 
 				// ---> 4. optimization error test and write position ssm-data
-				// check --- 1st. function error, 2nd. distance, 3rd. orient difference
-				if( ret >= 0 &&
-						gnd_square( ssm_position_read.data.x - pos_opt.x ) + gnd_square( ssm_position_read.data.y - pos_opt.y ) < gnd_square( pconf.failure_dist.value ) &&
-						::fabs( gnd_rad_normalize( ssm_position_read.data.theta - pos_opt.theta) ) < pconf.failure_orient.value ) {
+				// check --- 1st. function error, 2nd. distance, 3rd. orient difference (from the starting position)
+				matched = ret >= 0 &&
+						gnd_square( pos_start.x - pos_opt.x ) + gnd_square( pos_start.y - pos_opt.y ) < gnd_square( pconf.failure_dist.value ) &&
+						::fabs( gnd_rad_normalize( pos_start.theta - pos_opt.theta) ) < pconf.failure_orient.value;
+
+				// ---> failure recovery by correlative scan matching
+				if( !matched && recovery && cnt_correct > 0 ) {
+					gnd::vector::fixed_column<3> delta, ws3x1;
+					double score;
+
+					if( recovery->iterate(&delta, &ws3x1, &score) >= 0 && score >= pconf.recovery_score.value ) {
+						// refine the result of correlative search
+						gnd::matrix::copy(&move_opt, &delta);
+						optimize_restart(optimizer, optim_ini, recovery, &ws3x1);
+						pos_start.x = ws3x1[0];
+						pos_start.y = ws3x1[1];
+						pos_start.theta = ws3x1[2];
+						ret = optimize_converge(optimizer, &move_opt, &pos_opt, &lkl, &cnt_opt);
+
+						matched = ret >= 0 &&
+								gnd_square( pos_start.x - pos_opt.x ) + gnd_square( pos_start.y - pos_opt.y ) < gnd_square( pconf.failure_dist.value ) &&
+								::fabs( gnd_rad_normalize( pos_start.theta - pos_opt.theta) ) < pconf.failure_orient.value;
+						if( matched )	cnt_recovery++;
+					}
+				} // <--- failure recovery by correlative scan matching
+				if( sw_stage.get(0, &lap) == 0 )	lat_optimize.record(lap);
+
+				if( matched ) {
 
 
 					if( (cnt_correct >= pconf.ini_match_cnt.value ||
@@ -1080,72 +1307,32 @@ int main(int argc, char* argv[]) {
 							gnd_square( ssm_position_write.data.x - pos_premap.x) + gnd_square( ssm_position_write.data.y - pos_premap.y) > gnd_square(pconf.map_update_dist.value) ||
 							::fabs( ssm_position_write.data.theta - pos_premap.theta ) > pconf.map_update_orient.value;
 
-					if( mapupdate ) cnt_mapupdate++;
-					if( mapupdate && !pconf.map_update.value ){ // ---> clear
-						gnd::opsm::clear_counting_map(&cnt_smmap);
-					} // <--- clear
+					if( mapupdate ) {
+						cnt_mapupdate++;
+						// previous update have to be finished before entry
+						mapper.wait();
+					}
 
 					{// ---> scanning loop for sokuikiraw-data
-						gnd::vector::fixed_column<4> reflect_csns;
-						gnd::vector::fixed_column<4> reflect_cgl;
-						gnd::vector::fixed_column<2> reflect_prevent;
+						// extract valid reflection points
+						sokuiki_beam.extract(&ssm_sokuikiraw.data, filter_map, &sokuiki_pts);
+						// convert from sensor coordinate to global coordinate (in place)
+						gnd::matrix::coord2d_convert(&coordm_sns2gl, sokuiki_pts.x, sokuiki_pts.y, sokuiki_pts.numPoints(),
+								sokuiki_pts.x, sokuiki_pts.y);
 
 						// ---> scanning loop of laser scanner reading
-						for(size_t i = 0; i < ssm_sokuikiraw.data.numPoints(); i++){
-							gnd::vector::fixed_column<3> ws3x1;
-							gnd::matrix::fixed<3,3> ws3x3;
-
-							// if range data is null because of no reflection
-							if( ssm_sokuikiraw.data[i].status == ssm::laser::STATUS_NO_REFLECTION)	continue;
-							// ignore error data
-							else if( ssm_sokuikiraw.data[i].isError()) 	continue;
-							else if( ssm_sokuikiraw.data[i].r < ssm_sokuikiraw.property.distMin)	continue;
-							else if( ssm_sokuikiraw.data[i].r > ssm_sokuikiraw.property.distMax)	continue;
-							else if( pconf.use_range_dist.value > 0 && ssm_sokuikiraw.data[i].r > pconf.use_range_dist.value )		continue;
-							else if( pconf.use_range_orient.value > 0 && ssm_sokuikiraw.data[i].th > pconf.use_range_orient.value )	continue;
-
-
-
-							{ // ---> compute laser scanner reading position on global coordinate
-								// set search position on sensor-coordinate
-								gnd::matrix::set(&reflect_csns, 0, 0, ssm_sokuikiraw.data[i].r * ::cos( ssm_sokuikiraw.data[i].th ));
-								gnd::matrix::set(&reflect_csns, 1, 0, ssm_sokuikiraw.data[i].r * ::sin( ssm_sokuikiraw.data[i].th ) );
-								gnd::matrix::set(&reflect_csns, 2, 0, 0);
-								gnd::matrix::set(&reflect_csns, 3, 0, 1);
-
-								// data decimation with distance threshold
-								if( gnd_square(reflect_csns[0] - reflect_prevent[0]) + gnd_square(reflect_csns[1] - reflect_prevent[1]) < culling_sqdist ){
-									continue;
-								}
-								else {
-									// update previous entered data
-									gnd::matrix::copy(&reflect_prevent, &reflect_csns);
-								}
-
-								// convert from sensor coordinate to global coordinate
-								gnd::matrix::prod(&coordm_sns2gl, &reflect_csns, &reflect_cgl);
-							} // <--- compute laser scanner reading position on global coordinate
+						for(size_t i = 0; i < sokuiki_pts.numPoints(); i++){
 
 							// ---> enter laser scanner reading to map
 							if( mapupdate ) {
-								if( pconf.map_update.value ){
-									if( pconf.ndt.value ) {
-										gnd::opsm::update_ndt_map(&cnt_smmap, &smmap, reflect_cgl[0], reflect_cgl[1], gnd_mm2dist(1));
-									}
-									else {
-										gnd::opsm::update_map(&cnt_smmap, &smmap, reflect_cgl[0], reflect_cgl[1], gnd_mm2dist(1));
-									}
-								}
-								else {
-									gnd::opsm::counting_map(&cnt_smmap, reflect_cgl[0], reflect_cgl[1]);
-								}
+								mapper.push(sokuiki_pts.x[i], sokuiki_pts.y[i]);
 								// update
 								time_premap = ssm_sokuikiraw.time;
 								pos_premap = ssm_position_write.data;
 							} // <--- enter laser scanner reading to map
 
 							// log
-							if( llog_fp )	::fprintf(llog_fp, "%lf %lf\n", reflect_cgl[0], reflect_cgl[1]);
+							if( llog_fp )	::fprintf(llog_fp, "%lf %lf\n", sokuiki_pts.x[i], sokuiki_pts.y[i]);
 						} // <--- scanning loop of laser scanner reading
 
 						// log
@@ -1154,29 +1341,49 @@ int main(int argc, char* argv[]) {
 					} // <--- scanning loop for sokuikiraw-data
 
 
-					// ---> rebuild map
+					// ---> update map
+					// slam mode: update map incrementally
+					// otherwise: clear counting map and rebuild map
+					// if map-update-thread, map is updated on background thread and swapped before next matching
 					if( mapupdate ) {
-						if( pconf.map_update.value ){
-						}
-						else {
-							if( !pconf.ndt.value ){
-								if( gnd::opsm::build_map(&smmap, &cnt_smmap, gnd_mm2dist(1)) < 0 ){
-									::fprintf(stderr, "\x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: invalid map property\n");
-								}
-							}
-							else{
-								if( gnd::opsm::build_ndt_map(&smmap, &cnt_smmap, gnd_mm2dist(1)) < 0 ){
-									::fprintf(stderr, "\x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: invalid map property\n");
-								}
-							}
-						}
-					} // <--- rebuild map
+						mapper.post();
+					} // <--- update map
 				} // ---> 6. update map
+				if( sw_stage.get(&total, &lap) == 0 ) {
+					lat_mapupdate.record(lap);
+					lat_cycle.record(total);
+					if( pconf.cycle.value > 0 && total > pconf.cycle.value ) cnt_overrun++;
+				}
 				cnt++;
 			} // <--- read ssm sokuikiraw
 
+
+			// ---> latency log
+			if( lat_fp && timer_latency.clock() > 0 ) {
+				ssmTimeT t = gettimeSSM();
+
+				mapper.latency(&lat_build);
+				lat_read.txtlog(lat_fp, t, "scan-read");
+				lat_optimize.txtlog(lat_fp, t, "optimize");
+				lat_mapupdate.txtlog(lat_fp, t, "map-update");
+				lat_build.txtlog(lat_fp, t, "build-map");
+				lat_cycle.txtlog(lat_fp, t, "total");
+				::fflush(lat_fp);
+			} // <--- latency log
+
 		} // <--- operation loop
 
+		if( lat_fp ) { // ---> latency log (final)
+			ssmTimeT t = gettimeSSM();
+
+			mapper.latency(&lat_build);
+			lat_read.txtlog(lat_fp, t, "scan-read");
+			lat_optimize.txtlog(lat_fp, t, "optimize");
+			lat_mapupdate.txtlog(lat_fp, t, "map-update");
+			lat_build.txtlog(lat_fp, t, "build-map");
+			lat_cycle.txtlog(lat_fp, t, "total");
+		} // <--- latency log (final)
+
 	} // <--- operation
 
 
@@ -1185,14 +1392,30 @@ int main(int argc, char* argv[]) {
 		if(tlog_fp) ::fclose(tlog_fp);
 		if(llog_fp) ::fclose(llog_fp);
 		if(t4re_fp) ::fclose(t4re_fp);
+		if(lat_fp) ::fclose(lat_fp);
 
 		ssm_odometry.close();
 		ssm_position_write.close();
 		ssm_sokuikiraw.close();
 		::endSSM();
 
+		// wait for map update
+		mapper.end();
+		gnd::opsm::destroy_compiled_map(&smmap_cmpl_back);
+		gnd::opsm::destroy_map(&smmap_back);
+		gnd::opsm::destroy_map_pyramid(&smmap_pyr_back);
+		gnd::opsm::destroy_bnb_field(&smmap_field_back);
+
 		optimizer->initial_parameter_delete(&optim_ini);
 		delete optimizer;
+		optim_pool.end();
+		if( recovery ) {
+			recovery->initial_parameter_delete(&recovery_ini);
+			delete recovery;
+		}
+		gnd::opsm::destroy_compiled_map(&smmap_cmpl);
+		gnd::opsm::destroy_map_pyramid(&smmap_pyr);
+		gnd::opsm::destroy_bnb_field(&smmap_field);
 
 		// slam
 		if( pconf.map_update.value ) {
@@ -1252,7 +1475,7 @@ int main(int argc, char* argv[]) {
 				gnd::bmp32_t bmp;
 
 				// bmp file building
-				gnd::opsm::build_bmp32(&bmp, &smmap, gnd_m2dist( 1.0 / 10));
+				gnd::opsm::build_bmp32(&bmp, &smmap, gnd_m2dist( 1.0 / 10), 0.0, 4.0, &bmp_ws);
 				{ // ---> bmp
 					char fname[512];
 					::fprintf(stderr, " => write psm-image in bmp(32bit)\n");
@@ -1290,7 +1513,7 @@ int main(int argc, char* argv[]) {
 			if( pconf.bmp.value ) { // ---> bmp (8bit)
 				gnd::bmp8_t bmp8;
 
-				gnd::opsm::build_bmp8(&bmp8, &smmap, gnd_m2dist( 1.0 / 10));
+				gnd::opsm::build_bmp8(&bmp8, &smmap, gnd_m2dist( 1.0 / 10), 0.0, 4.0, &bmp_ws);
 				{ // ---> bmp
 					char fname[512];
 					::fprintf(stderr, " => write psm-image in bmp(8bit)\n");
@@ -0,0 +1,24 @@
+
+# offline replay build (ssm stand-in of ssmtype/replay/, no ssm daemon required)
+REPLAY_HEADER_DIR	:=ssmtype/replay/
+
+#optimize option
+_OPT_OPTION_	:=-O3
+
+#warning option
+_WRN_OPTION_	:=-Wall
+
+#debug option
+_DBG_OPTION_	:=
+
+#preprocessor option
+_PRE_OPTION_	:="-DNDEBUG=yes"
+
+#linker option
+_LNK_OPTION_	:=$(patsubst %,-l%,$(sort $(filter-out ssm,$(LIBS)) pthread))
+
+#header directory option
+_HDIR_OPTION_	:=$(patsubst %,-I$(WORKSPACE)%,$(REPLAY_HEADER_DIR) $(HEADER_DIR_LIST))
+
+#library directory option
+_LDIR_OPTION_	:= $(patsubst %,-L$(WORKSPACE)%,$(LIB_DIR_LIST))
@@ -107,6 +107,19 @@ namespace Localizer {
 			"re-sampling parameter"
 	};
 
+	/*
+	 * @brief remain resampling method
+	 */
+	static const char ResampleMultinomial[]	= "multinomial";
+	static const char ResampleSystematic[]	= "systematic";
+	static const char ResampleStratified[]	= "stratified";
+	static const char ResampleAlias[]		= "alias";
+	static const gnd::conf::parameter_array<char, 32> ConfIni_ResampleMethod = {
+			"resample-method",
+			"multinomial",
+			"remain re-sampling method (multinomial, systematic, stratified or alias)"
+	};
+
 	/*
 	 * @brief configure parameter random error resampling ratio
 	 */
@@ -188,6 +201,60 @@ namespace Localizer {
 			36
 	};
 
+	/*
+	 * @brief configure parameter adaptive number of particles (kld-sampling)
+	 */
+	static const gnd::conf::parameter<bool> ConfIni_KLDSampling = {
+			"kld-sampling",
+			false,
+			"adapt number of particles by kld-sampling"
+	};
+
+	/*
+	 * @brief configure parameter minimum number of particles (kld-sampling)
+	 */
+	static const gnd::conf::parameter<int> ConfIni_KLDParticlesMin = {
+			"kld-particles-min",
+			100,
+			"minimum number of particles (kld-sampling)"
+	};
+
+	/*
+	 * @brief configure parameter maximum number of particles (kld-sampling)
+	 */
+	static const gnd::conf::parameter<int> ConfIni_KLDParticlesMax = {
+			"kld-particles-max",
+			2000,
+			"maximum number of particles (kld-sampling)"
+	};
+
+	/*
+	 * @brief configure parameter error bound (kld-sampling)
+	 */
+	static const gnd::conf::parameter<double> ConfIni_KLDError = {
+			"kld-error",
+			0.05,
+			"bound of kl-divergence between sample and true distribution (kld-sampling)"
+	};
+
+	/*
+	 * @brief configure parameter quantile (kld-sampling)
+	 */
+	static const gnd::conf::parameter<double> ConfIni_KLDQuantile = {
+			"kld-quantile",
+			2.33,
+			"upper standard normal quantile of confidence (kld-sampling, 2.33: 99%)"
+	};
+
+	/*
+	 * @brief configure parameter histogram bin size (kld-sampling)
+	 */
+	static const gnd::conf::parameter_array< double, PARTICLE_POS_DIM > ConfIni_KLDBin = {
+			"kld-bin",
+			{ gnd_m2dist(0.5), gnd_m2dist(0.5), gnd_deg2ang(10.0) },
+			"histogram bin size of position (x[m], y[m], theta[deg]) (kld-sampling)"
+	};
+
 
 
 
@@ -265,6 +332,27 @@ namespace Localizer {
 			1.0 / 1145.9 // rad/sec par mV
 	};
 
+	/*
+	 * @brief latency log
+	 */
+	static const gnd::conf::parameter_array<char, 512> ConfIni_LatencyLog = {
+			"latency-txtlog",
+			"",		// file name
+			"processing latency log file name (text)"
+	};
+
+	/*
+	 * @brief particles layout on ssm
+	 */
+	static const char ParticleLayoutAoS[]		= "aos";
+	static const char ParticleLayoutSoA[]		= "soa";
+	static const char ParticleLayoutSoAFloat[]	= "soa-float";
+	static const gnd::conf::parameter_array<char, 32> ConfIni_ParticleLayout = {
+			"particle-layout",
+			"soa",
+			"particles layout on ssm (aos, soa or soa-float)"
+	};
+
 
 
 	/*
@@ -318,6 +406,10 @@ namespace Localizer {
 		 * @brief remain re-sampling rate
 		 */
 		gnd::conf::parameter<double>								resmp_rate_remain;
+		/*
+		 * @brief remain re-sampling method
+		 */
+		gnd::conf::parameter_array<char, 32>						resmp_method;
 		/*
 		 * @brief position error re-sampling rate
 		 */
@@ -386,6 +478,31 @@ namespace Localizer {
 		 */
 		gnd::conf::parameter<int>									random_sampling;
 
+		/*
+		 * @brief adaptive number of particles (kld-sampling)
+		 */
+		gnd::conf::parameter<bool>									kld;
+		/*
+		 * @brief minimum number of particles (kld-sampling)
+		 */
+		gnd::conf::parameter<int>									kld_min;
+		/*
+		 * @brief maximum number of particles (kld-sampling)
+		 */
+		gnd::conf::parameter<int>									kld_max;
+		/*
+		 * @brief error bound (kld-sampling)
+		 */
+		gnd::conf::parameter<double>								kld_error;
+		/*
+		 * @brief quantile (kld-sampling)
+		 */
+		gnd::conf::parameter<double>								kld_quantile;
+		/*
+		 * @brief histogram bin size (kld-sampling)
+		 */
+		gnd::conf::parameter_array<double, PARTICLE_POS_DIM>		kld_bin;
+
 		/*
 		 * @brief pws ssm-id (input)
 		 */
@@ -422,6 +539,16 @@ namespace Localizer {
 		 */
 		gnd::conf::parameter<double>								gyro_sf;
 
+		/*
+		 * @brief latency log
+		 */
+		gnd::conf::parameter_array<char, 512>						latency_log;
+
+		/*
+		 * @brief particles layout on ssm
+		 */
+		gnd::conf::parameter_array<char, 32>						particle_layout;
+
 	};
 	typedef struct proc_configuration configure_parameters;
 
@@ -521,6 +648,7 @@ namespace Localizer {
 
 		::memcpy(&conf->particles,					&ConfIni_Particles,						sizeof(ConfIni_Particles));
 		::memcpy(&conf->resmp_rate_remain,			&ConfIni_ResampleRate_Remain,			sizeof(ConfIni_ResampleRate_Remain));
+		::memcpy(&conf->resmp_method,				&ConfIni_ResampleMethod,				sizeof(ConfIni_ResampleMethod));
 
 		::memcpy(&conf->pos_err_ini,				&ConfIni_Initial_PositionError,			sizeof(ConfIni_Initial_PositionError));
 		::memcpy(&conf->sys_err_ini,				&ConfIni_Initial_SysErrorParam,			sizeof(ConfIni_Initial_SysErrorParam));
@@ -536,6 +664,12 @@ namespace Localizer {
 		::memcpy(&conf->reset_syserr_conf,			&ConfIni_ResetSysError,					sizeof(ConfIni_ResetSysError));
 
 		::memcpy(&conf->random_sampling,			&ConfIni_RandomSampling,			sizeof(ConfIni_RandomSampling));
+		::memcpy(&conf->kld,						&ConfIni_KLDSampling,				sizeof(ConfIni_KLDSampling));
+		::memcpy(&conf->kld_min,					&ConfIni_KLDParticlesMin,			sizeof(ConfIni_KLDParticlesMin));
+		::memcpy(&conf->kld_max,					&ConfIni_KLDParticlesMax,			sizeof(ConfIni_KLDParticlesMax));
+		::memcpy(&conf->kld_error,					&ConfIni_KLDError,					sizeof(ConfIni_KLDError));
+		::memcpy(&conf->kld_quantile,				&ConfIni_KLDQuantile,				sizeof(ConfIni_KLDQuantile));
+		::memcpy(&conf->kld_bin,					&ConfIni_KLDBin,					sizeof(ConfIni_KLDBin));
 
 		::memcpy(&conf->pws_id,						&ConfIni_PWSSSM,					sizeof(ConfIni_PWSSSM));
 		::memcpy(&conf->ssm_id,						&ConfIni_SSMID,						sizeof(ConfIni_SSMID));
@@ -546,6 +680,9 @@ namespace Localizer {
 		::memcpy(&conf->gyro_bias,					&ConfIni_GyroBias,					sizeof(ConfIni_GyroBias));
 		::memcpy(&conf->gyro_sf,					&ConfIni_GyroScaleFactor,			sizeof(ConfIni_GyroScaleFactor));
 
+		::memcpy(&conf->latency_log,				&ConfIni_LatencyLog,				sizeof(ConfIni_LatencyLog));
+		::memcpy(&conf->particle_layout,			&ConfIni_ParticleLayout,			sizeof(ConfIni_ParticleLayout));
+
 		proc_conf_sampling_ratio_normalize(conf);
 		configure_get_covariance(conf);
 		return 0;
@@ -665,6 +802,7 @@ namespace Localizer {
 		}
 		gnd::conf::get_parameter(src, &dest->sys_err_ini);
 		gnd::conf::get_parameter(src, &dest->resmp_rate_remain);
+		gnd::conf::get_parameter(src, &dest->resmp_method);
 		gnd::conf::get_parameter(src, &dest->resmp_rate_randerr);
 
 		if( gnd::conf::get_parameter(src, &dest->randerr_conf ) >= 3) {
@@ -683,6 +821,14 @@ namespace Localizer {
 		gnd::conf::get_parameter(src, &dest->reset_syserr_conf );
 
 		gnd::conf::get_parameter(src, &dest->random_sampling);
+		gnd::conf::get_parameter(src, &dest->kld);
+		gnd::conf::get_parameter(src, &dest->kld_min);
+		gnd::conf::get_parameter(src, &dest->kld_max);
+		gnd::conf::get_parameter(src, &dest->kld_error);
+		gnd::conf::get_parameter(src, &dest->kld_quantile);
+		if( gnd::conf::get_parameter(src, &dest->kld_bin ) >= 3) {
+			dest->kld_bin.value[2] = gnd_deg2ang(dest->kld_bin.value[2]);
+		}
 		gnd::conf::get_parameter(src, &dest->pws_id);
 		gnd::conf::get_parameter(src, &dest->ssm_id);
 		gnd::conf::get_parameter(src, &dest->gyro);
@@ -690,6 +836,8 @@ namespace Localizer {
 		gnd::conf::get_parameter(src, &dest->gyro_bits);
 		gnd::conf::get_parameter(src, &dest->gyro_bias);
 		gnd::conf::get_parameter(src, &dest->gyro_sf);
+		gnd::conf::get_parameter(src, &dest->latency_log);
+		gnd::conf::get_parameter(src, &dest->particle_layout);
 
 		proc_conf_sampling_ratio_normalize(dest);
 		configure_get_covariance(dest);
@@ -718,6 +866,7 @@ namespace Localizer {
 		src->pos_err_ini.value[2] = gnd_deg2ang(src->pos_err_ini.value[2]);
 		gnd::conf::set_parameter(dest, &src->sys_err_ini);
 		gnd::conf::set_parameter(dest, &src->resmp_rate_remain);
+		gnd::conf::set_parameter(dest, &src->resmp_method);
 		gnd::conf::set_parameter(dest, &src->resmp_rate_randerr);
 
 		src->randerr_conf.value[2] = gnd_ang2deg(src->randerr_conf.value[2]);
@@ -738,6 +887,14 @@ namespace Localizer {
 		gnd::conf::set_parameter(dest, &src->resmp_rate_resetsyserr);
 		gnd::conf::set_parameter(dest, &src->reset_syserr_conf);
 		gnd::conf::set_parameter(dest, &src->random_sampling);
+		gnd::conf::set_parameter(dest, &src->kld);
+		gnd::conf::set_parameter(dest, &src->kld_min);
+		gnd::conf::set_parameter(dest, &src->kld_max);
+		gnd::conf::set_parameter(dest, &src->kld_error);
+		gnd::conf::set_parameter(dest, &src->kld_quantile);
+		src->kld_bin.value[2] = gnd_ang2deg(src->kld_bin.value[2]);
+		gnd::conf::set_parameter(dest, &src->kld_bin);
+		src->kld_bin.value[2] = gnd_deg2ang(src->kld_bin.value[2]);
 		gnd::conf::set_parameter(dest, &src->pws_id);
 		gnd::conf::set_parameter(dest, &src->ssm_id);
 		gnd::conf::set_parameter(dest, &src->gyro);
@@ -745,6 +902,8 @@ namespace Localizer {
 		gnd::conf::set_parameter(dest, &src->gyro_bits);
 		gnd::conf::set_parameter(dest, &src->gyro_bias);
 		gnd::conf::set_parameter(dest, &src->gyro_sf);
+		gnd::conf::set_parameter(dest, &src->latency_log);
+		gnd::conf::set_parameter(dest, &src->particle_layout);
 
 		return 0;
 	}
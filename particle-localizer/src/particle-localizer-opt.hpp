@@ -63,6 +63,7 @@ namespace Localizer {
 
 	const char particle_filter[] = "particle-localizer";
 	const char ConfFile[] = "particle-localizer.conf";
+	const double LatencyLogCycle = 10.0;
 
 	// default parameter
 	const proc_option::operation_mode __PARTICLE_OPTION_DEFPARAM__ = {
@@ -7,6 +7,7 @@
 //============================================================================
 
 #include <stdio.h>
+#include <string.h>
 #include <signal.h>
 #include <stdint.h>
 
@@ -57,6 +58,7 @@ int main(int argc, char* argv[], char *envp[]) {
 			count_rev = 0,
 			revl_ratio = 0;
 	Spur_Odometry_Property odm_prop;
+	uint32_t nparticle_max = 0;		// number of allocated particles
 
 
 
@@ -204,10 +206,21 @@ int main(int argc, char* argv[], char *envp[]) {
 		} // <--- get configure
 
 
+		// ---> number of particles
+		if( !is_proc_shutoff() ){
+			nparticle_max = pconf.particles.value + pconf.random_sampling.value;
+			if( pconf.kld.value ) {
+				if( pconf.kld_min.value < 1 )	pconf.kld_min.value = 1;
+				if( pconf.kld_max.value < pconf.kld_min.value )	pconf.kld_max.value = pconf.kld_min.value;
+				if( nparticle_max < (unsigned) pconf.kld_max.value )	nparticle_max = pconf.kld_max.value;
+			}
+		} // <--- number of particles
+
+
 		// ---> set initialize position covariance matrix
 		if( !is_proc_shutoff() ){
-			ssm_estimation.property.n = pconf.particles.value + pconf.random_sampling.value;
-			ssm_estimation.data.n = pconf.particles.value + pconf.random_sampling.value;
+			ssm_estimation.property.n = nparticle_max;
+			ssm_estimation.data.n = nparticle_max;
 			ssm_estimation.data.value = new double [ssm_estimation.data.n];
 		} // <--- set initialize position covariance matrix
 
@@ -248,8 +261,11 @@ int main(int argc, char* argv[], char *envp[]) {
 			ssm_particle.data.init_particle(&myu_ini,
 					&pconf.poserr_cover_ini, &pconf.syserr_cover_ini, pconf.particles.value + pconf.random_sampling.value);
 
+			// allocate for maximum number of particles (size of ssm-data)
+			if( ssm_particle.data.nalloc() < nparticle_max )	ssm_particle.data.allocate(nparticle_max);
+
 			// set property
-			ssm_particle.property.n = pconf.particles.value + pconf.random_sampling.value;
+			ssm_particle.property.n = nparticle_max;
 
 			// set position
 			ssm_position.data.x = ssm_particle.data.pos.odo.x;
@@ -289,6 +305,16 @@ int main(int argc, char* argv[], char *envp[]) {
 		if( !is_proc_shutoff() ) {
 			::fprintf(stderr, "\n");
 			::fprintf(stderr, " => create ssm-data \"\x1b[4m%s\x1b[0m\"\n", SNAME_PARTICLES );
+			// ---> particles layout
+			if( !::strcmp(pconf.particle_layout.value, Localizer::ParticleLayoutAoS) )				ssm_particle.setLayout(PARTICLE_LAYOUT_AOS);
+			else if( !::strcmp(pconf.particle_layout.value, Localizer::ParticleLayoutSoAFloat) )	ssm_particle.setLayout(PARTICLE_LAYOUT_SOA_FLOAT);
+			else {
+				if( ::strcmp(pconf.particle_layout.value, Localizer::ParticleLayoutSoA) ) {
+					::fprintf(stderr, "  ... \x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: unknown particles layout \"%s\", use \"%s\"\n",
+							pconf.particle_layout.value, Localizer::ParticleLayoutSoA);
+				}
+				ssm_particle.setLayout(PARTICLE_LAYOUT_SOA);
+			} // <--- particles layout
 			if( !ssm_particle.create( SNAME_PARTICLES, 0, 5, 0.005 ) ){
 				::fprintf(stderr, "  \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to create \"\x1b[4m%s\x1b[0m\"\n", SNAME_PARTICLES );
 				proc_shutoff();
@@ -372,19 +398,38 @@ int main(int argc, char* argv[], char *envp[]) {
 		static const double eval_alpha_slow = 1.0 / 180;
 		double eval_ave_fast = 0;
 		static const double eval_alpha_fast = 1.0 / 60;
-		uint32_t nparticle_remain = pconf.particles.value * pconf.resmp_rate_remain.value;
-		uint32_t nparticle_pos = pconf.particles.value * pconf.resmp_rate_randerr.value;
-		uint32_t nparticle_knm = pconf.particles.value * pconf.resmp_rate_syserr.value;
-		uint32_t nparticle_wknm = pconf.particles.value * pconf.resmp_rate_syserr2.value;
-		uint32_t nparticle_knm_reset = pconf.particles.value - nparticle_remain - nparticle_pos
+		uint32_t nparticle = pconf.particles.value;		// number of particles after resampling
+		uint32_t nparticle_remain = nparticle * pconf.resmp_rate_remain.value;
+		uint32_t nparticle_pos = nparticle * pconf.resmp_rate_randerr.value;
+		uint32_t nparticle_knm = nparticle * pconf.resmp_rate_syserr.value;
+		uint32_t nparticle_wknm = nparticle * pconf.resmp_rate_syserr2.value;
+		uint32_t nparticle_knm_reset = nparticle - nparticle_remain - nparticle_pos
 				- nparticle_knm - nparticle_wknm;
+		uint32_t nkld_bins = 0;		// number of occupied histogram bins (kld-sampling)
+		int resmp_method = PARTICLE_RESAMPLING_MULTINOMIAL;
+
+		{ // ---> remain resampling method
+			if( !::strcmp(pconf.resmp_method.value, Localizer::ResampleSystematic) )			resmp_method = PARTICLE_RESAMPLING_SYSTEMATIC;
+			else if( !::strcmp(pconf.resmp_method.value, Localizer::ResampleStratified) )	resmp_method = PARTICLE_RESAMPLING_STRATIFIED;
+			else if( !::strcmp(pconf.resmp_method.value, Localizer::ResampleAlias) )		resmp_method = PARTICLE_RESAMPLING_ALIAS;
+			else if( ::strcmp(pconf.resmp_method.value, Localizer::ResampleMultinomial) ) {
+				::fprintf(stderr, "  ... \x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: unknown re-sampling method \"%s\", use \"%s\"\n",
+						pconf.resmp_method.value, Localizer::ResampleMultinomial);
+			}
+		} // <--- remain resampling method
 
 		int enc_cnt_pos = 0;
 		int enc_cnt_knm = 0;
 		int enc_cnt_wknm = 0;
 		FILE *dbgfp = 0;
+		FILE *lat_fp = 0;
 		double cuito = 0;;
 
+		gnd::stopwatch sw_stage;				// latency: stage stopwatch
+		gnd::timer::histogram lat_motion;		// latency: motion
+		gnd::timer::histogram lat_resampling;	// latency: resampling
+		gnd::timer::interval_timer timer_latency;
+
 		{ // ---> show
 			::fprintf(stderr, "\n\n");
 			::fprintf(stderr, "========== Oeration ==========\n");
@@ -404,6 +449,18 @@ int main(int argc, char* argv[], char *envp[]) {
 			}
 		} // <--- debug log open
 
+		// ---> latency log open
+		if( *pconf.latency_log.value ){
+			::fprintf(stderr, " => open latency log\n");
+			if( !(lat_fp = fopen(pconf.latency_log.value, "w")) ) {
+				::fprintf(stderr, "  ... \x1b[1m\x1b[31mError\x1b[39m\x1b[0m: fail to open \"\x1b[4m%s\x1b[0m\"", pconf.latency_log.value);
+			}
+			else {
+				fprintf(lat_fp, "# 1.[time, s] 2.[stage] 3.[count] 4.[mean] 5.[50%%] 6.[95%%] 7.[99%%] 8.[max] (msec)\n");
+				timer_latency.begin(CLOCK_REALTIME, Localizer::LatencyLogCycle);
+			}
+		} // <--- latency log open
+
 
 		while( !is_proc_shutoff() ){
 
@@ -542,6 +599,9 @@ int main(int argc, char* argv[], char *envp[]) {
 					::fprintf(stderr, "-------------------- \x1b[33m\x1b[1m%s\x1b[0m\x1b[39m --------------------\n", Localizer::particle_filter);
 					::fprintf(stderr, "    particle : %ld\n", ssm_particle.data.size() );
 					::fprintf(stderr, "             : r %d, p %d, k %d, wk %d rk %d\n", nparticle_remain, nparticle_pos, nparticle_knm, nparticle_wknm, nparticle_knm_reset);
+					if( pconf.kld.value ) {
+						::fprintf(stderr, "         kld : bins %d, particles %d (%d - %d)\n", nkld_bins, nparticle, pconf.kld_min.value, pconf.kld_max.value);
+					}
 					::fprintf(stderr, "    resample : %d,   reject %d\n", rsmpl_cnt, reject_cnt );
 					::fprintf(stderr, "    position : %.02lf %.02lf %.01lf\n",  ssm_particle.data.pos.odo.x,  ssm_particle.data.pos.odo.y,  gnd_ang2deg(ssm_particle.data.pos.odo.theta) );
 					::fprintf(stderr, "    velocity : v %.02lf  w %.03lf\n", ssm_position.data.v, gnd_ang2deg(ssm_position.data.w) );
@@ -550,6 +610,8 @@ int main(int argc, char* argv[], char *envp[]) {
 							pconf.gyro.value ? 1 / gnd_rad2deg( ssm_particle.data.pos.prop.wheel_odm.tread_ratio ) : ssm_particle.data.pos.prop.wheel_odm.tread_ratio );
 					::fprintf(stderr, " counter rot : left %s, right %s\n", pconf.k_lwheel_crot.value ? "on" : "off", pconf.k_rwheel_crot.value ?  "on" : "off" );
 					::fprintf(stderr, "    odometry : %s-odometry\n", pconf.gyro.value ? "gyro" : "wheel" );
+					lat_motion.print(stderr, "motion");
+					lat_resampling.print(stderr, "resampling");
 
 					::fprintf(stderr, "\n");
 					::fprintf(stderr, " Push \x1b[1mEnter\x1b[0m to change CUI Mode\n");
@@ -566,6 +628,7 @@ int main(int argc, char* argv[], char *envp[]) {
 
 			// read ssm motor
 			if( mtr.readNext() ){
+				double lap = 0;
 				int cnt1 = (pconf.k_lwheel_crot.value ? -1 : 1) * mtr.data.counter1;
 				int cnt2 = (pconf.k_rwheel_crot.value ? -1 : 1) * mtr.data.counter2;
 
@@ -577,6 +640,7 @@ int main(int argc, char* argv[], char *envp[]) {
 					cnt2 = buf;
 				}
 
+				sw_stage.begin(CLOCK_MONOTONIC);
 				// compute pertilecs motion
 				if( !pconf.gyro.value ) {
 					ssm_particle.data.odometry_motion(cnt1, cnt2);
@@ -618,6 +682,7 @@ int main(int argc, char* argv[], char *envp[]) {
 				// write position to ssm
 				ssm_position.write( mtr.time );
 				prev_time = mtr.time;
+				if( sw_stage.get(0, &lap) == 0 )	lat_motion.record(lap);
 
 
 				// log file out
@@ -652,6 +717,7 @@ int main(int argc, char* argv[], char *envp[]) {
 				size_t lknm = nparticle_knm;			// local kinematics sampling
 				size_t knm_reset = nparticle_knm_reset;	// kinematics reset
 				double eval_ave = 0;
+				double lap = 0;
 
 				// count resampling
 				rsmpl_cnt++;
@@ -662,6 +728,12 @@ int main(int argc, char* argv[], char *envp[]) {
 					continue;
 				} // <--- check time
 
+				// ---> check number of particles
+				if( ssm_estimation.data.n != ssm_particle.data.size() ){
+					reject_cnt++;
+					continue;
+				} // <--- check number of particles
+
 				if(enc_cnt_knm < 0.25 * count_rev * gear){
 					remain += lknm;
 					lknm = 0;
@@ -669,6 +741,7 @@ int main(int argc, char* argv[], char *envp[]) {
 				else {
 					enc_cnt_knm = 0;
 				}
+				sw_stage.begin(CLOCK_MONOTONIC);
 
 
 				if(enc_cnt_wknm < 10 * count_rev * gear){
@@ -681,7 +754,27 @@ int main(int argc, char* argv[], char *envp[]) {
 
 
 				// select remaining particle
-				ret = ssm_particle.data.resampling_remain(ssm_estimation.data.value, remain, &eval_ave);
+				ret = ssm_particle.data.resampling_remain(ssm_estimation.data.value, remain, &eval_ave, resmp_method);
+
+				// ---> adapt number of particles (kld-sampling)
+				if( ret >= 0 && pconf.kld.value ) {
+					uint32_t n;
+
+					// remaining particles are drawn from the posterior, count its histogram bins
+					ssm_particle.data.kld_bins(pconf.kld_bin.value, &nkld_bins);
+					n = particle_set_c::kld_bound(nkld_bins, pconf.kld_error.value, pconf.kld_quantile.value);
+					if( n < (unsigned) pconf.kld_min.value )	n = pconf.kld_min.value;
+					if( n > (unsigned) pconf.kld_max.value )	n = pconf.kld_max.value;
+
+					// applied from next resampling
+					nparticle = n;
+					nparticle_remain = nparticle * pconf.resmp_rate_remain.value;
+					nparticle_pos = nparticle * pconf.resmp_rate_randerr.value;
+					nparticle_knm = nparticle * pconf.resmp_rate_syserr.value;
+					nparticle_wknm = nparticle * pconf.resmp_rate_syserr2.value;
+					nparticle_knm_reset = nparticle - nparticle_remain - nparticle_pos
+							- nparticle_knm - nparticle_wknm;
+				} // <--- adapt number of particles (kld-sampling)
 
 
 				{ // ---> deternimation wide sampling num
@@ -724,10 +817,20 @@ int main(int argc, char* argv[], char *envp[]) {
 
 
 				} // <--- resampling
+				if( sw_stage.get(0, &lap) == 0 )	lat_resampling.record(lap);
 
 
 			} // <--- resampling
 
+
+			// ---> latency log
+			if( lat_fp && timer_latency.clock() > 0 ) {
+				ssmTimeT t = gettimeSSM();
+
+				lat_motion.txtlog(lat_fp, t, "motion");
+				lat_resampling.txtlog(lat_fp, t, "resampling");
+				::fflush(lat_fp);
+			} // <--- latency log
 		}
 
 		// close debug log
@@ -735,6 +838,15 @@ int main(int argc, char* argv[], char *envp[]) {
 			::fclose(dbgfp);
 		}
 
+		// close latency log
+		if( lat_fp ){
+			ssmTimeT t = gettimeSSM();
+
+			lat_motion.txtlog(lat_fp, t, "motion");
+			lat_resampling.txtlog(lat_fp, t, "resampling");
+			::fclose(lat_fp);
+		}
+
 	} // <--- operation
 
 
@@ -0,0 +1,12 @@
+/*
+ * ssm-log.hpp
+ *
+ *  ssm-log api is not served in replay, only the base api is provided
+ */
+
+#ifndef SSM_REPLAY_LOG_HPP_
+#define SSM_REPLAY_LOG_HPP_
+
+#include "ssm.hpp"
+
+#endif /* SSM_REPLAY_LOG_HPP_ */
@@ -0,0 +1,738 @@
+/*
+ * ssm.h
+ *
+ *  in-process stand-in of ssm for offline replay
+ *
+ *  this header replaces <ssm.h> of libssm when the include path "ssmtype/replay/" precedes the system include path.
+ *  streams are loaded from ssm-logger log files (e.g. the log directory of multilogger) and
+ *  they are served to the process on a virtual clock without ssm daemon.
+ *
+ *  environment variables
+ *    SSM_REPLAY_LOG  : log files or directories of log files (separated by ':')
+ *    SSM_REPLAY_RATE : replay speed (0: as fast as possible (default), 1: real-time)
+ *    SSM_REPLAY_OUT  : directory to record streams created by the process (ssm-logger format)
+ */
+
+#ifndef SSM_REPLAY_H_
+#define SSM_REPLAY_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+
+// ---> constant definition
+/// @brief maximum length of stream name
+#define SSM_SNAME_MAX	32
+
+/// @brief open mode
+enum {
+	SSM_READ		= 0x20,
+	SSM_WRITE		= 0x40,
+	SSM_EXCLUSIVE	= 0x80
+};
+
+namespace ssm {
+	namespace replay {
+		/// @brief maximum number of streams
+		static const int StreamMax = 64;
+		/// @brief environment variable of log files
+		static const char EnvLog[] = "SSM_REPLAY_LOG";
+		/// @brief environment variable of replay speed
+		static const char EnvRate[] = "SSM_REPLAY_RATE";
+		/// @brief environment variable of output directory
+		static const char EnvOut[] = "SSM_REPLAY_OUT";
+	}
+}
+// <--- constant definition
+
+
+
+// ---> type definition
+/// @brief time
+typedef double ssmTimeT;
+/// @brief time id
+typedef int SSM_tid;
+
+namespace ssm {
+	namespace replay {
+		/**
+		 * @brief replay stream
+		 * @note records of a logged stream are all kept in memory,
+		 * records of a created stream are kept in a ring buffer like ssm.
+		 */
+		struct stream {
+			/// @brief stream name
+			char name[SSM_SNAME_MAX];
+			/// @brief stream id
+			int id;
+			/// @brief data size
+			size_t size;
+			/// @brief number of records in buffer
+			int num;
+			/// @brief write cycle
+			double cycle;
+			/// @brief property
+			char *property;
+			/// @brief property size
+			size_t property_size;
+			/// @brief data buffer
+			char *data;
+			/// @brief time buffer
+			ssmTimeT *time;
+			/// @brief newest time id (-1: no record)
+			SSM_tid top;
+			/// @brief loaded from log file (read only)
+			bool logged;
+			/// @brief record file of created stream
+			FILE *out;
+			/// @brief number of delivered records
+			size_t nread;
+			/// @brief service time of delivered records [sec]
+			double *lat;
+			/// @brief number of service time
+			size_t nlat;
+			/// @brief allocated size of service time
+			size_t alat;
+		};
+
+		/**
+		 * @brief replay state
+		 */
+		struct state {
+			/// @brief streams
+			stream s[StreamMax];
+			/// @brief number of streams
+			int n;
+			/// @brief virtual clock
+			ssmTimeT now;
+			/// @brief log begin time
+			ssmTimeT begin;
+			/// @brief wall clock at begin
+			double wall;
+			/// @brief replay speed (0: as fast as possible)
+			double rate;
+			/// @brief initialized
+			bool init;
+			/// @brief end of logs
+			bool finish;
+			/// @brief output directory
+			char out[256];
+		};
+	}
+}
+
+/// @brief stream id
+typedef ssm::replay::stream* SSM_sid;
+// <--- type definition
+
+
+
+// ---> function declaration
+int initSSM(void);
+int endSSM(void);
+ssmTimeT gettimeSSM(void);
+ssmTimeT gettimeSSM_real(void);
+SSM_tid getTID_top(SSM_sid sid);
+SSM_tid readSSMP(SSM_sid sid, void *data, ssmTimeT *time, SSM_tid tid, void (*fn)(const void*, void*, void*), void *user);
+SSM_tid readSSMP_time(SSM_sid sid, void *data, ssmTimeT t, ssmTimeT *rt, void (*fn)(const void*, void*, void*), void *user);
+SSM_tid writeSSMP(SSM_sid sid, const void *data, ssmTimeT t, void (*fn)(void*, const void*, void*), void *user);
+
+namespace ssm {
+	namespace replay {
+		state* _state_();
+		double _wall_();
+		int _load_(const char *path);
+		int _load_file_(const char *path);
+		SSM_sid find(const char *name, int id);
+		SSM_sid create(const char *name, int id, size_t size, double life, double cycle);
+		int set_property(SSM_sid sid, const void *p, size_t size);
+		SSM_tid oldest(SSM_sid sid);
+		int wait(SSM_sid sid, SSM_tid tid, bool block);
+		void served(SSM_sid sid, double t);
+		void report(FILE *fp);
+	}
+}
+// <--- function declaration
+
+
+
+// ---> function definition
+namespace ssm {
+	namespace replay {
+
+		/**
+		 * @brief replay state (singleton)
+		 */
+		inline
+		state* _state_() {
+			static state s;
+			return &s;
+		}
+
+		/**
+		 * @brief wall clock [sec]
+		 */
+		inline
+		double _wall_() {
+			struct timespec ts;
+			::clock_gettime(CLOCK_MONOTONIC, &ts);
+			return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+		}
+
+		/**
+		 * @brief load a log file or log files in a directory
+		 * @param[in] path : file or directory path
+		 * @return number of loaded streams
+		 */
+		inline
+		int _load_(const char *path) {
+			struct stat st;
+
+			if( ::stat(path, &st) < 0 ) return -1;
+			if( !S_ISDIR(st.st_mode) ) return _load_file_(path) < 0 ? -1 : 1;
+
+			{ // ---> directory
+				DIR *d;
+				struct dirent *e;
+				int n = 0;
+
+				if( !(d = ::opendir(path)) ) return -1;
+				while( (e = ::readdir(d)) ) {
+					char fname[512];
+					size_t l = ::strlen(e->d_name);
+
+					if( l < 4 || ::strcmp(e->d_name + l - 4, ".log") ) continue;
+					::snprintf(fname, sizeof(fname), "%s/%s", path, e->d_name);
+					if( _load_file_(fname) == 0 ) n++;
+				}
+				::closedir(d);
+				return n;
+			} // <--- directory
+		}
+
+		/**
+		 * @brief load a ssm-logger log file
+		 * @param[in] path : file path
+		 * @details a log is a text line "name id data-size buffer-num cycle start-time property-size",
+		 * the property and then the records (time and data) as written by ssm-logger.
+		 */
+		inline
+		int _load_file_(const char *path) {
+			state *r = _state_();
+			stream *s;
+			FILE *fp;
+			char line[512];
+			unsigned long size, psize;
+			double start;
+			long pos, end;
+
+			if( r->n >= StreamMax ) return -1;
+			if( !(fp = ::fopen(path, "rb")) ) return -1;
+
+			s = r->s + r->n;
+			::memset(s, 0, sizeof(*s));
+			// header
+			if( !::fgets(line, sizeof(line), fp) ||
+					::sscanf(line, "%31s %d %lu %d %lf %lf %lu", s->name, &s->id, &size, &s->num, &s->cycle, &start, &psize) != 7 ||
+					size == 0 ) {
+				::fclose(fp);
+				::fprintf(stderr, " ... \x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: \"\x1b[4m%s\x1b[0m\" is not ssm-logger log\n", path);
+				return -1;
+			}
+			s->size = size;
+			s->property_size = psize;
+			// property
+			if( psize > 0 ) {
+				s->property = new char[psize];
+				if( ::fread(s->property, 1, psize, fp) != psize ) {
+					delete [] s->property;
+					::fclose(fp);
+					return -1;
+				}
+			}
+			// records
+			pos = ::ftell(fp);
+			::fseek(fp, 0, SEEK_END);
+			end = ::ftell(fp);
+			::fseek(fp, pos, SEEK_SET);
+			s->num = (end - pos) / (sizeof(ssmTimeT) + s->size);
+			s->data = new char[s->num * s->size + 1];
+			s->time = new ssmTimeT[s->num + 1];
+			for( int i = 0; i < s->num; i++ ) {
+				if( ::fread(s->time + i, sizeof(ssmTimeT), 1, fp) != 1 ||
+						::fread(s->data + i * s->size, 1, s->size, fp) != s->size ) {
+					s->num = i;
+					break;
+				}
+			}
+			::fclose(fp);
+
+			s->top = s->num - 1;
+			s->logged = true;
+			r->n++;
+			::fprintf(stderr, "    replay \"\x1b[4m%s\x1b[0m\" id %d, %d records (%s)\n", s->name, s->id, s->num, path);
+			return 0;
+		}
+
+		/**
+		 * @brief find a stream
+		 * @param[in] name : stream name
+		 * @param[in]   id : stream id
+		 * @return 0 : not found
+		 */
+		inline
+		SSM_sid find(const char *name, int id) {
+			state *r = _state_();
+
+			for( int i = 0; i < r->n; i++ ) {
+				if( r->s[i].id == id && !::strncmp(r->s[i].name, name, SSM_SNAME_MAX) ) return r->s + i;
+			}
+			return 0;
+		}
+
+		/**
+		 * @brief create a stream written by this process
+		 * @param[in] name : stream name
+		 * @param[in]   id : stream id
+		 * @param[in] size : data size
+		 * @param[in] life : storage time
+		 * @param[in] cycle : write cycle
+		 */
+		inline
+		SSM_sid create(const char *name, int id, size_t size, double life, double cycle) {
+			state *r = _state_();
+			stream *s;
+
+			if( (s = find(name, id)) ) return s->logged || s->size != size ? 0 : s;
+			if( r->n >= StreamMax || size == 0 || cycle <= 0 ) return 0;
+
+			s = r->s + r->n;
+			::memset(s, 0, sizeof(*s));
+			::strncpy(s->name, name, SSM_SNAME_MAX - 1);
+			s->id = id;
+			s->size = size;
+			s->cycle = cycle;
+			s->num = life / cycle + 5;
+			s->data = new char[s->num * size];
+			s->time = new ssmTimeT[s->num];
+			s->top = -1;
+
+			if( *r->out ) { // ---> record
+				char fname[512];
+
+				::snprintf(fname, sizeof(fname), "%s/%s-%d.log", r->out, s->name, s->id);
+				if( !(s->out = ::fopen(fname, "wb")) ) {
+					::fprintf(stderr, " ... \x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: fail to open \"\x1b[4m%s\x1b[0m\"\n", fname);
+				}
+			} // <--- record
+			r->n++;
+			return s;
+		}
+
+		/**
+		 * @brief set property of a created stream
+		 */
+		inline
+		int set_property(SSM_sid sid, const void *p, size_t size) {
+			if( !sid || sid->logged ) return -1;
+			if( sid->property_size != size ) {
+				delete [] sid->property;
+				sid->property = new char[size];
+				sid->property_size = size;
+			}
+			::memcpy(sid->property, p, size);
+			return 0;
+		}
+
+		/**
+		 * @brief oldest time id in buffer
+		 */
+		inline
+		SSM_tid oldest(SSM_sid sid) {
+			if( sid->logged || sid->top < sid->num ) return 0;
+			return sid->top - sid->num + 1;
+		}
+
+		/**
+		 * @brief the newest visible time id of a logged stream at the virtual clock
+		 */
+		inline
+		SSM_tid _visible_(SSM_sid sid) {
+			ssmTimeT now = _state_()->now;
+			int lower = 0, upper = sid->num;
+
+			// the first record later than the virtual clock
+			while( lower < upper ) {
+				int m = (lower + upper) / 2;
+				if( sid->time[m] <= now )	lower = m + 1;
+				else						upper = m;
+			}
+			return lower - 1;
+		}
+
+		/**
+		 * @brief synchronize virtual clock with wall clock (real-time replay)
+		 */
+		inline
+		void _sync_() {
+			state *r = _state_();
+
+			if( r->rate > 0 ) {
+				ssmTimeT t = r->begin + (_wall_() - r->wall) * r->rate;
+				if( t > r->now ) r->now = t;
+			}
+		}
+
+		/**
+		 * @brief move virtual clock
+		 * @param[in] t : time
+		 */
+		inline
+		void _advance_(ssmTimeT t) {
+			state *r = _state_();
+
+			if( t <= r->now ) return;
+			if( r->rate > 0 ) {
+				double w = r->wall + (t - r->begin) / r->rate - _wall_();
+				if( w > 0 ) ::usleep(w * 1.0e6);
+			}
+			r->now = t;
+		}
+
+		/**
+		 * @brief end of replay
+		 * @details ssm processes shut off on SIGINT
+		 */
+		inline
+		void _finish_() {
+			state *r = _state_();
+
+			if( r->finish ) return;
+			r->finish = true;
+			::fprintf(stderr, "\n => end of replay log\n");
+			::raise(SIGINT);
+		}
+
+		/**
+		 * @brief wait for a record on the virtual clock
+		 * @param[in]   sid : stream
+		 * @param[in]   tid : time id
+		 * @param[in] block : blocking read
+		 * @return    0 : the record is available
+		 * @return   <0 : not available
+		 * @details in fast replay, a blocking read moves the virtual clock to the record,
+		 * and a non-blocking read that finds nothing moves it to the next record of any logged stream,
+		 * so the records of all the streams are served in time order.
+		 */
+		inline
+		int wait(SSM_sid sid, SSM_tid tid, bool block) {
+			state *r = _state_();
+
+			if( !sid ) return -1;
+			if( !sid->logged ) {
+				// created stream: records are written by this process
+				return tid <= sid->top ? 0 : -1;
+			}
+
+			_sync_();
+			if( tid <= _visible_(sid) ) return 0;
+			if( tid >= sid->num ) {
+				// no more record
+				_finish_();
+				return -1;
+			}
+			if( block ) {
+				_advance_(sid->time[tid]);
+				return 0;
+			}
+			if( r->rate > 0 ) return -1;
+
+			{ // ---> move to the next event
+				ssmTimeT next = 0;
+				bool any = false;
+
+				for( int i = 0; i < r->n; i++ ) {
+					SSM_tid v;
+					if( !r->s[i].logged ) continue;
+					v = _visible_(r->s + i) + 1;
+					if( v >= r->s[i].num ) continue;
+					if( !any || r->s[i].time[v] < next ) next = r->s[i].time[v];
+					any = true;
+				}
+				if( !any ) {
+					_finish_();
+					return -1;
+				}
+				_advance_(next);
+			} // <--- move to the next event
+
+			return tid <= _visible_(sid) ? 0 : -1;
+		}
+
+		/**
+		 * @brief record service time of a delivered record
+		 * @param[in] sid : stream
+		 * @param[in]   t : service time [sec]
+		 */
+		inline
+		void served(SSM_sid sid, double t) {
+			if( !sid ) return;
+			if( sid->nlat >= sid->alat ) {
+				size_t n = sid->alat ? sid->alat * 2 : 1024;
+				double *p = new double[n];
+
+				if( sid->nlat ) ::memcpy(p, sid->lat, sizeof(double) * sid->nlat);
+				delete [] sid->lat;
+				sid->lat = p;
+				sid->alat = n;
+			}
+			sid->lat[sid->nlat++] = t;
+		}
+
+		/**
+		 * @brief ascending order
+		 */
+		inline
+		int _compare_(const void *a, const void *b) {
+			double d = *(const double*)a - *(const double*)b;
+			return d < 0 ? -1 : (d > 0 ? 1 : 0);
+		}
+
+		/**
+		 * @brief print replay report
+		 * @param[out] fp : output stream
+		 * @details service time is the wall time from the delivery of a record to the next read request on the stream,
+		 * namely per-record processing latency.
+		 */
+		inline
+		void report(FILE *fp) {
+			state *r = _state_();
+			double wall = _wall_() - r->wall;
+
+			::fprintf(fp, "\n => ssm replay report\n");
+			::fprintf(fp, "    log time %.3lf [sec], wall time %.3lf [sec] (x%.2lf)\n",
+					r->now - r->begin, wall, wall > 0 ? (r->now - r->begin) / wall : 0.0);
+			for( int i = 0; i < r->n; i++ ) {
+				stream *s = r->s + i;
+
+				if( !s->logged || !s->nread ) continue;
+				::fprintf(fp, "    \"%s\" id %d : %lu records, %.1lf [rec/sec]\n", s->name, s->id,
+						(unsigned long)s->nread, wall > 0 ? s->nread / wall : 0.0);
+				if( s->nlat ) {
+					double sum = 0;
+
+					::qsort(s->lat, s->nlat, sizeof(double), _compare_);
+					for( size_t k = 0; k < s->nlat; k++ ) sum += s->lat[k];
+					::fprintf(fp, "      latency mean %.3lf, 50%% %.3lf, 95%% %.3lf, 99%% %.3lf, max %.3lf [msec]\n",
+							sum / s->nlat * 1.0e3,
+							s->lat[s->nlat / 2] * 1.0e3,
+							s->lat[(size_t)(s->nlat * 0.95)] * 1.0e3,
+							s->lat[(size_t)(s->nlat * 0.99)] * 1.0e3,
+							s->lat[s->nlat - 1] * 1.0e3);
+				}
+			}
+		}
+
+		/**
+		 * @brief write a record into record file
+		 */
+		inline
+		void _record_(SSM_sid sid, SSM_tid tid) {
+			if( !sid->out ) return;
+			if( tid == 0 ) {
+				::fprintf(sid->out, "%s %d %lu %d %lf %lf %lu\n", sid->name, sid->id,
+						(unsigned long)sid->size, sid->num, sid->cycle, sid->time[0], (unsigned long)sid->property_size);
+				if( sid->property_size ) ::fwrite(sid->property, 1, sid->property_size, sid->out);
+			}
+			::fwrite(sid->time + (tid % sid->num), sizeof(ssmTimeT), 1, sid->out);
+			::fwrite(sid->data + (tid % sid->num) * sid->size, 1, sid->size, sid->out);
+		}
+	}
+}
+
+
+/**
+ * @brief initialize replay (load logs)
+ * @return 1 : success
+ * @return 0 : failure
+ */
+inline
+int initSSM(void) {
+	ssm::replay::state *r = ssm::replay::_state_();
+	const char *env;
+
+	if( r->init ) return 1;
+
+	if( !(env = ::getenv(ssm::replay::EnvLog)) || !*env ) {
+		::fprintf(stderr, " ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: set replay log files into \"%s\"\n", ssm::replay::EnvLog);
+		return 0;
+	}
+	if( ::getenv(ssm::replay::EnvOut) ) {
+		::strncpy(r->out, ::getenv(ssm::replay::EnvOut), sizeof(r->out) - 1);
+	}
+	r->rate = ::getenv(ssm::replay::EnvRate) ? ::atof(::getenv(ssm::replay::EnvRate)) : 0;
+
+	{ // ---> load logs
+		char buf[2048];
+		char *p, *save = 0;
+
+		::strncpy(buf, env, sizeof(buf) - 1);
+		buf[sizeof(buf) - 1] = '\0';
+		for( p = ::strtok_r(buf, ":", &save); p; p = ::strtok_r(0, ":", &save) ) {
+			if( ssm::replay::_load_(p) < 0 ) {
+				::fprintf(stderr, " ... \x1b[1m\x1b[33mWarning\x1b[39m\x1b[0m: fail to load \"\x1b[4m%s\x1b[0m\"\n", p);
+			}
+		}
+	} // <--- load logs
+
+	{ // ---> start when every stream has a record
+		bool any = false;
+
+		for( int i = 0; i < r->n; i++ ) {
+			if( !r->s[i].num ) continue;
+			if( !any || r->s[i].time[0] > r->begin ) r->begin = r->s[i].time[0];
+			any = true;
+		}
+		if( !any ) {
+			::fprintf(stderr, " ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: no replay record\n");
+			return 0;
+		}
+	} // <--- start when every stream has a record
+
+	r->now = r->begin;
+	r->wall = ssm::replay::_wall_();
+	r->init = true;
+	return 1;
+}
+
+/**
+ * @brief finalize replay (report and close record files)
+ */
+inline
+int endSSM(void) {
+	ssm::replay::state *r = ssm::replay::_state_();
+
+	if( !r->init ) return 1;
+	ssm::replay::report(stderr);
+	for( int i = 0; i < r->n; i++ ) {
+		if( r->s[i].out ) ::fclose(r->s[i].out);
+		r->s[i].out = 0;
+	}
+	r->init = false;
+	return 1;
+}
+
+/**
+ * @brief virtual clock
+ */
+inline
+ssmTimeT gettimeSSM(void) {
+	ssm::replay::_sync_();
+	return ssm::replay::_state_()->now;
+}
+
+/**
+ * @brief wall clock
+ */
+inline
+ssmTimeT gettimeSSM_real(void) {
+	return ssm::replay::_wall_();
+}
+
+/**
+ * @brief newest time id at virtual clock
+ */
+inline
+SSM_tid getTID_top(SSM_sid sid) {
+	if( !sid ) return -1;
+	if( !sid->logged ) return sid->top;
+	ssm::replay::_sync_();
+	return ssm::replay::_visible_(sid);
+}
+
+/**
+ * @brief read a record
+ * @param[in]   sid : stream
+ * @param[out] data : data
+ * @param[out] time : time
+ * @param[in]   tid : time id (<0 : newest)
+ * @param[in]    fn : deserializer (0: copy)
+ * @param[in]  user : user data of deserializer
+ * @return time id (<0 : failure)
+ */
+inline
+SSM_tid readSSMP(SSM_sid sid, void *data, ssmTimeT *time, SSM_tid tid, void (*fn)(const void*, void*, void*), void *user) {
+	SSM_tid top = getTID_top(sid);
+
+	if( !sid || top < 0 ) return -1;
+	if( tid < 0 ) tid = top;
+	if( tid > top || tid < ssm::replay::oldest(sid) ) return -1;
+
+	{
+		const char *p = sid->data + (sid->logged ? tid : tid % sid->num) * sid->size;
+
+		if( fn )	fn(p, data, user);
+		else		::memcpy(data, p, sid->size);
+		if( time ) *time = sid->time[sid->logged ? tid : tid % sid->num];
+	}
+	return tid;
+}
+
+/**
+ * @brief read the newest record before a time
+ * @param[in]   sid : stream
+ * @param[out] data : data
+ * @param[in]     t : time
+ * @param[out]   rt : time of read record
+ * @param[in]    fn : deserializer (0: copy)
+ * @param[in]  user : user data of deserializer
+ * @return time id (<0 : failure)
+ */
+inline
+SSM_tid readSSMP_time(SSM_sid sid, void *data, ssmTimeT t, ssmTimeT *rt, void (*fn)(const void*, void*, void*), void *user) {
+	SSM_tid top = getTID_top(sid);
+	SSM_tid tid;
+
+	if( !sid || top < 0 ) return -1;
+	for( tid = top; tid >= ssm::replay::oldest(sid); tid-- ) {
+		if( sid->time[sid->logged ? tid : tid % sid->num] <= t ) break;
+	}
+	if( tid < ssm::replay::oldest(sid) ) return -1;
+	return readSSMP(sid, data, rt, tid, fn, user);
+}
+
+/**
+ * @brief write a record
+ * @param[in]  sid : stream
+ * @param[in] data : data
+ * @param[in]    t : time
+ * @param[in]   fn : serializer (0: copy)
+ * @param[in] user : user data of serializer
+ * @return time id (<0 : failure)
+ */
+inline
+SSM_tid writeSSMP(SSM_sid sid, const void *data, ssmTimeT t, void (*fn)(void*, const void*, void*), void *user) {
+	if( !sid || sid->logged ) return -1;
+
+	{
+		SSM_tid tid = sid->top + 1;
+		char *p = sid->data + (tid % sid->num) * sid->size;
+
+		if( fn )	fn(p, data, user);
+		else		::memcpy(p, data, sid->size);
+		sid->time[tid % sid->num] = t;
+		sid->top = tid;
+		ssm::replay::_record_(sid, tid);
+		return tid;
+	}
+}
+// <--- function definition
+
+#endif /* SSM_REPLAY_H_ */
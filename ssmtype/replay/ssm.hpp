@@ -0,0 +1,267 @@
+/*
+ * ssm.hpp
+ *
+ *  in-process stand-in of ssm c++ api for offline replay
+ *
+ *  SSMApi subset used by the processes, served by replay streams of "ssm.h" in this directory.
+ *  records delivered by readNew() and readNext() are accounted for the replay report.
+ */
+
+#ifndef SSM_REPLAY_HPP_
+#define SSM_REPLAY_HPP_
+
+#include "ssm.h"
+
+
+/**
+ * @brief ssm api base (replay)
+ */
+class SSMApiBase {
+	// ---> constructor, destructor
+public:
+	SSMApiBase() :
+		time(0), timeId(-1), ssmId(0),
+		mData(0), mDataSize(0), mProperty(0), mPropertySize(0),
+		mBlocking(false), mDelivered(-1) {
+		mStreamName[0] = '\0';
+		mStreamId = 0;
+	}
+	SSMApiBase(const char *streamName, int streamId = 0) :
+		time(0), timeId(-1), ssmId(0),
+		mData(0), mDataSize(0), mProperty(0), mPropertySize(0),
+		mBlocking(false), mDelivered(-1) {
+		setStream(streamName, streamId);
+	}
+	virtual ~SSMApiBase() {
+	}
+	// <--- constructor, destructor
+
+	// ---> variables
+public:
+	/// @brief time of data
+	ssmTimeT time;
+	/// @brief time id of data
+	SSM_tid timeId;
+	/// @brief stream
+	SSM_sid ssmId;
+protected:
+	/// @brief data buffer
+	void *mData;
+	/// @brief data size
+	size_t mDataSize;
+	/// @brief property buffer
+	void *mProperty;
+	/// @brief property size
+	size_t mPropertySize;
+	/// @brief stream name
+	char mStreamName[SSM_SNAME_MAX];
+	/// @brief stream id
+	int mStreamId;
+	/// @brief blocking read
+	bool mBlocking;
+	/// @brief wall clock of the last delivery (<0: none)
+	double mDelivered;
+	// <--- variables
+
+	// ---> setting
+public:
+	void setStream(const char *streamName, int streamId = 0) {
+		::strncpy(mStreamName, streamName, SSM_SNAME_MAX - 1);
+		mStreamName[SSM_SNAME_MAX - 1] = '\0';
+		mStreamId = streamId;
+	}
+	void setBuffer(void *data, size_t dataSize, void *property, size_t propertySize) {
+		mData = data;
+		mDataSize = dataSize;
+		mProperty = property;
+		mPropertySize = propertySize;
+	}
+	void setDataBuffer(void *data, size_t dataSize) {
+		mData = data;
+		mDataSize = dataSize;
+	}
+	void setPropertyBuffer(void *property, size_t propertySize) {
+		mProperty = property;
+		mPropertySize = propertySize;
+	}
+	void setBlocking(bool blocking) {
+		mBlocking = blocking;
+	}
+	const char* getStreamName() const {
+		return mStreamName;
+	}
+	int getStreamId() const {
+		return mStreamId;
+	}
+	virtual size_t sharedSize() {
+		return mDataSize;
+	}
+	// <--- setting
+
+	// ---> open, create
+public:
+	bool open(const char *streamName, int streamId = 0, int mode = SSM_READ) {
+		setStream(streamName, streamId);
+		return open(mode);
+	}
+	bool open(int mode = SSM_READ) {
+		if( !(ssmId = ssm::replay::find(mStreamName, mStreamId)) ) return false;
+		timeId = -1;
+		return true;
+	}
+	bool openWait(const char *streamName, int streamId = 0, double timeOut = 0.0, int mode = SSM_READ) {
+		// replay streams exist from the start
+		return open(streamName, streamId, mode);
+	}
+	bool create(const char *streamName, int streamId, double saveTime, double cycle) {
+		setStream(streamName, streamId);
+		return create(saveTime, cycle);
+	}
+	bool create(double saveTime, double cycle) {
+		if( !(ssmId = ssm::replay::create(mStreamName, mStreamId, sharedSize(), saveTime, cycle)) ) return false;
+		timeId = -1;
+		return true;
+	}
+	bool close() {
+		ssmId = 0;
+		return true;
+	}
+	bool release() {
+		return close();
+	}
+	bool isOpen() {
+		return ssmId != 0;
+	}
+	// <--- open, create
+
+	// ---> property
+public:
+	bool getProperty() {
+		if( !isOpen() || !mProperty || !ssmId->property_size ) return false;
+		::memcpy(mProperty, ssmId->property, ssmId->property_size < mPropertySize ? ssmId->property_size : mPropertySize);
+		return true;
+	}
+	bool setProperty() {
+		if( !isOpen() || !mProperty ) return false;
+		return ssm::replay::set_property(ssmId, mProperty, mPropertySize) == 0;
+	}
+	// <--- property
+
+	// ---> read, write
+public:
+	virtual bool read(SSM_tid tid = -1) {
+		SSM_tid t;
+
+		if( !isOpen() ) return false;
+		if( (t = readSSMP(ssmId, mData, &time, tid, 0, 0)) < 0 ) return false;
+		timeId = t;
+		return true;
+	}
+	virtual bool readTime(ssmTimeT t) {
+		SSM_tid tid;
+
+		if( !isOpen() ) return false;
+		if( (tid = readSSMP_time(ssmId, mData, t, &time, 0, 0)) < 0 ) return false;
+		timeId = tid;
+		return true;
+	}
+	virtual bool write(ssmTimeT t = gettimeSSM()) {
+		SSM_tid tid;
+
+		if( !isOpen() ) return false;
+		if( (tid = writeSSMP(ssmId, mData, t, 0, 0)) < 0 ) return false;
+		timeId = tid;
+		time = t;
+		return true;
+	}
+	/// @brief read the newest record if it is newer than the last read
+	bool readNew() {
+		SSM_tid top;
+
+		if( !isOpen() ) return false;
+		_served_();
+		top = ::getTID_top(ssmId);
+		if( top <= timeId && ssm::replay::wait(ssmId, timeId + 1, mBlocking) < 0 ) return false;
+		return _delivered_(read(-1));
+	}
+	/// @brief read the next record
+	bool readNext(int dt = 1) {
+		SSM_tid tid;
+
+		if( !isOpen() ) return false;
+		_served_();
+		tid = timeId < 0 ? ::getTID_top(ssmId) : timeId + dt;
+		if( tid < ssm::replay::oldest(ssmId) ) tid = ssm::replay::oldest(ssmId);
+		if( ssm::replay::wait(ssmId, tid, mBlocking) < 0 ) return false;
+		return _delivered_(read(tid));
+	}
+	/// @brief read the previous record
+	bool readBack(int dt = 1) {
+		return timeId - dt >= 0 ? read(timeId - dt) : false;
+	}
+	/// @brief read the newest record
+	bool readLast() {
+		return read(-1);
+	}
+	SSM_tid getTID() {
+		return timeId;
+	}
+	SSM_tid getTID_top() {
+		return ::getTID_top(ssmId);
+	}
+	// <--- read, write
+
+	// ---> replay statistics
+private:
+	void _served_() {
+		if( mDelivered < 0 ) return;
+		ssm::replay::served(ssmId, ssm::replay::_wall_() - mDelivered);
+		mDelivered = -1;
+	}
+	bool _delivered_(bool ret) {
+		if( !ret || !ssmId->logged ) return ret;
+		ssmId->nread++;
+		mDelivered = ssm::replay::_wall_();
+		return ret;
+	}
+	// <--- replay statistics
+};
+
+
+/**
+ * @brief dummy property
+ */
+struct SSMDummyProperty {
+};
+
+
+/**
+ * @brief ssm api (replay)
+ * @tparam D : data type
+ * @tparam P : property type
+ */
+template < typename D, typename P = SSMDummyProperty >
+class SSMApi : public SSMApiBase {
+public:
+	SSMApi() {
+		_init_();
+	}
+	SSMApi(const char *streamName, int streamId = 0) : SSMApiBase(streamName, streamId) {
+		_init_();
+	}
+	virtual ~SSMApi() {
+	}
+
+public:
+	/// @brief data
+	D data;
+	/// @brief property
+	P property;
+
+private:
+	void _init_() {
+		setBuffer(&data, sizeof(D), &property, sizeof(P));
+	}
+};
+
+#endif /* SSM_REPLAY_HPP_ */
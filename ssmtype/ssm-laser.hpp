@@ -22,6 +22,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstring>
+#include <cmath>
 #include <sys/uio.h>
 
 #include <stdint.h>
@@ -342,6 +343,96 @@ namespace ssm {
 
 	typedef ScanPoint2DProperty SOKUIKIData3DProperty;
 
+
+
+	/// 走査点抽出条件
+	class ScanPoint2DFilter
+	{
+	public:
+		ScanPoint2DFilter(  );
+
+	public:
+		/// 間引き方法
+		enum
+		{
+			CULL_SEQUENTIAL = 0,					///< 直前に採用した点からの距離がcull未満なら棄却(初期値はセンサ原点)
+			CULL_ORIGIN,							///< センサ原点からの距離がcull以下なら棄却
+		};
+
+		double distMin;								///< 最小距離(m)(これ未満は棄却)
+		double distMax;								///< 最大距離(m)(これを超えると棄却, 0以下で無効)
+		double angMax;								///< 最大角度(rad)(これを超えると棄却, 0以下で無効)
+		double cull;								///< 間引き距離(m)(0以下で無効)
+		int cullMode;								///< 間引き方法
+	};
+
+	/// 抽出済み走査点(センサ座標系, SoA)
+	class ScanPoint2DPoints
+	{
+	// ---> constructor,destructor
+	public:
+		ScanPoint2DPoints(  );
+		~ScanPoint2DPoints(  );
+
+	// ---> allocator
+	public:
+		bool alloc( uint32_t numPoints );
+
+	// ---> getter
+	public:
+		/// 抽出点数
+		uint32_t numPoints(  ) const;
+
+	public:
+		double *x;									///< x座標(m)
+		double *y;									///< y座標(m)
+		uint32_t *index;							///< 元のビーム番号
+
+	private:
+		uint32_t _numPoints;						///< 抽出点数
+		uint32_t _allocPoints;						///< 確保点数
+
+		friend class ScanPoint2DBeamCache;
+	};
+
+	/// ビーム毎の単位ベクトルキャッシュ
+	/**
+	 * ScanPoint2DPropertyの角度からcos,sinを一度だけ計算しておく.
+	 * 走査データの角度がキャッシュと異なるビームは読み込み時に再計算するので,
+	 * 結果は毎回::cos,::sinを呼んだ場合と同一になる.
+	 */
+	class ScanPoint2DBeamCache
+	{
+	// ---> constructor,destructor
+	public:
+		ScanPoint2DBeamCache(  );
+		~ScanPoint2DBeamCache(  );
+
+	// ---> setter
+	public:
+		bool set( const ScanPoint2DProperty &prop );
+		bool refresh( ScanPoint2D *scan );
+
+	// ---> getter
+	public:
+		uint32_t numPoints(  ) const;
+		double unitX( uint32_t index ) const;
+		double unitY( uint32_t index ) const;
+
+	// ---> operation
+	public:
+		int extract( ScanPoint2D *scan, const ScanPoint2DFilter &filter, ScanPoint2DPoints *points );
+
+	private:
+		bool _alloc( uint32_t numPoints );
+
+	private:
+		uint32_t _numPoints;						///< ビーム数
+		double *_th;								///< 角度(rad)
+		double *_cos;								///< cos(角度)
+		double *_sin;								///< sin(角度)
+	};
+
 } // namespace ssm
 // ---> type declaration
 
@@ -604,6 +695,210 @@ namespace ssm {
 	// <---- ScanPoint2D function
 
 
+
+	// ----> ScanPoint2DFilter function
+	inline
+	ScanPoint2DFilter::ScanPoint2DFilter(  )
+	{
+		distMin = 0;
+		distMax = 0;
+		angMax = 0;
+		cull = 0;
+		cullMode = CULL_SEQUENTIAL;
+	}
+	// <---- ScanPoint2DFilter function
+
+
+
+	// ----> ScanPoint2DPoints function
+	inline
+	ScanPoint2DPoints::ScanPoint2DPoints(  )
+	{
+		x = NULL;
+		y = NULL;
+		index = NULL;
+		_numPoints = 0;
+		_allocPoints = 0;
+	}
+
+	inline
+	ScanPoint2DPoints::~ScanPoint2DPoints(  )
+	{
+		delete [] x;
+		delete [] y;
+		delete [] index;
+	}
+
+	inline
+	bool ScanPoint2DPoints::alloc( uint32_t numPoints )
+	{
+		_numPoints = 0;
+		if( numPoints <= _allocPoints )	return true;
+
+		delete [] x;
+		delete [] y;
+		delete [] index;
+		x = new double[numPoints];
+		y = new double[numPoints];
+		index = new uint32_t[numPoints];
+		_allocPoints = numPoints;
+		return true;
+	}
+
+	inline
+	uint32_t ScanPoint2DPoints::numPoints(  ) const
+	{
+		return _numPoints;
+	}
+	// <---- ScanPoint2DPoints function
+
+
+
+	// ----> ScanPoint2DBeamCache function
+	inline
+	ScanPoint2DBeamCache::ScanPoint2DBeamCache(  )
+	{
+		_numPoints = 0;
+		_th = NULL;
+		_cos = NULL;
+		_sin = NULL;
+	}
+
+	inline
+	ScanPoint2DBeamCache::~ScanPoint2DBeamCache(  )
+	{
+		delete [] _th;
+		delete [] _cos;
+		delete [] _sin;
+	}
+
+	inline
+	bool ScanPoint2DBeamCache::_alloc( uint32_t numPoints )
+	{
+		if( numPoints == _numPoints )	return true;
+
+		delete [] _th;
+		delete [] _cos;
+		delete [] _sin;
+		_th = new double[numPoints];
+		_cos = new double[numPoints];
+		_sin = new double[numPoints];
+		_numPoints = numPoints;
+		return true;
+	}
+
+	/// @brief プロパティの角度範囲から単位ベクトルを計算
+	inline
+	bool ScanPoint2DBeamCache::set( const ScanPoint2DProperty &prop )
+	{
+		_alloc( prop.numPoints );
+		for( uint32_t i = 0; i < _numPoints; i++ )
+		{
+			_th[i] = prop.angMin + prop.angResolution * i;
+			_cos[i] = ::cos( _th[i] );
+			_sin[i] = ::sin( _th[i] );
+		}
+		return true;
+	}
+
+	/// @brief 走査データの角度と異なるビームの単位ベクトルを再計算
+	inline
+	bool ScanPoint2DBeamCache::refresh( ScanPoint2D *scan )
+	{
+		if( scan->numPoints(  ) != _numPoints )
+		{
+			_alloc( scan->numPoints(  ) );
+			for( uint32_t i = 0; i < _numPoints; i++ )
+			{
+				// 必ず再計算させる
+				_th[i] = (*scan)[i].th + 1.0;
+			}
+		}
+
+		for( uint32_t i = 0; i < _numPoints; i++ )
+		{
+			if( (*scan)[i].th != _th[i] )
+			{
+				_th[i] = (*scan)[i].th;
+				_cos[i] = ::cos( _th[i] );
+				_sin[i] = ::sin( _th[i] );
+			}
+		}
+		return true;
+	}
+
+	inline
+	uint32_t ScanPoint2DBeamCache::numPoints(  ) const
+	{
+		return _numPoints;
+	}
+
+	inline
+	double ScanPoint2DBeamCache::unitX( uint32_t index ) const
+	{
+		return _cos[index];
+	}
+
+	inline
+	double ScanPoint2DBeamCache::unitY( uint32_t index ) const
+	{
+		return _sin[index];
+	}
+
+	/// @brief 走査データから有効な点を抽出してセンサ座標系の点列にする
+	/// @param scan[in] 走査データ
+	/// @param filter[in] 抽出条件
+	/// @param points[out] 抽出点列
+	/// @return 抽出点数
+	inline
+	int ScanPoint2DBeamCache::extract( ScanPoint2D *scan, const ScanPoint2DFilter &filter, ScanPoint2DPoints *points )
+	{
+		double sqcull = filter.cull > 0 ? filter.cull * filter.cull : 0;
+		double prevx = 0, prevy = 0;
+		uint32_t n = 0;
+
+		refresh( scan );
+		points->alloc( _numPoints );
+
+		for( uint32_t i = 0; i < _numPoints; i++ )
+		{
+			MeasuredPoint2DPolar &p = (*scan)[i];
+			double x, y;
+
+			if( p.status == laser::STATUS_NO_REFLECTION )	continue;
+			else if( p.isError(  ) )	continue;
+			else if( p.r < filter.distMin )	continue;
+			else if( filter.distMax > 0 && p.r > filter.distMax )	continue;
+			else if( filter.angMax > 0 && p.th > filter.angMax )	continue;
+
+			x = p.r * _cos[i];
+			y = p.r * _sin[i];
+
+			// 間引き
+			if( filter.cull > 0 )
+			{
+				double sqdist = (x - prevx) * (x - prevx) + (y - prevy) * (y - prevy);
+				if( filter.cullMode == ScanPoint2DFilter::CULL_ORIGIN )
+				{
+					if( sqdist <= sqcull )	continue;
+				}
+				else
+				{
+					if( sqdist < sqcull )	continue;
+					prevx = x;
+					prevy = y;
+				}
+			}
+
+			points->x[n] = x;
+			points->y[n] = y;
+			points->index[n] = i;
+			n++;
+		}
+		points->_numPoints = n;
+		return n;
+	}
+	// <---- ScanPoint2DBeamCache function
 } // namespace ssm
 // <--- function definition
 
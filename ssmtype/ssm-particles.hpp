@@ -45,6 +45,25 @@ enum {
 	PARTICLE_DIM = PARTICLE_END
 };
 
+/**
+ * @brief resampling method of remaining particles
+ */
+enum {
+	PARTICLE_RESAMPLING_MULTINOMIAL = 0,	// independent random draw
+	PARTICLE_RESAMPLING_SYSTEMATIC = 1,		// low variance sampling (one random number)
+	PARTICLE_RESAMPLING_STRATIFIED = 2,		// one random number in each stratum
+	PARTICLE_RESAMPLING_ALIAS = 3,			// independent random draw with alias table
+};
+
+/**
+ * @brief layout of particles on shared memory
+ */
+enum {
+	PARTICLE_LAYOUT_AOS = 0,				// array of particle vector (double)
+	PARTICLE_LAYOUT_SOA = 1,				// array of each component (double)
+	PARTICLE_LAYOUT_SOA_FLOAT = 2,			// array of each component (float)
+};
+
 
 struct POSITION_PARTICLE {
 	union {
@@ -122,7 +141,7 @@ public:
 	/**
 	 * @brief resampling remain
 	 */
-	int resampling_remain(double *eval, const uint32_t n, value_t* ave = 0);
+	int resampling_remain(double *eval, const uint32_t n, value_t* ave = 0, int method = PARTICLE_RESAMPLING_MULTINOMIAL);
 
 	/**
 	 * @brief resampling change position
@@ -145,6 +164,23 @@ public:
 	template< typename MTRX >
 	int random_sampling( MTRX *myu );
 
+// ---> adaptive number of particles
+public:
+	int kld_bins( const double *bin, uint32_t *k );
+	static uint32_t kld_bound( uint32_t k, double epsilon, double z );
+
+// ---> random
+public:
+	void random_seed( uint64_t s );
+private:
+	/**
+	 * @brief random engine of this particle set
+	 */
+	gnd::random_engine _rng;
+	/**
+	 * @brief number of uniform random values drawn at once in resampling
+	 */
+	static const uint32_t UniformBatch = 64;
 
 private:
 	/**
@@ -153,7 +189,14 @@ private:
 	struct {
 		gnd::queue< gnd::matrix::fixed< 1, PARTICLE_DIM > > storage;
 		double sum;
+		gnd::queue< double > cumsum;		// cumulative sum of evaluation
+		gnd::queue< double > prob;			// alias table probability
+		gnd::queue< uint32_t > alias;		// alias table index
+		gnd::queue< uint64_t > bins;		// histogram bin of particles (kld-sampling)
 	} _resampling_var;
+
+	uint32_t _cumsum_search_(double rnd);
+	int _alias_table_build_(double *eval, uint32_t n, double sum);
 };
 typedef POSITION_PARTICLE_SET_CLASS particle_set_c;
 
@@ -177,6 +220,94 @@ inline POSITION_PARTICLE_SET_CLASS::~POSITION_PARTICLE_SET_CLASS()
 
 
 
+/**
+ * @brief compare histogram bin (for qsort)
+ */
+inline int __particle_bin_compare__( const void *a, const void *b )
+{
+	const uint64_t ka = *static_cast<const uint64_t*>(a);
+	const uint64_t kb = *static_cast<const uint64_t*>(b);
+	return ka < kb ? -1 : ka > kb ? 1 : 0;
+}
+
+/**
+ * @brief count histogram bins occupied by particles
+ * @param [in]  bin : bin size of position (x, y, theta)
+ * @param [out]   k : number of occupied bins
+ */
+inline int POSITION_PARTICLE_SET_CLASS::kld_bins( const double *bin, uint32_t *k )
+{
+	gnd_assert(!bin || !k, -1, "null pointer");
+	gnd_assert(bin[0] <= 0 || bin[1] <= 0 || bin[2] <= 0, -1, "invalid argument");
+
+	*k = 0;
+	if( size() <= 0 )	return 0;
+
+	{ // ---> compute bin of each particle
+		uint32_t i;
+
+		_resampling_var.bins.clear();
+		if( _resampling_var.bins.nalloc() < size() )	_resampling_var.bins.allocate(size());
+		for( i = 0; i < size(); i++ ) {
+			double th = ::fmod( (*this)[i][0][PARTICLE_THETA], 2.0 * M_PI );
+			int64_t ix, iy, ith;
+			uint64_t key;
+
+			if( th < 0 )	th += 2.0 * M_PI;
+			ix = (int64_t) ::floor( (*this)[i][0][PARTICLE_X] / bin[0] );
+			iy = (int64_t) ::floor( (*this)[i][0][PARTICLE_Y] / bin[1] );
+			ith = (int64_t) ::floor( th / bin[2] );
+			// 21 bits for each axis
+			key = (((uint64_t) ix & 0x1fffff) << 42) | (((uint64_t) iy & 0x1fffff) << 21) | ((uint64_t) ith & 0x1fffff);
+			_resampling_var.bins.push_back(&key);
+		}
+	} // <--- compute bin of each particle
+
+	{ // ---> count unique bins
+		uint64_t *p = _resampling_var.bins.begin();
+		uint32_t i;
+
+		::qsort(p, _resampling_var.bins.size(), sizeof(uint64_t), __particle_bin_compare__);
+		*k = 1;
+		for( i = 1; i < _resampling_var.bins.size(); i++ ) {
+			if( p[i] != p[i - 1] )	(*k)++;
+		}
+	} // <--- count unique bins
+
+	return 0;
+}
+
+/**
+ * @brief number of particles required by kld-sampling
+ * @param [in]       k : number of occupied histogram bins
+ * @param [in] epsilon : bound of kl-divergence between sample and true distribution
+ * @param [in]       z : upper standard normal quantile of confidence
+ * @return number of particles (0 if k < 2)
+ * @note D. Fox, "KLD-sampling: adaptive particle filters", NIPS 2001 (wilson-hilferty approximation of chi-square quantile)
+ */
+inline uint32_t POSITION_PARTICLE_SET_CLASS::kld_bound( uint32_t k, double epsilon, double z )
+{
+	double a, b;
+
+	if( k < 2 || epsilon <= 0 )	return 0;
+	a = 2.0 / ( 9.0 * (k - 1) );
+	b = 1.0 - a + ::sqrt(a) * z;
+	return (uint32_t) ::ceil( (k - 1) / ( 2.0 * epsilon ) * b * b * b );
+}
+
+
+
+/**
+ * @brief set seed of random engine
+ * @param [in] s : seed
+ */
+inline void POSITION_PARTICLE_SET_CLASS::random_seed( uint64_t s )
+{
+	_rng.seed(s);
+}
+
+
+
 /**
  * @brief generate initial particle set
  * @param [in] myu		: mean
@@ -193,6 +324,14 @@ inline int POSITION_PARTICLE_SET_CLASS::init_particle( MTRX1 *myu, MTRX2 *sigmap
 	gnd_assert(gnd::matrix::column(sigmap) < (signed) PARTICLE_POS_DIM, -1, "invalid argument");
 	gnd_error(n <= 0, -1, "no effect argument");
 
+	gnd::gaussian_sampler<PARTICLE_POS_DIM> smpp;
+	gnd::gaussian_sampler<PARTICLE_PROP_DIM> smpk;
+	bool noisep, noisek;
+
+	{ // ---> factorize covariance (no random value is added if it is invalid)
+		noisep = smpp.set(sigmap) == 0;
+		noisek = sigmak && smpk.set(sigmak) == 0;
+	} // <--- factorize covariance
 
 	{ // ---> initialize matrix
 		clear();
@@ -202,8 +341,11 @@ inline int POSITION_PARTICLE_SET_CLASS::init_particle( MTRX1 *myu, MTRX2 *sigmap
 	{
 		uint32_t i = 0;
 		gnd::matrix::fixed<1, PARTICLE_DIM> rnd;
-		gnd::matrix::fixed<1, PARTICLE_POS_DIM> ws;
-		gnd::matrix::fixed<PARTICLE_POS_DIM, PARTICLE_POS_DIM> cp_sigma;
+		double rndp[UniformBatch * PARTICLE_POS_DIM];
+		double rndk[UniformBatch * PARTICLE_PROP_DIM];
+
+		if( !noisep )	::memset(rndp, 0, sizeof(rndp));
+		if( !noisek )	::memset(rndk, 0, sizeof(rndk));
 
 		// set
 		push_back( myu );
@@ -213,22 +355,25 @@ inline int POSITION_PARTICLE_SET_CLASS::init_particle( MTRX1 *myu, MTRX2 *sigmap
 		pos.prop.wheel_odm.wheel_mean = pos.prop.wheel_odm.wheel_ratio = pos.prop.wheel_odm.tread_ratio = 0;
 
 		for(i = 1; i < n; i++){
-			gnd::matrix::flex rand_ref;			// reference for randamize
-			gnd::matrix::set_zero(&rnd);
-
-			{ // ---> add random (position)
-				gnd::matrix::assign_to_as_vector(&rand_ref, &rnd, 0, PARTICLE_POS_INDX, PARTICLE_POS_DIM);
-				gnd::matrix::copy(&cp_sigma, sigmap);
-				gnd::random_gaussian_mult(&cp_sigma, PARTICLE_POS_DIM, &ws, &rand_ref);
-			} // <--- add random (position)
-			// ---> add random (kinematics)
+			const uint32_t b = (i - 1) % UniformBatch;
+			uint32_t k;
+
+			// draw random values by batch
+			if( b == 0 ) {
+				const uint32_t m = n - i < UniformBatch ? n - i : (uint32_t) UniformBatch;
+				if( noisep )	smpp.sample(&_rng, rndp, m);
+				if( noisek )	smpk.sample(&_rng, rndk, m);
+			}
+
+			gnd::matrix::copy(&rnd, myu);
+			// add random (position)
+			for( k = 0; k < PARTICLE_POS_DIM; k++ )
+				rnd[0][PARTICLE_POS_INDX + k] += rndp[b * PARTICLE_POS_DIM + k];
+			// add random (kinematics)
 			if( sigmak ) {
-				gnd::matrix::assign_to_as_vector(&rand_ref, &rnd, 0, PARTICLE_PROP_INDX, PARTICLE_PROP_DIM);
-				gnd::matrix::copy(&cp_sigma, sigmak);
-				gnd::random_gaussian_mult(&cp_sigma, PARTICLE_PROP_DIM, &ws, &rand_ref);
-			} // <--- add random (kinematics)
-			// add random error to mean
-			gnd::matrix::add(&rnd, myu, &rnd);
+				for( k = 0; k < PARTICLE_PROP_DIM; k++ )
+					rnd[0][PARTICLE_PROP_INDX + k] += rndk[b * PARTICLE_PROP_DIM + k];
+			}
 			// set new particle
 			push_back( &rnd );
 
@@ -370,10 +515,74 @@ inline int POSITION_PARTICLE_SET_CLASS::gyro_odometry_motion(int cnt1, int cnt2,
 
 
 
+/**
+ * @brief search cumulative sum
+ * @param [in] rnd : value in [0, sum)
+ * @return first index that cumulative sum is greater than rnd
+ */
+inline uint32_t POSITION_PARTICLE_SET_CLASS::_cumsum_search_(double rnd)
+{
+	uint32_t lo = 0, hi;
+
+	if( _resampling_var.cumsum.size() <= 0 )	return 0;
+	hi = _resampling_var.cumsum.size() - 1;
+	while( lo < hi ) {
+		uint32_t mid = (lo + hi) / 2;
+		if( _resampling_var.cumsum[mid] > rnd )	hi = mid;
+		else									lo = mid + 1;
+	}
+	return lo;
+}
+
+/**
+ * @brief build alias table (Vose's method)
+ * @param [in] eval : evaluation
+ * @param [in]    n : number of evaluation
+ * @param [in]  sum : sum of evaluation
+ */
+inline int POSITION_PARTICLE_SET_CLASS::_alias_table_build_(double *eval, uint32_t n, double sum)
+{
+	// work stack: small from front, large from back
+	uint32_t *stack = new uint32_t[n];
+	uint32_t nsmall = 0, nlarge = 0;
+	uint32_t i;
+
+	_resampling_var.prob.clear();
+	_resampling_var.alias.clear();
+	for( i = 0; i < n; i++ ) {
+		double p = eval[i] * n / sum;
+		_resampling_var.prob.push_back(&p);
+		_resampling_var.alias.push_back(&i);
+		if( p < 1.0 )	stack[nsmall++] = i;
+		else			stack[n - (++nlarge)] = i;
+	}
+
+	while( nsmall > 0 && nlarge > 0 ) {
+		uint32_t s = stack[--nsmall];
+		uint32_t l = stack[n - (nlarge--)];
+
+		_resampling_var.alias[s] = l;
+		_resampling_var.prob[l] = (_resampling_var.prob[l] + _resampling_var.prob[s]) - 1.0;
+		if( _resampling_var.prob[l] < 1.0 )	stack[nsmall++] = l;
+		else								stack[n - (++nlarge)] = l;
+	}
+	// remaining (numerical error)
+	while( nlarge > 0 )	_resampling_var.prob[ stack[n - (nlarge--)] ] = 1.0;
+	while( nsmall > 0 )	_resampling_var.prob[ stack[--nsmall] ] = 1.0;
+
+	delete[] stack;
+	return 0;
+}
+
+
 /**
  * @brief init_resampling()
+ * @param [in]  eval   : evaluation of each particle
+ * @param [in]  nremain: number of remaining particles
+ * @param [out] ave    : average of remaining particles evaluation
+ * @param [in]  method : resampling method (PARTICLE_RESAMPLING_*)
  */
-inline int POSITION_PARTICLE_SET_CLASS::resampling_remain(double *eval, const uint32_t nremain, value_t *ave)
+inline int POSITION_PARTICLE_SET_CLASS::resampling_remain(double *eval, const uint32_t nremain, value_t *ave, int method)
 {
 	double evalsum = 0;
 	{ // ---> initialize
@@ -381,32 +590,64 @@ inline int POSITION_PARTICLE_SET_CLASS::resampling_remain(double *eval, const ui
 		_resampling_var.sum = 0;
 	} // <--- initialize
 
+	if( size() <= 0 )	return -1;
+
 	{ // ---> set evaluation and compute sum
 		uint32_t i;
 
-		// compute eval
+		// compute cumulative sum of eval
+		_resampling_var.cumsum.clear();
 		for(i = 0; (signed)i < size(); i++){
 			evalsum += eval[i];
+			_resampling_var.cumsum.push_back(&evalsum);
 		}
 
 		if(evalsum <= 0)	return -1;
 	} // <--- set evaluation and compute sum
 
+	if( method == PARTICLE_RESAMPLING_ALIAS ) {
+		_alias_table_build_(eval, size(), evalsum);
+	}
+
 	{ // ---> resampling remain
-		uint32_t i, j;
+		uint32_t i, j = 0;
 		double rnd;
+		double step = evalsum / nremain;
+		double offset = step * _rng.uniform();
+		double urnd[UniformBatch];
 		gnd::matrix::fixed<1, PARTICLE_DIM> wave;
 		gnd::matrix::fixed<1, PARTICLE_DIM> ws;
-		gnd::matrix::flex ref;
 
 		// ---> save into storage
 		gnd::matrix::set_zero(&wave);
 		for(i = 0; i < nremain; i++){
-			double sum = 0;
-			rnd = evalsum * gnd::random_uniform();
-			// select particle
-			for(j = 0; (signed)j < size() && rnd > sum; j++)	sum += eval[j];
-			if(j >= 0)	j--;
+			// draw uniform random values by batch
+			if( method != PARTICLE_RESAMPLING_SYSTEMATIC && i % UniformBatch == 0 ) {
+				_rng.fill_uniform(urnd, nremain - i < UniformBatch ? nremain - i : (uint32_t) UniformBatch);
+			}
+
+			// ---> select particle
+			switch( method ) {
+			case PARTICLE_RESAMPLING_SYSTEMATIC:
+			case PARTICLE_RESAMPLING_STRATIFIED: {
+				rnd = method == PARTICLE_RESAMPLING_SYSTEMATIC ?
+						offset + step * i :
+						step * (i + urnd[i % UniformBatch]);
+				// cumulative sum is monotonic, so search forward from previous selection
+				while( j + 1 < size() && _resampling_var.cumsum[j] <= rnd )	j++;
+			} break;
+			case PARTICLE_RESAMPLING_ALIAS: {
+				rnd = size() * urnd[i % UniformBatch];
+				j = (uint32_t) rnd;
+				if( j >= size() )	j = size() - 1;
+				if( rnd - j >= _resampling_var.prob[j] )	j = _resampling_var.alias[j];
+			} break;
+			case PARTICLE_RESAMPLING_MULTINOMIAL:
+			default: {
+				rnd = evalsum * urnd[i % UniformBatch];
+				j = _cumsum_search_(rnd);
+			} break;
+			} // <--- select particle
 
 			_resampling_var.storage.push_back( (*this) + j );
 			// increment remaining count
@@ -416,8 +657,6 @@ inline int POSITION_PARTICLE_SET_CLASS::resampling_remain(double *eval, const ui
 			_resampling_var.sum += eval[j];
 
 			// weighted summation of particle vector
-			gnd::matrix::clear(&ref);
-
 			gnd::matrix::scalar_prod(_resampling_var.storage + i,  eval[j],  &ws);
 			gnd::matrix::add(&wave, &ws, &wave);
 		} // for(i)
@@ -434,6 +673,15 @@ inline int POSITION_PARTICLE_SET_CLASS::resampling_remain(double *eval, const ui
 		}
 		// <--- set remaining particle
 
+		// ---> cumulative sum of remaining particle evaluation
+		_resampling_var.cumsum.clear();
+		rnd = 0;
+		for(i = 0; i < _resampling_var.storage.size(); i++){
+			rnd += _resampling_var.storage[i][0][PARTICLE_EVAL];
+			_resampling_var.cumsum.push_back(&rnd);
+		}
+		// <--- cumulative sum of remaining particle evaluation
+
 		// save eval average
 		if(ave){
 			*ave = _resampling_var.sum / _resampling_var.storage.size();
@@ -453,32 +701,32 @@ template < typename MTRX >
 inline int POSITION_PARTICLE_SET_CLASS::resampling_position( MTRX *sigma, const uint32_t n)
 {
 	gnd::matrix::fixed<1, PARTICLE_DIM> tmp;
-	gnd::matrix::fixed<1, PARTICLE_POS_DIM> ws;
-	gnd::matrix::fixed<PARTICLE_POS_DIM, PARTICLE_POS_DIM> cp_sigma;
-	uint32_t i, j;
+	gnd::gaussian_sampler<PARTICLE_POS_DIM> smp;
+	double rndp[UniformBatch * PARTICLE_POS_DIM];
+	uint32_t i, j, k;
 	double rnd;
+	bool noise;
+
+	// factorize covariance once for all particles (no random value is added if it is invalid)
+	if( !(noise = smp.set(sigma) == 0) )	::memset(rndp, 0, sizeof(rndp));
 
 	for(i = 0; i < n; i++){
-		double sum = 0;
-		rnd = _resampling_var.sum * gnd::random_uniform();
+		const uint32_t b = i % UniformBatch;
 
-		// select perticle
-		for(j = 0; (signed)j < _resampling_var.storage.size() && rnd > sum; j++)
-			sum += _resampling_var.storage[j][0][PARTICLE_EVAL];
-		j--;
+		// draw random values by batch
+		if( noise && b == 0 ) {
+			smp.sample(&_rng, rndp, n - i < UniformBatch ? n - i : (uint32_t) UniformBatch);
+		}
 
-		{ // ---> add random (position)
-			gnd::matrix::flex rndp;
+		rnd = _resampling_var.sum * _rng.uniform();
 
-			// clear
-			gnd::matrix::set_zero(&tmp);
-			// assign
-			gnd::matrix::assign_to_as_vector(&rndp, &tmp, 0, PARTICLE_POS_INDX, PARTICLE_POS_DIM);
-			gnd::matrix::copy(&cp_sigma, sigma);
-			// generate random
-			gnd::random_gaussian_mult(&cp_sigma, PARTICLE_POS_DIM, &ws, &rndp);
+		// select perticle
+		j = _cumsum_search_(rnd);
 
-			gnd::matrix::add(&tmp, _resampling_var.storage + j, &tmp);
+		{ // ---> add random (position)
+			gnd::matrix::copy(&tmp, _resampling_var.storage + j);
+			for( k = 0; k < PARTICLE_POS_DIM; k++ )
+				tmp[0][PARTICLE_POS_INDX + k] += rndp[b * PARTICLE_POS_DIM + k];
 			// initialize remaining count
 			push_back( &tmp );
 		} // <--- add random (position)
@@ -495,35 +743,35 @@ template < typename MTRX >
 inline int POSITION_PARTICLE_SET_CLASS::resampling_kinematics( MTRX *sigma, const uint32_t n)
 {
 	gnd::matrix::fixed<1, PARTICLE_DIM> tmp;
-	gnd::matrix::fixed<1, PARTICLE_PROP_DIM> ws;
-	gnd::matrix::fixed<PARTICLE_PROP_DIM, PARTICLE_PROP_DIM> cp_sigma;
-	uint32_t i, j;
+	gnd::gaussian_sampler<PARTICLE_PROP_DIM> smp;
+	double rndk[UniformBatch * PARTICLE_PROP_DIM];
+	uint32_t i, j, k;
 	double rnd;
+	bool noise;
+
+	// factorize covariance once for all particles (no random value is added if it is invalid)
+	if( !(noise = smp.set(sigma) == 0) )	::memset(rndk, 0, sizeof(rndk));
 
 	for(i = 0; i < n; i++){
-		double sum = 0;
-		rnd = _resampling_var.sum * gnd::random_uniform();
+		const uint32_t b = i % UniformBatch;
 
-		// select perticle
-		for(j = 0; (signed)j < _resampling_var.storage.size() && rnd > sum; j++)
-			sum += _resampling_var.storage[j][0][PARTICLE_EVAL];
-		j--;
+		// draw random values by batch
+		if( noise && b == 0 ) {
+			smp.sample(&_rng, rndk, n - i < UniformBatch ? n - i : (uint32_t) UniformBatch);
+		}
 
-		{ // ---> add random (position)
-			gnd::matrix::flex rndp;
+		rnd = _resampling_var.sum * _rng.uniform();
 
-			// clear
-			gnd::matrix::set_zero(&tmp);
-			// assign
-			gnd::matrix::assign_to_as_vector(&rndp, &tmp, 0, PARTICLE_PROP_INDX, PARTICLE_PROP_DIM);
-			gnd::matrix::copy(&cp_sigma, sigma);
-			// generate random
-			gnd::random_gaussian_mult(&cp_sigma, PARTICLE_PROP_DIM, &ws, &rndp);
+		// select perticle
+		j = _cumsum_search_(rnd);
 
-			gnd::matrix::add(&tmp, _resampling_var.storage + j, &tmp);
+		{ // ---> add random (kinematics)
+			gnd::matrix::copy(&tmp, _resampling_var.storage + j);
+			for( k = 0; k < PARTICLE_PROP_DIM; k++ )
+				tmp[0][PARTICLE_PROP_INDX + k] += rndk[b * PARTICLE_PROP_DIM + k];
 			// initialize remaining count
 			push_back( &tmp );
-		} // <--- add random (position)
+		} // <--- add random (kinematics)
 	} // for(i)
 
 	return 0;
@@ -533,37 +781,37 @@ template < typename MTRX1, typename MTRX2 >
 inline int POSITION_PARTICLE_SET_CLASS::resampling_kinematics_reset( MTRX1 *myu, MTRX2 *sigma, const uint32_t n)
 {
 	gnd::matrix::fixed<1, PARTICLE_DIM> tmp;
-	gnd::matrix::fixed<1, PARTICLE_PROP_DIM> ws;
-	gnd::matrix::fixed<PARTICLE_PROP_DIM, PARTICLE_PROP_DIM> cp_sigma;
-	uint32_t i, j;
+	gnd::gaussian_sampler<PARTICLE_PROP_DIM> smp;
+	double rndk[UniformBatch * PARTICLE_PROP_DIM];
+	uint32_t i, j, k;
 	double rnd;
+	bool noise;
+
+	// factorize covariance once for all particles (no random value is added if it is invalid)
+	if( !(noise = smp.set(sigma) == 0) )	::memset(rndk, 0, sizeof(rndk));
 
 	for(i = 0; i < n; i++){
-		double sum = 0;
-		rnd = _resampling_var.sum * gnd::random_uniform();
+		const uint32_t b = i % UniformBatch;
 
-		// select perticle
-		for(j = 0; (signed)j < _resampling_var.storage.size() && rnd > sum; j++)
-			sum += _resampling_var.storage[j][0][PARTICLE_EVAL];
-		j--;
+		// draw random values by batch
+		if( noise && b == 0 ) {
+			smp.sample(&_rng, rndk, n - i < UniformBatch ? n - i : (uint32_t) UniformBatch);
+		}
 
-		{ // ---> add random (position)
-			gnd::matrix::flex rndp;
+		rnd = _resampling_var.sum * _rng.uniform();
 
-			// clear
-			gnd::matrix::set_zero(&tmp);
-			// assign
-			gnd::matrix::assign_to_as_vector(&rndp, &tmp, 0, PARTICLE_PROP_INDX, PARTICLE_PROP_DIM);
-			gnd::matrix::copy(&cp_sigma, sigma);
-			// generate random
-			gnd::random_gaussian_mult(&cp_sigma, PARTICLE_PROP_DIM, &ws, &rndp);
+		// select perticle
+		j = _cumsum_search_(rnd);
 
+		{ // ---> add random (kinematics)
 			//todo
 			gnd::matrix::set(_resampling_var.storage + j, 0, PARTICLE_PROP_INDX, gnd::matrix::pointer(myu, 0, PARTICLE_PROP_INDX), PARTICLE_PROP_DIM);
-			gnd::matrix::add(&tmp, _resampling_var.storage + j, &tmp);
+			gnd::matrix::copy(&tmp, _resampling_var.storage + j);
+			for( k = 0; k < PARTICLE_PROP_DIM; k++ )
+				tmp[0][PARTICLE_PROP_INDX + k] += rndk[b * PARTICLE_PROP_DIM + k];
 			// initialize remaining count
 			push_back( &tmp );
-		} // <--- add random (position)
+		} // <--- add random (kinematics)
 	} // for(i)
 
 	return 0;
@@ -589,6 +837,106 @@ int POSITION_PARTICLE_SET_CLASS::random_sampling( MTRX *myu )
 
 
 
+/**
+ * @brief header of particles record on shared memory
+ * @note on little endian, layout 0 record is identical with the former one (uint64_t number of particle)
+ */
+struct PARTICLES_RECORD_HEADER {
+	uint32_t n;			///< number of particle
+	uint32_t layout;	///< layout (PARTICLE_LAYOUT_*)
+};
+typedef struct PARTICLES_RECORD_HEADER particles_record_header;
+
+
+
+/**
+ * @brief view of particles record (refer to the record, no copy)
+ */
+class PARTICLE_VIEW_CLASS {
+public:
+	PARTICLE_VIEW_CLASS();
+
+public:
+	/// @brief number of particle
+	uint32_t n;
+	/// @brief layout (PARTICLE_LAYOUT_*)
+	uint32_t layout;
+private:
+	/// @brief top of particle vector
+	const char *_base;
+	/// @brief byte step between particles
+	size_t _step;
+	/// @brief byte step between components
+	size_t _cstep;
+	/// @brief byte size of a component
+	size_t _esize;
+
+public:
+	int set(const void *rec);
+	template < typename T >
+	const T* column(int j, size_t *step) const;
+};
+typedef PARTICLE_VIEW_CLASS particle_view;
+
+
+inline PARTICLE_VIEW_CLASS::PARTICLE_VIEW_CLASS()
+	: n(0), layout(PARTICLE_LAYOUT_AOS), _base(0), _step(0), _cstep(0), _esize(0)
+{
+}
+
+/**
+ * @brief set record
+ * @param [in] rec : particles record (header and particles)
+ */
+inline int PARTICLE_VIEW_CLASS::set(const void *rec)
+{
+	const particles_record_header *h = static_cast<const particles_record_header*>(rec);
+
+	gnd_assert(!rec, -1, "null pointer");
+
+	n = h->n;
+	layout = h->layout;
+	_base = static_cast<const char*>(rec) + sizeof(particles_record_header);
+	switch( layout ) {
+	case PARTICLE_LAYOUT_AOS:
+		_step = sizeof(double) * PARTICLE_DIM;
+		_cstep = sizeof(double);
+		_esize = sizeof(double);
+		break;
+	case PARTICLE_LAYOUT_SOA:
+		_step = sizeof(double);
+		_cstep = sizeof(double) * n;
+		_esize = sizeof(double);
+		break;
+	case PARTICLE_LAYOUT_SOA_FLOAT:
+		_step = sizeof(float);
+		_cstep = sizeof(float) * n;
+		_esize = sizeof(float);
+		break;
+	default:
+		n = 0;
+		gnd_error(true, -1, "unknown layout");
+	}
+	return 0;
+}
+
+/**
+ * @brief get component array
+ * @param [in]  j    : component index (PARTICLE_X, ...)
+ * @param [out] step : number of elements between particles (1 on structure of arrays layout)
+ * @return top of array, null if the element type does not match (float: PARTICLE_LAYOUT_SOA_FLOAT, double: others)
+ * @note the i-th particle component is column<T>(j, &step)[i * step]
+ */
+template < typename T >
+inline const T* PARTICLE_VIEW_CLASS::column(int j, size_t *step) const
+{
+	if( _esize != sizeof(T) )	return 0;
+	*step = _step / sizeof(T);
+	return reinterpret_cast<const T*>(_base + _cstep * j);
+}
+
+
+
 #include <ssm.hpp>
 
 /**
@@ -611,40 +959,122 @@ class SSMParticles
 	: public SSMApi<particle_set_c, SSMParticlesProperty>
 {
 public:
-	SSMParticles(){}
-	SSMParticles( const char *streamName, int streamId = 0 ) : SSMApi<particle_set_c, SSMParticlesProperty>( streamName, streamId ){}
+	SSMParticles() : _layout(PARTICLE_LAYOUT_AOS) {}
+	SSMParticles( const char *streamName, int streamId = 0 ) : SSMApi<particle_set_c, SSMParticlesProperty>( streamName, streamId ), _layout(PARTICLE_LAYOUT_AOS) {}
 
 	typedef gnd::matrix::fixed<1, PARTICLE_DIM> ssmdata_t;
 
+private:
+	/// @brief layout of written record (PARTICLE_LAYOUT_*)
+	uint32_t _layout;
+
+	/**
+	 * @brief view reading context
+	 */
+	struct view_context {
+		void (*fn)(const particle_view*, void*);
+		void *user;
+	};
+
 public:
 	///
 	size_t sharedSize(  )
 	{
-		return sizeof(gnd::matrix::fixed<1, PARTICLE_DIM>) * data.nalloc();
+		return sizeof(particles_record_header) + sizeof(gnd::matrix::fixed<1, PARTICLE_DIM>) * data.nalloc();
+	}
+
+	/**
+	 * @brief set layout of written record
+	 * @param [in] layout : PARTICLE_LAYOUT_*
+	 */
+	void setLayout( uint32_t layout )
+	{
+		_layout = layout;
 	}
 
 
 private:
+	/**
+	 * @brief write into shared memory
+	 * @note structure of arrays layout is filled in place on the shared memory, no intermediate buffer
+	 */
 	static void _ssmWrite( void *assmp, const void *adata, void *userData ){
-//		ssmdata_t *ssmp = static_cast<ssmdata_t *>( assmp );
 		const particle_set_c *data = static_cast<const particle_set_c*>(adata);
-		uint64_t n = data->size();
-
-		::memcpy( assmp, &n, sizeof(uint64_t));
-		::memcpy( (char*)assmp + sizeof(uint64_t), data->const_begin(),
-				data->size() * sizeof(ssmdata_t));
+		particles_record_header *h = static_cast<particles_record_header*>(assmp);
+		char *p = static_cast<char*>(assmp) + sizeof(particles_record_header);
+		const uint32_t n = data->size();
+		const ssmdata_t *src = data->const_begin();
+
+		h->n = n;
+		h->layout = *static_cast<const uint32_t*>(userData);
+		switch( h->layout ) {
+		case PARTICLE_LAYOUT_SOA: {
+			double *dest = reinterpret_cast<double*>(p);
+			for( uint32_t j = 0; j < PARTICLE_DIM; j++ ) {
+				for( uint32_t i = 0; i < n; i++ )	dest[i] = src[i][0][j];
+				dest += n;
+			}
+		} break;
+		case PARTICLE_LAYOUT_SOA_FLOAT: {
+			float *dest = reinterpret_cast<float*>(p);
+			for( uint32_t j = 0; j < PARTICLE_DIM; j++ ) {
+				for( uint32_t i = 0; i < n; i++ )	dest[i] = (float) src[i][0][j];
+				dest += n;
+			}
+		} break;
+		case PARTICLE_LAYOUT_AOS:
+		default:
+			h->layout = PARTICLE_LAYOUT_AOS;
+			::memcpy( p, src, n * sizeof(ssmdata_t));
+			break;
+		}
 	}
 
 	static void _ssmRead( const void *assmp, void *adata, void *auserData )
 	{
-		const ssmdata_t *ssmp = static_cast<const ssmdata_t *>( (const void*) ((const char*)assmp + sizeof(uint64_t)));
 		particle_set_c *data = static_cast<particle_set_c *>( adata );
-		uint64_t n;
+		particle_view v;
 
-		::memcpy( &n, static_cast<const char *>(assmp), sizeof(uint64_t) );
-		if( data->nalloc() < n )	data->allocate(n);
 		data->clear();
-		data->push_back( ssmp,  n );
+		if( v.set(assmp) < 0 )	return;
+		if( data->nalloc() < v.n )	data->allocate(v.n);
+
+		if( v.layout == PARTICLE_LAYOUT_AOS ) {
+			const ssmdata_t *ssmp = static_cast<const ssmdata_t *>( (const void*) ((const char*)assmp + sizeof(particles_record_header)));
+			data->push_back( ssmp, v.n );
+		}
+		else if( v.layout == PARTICLE_LAYOUT_SOA_FLOAT ) {
+			_ssmReadColumn<float>( data, &v );
+		}
+		else {
+			_ssmReadColumn<double>( data, &v );
+		}
+	}
+
+	/**
+	 * @brief gather structure of arrays record into particles
+	 */
+	template < typename T >
+	static void _ssmReadColumn( particle_set_c *data, const particle_view *v )
+	{
+		const T *col[PARTICLE_DIM];
+		size_t step = 0;
+		ssmdata_t ws;
+
+		for( uint32_t j = 0; j < PARTICLE_DIM; j++ )	col[j] = v->column<T>(j, &step);
+		for( uint32_t i = 0; i < v->n; i++ ) {
+			for( uint32_t j = 0; j < PARTICLE_DIM; j++ )	ws[0][j] = col[j][i * step];
+			data->push_back( &ws );
+		}
+	}
+
+	static void _ssmView( const void *assmp, void *adata, void *auserData )
+	{
+		view_context *ctx = static_cast<view_context *>( adata );
+		particle_view v;
+
+		if( v.set(assmp) < 0 )	return;
+		ctx->fn(&v, ctx->user);
 	}
 
 public:
@@ -653,7 +1083,7 @@ public:
 		if( !isOpen(  ) )
 			return false;
 		int tid;
-		tid = writeSSMP( ssmId, &data, time, SSMParticles::_ssmWrite, NULL );
+		tid = writeSSMP( ssmId, &data, time, SSMParticles::_ssmWrite, &_layout );
 		if(tid >= 0){timeId = tid; this->time = time; return true;}
 		return false;
 	}
@@ -693,6 +1123,34 @@ public:
 		return false;
 	}
 
+	/**
+	 * @brief read by time without copy
+	 * @param [in] time : time
+	 * @param [in]   fn : function called with the view of the record on shared memory
+	 * @param [in] user : user data of fn
+	 * @return true if the record is found
+	 * @note the view is valid only while fn is running, and data is not updated
+	 */
+	bool readTimeView( ssmTimeT time, void (*fn)(const particle_view*, void*), void *user )
+	{
+		view_context ctx;
+
+		if( !isOpen(  ) )
+		{
+			return false;
+		}
+		ctx.fn = fn;
+		ctx.user = user;
+		SSM_tid tid = readSSMP_time( ssmId, &ctx, time, &( this->time ),
+				SSMParticles::_ssmView, NULL );
+		if( tid >= 0 )
+		{
+			timeId = tid;
+			return true;
+		}
+		return false;
+	}
+
 };
 
 
@@ -904,11 +904,26 @@ int main(int argc, char **argv)
 			if( gnd::opsm::read_counting_map(&cnt_smmap, (map_path+map_name+"opsm-map").c_str()) < 0){
 				::fprintf(stderr, "  ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to load scan matching map \"\x1b[4m%s\x1b[0m\"\n", (map_path+map_name+"opsm-map").c_str());
 			}
-			else if( gnd::opsm::build_map(&smmap, &cnt_smmap, gnd_mm2dist(1)) < 0) {
-				::fprintf(stderr, "  ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to build scan matching map \"\x1b[4m%s\x1b[0m\"\n", (map_path+map_name+"opsm-map").c_str());
-			}
-			else if (gnd::opsm::build_bmp8(&bmp8, &smmap, gnd_m2dist( 1.0 / 32)) < 0) {
-				::fprintf(stderr, "  ... \x1b[1mOK\x1b[0m: load scan matching map \"\x1b[4m%s\x1b[0m\"\n", (map_path+map_name+"opsm-map").c_str());
+			else {
+				double prm[2] = { 0, gnd_mm2dist(1) };
+				uint64_t key = gnd::opsm::counting_map_key(&cnt_smmap, gnd::mapped_file_checksum(prm, sizeof(prm)));
+
+				// built map file is used if it is written by opsm-position-tracker or previous run (same building parameter)
+				if( gnd::opsm::read_map(&smmap, &cnt_smmap, (map_path+map_name+"opsm-map").c_str(),
+						gnd::opsm::CMapFileNameDefault, gnd::opsm::MapFileExtension, key) < 0 ) {
+					if( gnd::opsm::build_map(&smmap, &cnt_smmap, gnd_mm2dist(1)) < 0) {
+						::fprintf(stderr, "  ... \x1b[1m\x1b[31mERROR\x1b[39m\x1b[0m: fail to build scan matching map \"\x1b[4m%s\x1b[0m\"\n", (map_path+map_name+"opsm-map").c_str());
+					}
+					else {
+						// write built map file for next run (read-only map directory is allowed)
+						gnd::opsm::write_map(&smmap, (map_path+map_name+"opsm-map").c_str(),
+								gnd::opsm::CMapFileNameDefault, gnd::opsm::MapFileExtension, key);
+					}
+				}
+
+				if( smmap.plane[0].is_allocate() && gnd::opsm::build_bmp8(&bmp8, &smmap, gnd_m2dist( 1.0 / 32)) < 0) {
+					::fprintf(stderr, "  ... \x1b[1mOK\x1b[0m: load scan matching map \"\x1b[4m%s\x1b[0m\"\n", (map_path+map_name+"opsm-map").c_str());
+				}
 			}
 
 			for(unsigned int y=0; y<bmp8.row(); y++)